@@ -0,0 +1,68 @@
+#include "Camera.h"
+#include <benchmark/benchmark.h>
+
+namespace
+{
+	// RenderWindow::Update before Camera: the view rebuilt, the projection
+	// OnResize stored loaded, and three general inversions, every frame.
+	void BM_PassConstantsGeneralInverse(benchmark::State& state)
+	{
+		XMFLOAT4X4 storedProj;
+		XMStoreFloat4x4(&storedProj, XMMatrixPerspectiveFovLH(0.25f * XM_PI, 4.0f / 3.0f, 1.0f, 1000.0f));
+		benchmark::DoNotOptimize(&storedProj);
+
+		PassConstants pass = {};
+		float theta = 0.0f;
+		for (auto _ : state)
+		{
+			// The projection is data, as it was, not a constant to fold.
+			benchmark::ClobberMemory();
+
+			theta += 1e-4f;
+			XMMATRIX view = XMMatrixLookAtLH(MathHelper::SphericalToCartesian(5.0f, theta, XM_PIDIV4), XMVectorZero(), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+			XMMATRIX proj = XMLoadFloat4x4(&storedProj);
+			XMMATRIX viewProj = XMMatrixMultiply(view, proj);
+
+			XMVECTOR det;
+			XMStoreFloat4x4(&pass.View, XMMatrixTranspose(view));
+			XMStoreFloat4x4(&pass.InvView, XMMatrixTranspose(XMMatrixInverse(&det, view)));
+			XMStoreFloat4x4(&pass.Proj, XMMatrixTranspose(proj));
+			XMStoreFloat4x4(&pass.InvProj, XMMatrixTranspose(XMMatrixInverse(&det, proj)));
+			XMStoreFloat4x4(&pass.ViewProj, XMMatrixTranspose(viewProj));
+			XMStoreFloat4x4(&pass.InvViewProj, XMMatrixTranspose(XMMatrixInverse(&det, viewProj)));
+			benchmark::DoNotOptimize(pass);
+		}
+	}
+	BENCHMARK(BM_PassConstantsGeneralInverse);
+
+	// Camera with the orbit moving every frame: view rebuilt, closed-form
+	// inverses, projection cached.
+	void BM_PassConstantsCameraMoving(benchmark::State& state)
+	{
+		Camera camera;
+		camera.SetLens(0.25f * XM_PI, 4.0f / 3.0f, 1.0f, 1000.0f);
+		PassConstants pass = {};
+		float theta = 0.0f;
+		for (auto _ : state)
+		{
+			theta += 1e-4f;
+			camera.SetOrbit(5.0f, theta, XM_PIDIV4);
+			benchmark::DoNotOptimize(camera.UpdatePassConstants(pass));
+			benchmark::DoNotOptimize(pass);
+		}
+	}
+	BENCHMARK(BM_PassConstantsCameraMoving);
+
+	// Camera standing still: nothing to recompute.
+	void BM_PassConstantsCameraStill(benchmark::State& state)
+	{
+		Camera camera;
+		PassConstants pass = {};
+		for (auto _ : state)
+		{
+			camera.SetOrbit(5.0f, 1.5f * XM_PI, XM_PIDIV4);
+			benchmark::DoNotOptimize(camera.UpdatePassConstants(pass));
+		}
+	}
+	BENCHMARK(BM_PassConstantsCameraStill);
+}
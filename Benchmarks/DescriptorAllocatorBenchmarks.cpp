@@ -0,0 +1,80 @@
+#include "DescriptorAllocator.h"
+#include "FrameResource.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <random>
+
+namespace
+{
+	// Single-descriptor churn, as texture streaming does: free one, allocate
+	// one, with the frees held for gNumFrameResources frames.
+	void BM_FreeListChurn(benchmark::State& state)
+	{
+		const std::uint32_t capacity = 1024 * 64;
+		DescriptorFreeList list(0, capacity);
+		std::vector<DescriptorSpan> live;
+		for (std::uint32_t i = 0; i < capacity / 2; ++i)
+			live.push_back(list.Allocate(1));
+
+		std::mt19937 random(3);
+		std::uint64_t fence = 0;
+		std::size_t operations = 0;
+		for (auto _ : state)
+		{
+			for (int i = 0; i < 256; ++i)
+			{
+				DescriptorSpan& slot = live[random() % live.size()];
+				list.Free(slot);
+				slot = list.Allocate(1);
+				benchmark::DoNotOptimize(slot);
+			}
+			operations += 256;
+
+			list.EndFrame(++fence);
+			if (fence > gNumFrameResources)
+				list.ReleaseCompleted(fence - gNumFrameResources);
+		}
+		state.SetItemsProcessed(operations);
+		state.counters["ranges"] = list.GetFreeRangeCount();
+	}
+	BENCHMARK(BM_FreeListChurn);
+
+	// Mixed sizes freed in random order: how the sorted list copes with
+	// fragmentation.
+	void BM_FreeListFragmented(benchmark::State& state)
+	{
+		const std::uint32_t capacity = 1024 * 64;
+		std::mt19937 random(5);
+		for (auto _ : state)
+		{
+			DescriptorFreeList list(0, capacity);
+			std::vector<DescriptorSpan> spans;
+			for (DescriptorSpan span = list.Allocate(1 + random() % 16); span.IsValid(); span = list.Allocate(1 + random() % 16))
+				spans.push_back(span);
+			std::shuffle(spans.begin(), spans.end(), random);
+			for (const DescriptorSpan& span : spans)
+				list.FreeNow(span);
+			benchmark::DoNotOptimize(list.GetFreeRangeCount());
+			state.SetItemsProcessed(state.items_processed() + 2 * spans.size());
+		}
+	}
+	BENCHMARK(BM_FreeListFragmented)->Unit(benchmark::kMicrosecond);
+
+	// A frame's tables: range(0) allocations of 1-8 descriptors from the ring.
+	void BM_RingFrame(benchmark::State& state)
+	{
+		const std::uint32_t tables = (std::uint32_t)state.range(0);
+		DescriptorRing ring(0, 4096 * gNumFrameResources);
+		std::uint64_t fence = 0;
+		for (auto _ : state)
+		{
+			for (std::uint32_t i = 0; i < tables; ++i)
+				benchmark::DoNotOptimize(ring.Allocate(1 + (i & 7)));
+			ring.EndFrame(++fence);
+			if (fence >= gNumFrameResources)
+				ring.ReleaseCompleted(fence - gNumFrameResources + 1);
+		}
+		state.SetItemsProcessed(state.iterations() * tables);
+	}
+	BENCHMARK(BM_RingFrame)->Arg(64)->Arg(512);
+}
@@ -0,0 +1,100 @@
+#include "Components.h"
+#include "EntityWorld.h"
+#include "FrameResource.h"
+#include <benchmark/benchmark.h>
+
+namespace
+{
+	const std::uint32_t EntityCount = 1000000;
+
+	// The entities GameObject creates, minus the render link.
+	void Populate(EntityWorld& world)
+	{
+		for (std::uint32_t i = 0; i < EntityCount; ++i)
+		{
+			Transform local(XMFLOAT3((float)(i % 1000), 0.0f, (float)(i / 1000)), XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f), 1.0f);
+			world.Create(local, MeshRef(), Bounds(), Visibility());
+		}
+	}
+
+	// One system over 1M entities per frame: it reads the transform and
+	// writes the visibility, touching two of the four component arrays.
+	void BM_ForEach1M(benchmark::State& state)
+	{
+		EntityWorld world;
+		Populate(world);
+
+		for (auto _ : state)
+		{
+			world.ForEach<const Transform, Visibility>([](Entity, const Transform& transform, Visibility& visibility)
+			{
+				visibility.Visible = transform.Position.x < 500.0f;
+			});
+			benchmark::ClobberMemory();
+		}
+		state.SetItemsProcessed(state.iterations() * EntityCount);
+	}
+	BENCHMARK(BM_ForEach1M)->Unit(benchmark::kMillisecond);
+
+	void BM_ParallelForEach1M(benchmark::State& state)
+	{
+		EntityWorld world;
+		Populate(world);
+
+		std::uint32_t frame = 0;
+		for (auto _ : state)
+		{
+			FrameArena::BeginFrame(frame++ % gNumFrameResources);
+			world.ParallelForEach<const Transform, Visibility>([](Entity, const Transform& transform, Visibility& visibility)
+			{
+				visibility.Visible = transform.Position.x < 500.0f;
+			});
+			benchmark::ClobberMemory();
+		}
+		state.SetItemsProcessed(state.iterations() * EntityCount);
+	}
+	BENCHMARK(BM_ParallelForEach1M)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+	// The same system over an array of whole entities, as a vector of
+	// objects would store them: every component is pulled through the cache.
+	struct EntityObject
+	{
+		Transform								Local;
+		MeshRef									Mesh;
+		Bounds									Box;
+		Visibility								Visible;
+	};
+
+	void BM_ArrayOfObjects1M(benchmark::State& state)
+	{
+		std::vector<EntityObject> objects(EntityCount);
+		for (std::uint32_t i = 0; i < EntityCount; ++i)
+			objects[i].Local.Position.x = (float)(i % 1000);
+
+		for (auto _ : state)
+		{
+			for (EntityObject& object : objects)
+				object.Visible.Visible = object.Local.Position.x < 500.0f;
+			benchmark::ClobberMemory();
+		}
+		state.SetItemsProcessed(state.iterations() * EntityCount);
+	}
+	BENCHMARK(BM_ArrayOfObjects1M)->Unit(benchmark::kMillisecond);
+
+	// Building and tearing down 1M entities.
+	void BM_CreateDestroy1M(benchmark::State& state)
+	{
+		for (auto _ : state)
+		{
+			EntityWorld world;
+			std::vector<Entity> entities;
+			entities.reserve(EntityCount);
+			for (std::uint32_t i = 0; i < EntityCount; ++i)
+				entities.push_back(world.Create(Transform(), Visibility()));
+			for (Entity entity : entities)
+				world.Destroy(entity);
+		}
+		state.SetItemsProcessed(state.iterations() * EntityCount);
+	}
+	BENCHMARK(BM_CreateDestroy1M)->Unit(benchmark::kMillisecond);
+}
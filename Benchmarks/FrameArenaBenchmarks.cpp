@@ -0,0 +1,69 @@
+#include "FrameArena.h"
+#include "FrameResource.h"
+#include <benchmark/benchmark.h>
+
+namespace
+{
+	// A frame's scratch list, as UpdateObjectCBs builds its dirty list: one
+	// reserve and range(0) push_backs, from the heap and from FrameArena.
+	void BM_ScratchStdVector(benchmark::State& state)
+	{
+		const size_t count = (size_t)state.range(0);
+		for (auto _ : state)
+		{
+			std::vector<void*> scratch;
+			scratch.reserve(count);
+			for (size_t i = 0; i < count; ++i)
+				scratch.push_back(&scratch);
+			benchmark::DoNotOptimize(scratch.data());
+		}
+	}
+	BENCHMARK(BM_ScratchStdVector)->Arg(64)->Arg(4096)->Arg(65536);
+
+	void BM_ScratchFrameVector(benchmark::State& state)
+	{
+		const size_t count = (size_t)state.range(0);
+		std::uint32_t frame = 0;
+		for (auto _ : state)
+		{
+			FrameArena::BeginFrame(frame++ % gNumFrameResources);
+			FrameVector<void*> scratch;
+			scratch.reserve(count);
+			for (size_t i = 0; i < count; ++i)
+				scratch.push_back(&scratch);
+			benchmark::DoNotOptimize(scratch.data());
+		}
+	}
+	BENCHMARK(BM_ScratchFrameVector)->Arg(64)->Arg(4096)->Arg(65536);
+
+	// Many small allocations without a reserve, where the heap pays most.
+	void BM_SmallAllocationsHeap(benchmark::State& state)
+	{
+		std::vector<void*> blocks(256);
+		for (auto _ : state)
+		{
+			for (void*& block : blocks)
+				block = ::operator new(48);
+			benchmark::DoNotOptimize(blocks.data());
+			for (void* block : blocks)
+				::operator delete(block);
+		}
+		state.SetItemsProcessed(state.iterations() * blocks.size());
+	}
+	BENCHMARK(BM_SmallAllocationsHeap);
+
+	void BM_SmallAllocationsFrameArena(benchmark::State& state)
+	{
+		std::vector<void*> blocks(256);
+		std::uint32_t frame = 0;
+		for (auto _ : state)
+		{
+			FrameArena::BeginFrame(frame++ % gNumFrameResources);
+			for (void*& block : blocks)
+				block = FrameArena::Allocate(48);
+			benchmark::DoNotOptimize(blocks.data());
+		}
+		state.SetItemsProcessed(state.iterations() * blocks.size());
+	}
+	BENCHMARK(BM_SmallAllocationsFrameArena);
+}
@@ -0,0 +1,36 @@
+#include "FrameLimiter.h"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+	// Pacing at 1 kHz on the real clock and scheduler, by spin threshold in
+	// microseconds. Zero leaves the spin window to the measured overshoot
+	// alone. Reports how late the waits woke and how much of each frame was
+	// slept through rather than spun.
+	void BM_WaitForNextFrame(benchmark::State& state)
+	{
+		double slept = 0.0;
+		FrameLimiter limiter(
+			[] { return GameTimer::QueryCounter() * GameTimer::SecondsPerCount(); },
+			[&slept](double seconds)
+			{
+				double before = GameTimer::QueryCounter() * GameTimer::SecondsPerCount();
+				std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+				slept += GameTimer::QueryCounter() * GameTimer::SecondsPerCount() - before;
+			});
+		limiter.SetTargetFrameRate(1000.0);
+		limiter.SetSpinThreshold(state.range(0) * 1e-6);
+		limiter.WaitForNextFrame();
+
+		for (auto _ : state)
+			limiter.WaitForNextFrame();
+
+		FrameTimeStats wake = limiter.WakeError().Compute();
+		state.counters["wake_p50_us"] = wake.P50 * 1000.0f;
+		state.counters["wake_p99_us"] = wake.P99 * 1000.0f;
+		state.counters["sleep%"] = 100.0 * slept / (state.iterations() * 1e-3);
+	}
+	BENCHMARK(BM_WaitForNextFrame)->Arg(0)->Arg(200)->Arg(2000)->Unit(benchmark::kMicrosecond)->UseRealTime();
+}
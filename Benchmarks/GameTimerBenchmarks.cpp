@@ -0,0 +1,43 @@
+#include "GameTimer.h"
+#include <benchmark/benchmark.h>
+#include <chrono>
+
+namespace
+{
+	// The timer's counter backend.
+	void BM_QueryCounter(benchmark::State& state)
+	{
+		for (auto _ : state)
+			benchmark::DoNotOptimize(GameTimer::QueryCounter());
+	}
+	BENCHMARK(BM_QueryCounter);
+
+	void BM_SteadyClockNow(benchmark::State& state)
+	{
+		for (auto _ : state)
+			benchmark::DoNotOptimize(std::chrono::steady_clock::now());
+	}
+	BENCHMARK(BM_SteadyClockNow);
+
+	// A frame's timing work: counter read and histogram record.
+	void BM_GameTimerTick(benchmark::State& state)
+	{
+		GameTimer timer;
+		timer.Reset();
+		for (auto _ : state)
+			timer.Tick();
+		benchmark::DoNotOptimize(timer.DeltaTime());
+	}
+	BENCHMARK(BM_GameTimerTick);
+
+	// Statistics over a full window, as the overlay computes them.
+	void BM_FrameTimeHistogramCompute(benchmark::State& state)
+	{
+		FrameTimeHistogram histogram;
+		for (std::uint32_t i = 0; i < FrameTimeHistogram::Capacity; ++i)
+			histogram.Record(0.016 + (i * 7919 % 100) * 1e-5);
+		for (auto _ : state)
+			benchmark::DoNotOptimize(histogram.Compute());
+	}
+	BENCHMARK(BM_FrameTimeHistogramCompute)->Unit(benchmark::kMicrosecond);
+}
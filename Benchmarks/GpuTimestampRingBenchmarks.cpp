@@ -0,0 +1,35 @@
+#include "GpuTimestampRing.h"
+#include "FrameResource.h"
+#include <benchmark/benchmark.h>
+
+namespace
+{
+	// The GPU timer's CPU side for one frame: 16 nested zones recorded, then
+	// resolved from the read-back.
+	void BM_TimestampRingFrame(benchmark::State& state)
+	{
+		const std::uint32_t zones = 16;
+		GpuTimestampRing ring(gNumFrameResources, zones);
+		std::vector<std::uint64_t> timestamps(ring.TotalQueries());
+		for (std::size_t i = 0; i < timestamps.size(); ++i)
+			timestamps[i] = 1000 * i;
+		std::vector<GpuZoneTiming> timings;
+		timings.reserve(zones);
+
+		std::uint32_t frame = 0;
+		for (auto _ : state)
+		{
+			ring.Resolve(frame, timestamps.data() + ring.FirstQuery(frame), 1000000, timings);
+			benchmark::DoNotOptimize(timings.data());
+
+			ring.BeginFrame(frame);
+			std::uint32_t outer = ring.BeginZone("Frame");
+			for (std::uint32_t i = 1; i < zones; ++i)
+				ring.EndZone(ring.BeginZone("Pass"));
+			ring.EndZone(outer);
+			frame = (frame + 1) % gNumFrameResources;
+		}
+		state.SetItemsProcessed(state.iterations() * zones);
+	}
+	BENCHMARK(BM_TimestampRingFrame);
+}
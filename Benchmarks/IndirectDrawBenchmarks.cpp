@@ -0,0 +1,82 @@
+#include "IndirectDraw.h"
+#include "NullBackend.h"
+#include "SceneRenderer.h"
+#include <benchmark/benchmark.h>
+
+namespace
+{
+	const UINT ItemCount = 4096;
+
+	// Spawns ItemCount entities with `visiblePercent` of them visible, spread
+	// evenly, and occlusion culling off so visibility stays as set.
+	void BuildScene(SceneRenderer& renderer, int visiblePercent)
+	{
+		GameObject& scene = renderer.GetScene();
+		scene.SetOcclusionCulling(false);
+		for (UINT i = 0; i < ItemCount; ++i)
+		{
+			Transform local(XMFLOAT3(2.0f * (i % 64), 0.0f, 2.0f * (i / 64)), XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f), 1.0f);
+			Entity entity = scene.Spawn("shapeGeo", "box", local);
+			scene.GetEntities().Get<Visibility>(entity)->Visible = (i * visiblePercent) % 100 < (UINT)visiblePercent;
+		}
+	}
+
+	// Records and executes the draws of one frame, direct or indirect, with
+	// 1% or 100% of the items visible.
+	void BM_DrawScene(benchmark::State& state)
+	{
+		bool indirect = state.range(0) != 0;
+		int visiblePercent = (int)state.range(1);
+
+		NullRenderDevice device;
+		SceneRendererSettings settings;
+		settings.IndirectDraw = indirect;
+		SceneRenderer renderer(device, settings, ItemCount);
+		renderer.Initialize();
+		BuildScene(renderer, visiblePercent);
+
+		GameTimer timer;
+		timer.Reset();
+		for (auto _ : state)
+		{
+			renderer.BeginFrame();
+			state.PauseTiming();
+			renderer.Update(timer, 800, 600);
+			state.ResumeTiming();
+
+			GpuCommandList& commandList = renderer.BeginCommandList();
+			renderer.DrawScene(commandList);
+			renderer.Submit(commandList);
+			renderer.Signal();
+		}
+		renderer.Flush();
+
+		state.counters["draws"] = renderer.GetDrawCount();
+		state.SetItemsProcessed(state.iterations() * ItemCount);
+	}
+	BENCHMARK(BM_DrawScene)->ArgNames({ "indirect", "visible%" })->ArgsProduct({ { 0, 1 }, { 1, 100 } })->Unit(benchmark::kMicrosecond);
+
+	// The CPU argument building alone.
+	void BM_IndirectBuild(benchmark::State& state)
+	{
+		int visiblePercent = (int)state.range(0);
+
+		MeshGeometry geo;
+		std::vector<RenderItem> items(ItemCount);
+		for (UINT i = 0; i < ItemCount; ++i)
+		{
+			items[i].Geo = &geo;
+			items[i].ObjCBIndex = i;
+			items[i].IndexCount = 36;
+			items[i].Visible = (i * visiblePercent) % 100 < (UINT)visiblePercent;
+		}
+
+		IndirectDrawBuilder builder;
+		for (auto _ : state)
+			benchmark::DoNotOptimize(builder.Build(items, 0x10000));
+
+		state.counters["commands"] = builder.GetCommandCount();
+		state.SetItemsProcessed(state.iterations() * ItemCount);
+	}
+	BENCHMARK(BM_IndirectBuild)->ArgName("visible%")->Arg(1)->Arg(100)->Unit(benchmark::kMicrosecond);
+}
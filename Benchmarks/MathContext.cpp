@@ -0,0 +1,17 @@
+#include "MathTypes.h"
+#include <benchmark/benchmark.h>
+
+namespace
+{
+	// Printed above the results, so timings taken on the scalar stand-in are
+	// not mistaken for the shipped code's.
+	const bool s_mathContext = []
+	{
+#if ENGINE_PORTABLE_MATH
+		benchmark::AddCustomContext("math", "scalar stand-in (Portable/), not the shipped SSE DirectXMath");
+#else
+		benchmark::AddCustomContext("math", "DirectXMath");
+#endif
+		return true;
+	}();
+}
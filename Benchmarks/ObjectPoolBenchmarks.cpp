@@ -0,0 +1,66 @@
+#include "GameObject.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+
+namespace
+{
+	const std::uint32_t ItemCount = 100000;
+
+	// The gather UpdateObjectCBs and the draw loops do: one read of every
+	// live item.
+	template<typename Items, typename Deref>
+	std::uint32_t CountDirtyVisible(const Items& items, Deref deref)
+	{
+		std::uint32_t count = 0;
+		for (const auto& entry : items)
+		{
+			const RenderItem& item = deref(entry);
+			count += item.NumFramesDirty > 0 && item.Visible;
+		}
+		return count;
+	}
+
+	// The pool after heavy churn: half the items despawned at random and
+	// respawned, so slots and dense order no longer match.
+	void BM_PoolWalk(benchmark::State& state)
+	{
+		RenderItemPool pool(ItemCount);
+		std::vector<PoolHandle> handles;
+		for (std::uint32_t i = 0; i < ItemCount; ++i)
+			handles.push_back(pool.Create());
+		std::mt19937 random(11);
+		std::shuffle(handles.begin(), handles.end(), random);
+		for (std::uint32_t i = 0; i < ItemCount / 2; ++i)
+			pool.Destroy(handles[i]);
+		for (std::uint32_t i = 0; i < ItemCount / 2; ++i)
+			pool.Create();
+
+		for (auto _ : state)
+			benchmark::DoNotOptimize(CountDirtyVisible(pool.Items(), [](const RenderItem& item) -> const RenderItem& { return item; }));
+		state.SetItemsProcessed(state.iterations() * ItemCount);
+		state.SetBytesProcessed(state.iterations() * ItemCount * sizeof(RenderItem));
+	}
+	BENCHMARK(BM_PoolWalk)->Unit(benchmark::kMicrosecond);
+
+	// What a dense list of pointers into scattered storage costs: the same
+	// walk through pointers in an order unrelated to the objects' addresses.
+	void BM_PointerWalk(benchmark::State& state)
+	{
+		std::vector<std::unique_ptr<RenderItem>> storage;
+		for (std::uint32_t i = 0; i < ItemCount; ++i)
+			storage.push_back(std::make_unique<RenderItem>());
+		std::vector<RenderItem*> items;
+		for (const auto& item : storage)
+			items.push_back(item.get());
+		std::mt19937 random(11);
+		std::shuffle(items.begin(), items.end(), random);
+
+		for (auto _ : state)
+			benchmark::DoNotOptimize(CountDirtyVisible(items, [](const RenderItem* item) -> const RenderItem& { return *item; }));
+		state.SetItemsProcessed(state.iterations() * ItemCount);
+		state.SetBytesProcessed(state.iterations() * ItemCount * sizeof(RenderItem));
+	}
+	BENCHMARK(BM_PointerWalk)->Unit(benchmark::kMicrosecond);
+}
@@ -0,0 +1,115 @@
+#include "OcclusionBuffer.h"
+#include "CreateGeometry.h"
+#include "HeadlessRenderer.h"
+#include "NullBackend.h"
+#include <benchmark/benchmark.h>
+#include <random>
+
+namespace
+{
+	// Looking down at a 64 x 64 field of boxes from its edge.
+	void StoreViewProj(float* out)
+	{
+		XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 8.0f, -40.0f, 1.0f), XMVectorZero(), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+		XMMATRIX proj = XMMatrixPerspectiveFovLH(0.25f * XM_PI, 320.0f / 192.0f, 1.0f, 1000.0f);
+		XMStoreFloat4x4(reinterpret_cast<XMFLOAT4X4*>(out), XMMatrixMultiply(view, proj));
+	}
+
+	// range(0) large boxes added and rasterized, as GameObject::CullOccluded
+	// does each frame.
+	void BM_RasterizeOccluders(benchmark::State& state)
+	{
+		const std::uint32_t occluders = (std::uint32_t)state.range(0);
+		CreateGeometry::MeshData box = CreateGeometry().CreateBox(1.0f, 1.0f, 1.0f, 0);
+		const TrackedVector<std::uint16_t, MemTag::Geometry>& indices = box.GetIndices16();
+
+		std::mt19937 random(3);
+		std::uniform_real_distribution<float> position(-30.0f, 30.0f);
+		std::uniform_real_distribution<float> size(2.0f, 8.0f);
+		std::vector<XMFLOAT4X4> worlds(occluders);
+		for (XMFLOAT4X4& world : worlds)
+			XMStoreFloat4x4(&world, XMMatrixMultiply(XMMatrixScaling(size(random), size(random), size(random)), XMMatrixTranslation(position(random), 0.0f, position(random))));
+
+		float viewProj[16];
+		StoreViewProj(viewProj);
+		OcclusionBuffer buffer;
+		for (auto _ : state)
+		{
+			buffer.BeginFrame(viewProj);
+			for (const XMFLOAT4X4& world : worlds)
+				buffer.AddOccluder(&world._11, box.Vertices.data(), sizeof(CreateGeometry::Vertex), indices.data(), (std::uint32_t)indices.size());
+			buffer.Rasterize();
+			benchmark::DoNotOptimize(buffer.GetDepth());
+		}
+		state.counters["triangles"] = buffer.GetStats().Triangles;
+		state.counters["tileTriangles"] = buffer.GetStats().TileTriangles;
+		state.SetItemsProcessed(state.iterations() * occluders);
+	}
+	BENCHMARK(BM_RasterizeOccluders)->Arg(4)->Arg(16)->Arg(64)->Unit(benchmark::kMicrosecond);
+
+	// 4096 small boxes tested against 16 occluders: the other half of the
+	// occlusion pass.
+	void BM_TestBoxes(benchmark::State& state)
+	{
+		CreateGeometry::MeshData box = CreateGeometry().CreateBox(1.0f, 1.0f, 1.0f, 0);
+		const TrackedVector<std::uint16_t, MemTag::Geometry>& indices = box.GetIndices16();
+
+		float viewProj[16];
+		StoreViewProj(viewProj);
+		OcclusionBuffer buffer;
+		buffer.BeginFrame(viewProj);
+		std::mt19937 random(5);
+		std::uniform_real_distribution<float> position(-30.0f, 30.0f);
+		std::uniform_real_distribution<float> size(2.0f, 8.0f);
+		for (int i = 0; i < 16; ++i)
+		{
+			XMFLOAT4X4 world;
+			XMStoreFloat4x4(&world, XMMatrixMultiply(XMMatrixScaling(size(random), size(random), size(random)), XMMatrixTranslation(position(random), 0.0f, position(random))));
+			buffer.AddOccluder(&world._11, box.Vertices.data(), sizeof(CreateGeometry::Vertex), indices.data(), (std::uint32_t)indices.size());
+		}
+		buffer.Rasterize();
+
+		std::vector<XMFLOAT3> centers(4096);
+		for (std::size_t i = 0; i < centers.size(); ++i)
+			centers[i] = XMFLOAT3(2.0f * (i % 64) - 64.0f, 0.0f, 2.0f * (i / 64) - 64.0f);
+		const XMFLOAT3 extents(0.5f, 0.5f, 0.5f);
+
+		std::size_t hidden = 0;
+		for (auto _ : state)
+		{
+			hidden = 0;
+			for (const XMFLOAT3& center : centers)
+				hidden += !buffer.IsVisible(&center.x, &extents.x);
+			benchmark::DoNotOptimize(hidden);
+		}
+		state.counters["hidden"] = (double)hidden;
+		state.SetItemsProcessed(state.iterations() * centers.size());
+	}
+	BENCHMARK(BM_TestBoxes)->Unit(benchmark::kMicrosecond);
+
+	// Full headless frames of 4096 items with occlusion culling off (0) or on
+	// with range(0) occluders.
+	void BM_OcclusionFrame(benchmark::State& state)
+	{
+		HeadlessSettings settings;
+		settings.ItemCount = 4096;
+		settings.OcclusionCulling = state.range(0) > 0;
+		settings.MaxOccluders = (std::uint32_t)state.range(0);
+
+		NullRenderDevice device;
+		HeadlessRenderer renderer(device, settings);
+		renderer.Initialize();
+
+		GameTimer timer;
+		timer.Reset();
+		renderer.Run(timer, gNumFrameResources);
+
+		for (auto _ : state)
+			renderer.Run(timer, 1);
+		renderer.Flush();
+
+		state.counters["draws"] = renderer.GetFrameStats().Draws;
+		state.SetItemsProcessed(state.iterations() * settings.ItemCount);
+	}
+	BENCHMARK(BM_OcclusionFrame)->ArgName("occluders")->Arg(0)->Arg(16)->Unit(benchmark::kMicrosecond);
+}
@@ -0,0 +1,68 @@
+#include "Profiler.h"
+#include <benchmark/benchmark.h>
+
+namespace
+{
+	// The cost of instrumenting a zone: an empty zone against no zone at all,
+	// on one thread and on several at once (each writes its own ring).
+	void BM_NoZone(benchmark::State& state)
+	{
+		int work = 0;
+		for (auto _ : state)
+		{
+			work++;
+			benchmark::DoNotOptimize(work);
+		}
+	}
+	BENCHMARK(BM_NoZone)->Threads(1)->Threads(4);
+
+	void BM_ProfileScope(benchmark::State& state)
+	{
+		if (state.thread_index() == 0)
+			Profiler::Get().Clear();
+
+		int work = 0;
+		for (auto _ : state)
+		{
+			PROFILE_SCOPE("benchmark zone");
+			work++;
+			benchmark::DoNotOptimize(work);
+		}
+	}
+	BENCHMARK(BM_ProfileScope)->Threads(1)->Threads(4);
+
+	void BM_ProfileCounter(benchmark::State& state)
+	{
+		double value = 0.0;
+		for (auto _ : state)
+			PROFILE_COUNTER("benchmark counter", value += 1.0);
+	}
+	BENCHMARK(BM_ProfileCounter);
+
+	// Track zones take the profiler lock; this is what the GPU timestamps
+	// pay per zone.
+	void BM_RecordTrackZone(benchmark::State& state)
+	{
+		std::int64_t tick = 0;
+		for (auto _ : state)
+		{
+			Profiler::Get().RecordTrackZone("benchmark track", "benchmark zone", tick, tick + 1, 0);
+			tick++;
+		}
+	}
+	BENCHMARK(BM_RecordTrackZone)->Threads(1)->Threads(4);
+
+	// Exporting full rings, as a capture does.
+	void BM_ExportChromeTrace(benchmark::State& state)
+	{
+		Profiler& profiler = Profiler::Get();
+		profiler.Clear();
+		for (std::uint32_t i = 0; i < Profiler::EventsPerThread; ++i)
+			PROFILE_SCOPE("benchmark zone");
+
+		for (auto _ : state)
+			benchmark::DoNotOptimize(profiler.ExportChromeTrace());
+		state.SetItemsProcessed(state.iterations() * Profiler::EventsPerThread);
+	}
+	BENCHMARK(BM_ExportChromeTrace)->Unit(benchmark::kMillisecond);
+}
@@ -0,0 +1,144 @@
+#include "Random.h"
+#include "MathHelper.h"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+	// What MathHelper did before Random: the C library's generator.
+	void BM_CRand(benchmark::State& state)
+	{
+		std::srand(1);
+		for (auto _ : state)
+			benchmark::DoNotOptimize(std::rand());
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_CRand);
+
+	void BM_Next(benchmark::State& state)
+	{
+		Random random(1);
+		for (auto _ : state)
+			benchmark::DoNotOptimize(random.Next());
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_Next);
+
+	void BM_NextFloatRange(benchmark::State& state)
+	{
+		Random random(1);
+		for (auto _ : state)
+			benchmark::DoNotOptimize(random.NextFloat(-1.0f, 1.0f));
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_NextFloatRange);
+
+	// Through the thread-local generator, as the rest of the engine calls it.
+	void BM_MathHelperRandF(benchmark::State& state)
+	{
+		for (auto _ : state)
+			benchmark::DoNotOptimize(MathHelper::RandF(-1.0f, 1.0f));
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_MathHelperRandF);
+
+	// rand() % n, biased, against NextUInt(n).
+	void BM_CRandModulo(benchmark::State& state)
+	{
+		std::srand(1);
+		const int bound = (int)state.range(0);
+		for (auto _ : state)
+			benchmark::DoNotOptimize(std::rand() % bound);
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_CRandModulo)->Arg(6)->Arg(1000);
+
+	void BM_NextUInt(benchmark::State& state)
+	{
+		Random random(1);
+		const std::uint32_t bound = (std::uint32_t)state.range(0);
+		for (auto _ : state)
+			benchmark::DoNotOptimize(random.NextUInt(bound));
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_NextUInt)->Arg(6)->Arg(1000)->Arg(3ll << 30);
+
+	void BM_FillFloats(benchmark::State& state)
+	{
+		Random random(1);
+		std::vector<float> values((std::size_t)state.range(0));
+		for (auto _ : state)
+		{
+			random.FillFloats(values.data(), values.size(), -1.0f, 1.0f);
+			benchmark::DoNotOptimize(values.data());
+		}
+		state.SetItemsProcessed(state.iterations() * values.size());
+	}
+	BENCHMARK(BM_FillFloats)->Arg(64)->Arg(4096);
+
+	void BM_FillUInts(benchmark::State& state)
+	{
+		Random random(1);
+		std::vector<std::uint32_t> values(4096);
+		const std::uint32_t bound = (std::uint32_t)state.range(0);
+		for (auto _ : state)
+		{
+			random.FillUInts(values.data(), values.size(), bound);
+			benchmark::DoNotOptimize(values.data());
+		}
+		state.SetItemsProcessed(state.iterations() * values.size());
+	}
+	BENCHMARK(BM_FillUInts)->Arg(1000)->Arg(3ll << 30);
+
+	// The rejection loop MathHelper::RandUnitVec3 ran on rand() before:
+	// points in the cube until one falls inside the ball.
+	void BM_RejectionUnitVector(benchmark::State& state)
+	{
+		std::srand(1);
+		for (auto _ : state)
+		{
+			float x, y, z, lengthSq;
+			do
+			{
+				x = 2.0f * (float)std::rand() / (float)RAND_MAX - 1.0f;
+				y = 2.0f * (float)std::rand() / (float)RAND_MAX - 1.0f;
+				z = 2.0f * (float)std::rand() / (float)RAND_MAX - 1.0f;
+				lengthSq = x * x + y * y + z * z;
+			} while (lengthSq > 1.0f || lengthSq == 0.0f);
+			float scale = 1.0f / std::sqrt(lengthSq);
+			float v[3] = { x * scale, y * scale, z * scale };
+			benchmark::DoNotOptimize(v);
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_RejectionUnitVector);
+
+	void BM_UnitVector(benchmark::State& state)
+	{
+		Random random(1);
+		for (auto _ : state)
+		{
+			float v[3];
+			random.UnitVector(v);
+			benchmark::DoNotOptimize(v);
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_UnitVector);
+
+	void BM_HemisphereVector(benchmark::State& state)
+	{
+		Random random(1);
+		const float n[3] = { 0.0f, 1.0f, 0.0f };
+		for (auto _ : state)
+		{
+			float v[3];
+			random.HemisphereVector(n, v);
+			benchmark::DoNotOptimize(v);
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_HemisphereVector);
+}
@@ -0,0 +1,38 @@
+#include "ReferenceRasterizer.h"
+#include "HeadlessRenderer.h"
+#include "NullBackend.h"
+#include <benchmark/benchmark.h>
+
+namespace
+{
+	// Headless frames of range(0) items drawn on the reference rasterizer at
+	// 800 x 600, with its triangle and pixel throughput.
+	void BM_ReferenceFrame(benchmark::State& state)
+	{
+		HeadlessSettings settings;
+		settings.ItemCount = (std::uint32_t)state.range(0);
+
+		ReferenceRasterizer rasterizer(settings.RenderTargetWidth, settings.RenderTargetHeight);
+		NullRenderDevice device;
+		device.SetRasterizer(&rasterizer);
+		HeadlessRenderer renderer(device, settings);
+		renderer.Initialize();
+
+		GameTimer timer;
+		timer.Reset();
+		timer.Stop();
+		const float clearColor[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+		rasterizer.ResetStats();
+		for (auto _ : state)
+		{
+			rasterizer.Clear(clearColor);
+			renderer.Run(timer, 1);
+		}
+		renderer.Flush();
+
+		const ReferenceStats& stats = rasterizer.GetStats();
+		state.counters["triangles/s"] = benchmark::Counter((double)stats.Triangles, benchmark::Counter::kIsRate);
+		state.counters["pixels/s"] = benchmark::Counter((double)stats.PixelsCovered, benchmark::Counter::kIsRate);
+	}
+	BENCHMARK(BM_ReferenceFrame)->ArgName("items")->Arg(64)->Arg(1024)->Unit(benchmark::kMillisecond);
+}
@@ -0,0 +1,74 @@
+#include "HeadlessRenderer.h"
+#include "NullBackend.h"
+#include <benchmark/benchmark.h>
+
+namespace
+{
+	// Full headless frames of 4096 items with 1% or 100% of them moving, so
+	// that 1% or all of the object constants are uploaded each frame.
+	void BM_Frame(benchmark::State& state)
+	{
+		HeadlessSettings settings;
+		settings.ItemCount = 4096;
+		settings.MovingFraction = (float)state.range(0) / 100.0f;
+
+		NullRenderDevice device;
+		HeadlessRenderer renderer(device, settings);
+		renderer.Initialize();
+
+		GameTimer timer;
+		timer.Reset();
+		// Past the frames that upload every new item.
+		renderer.Run(timer, gNumFrameResources);
+
+		for (auto _ : state)
+			renderer.Run(timer, 1);
+		renderer.Flush();
+
+		state.counters["written"] = renderer.GetFrameStats().ObjectCBWritten;
+		state.counters["skipped"] = renderer.GetFrameStats().ObjectCBSkipped;
+		state.SetItemsProcessed(state.iterations() * settings.ItemCount);
+	}
+	BENCHMARK(BM_Frame)->ArgName("moving%")->Arg(1)->Arg(100)->Unit(benchmark::kMicrosecond);
+
+	// Entity churn: 64 of 4096 entities despawned and as many spawned each
+	// frame, with the transform and constant buffer work that follows.
+	void BM_SpawnDespawnFrame(benchmark::State& state)
+	{
+		NullRenderDevice device;
+		SceneRenderer renderer(device, SceneRendererSettings(), 4096);
+		renderer.Initialize();
+
+		GameObject& scene = renderer.GetScene();
+		StringId geo("shapeGeo");
+		StringId box("box");
+		std::vector<Entity> entities;
+		for (int i = 0; i < 4096; ++i)
+			entities.push_back(scene.Spawn(geo, box, Transform(XMFLOAT3(2.0f * (i % 64), 0.0f, 2.0f * (i / 64)), XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f), 1.0f)));
+
+		GameTimer timer;
+		timer.Reset();
+		std::uint32_t random = 1;
+		for (auto _ : state)
+		{
+			for (int i = 0; i < 64; ++i)
+			{
+				random = random * 1664525u + 1013904223u;
+				Entity& entity = entities[(random >> 8) % entities.size()];
+				Transform local = *scene.GetTransform(entity);
+				scene.Despawn(entity);
+				entity = scene.Spawn(geo, box, local);
+			}
+
+			renderer.BeginFrame();
+			renderer.Update(timer, 800, 600);
+			GpuCommandList& commandList = renderer.BeginCommandList();
+			renderer.DrawScene(commandList);
+			renderer.Submit(commandList);
+			renderer.Signal();
+		}
+		renderer.Flush();
+		state.SetItemsProcessed(state.iterations() * 64);
+	}
+	BENCHMARK(BM_SpawnDespawnFrame)->Unit(benchmark::kMicrosecond);
+}
@@ -0,0 +1,97 @@
+#include "MathHelper.h"
+#include "TransformHierarchy.h"
+#include <benchmark/benchmark.h>
+
+namespace
+{
+	// Working-set sweep: from 4K objects, which fit in L2 in every layout, to
+	// 4M, which is hundreds of megabytes and past the last-level cache. Time
+	// per object rises where a layout stops fitting in a cache level, so the
+	// smaller layout shows up as a later and lower step.
+	void ObjectCounts(benchmark::internal::Benchmark* benchmark)
+	{
+		benchmark->ArgName("objects")->RangeMultiplier(4)->Range(1 << 12, 1 << 22)->Unit(benchmark::kMicrosecond);
+	}
+
+	void SetCounters(benchmark::State& state, size_t bytesPerObject)
+	{
+		size_t count = (size_t)state.range(0);
+		state.counters["bytes/object"] = (double)bytesPerObject;
+		state.counters["working set MiB"] = (double)(count * bytesPerObject) / (1024.0 * 1024.0);
+		state.SetItemsProcessed(state.iterations() * count);
+		state.SetBytesProcessed(state.iterations() * count * bytesPerObject);
+	}
+
+	// A system that moves every object, as Simulate does, with the state
+	// stored as full world matrices (RenderItem::World before Transform).
+	void BM_MoveObjectsMatrix(benchmark::State& state)
+	{
+		std::vector<XMFLOAT4X4> worlds((size_t)state.range(0), MathHelper::Identity4x4());
+		for (auto _ : state)
+		{
+			for (XMFLOAT4X4& world : worlds)
+				world._42 += 0.01f;
+			benchmark::ClobberMemory();
+		}
+		SetCounters(state, sizeof(XMFLOAT4X4));
+	}
+	BENCHMARK(BM_MoveObjectsMatrix)->Apply(ObjectCounts);
+
+	// The same with the state stored as Transform.
+	void BM_MoveObjectsTransform(benchmark::State& state)
+	{
+		std::vector<Transform> transforms((size_t)state.range(0));
+		for (auto _ : state)
+		{
+			for (Transform& transform : transforms)
+				transform.Position.y += 0.01f;
+			benchmark::ClobberMemory();
+		}
+		SetCounters(state, sizeof(Transform));
+	}
+	BENCHMARK(BM_MoveObjectsTransform)->Apply(ObjectCounts);
+
+	// Every object moved through the hierarchy, which reads its local
+	// transform and writes its world one: the two Transforms a node keeps.
+	void BM_MoveObjectsHierarchy(benchmark::State& state)
+	{
+		const TransformHierarchy::NodeId count = (TransformHierarchy::NodeId)state.range(0);
+		TransformHierarchy hierarchy;
+		for (TransformHierarchy::NodeId node = 0; node < count; ++node)
+			hierarchy.AddNode(TransformHierarchy::InvalidNode, Transform());
+		hierarchy.Update();
+
+		Transform moved;
+		for (auto _ : state)
+		{
+			moved.Position.y += 0.01f;
+			for (TransformHierarchy::NodeId node = 0; node < count; ++node)
+				hierarchy.SetLocal(node, moved);
+			hierarchy.Update();
+		}
+		SetCounters(state, 2 * sizeof(Transform));
+	}
+	BENCHMARK(BM_MoveObjectsHierarchy)->Apply(ObjectCounts);
+
+	// Children one level down: each node also reads its parent's world
+	// transform, as the sweep does below the roots.
+	void BM_MoveObjectsHierarchyChildren(benchmark::State& state)
+	{
+		const TransformHierarchy::NodeId count = (TransformHierarchy::NodeId)state.range(0);
+		TransformHierarchy hierarchy;
+		TransformHierarchy::NodeId root = hierarchy.AddNode(TransformHierarchy::InvalidNode, Transform());
+		for (TransformHierarchy::NodeId node = 1; node < count; ++node)
+			hierarchy.AddNode(root, Transform());
+		hierarchy.Update();
+
+		Transform moved;
+		for (auto _ : state)
+		{
+			moved.Position.y += 0.01f;
+			hierarchy.SetLocal(root, moved);
+			hierarchy.Update();
+		}
+		SetCounters(state, 2 * sizeof(Transform));
+	}
+	BENCHMARK(BM_MoveObjectsHierarchyChildren)->Apply(ObjectCounts);
+}
@@ -0,0 +1,105 @@
+#include "TransformHierarchy.h"
+#include <benchmark/benchmark.h>
+
+namespace
+{
+	const int NodeCount = 100000;
+
+	Transform Make(int i)
+	{
+		XMFLOAT4 rotation;
+		XMStoreFloat4(&rotation, XMQuaternionRotationAxis(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), 0.001f * i));
+		return Transform(XMFLOAT3(0.5f, 0.0f, 0.25f), rotation, 1.0f);
+	}
+
+	// Wide: 100 roots with 999 children each. Deep: 1000 chains of 100 nodes.
+	void Build(TransformHierarchy& hierarchy, bool deep)
+	{
+		int chainLength = deep ? 100 : 2;
+		int fanOut = deep ? 1 : 999;
+		TransformHierarchy::NodeId parent = TransformHierarchy::InvalidNode;
+		for (int i = 0; i < NodeCount; ++i)
+		{
+			int position = deep ? i % chainLength : (i % (fanOut + 1) == 0 ? 0 : 1);
+			if (position == 0)
+				parent = TransformHierarchy::InvalidNode;
+			TransformHierarchy::NodeId node = hierarchy.AddNode(parent, Make(i));
+			if (deep || position == 0)
+				parent = node;
+		}
+		hierarchy.Update();
+	}
+
+	// Every root moves: the whole hierarchy is recomputed.
+	void BM_HierarchyUpdateAll(benchmark::State& state)
+	{
+		bool deep = state.range(0) != 0;
+		TransformHierarchy hierarchy;
+		Build(hierarchy, deep);
+
+		int frame = 0;
+		for (auto _ : state)
+		{
+			for (TransformHierarchy::NodeId node = 0; node < (TransformHierarchy::NodeId)NodeCount; ++node)
+			{
+				if (hierarchy.GetParent(node) == TransformHierarchy::InvalidNode)
+					hierarchy.SetLocal(node, Make(++frame));
+			}
+			hierarchy.Update();
+		}
+		state.SetItemsProcessed(state.iterations() * NodeCount);
+	}
+	BENCHMARK(BM_HierarchyUpdateAll)->ArgName("deep")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+	// One root moves: its subtree is recomputed, the rest is only checked.
+	void BM_HierarchyUpdateOneSubtree(benchmark::State& state)
+	{
+		bool deep = state.range(0) != 0;
+		TransformHierarchy hierarchy;
+		Build(hierarchy, deep);
+
+		int frame = 0;
+		for (auto _ : state)
+		{
+			hierarchy.SetLocal(0, Make(++frame));
+			hierarchy.Update();
+		}
+		state.SetItemsProcessed(state.iterations() * NodeCount);
+	}
+	BENCHMARK(BM_HierarchyUpdateOneSubtree)->ArgName("deep")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+	// Entity churn: 1% of the nodes are removed and as many added back each
+	// frame, half of them as roots and half as children of a surviving root.
+	// Neither moves a slot, so the frame costs the churn plus the update of
+	// the new nodes, not a re-sort of the whole hierarchy.
+	void BM_HierarchyChurn(benchmark::State& state)
+	{
+		TransformHierarchy hierarchy;
+		Build(hierarchy, false);
+
+		const int churn = NodeCount / 100;
+		std::vector<TransformHierarchy::NodeId> leaves;
+		for (TransformHierarchy::NodeId node = 0; node < (TransformHierarchy::NodeId)NodeCount; ++node)
+		{
+			if (hierarchy.GetParent(node) != TransformHierarchy::InvalidNode)
+				leaves.push_back(node);
+		}
+
+		std::uint32_t random = 1;
+		int frame = 0;
+		for (auto _ : state)
+		{
+			for (int i = 0; i < churn; ++i)
+			{
+				random = random * 1664525u + 1013904223u;
+				TransformHierarchy::NodeId& leaf = leaves[(random >> 8) % leaves.size()];
+				hierarchy.RemoveNode(leaf);
+				TransformHierarchy::NodeId parent = i % 2 ? TransformHierarchy::InvalidNode : (TransformHierarchy::NodeId)((random >> 4) % 100) * 1000;
+				leaf = hierarchy.AddNode(parent, Make(++frame));
+			}
+			hierarchy.Update();
+		}
+		state.SetItemsProcessed(state.iterations() * churn);
+	}
+	BENCHMARK(BM_HierarchyChurn)->Unit(benchmark::kMicrosecond);
+}
@@ -0,0 +1,83 @@
+#include "Camera.h"
+
+void Camera::SetOrbit(float radius, float theta, float phi)
+{
+	if (radius == m_radius && theta == m_theta && phi == m_phi)
+		return;
+
+	m_radius = radius;
+	m_theta = theta;
+	m_phi = phi;
+	m_viewDirty = true;
+}
+
+void Camera::SetLens(float fovY, float aspect, float zn, float zf)
+{
+	if (fovY == m_fovY && aspect == m_aspect && zn == m_nearZ && zf == m_farZ)
+		return;
+
+	m_fovY = fovY;
+	m_aspect = aspect;
+	m_nearZ = zn;
+	m_farZ = zf;
+	m_projDirty = true;
+}
+
+bool Camera::UpdatePassConstants(PassConstants& pass)
+{
+	if (!m_viewDirty && !m_projDirty)
+		return false;
+
+	if (m_viewDirty)
+		RebuildView();
+	if (m_projDirty)
+		RebuildProj();
+
+	XMMATRIX view = XMLoadFloat4x4(&m_view);
+	XMMATRIX invView = XMLoadFloat4x4(&m_invView);
+	XMMATRIX proj = XMLoadFloat4x4(&m_proj);
+	XMMATRIX invProj = XMLoadFloat4x4(&m_invProj);
+
+	// (V * P)^-1 = P^-1 * V^-1, so no inversion is needed here either.
+	XMMATRIX viewProj = XMMatrixMultiply(view, proj);
+	XMMATRIX invViewProj = XMMatrixMultiply(invProj, invView);
+
+	XMStoreFloat4x4(&pass.View, XMMatrixTranspose(view));
+	XMStoreFloat4x4(&pass.InvView, XMMatrixTranspose(invView));
+	XMStoreFloat4x4(&pass.Proj, XMMatrixTranspose(proj));
+	XMStoreFloat4x4(&pass.InvProj, XMMatrixTranspose(invProj));
+	XMStoreFloat4x4(&pass.ViewProj, XMMatrixTranspose(viewProj));
+	XMStoreFloat4x4(&pass.InvViewProj, XMMatrixTranspose(invViewProj));
+
+	pass.EyePosW = m_position;
+	pass.NearZ = m_nearZ;
+	pass.FarZ = m_farZ;
+
+	return true;
+}
+
+void Camera::RebuildView()
+{
+	// Convert Spherical to Cartesian coordinates.
+	XMVECTOR pos = MathHelper::SphericalToCartesian(m_radius, m_theta, m_phi);
+	XMVECTOR target = XMVectorZero();
+	XMVECTOR up = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+
+	XMMATRIX view = XMMatrixLookAtLH(pos, target, up);
+
+	XMStoreFloat3(&m_position, pos);
+	XMStoreFloat4x4(&m_view, view);
+	XMStoreFloat4x4(&m_invView, MathHelper::InverseRigid(view));
+
+	m_viewDirty = false;
+}
+
+void Camera::RebuildProj()
+{
+	XMMATRIX proj = XMMatrixPerspectiveFovLH(m_fovY, m_aspect, m_nearZ, m_farZ);
+
+	XMStoreFloat4x4(&m_proj, proj);
+	XMStoreFloat4x4(&m_invProj, MathHelper::InversePerspective(proj));
+
+	m_projDirty = false;
+}
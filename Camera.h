@@ -0,0 +1,52 @@
+#pragma once
+#include "MathTypes.h"
+#include "MathHelper.h"
+#include "ShaderStructures.h"
+
+using namespace DirectX;
+
+// Orbit camera that owns the camera half of PassConstants. View and
+// projection are rebuilt only when their inputs change, and their inverses
+// use the closed forms for rigid and perspective matrices instead of a
+// general 4x4 inversion.
+class Camera
+{
+public:
+
+	// Spherical coordinates around the origin. Marks the view dirty only if
+	// a value actually changed.
+	void								SetOrbit(float radius, float theta, float phi);
+	void								SetLens(float fovY, float aspect, float zn, float zf);
+
+	// Writes View/Proj/ViewProj, their inverses, EyePosW, NearZ and FarZ into
+	// `pass` if anything changed since the last call. Returns false and leaves
+	// `pass` untouched otherwise.
+	bool								UpdatePassConstants(PassConstants& pass);
+
+	XMMATRIX							GetView()			const	{	return XMLoadFloat4x4(&m_view);	}
+	XMMATRIX							GetProj()			const	{	return XMLoadFloat4x4(&m_proj);	}
+	XMFLOAT3							GetPosition()		const	{	return m_position;	}
+
+private:
+
+	void								RebuildView();
+	void								RebuildProj();
+
+	float								m_radius = 5.0f;
+	float								m_theta = 1.5f * XM_PI;
+	float								m_phi = XM_PIDIV4;
+
+	float								m_fovY = 0.25f * XM_PI;
+	float								m_aspect = 1.0f;
+	float								m_nearZ = 1.0f;
+	float								m_farZ = 1000.0f;
+
+	XMFLOAT3							m_position = { 0.0f, 0.0f, 0.0f };
+	XMFLOAT4X4							m_view = MathHelper::Identity4x4();
+	XMFLOAT4X4							m_invView = MathHelper::Identity4x4();
+	XMFLOAT4X4							m_proj = MathHelper::Identity4x4();
+	XMFLOAT4X4							m_invProj = MathHelper::Identity4x4();
+
+	bool								m_viewDirty = true;
+	bool								m_projDirty = true;
+};
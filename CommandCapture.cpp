@@ -0,0 +1,393 @@
+#include "CommandCapture.h"
+#include "GameTimer.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace
+{
+	double Now()
+	{
+		return GameTimer::QueryCounter() * GameTimer::SecondsPerCount();
+	}
+}
+
+CaptureBuffer::CaptureBuffer(CaptureRenderDevice& device, std::unique_ptr<GpuBuffer> target, std::uint32_t id)
+	: m_device(device), m_target(std::move(target)), m_id(id)
+{
+	// Buffers are created zeroed, on the replay too.
+	if (m_target->GetUsage() == GpuBufferUsage::Upload)
+		m_shadow.assign((std::size_t)m_target->GetSize(), 0);
+}
+
+CaptureBuffer::~CaptureBuffer()
+{
+	m_device.Unregister(*this);
+}
+
+CaptureFence::CaptureFence(CaptureRenderDevice& device, std::unique_ptr<GpuFence> target, std::uint32_t id)
+	: m_device(device), m_target(std::move(target)), m_id(id)
+{
+}
+
+void CaptureFence::Wait(std::uint64_t value)
+{
+	if (CommandLogWriter* log = m_device.Record(CommandLogOp::Wait))
+		log->U(m_id).U(value);
+
+	m_target->Wait(value);
+}
+
+CaptureCommandSignature::CaptureCommandSignature(CaptureRenderDevice& device, std::unique_ptr<GpuCommandSignature> target, std::uint32_t id)
+	: m_device(device), m_target(std::move(target)), m_id(id)
+{
+}
+
+CaptureCommandSignature::~CaptureCommandSignature()
+{
+	if (CommandLogWriter* log = m_device.Record(CommandLogOp::DestroyCommandSignature))
+		log->U(m_id);
+}
+
+CaptureCommandList::CaptureCommandList(CaptureRenderDevice& device, std::unique_ptr<GpuCommandList> target, std::uint32_t id)
+	: m_device(device), m_target(std::move(target)), m_id(id)
+{
+}
+
+void CaptureCommandList::Reset()
+{
+	if (CommandLogWriter* log = m_device.Record(CommandLogOp::Reset))
+		log->U(m_id);
+
+	m_pendingIndirect.clear();
+	m_target->Reset();
+}
+
+void CaptureCommandList::Close()
+{
+	if (CommandLogWriter* log = m_device.Record(CommandLogOp::Close))
+		log->U(m_id);
+
+	m_target->Close();
+}
+
+void CaptureCommandList::SetPipelineState(std::uint64_t pipelineHash)
+{
+	if (CommandLogWriter* log = m_device.Record(CommandLogOp::SetPipelineState))
+		log->U(m_id).Fixed(pipelineHash);
+
+	m_target->SetPipelineState(pipelineHash);
+}
+
+void CaptureCommandList::SetRootSignature(std::uint64_t rootSignatureHash)
+{
+	if (CommandLogWriter* log = m_device.Record(CommandLogOp::SetRootSignature))
+		log->U(m_id).Fixed(rootSignatureHash);
+
+	m_target->SetRootSignature(rootSignatureHash);
+}
+
+void CaptureCommandList::SetRootConstantBuffer(std::uint32_t rootParameter, GpuAddress address)
+{
+	if (CommandLogWriter* log = m_device.Record(CommandLogOp::SetRootConstantBuffer))
+	{
+		log->U(m_id).U(rootParameter);
+		m_device.WriteAddress(*log, address);
+	}
+
+	m_target->SetRootConstantBuffer(rootParameter, address);
+}
+
+void CaptureCommandList::SetRootConstant(std::uint32_t rootParameter, std::uint32_t value, std::uint32_t offset)
+{
+	if (CommandLogWriter* log = m_device.Record(CommandLogOp::SetRootConstant))
+		log->U(m_id).U(rootParameter).U(value).U(offset);
+
+	m_target->SetRootConstant(rootParameter, value, offset);
+}
+
+void CaptureCommandList::SetVertexBuffer(GpuAddress address, std::uint32_t size, std::uint32_t stride)
+{
+	if (CommandLogWriter* log = m_device.Record(CommandLogOp::SetVertexBuffer))
+	{
+		log->U(m_id);
+		m_device.WriteAddress(*log, address);
+		log->U(size).U(stride);
+	}
+
+	m_target->SetVertexBuffer(address, size, stride);
+}
+
+void CaptureCommandList::SetIndexBuffer(GpuAddress address, std::uint32_t size, IndexFormat format)
+{
+	if (CommandLogWriter* log = m_device.Record(CommandLogOp::SetIndexBuffer))
+	{
+		log->U(m_id);
+		m_device.WriteAddress(*log, address);
+		log->U(size).U((std::uint64_t)format);
+	}
+
+	m_target->SetIndexBuffer(address, size, format);
+}
+
+void CaptureCommandList::SetPrimitiveTopology(PrimitiveTopology topology)
+{
+	if (CommandLogWriter* log = m_device.Record(CommandLogOp::SetPrimitiveTopology))
+		log->U(m_id).U((std::uint64_t)topology);
+
+	m_target->SetPrimitiveTopology(topology);
+}
+
+void CaptureCommandList::DrawIndexedInstanced(std::uint32_t indexCount, std::uint32_t instanceCount,
+	std::uint32_t startIndex, std::int32_t baseVertex, std::uint32_t startInstance)
+{
+	if (CommandLogWriter* log = m_device.Record(CommandLogOp::DrawIndexedInstanced))
+		log->U(m_id).U(indexCount).U(instanceCount).U(startIndex).S(baseVertex).U(startInstance);
+
+	m_target->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
+
+void CaptureCommandList::ExecuteIndirect(GpuCommandSignature& signature, std::uint32_t maxCommandCount,
+	GpuBuffer& arguments, std::uint64_t argumentOffset, GpuBuffer* count, std::uint64_t countOffset)
+{
+	CaptureCommandSignature& capturedSignature = static_cast<CaptureCommandSignature&>(signature);
+	CaptureBuffer& capturedArguments = static_cast<CaptureBuffer&>(arguments);
+	CaptureBuffer* capturedCount = static_cast<CaptureBuffer*>(count);
+	if (CommandLogWriter* log = m_device.Record(CommandLogOp::ExecuteIndirect))
+	{
+		assert(arguments.GetUsage() == GpuBufferUsage::Upload && (count == nullptr || count->GetUsage() == GpuBufferUsage::Upload)
+			&& "Captured ExecuteIndirect buffers must be upload buffers.");
+		log->U(m_id).U(capturedSignature.GetId()).U(maxCommandCount).U(capturedArguments.GetId()).U(argumentOffset)
+			.U(capturedCount != nullptr ? capturedCount->GetId() : 0).U(countOffset);
+		m_pendingIndirect.push_back(PendingIndirect{ &capturedSignature, maxCommandCount, &capturedArguments, argumentOffset, capturedCount, countOffset });
+	}
+
+	m_target->ExecuteIndirect(capturedSignature.GetTarget(), maxCommandCount, capturedArguments.GetTarget(), argumentOffset,
+		capturedCount != nullptr ? &capturedCount->GetTarget() : nullptr, countOffset);
+}
+
+void CaptureCommandList::Barrier(GpuBuffer& buffer, ResourceState before, ResourceState after)
+{
+	CaptureBuffer& captured = static_cast<CaptureBuffer&>(buffer);
+	if (CommandLogWriter* log = m_device.Record(CommandLogOp::Barrier))
+		log->U(m_id).U(captured.GetId()).U((std::uint64_t)before).U((std::uint64_t)after);
+
+	m_target->Barrier(captured.GetTarget(), before, after);
+}
+
+void CaptureCommandList::CopyBuffer(GpuBuffer& destination, std::uint64_t destinationOffset,
+	GpuBuffer& source, std::uint64_t sourceOffset, std::uint64_t size)
+{
+	CaptureBuffer& capturedDestination = static_cast<CaptureBuffer&>(destination);
+	CaptureBuffer& capturedSource = static_cast<CaptureBuffer&>(source);
+	if (CommandLogWriter* log = m_device.Record(CommandLogOp::CopyBuffer))
+		log->U(m_id).U(capturedDestination.GetId()).U(destinationOffset).U(capturedSource.GetId()).U(sourceOffset).U(size);
+
+	m_target->CopyBuffer(capturedDestination.GetTarget(), destinationOffset, capturedSource.GetTarget(), sourceOffset, size);
+}
+
+CaptureRenderDevice::CaptureRenderDevice(RenderDevice& target)
+	: m_target(target)
+{
+}
+
+CaptureRenderDevice::~CaptureRenderDevice()
+{
+	assert(m_buffers.empty() && "Captured buffers outlive their device.");
+	Close();
+}
+
+bool CaptureRenderDevice::Open(const std::string& path)
+{
+	if (!m_log.Open(path))
+		return false;
+
+	m_stats = CaptureStats();
+	m_lastSignalTime = Now();
+	return true;
+}
+
+void CaptureRenderDevice::Close()
+{
+	m_log.Close();
+}
+
+CommandLogWriter* CaptureRenderDevice::Record(CommandLogOp op)
+{
+	if (!m_log.IsOpen())
+		return nullptr;
+
+	m_stats.Commands++;
+	return &m_log.Op(op);
+}
+
+void CaptureRenderDevice::WriteAddress(CommandLogWriter& log, GpuAddress address) const
+{
+	auto it = m_buffers.upper_bound(address);
+	if (it != m_buffers.begin())
+	{
+		--it;
+		const CaptureBuffer* buffer = it->second;
+		if (address < it->first + buffer->GetSize())
+		{
+			log.U(buffer->GetId()).U(address - it->first);
+			return;
+		}
+	}
+
+	log.U(0).U(address);
+}
+
+std::unique_ptr<GpuBuffer> CaptureRenderDevice::CreateBuffer(std::uint64_t size, GpuBufferUsage usage)
+{
+	std::uint32_t id = m_nextBufferId++;
+	if (CommandLogWriter* log = Record(CommandLogOp::CreateBuffer))
+		log->U(id).U(size).U((std::uint64_t)usage);
+
+	auto buffer = std::make_unique<CaptureBuffer>(*this, m_target.CreateBuffer(size, usage), id);
+	m_buffers[buffer->GetGpuAddress()] = buffer.get();
+	if (usage == GpuBufferUsage::Upload)
+		m_uploadBuffers.push_back(buffer.get());
+	return buffer;
+}
+
+std::unique_ptr<GpuCommandList> CaptureRenderDevice::CreateCommandList()
+{
+	std::uint32_t id = m_nextCommandListId++;
+	if (CommandLogWriter* log = Record(CommandLogOp::CreateCommandList))
+		log->U(id);
+
+	return std::make_unique<CaptureCommandList>(*this, m_target.CreateCommandList(), id);
+}
+
+std::unique_ptr<GpuFence> CaptureRenderDevice::CreateFence(std::uint64_t initialValue)
+{
+	std::uint32_t id = m_nextFenceId++;
+	if (CommandLogWriter* log = Record(CommandLogOp::CreateFence))
+		log->U(id).U(initialValue);
+
+	return std::make_unique<CaptureFence>(*this, m_target.CreateFence(initialValue), id);
+}
+
+std::unique_ptr<GpuCommandSignature> CaptureRenderDevice::CreateCommandSignature(const CommandSignatureDesc& desc, std::uint64_t rootSignatureHash)
+{
+	std::uint32_t id = m_nextCommandSignatureId++;
+	if (CommandLogWriter* log = Record(CommandLogOp::CreateCommandSignature))
+	{
+		log->U(id).Fixed(rootSignatureHash).U(desc.ByteStride).U(desc.Arguments.size());
+		for (const IndirectArgument& argument : desc.Arguments)
+			log->U((std::uint64_t)argument.Type).U(argument.RootParameter);
+	}
+
+	return std::make_unique<CaptureCommandSignature>(*this, m_target.CreateCommandSignature(desc, rootSignatureHash), id);
+}
+
+void CaptureRenderDevice::LogUploads()
+{
+	for (CaptureBuffer* buffer : m_uploadBuffers)
+	{
+		const std::uint8_t* data = buffer->GetMappedData();
+		std::uint8_t* shadow = buffer->m_shadow.data();
+		std::size_t size = buffer->m_shadow.size();
+
+		// Runs of changed blocks become one record each.
+		std::size_t offset = 0;
+		while (offset < size)
+		{
+			std::size_t block = std::min<std::size_t>(BlockSize, size - offset);
+			if (std::memcmp(data + offset, shadow + offset, block) == 0)
+			{
+				offset += block;
+				continue;
+			}
+
+			std::size_t begin = offset;
+			offset += block;
+			while (offset < size)
+			{
+				block = std::min<std::size_t>(BlockSize, size - offset);
+				if (std::memcmp(data + offset, shadow + offset, block) == 0)
+					break;
+				offset += block;
+			}
+
+			std::size_t length = offset - begin;
+			std::memcpy(shadow + begin, data + begin, length);
+			m_log.Op(CommandLogOp::BufferData).U(buffer->GetId()).U(begin).U(length).Bytes(data + begin, length);
+			m_stats.Commands++;
+			m_stats.UploadBytes += length;
+		}
+	}
+}
+
+void CaptureRenderDevice::LogIndirectArguments(CaptureCommandList& commandList)
+{
+	for (const CaptureCommandList::PendingIndirect& pending : commandList.m_pendingIndirect)
+	{
+		std::uint32_t commandCount = pending.MaxCommandCount;
+		if (pending.Count != nullptr)
+		{
+			std::uint32_t count;
+			std::memcpy(&count, pending.Count->GetMappedData() + pending.CountOffset, sizeof(count));
+			commandCount = std::min(commandCount, count);
+		}
+
+		const CommandSignatureDesc& desc = pending.Signature->GetDesc();
+		const std::uint8_t* data = pending.Arguments->GetMappedData() + pending.ArgumentOffset;
+
+		CommandLogWriter& log = m_log.Op(CommandLogOp::IndirectArguments);
+		log.U(pending.Arguments->GetId()).U(pending.ArgumentOffset).U(pending.Signature->GetId()).U(commandCount);
+		for (std::uint32_t i = 0; i < commandCount; ++i, data += desc.ByteStride)
+		{
+			const std::uint8_t* argument = data;
+			for (const IndirectArgument& arg : desc.Arguments)
+			{
+				if (arg.Type == IndirectArgumentType::ConstantBufferView)
+				{
+					GpuAddress address;
+					std::memcpy(&address, argument, sizeof(address));
+					WriteAddress(log, address);
+				}
+				argument += IndirectArgumentSize(arg.Type);
+			}
+		}
+		m_stats.Commands++;
+	}
+}
+
+void CaptureRenderDevice::Execute(GpuCommandList& commandList)
+{
+	CaptureCommandList& captured = static_cast<CaptureCommandList&>(commandList);
+	if (m_log.IsOpen())
+	{
+		// The GPU reads upload buffers as they are now.
+		LogUploads();
+		LogIndirectArguments(captured);
+		Record(CommandLogOp::Execute)->U(captured.GetId());
+	}
+
+	m_target.GetQueue().Execute(captured.GetTarget());
+}
+
+void CaptureRenderDevice::Signal(GpuFence& fence, std::uint64_t value)
+{
+	CaptureFence& captured = static_cast<CaptureFence&>(fence);
+	if (CommandLogWriter* log = Record(CommandLogOp::Signal))
+	{
+		double now = Now();
+		log->U(captured.GetId()).U(value).U((std::uint64_t)((now - m_lastSignalTime) * 1e6));
+		m_lastSignalTime = now;
+		m_stats.Signals++;
+	}
+
+	m_target.GetQueue().Signal(captured.GetTarget(), value);
+}
+
+void CaptureRenderDevice::Unregister(const CaptureBuffer& buffer)
+{
+	if (CommandLogWriter* log = Record(CommandLogOp::DestroyBuffer))
+		log->U(buffer.GetId());
+
+	m_buffers.erase(buffer.m_target->GetGpuAddress());
+	m_uploadBuffers.erase(std::remove(m_uploadBuffers.begin(), m_uploadBuffers.end(), &buffer), m_uploadBuffers.end());
+}
@@ -0,0 +1,206 @@
+#pragma once
+#include "RenderBackend.h"
+#include "CommandLog.h"
+#include <map>
+#include <vector>
+
+class CaptureRenderDevice;
+
+class CaptureBuffer : public GpuBuffer
+{
+public:
+
+											CaptureBuffer(CaptureRenderDevice& device, std::unique_ptr<GpuBuffer> target, std::uint32_t id);
+											~CaptureBuffer() override;
+
+	std::uint8_t*							GetMappedData()		override	{	return m_target->GetMappedData();	}
+	GpuAddress								GetGpuAddress()		const override	{	return m_target->GetGpuAddress();	}
+	std::uint64_t							GetSize()			const override	{	return m_target->GetSize();	}
+	GpuBufferUsage							GetUsage()			const override	{	return m_target->GetUsage();	}
+
+	GpuBuffer&								GetTarget()			{	return *m_target;	}
+	std::uint32_t							GetId()				const	{	return m_id;	}
+
+private:
+
+	friend class CaptureRenderDevice;
+
+	CaptureRenderDevice&					m_device;
+	std::unique_ptr<GpuBuffer>				m_target;
+	std::uint32_t							m_id;
+	// Upload buffers: contents as of the last logged update.
+	std::vector<std::uint8_t>				m_shadow;
+};
+
+class CaptureFence : public GpuFence
+{
+public:
+
+											CaptureFence(CaptureRenderDevice& device, std::unique_ptr<GpuFence> target, std::uint32_t id);
+
+	std::uint64_t							GetCompletedValue()	const override	{	return m_target->GetCompletedValue();	}
+	void									Wait(std::uint64_t value) override;
+
+	GpuFence&								GetTarget()			{	return *m_target;	}
+	std::uint32_t							GetId()				const	{	return m_id;	}
+
+private:
+
+	CaptureRenderDevice&					m_device;
+	std::unique_ptr<GpuFence>				m_target;
+	std::uint32_t							m_id;
+};
+
+class CaptureCommandSignature : public GpuCommandSignature
+{
+public:
+
+											CaptureCommandSignature(CaptureRenderDevice& device, std::unique_ptr<GpuCommandSignature> target, std::uint32_t id);
+											~CaptureCommandSignature() override;
+
+	const CommandSignatureDesc&				GetDesc()			const override	{	return m_target->GetDesc();	}
+
+	GpuCommandSignature&					GetTarget()			{	return *m_target;	}
+	std::uint32_t							GetId()				const	{	return m_id;	}
+
+private:
+
+	CaptureRenderDevice&					m_device;
+	std::unique_ptr<GpuCommandSignature>	m_target;
+	std::uint32_t							m_id;
+};
+
+class CaptureCommandList : public GpuCommandList
+{
+public:
+
+											CaptureCommandList(CaptureRenderDevice& device, std::unique_ptr<GpuCommandList> target, std::uint32_t id);
+
+	void									Reset() override;
+	void									Close() override;
+
+	void									SetPipelineState(std::uint64_t pipelineHash) override;
+	void									SetRootSignature(std::uint64_t rootSignatureHash) override;
+	void									SetRootConstantBuffer(std::uint32_t rootParameter, GpuAddress address) override;
+	void									SetRootConstant(std::uint32_t rootParameter, std::uint32_t value, std::uint32_t offset) override;
+
+	void									SetVertexBuffer(GpuAddress address, std::uint32_t size, std::uint32_t stride) override;
+	void									SetIndexBuffer(GpuAddress address, std::uint32_t size, IndexFormat format) override;
+	void									SetPrimitiveTopology(PrimitiveTopology topology) override;
+	void									DrawIndexedInstanced(std::uint32_t indexCount, std::uint32_t instanceCount,
+												std::uint32_t startIndex, std::int32_t baseVertex, std::uint32_t startInstance) override;
+	void									ExecuteIndirect(GpuCommandSignature& signature, std::uint32_t maxCommandCount,
+												GpuBuffer& arguments, std::uint64_t argumentOffset,
+												GpuBuffer* count, std::uint64_t countOffset) override;
+
+	void									Barrier(GpuBuffer& buffer, ResourceState before, ResourceState after) override;
+	void									CopyBuffer(GpuBuffer& destination, std::uint64_t destinationOffset,
+												GpuBuffer& source, std::uint64_t sourceOffset, std::uint64_t size) override;
+
+	GpuCommandList&							GetTarget()			{	return *m_target;	}
+	std::uint32_t							GetId()				const	{	return m_id;	}
+
+private:
+
+	friend class CaptureRenderDevice;
+
+	// An ExecuteIndirect whose arguments are logged when the list executes.
+	struct PendingIndirect
+	{
+		CaptureCommandSignature*			Signature;
+		std::uint32_t						MaxCommandCount;
+		CaptureBuffer*						Arguments;
+		std::uint64_t						ArgumentOffset;
+		CaptureBuffer*						Count;
+		std::uint64_t						CountOffset;
+	};
+
+	CaptureRenderDevice&					m_device;
+	std::unique_ptr<GpuCommandList>			m_target;
+	std::uint32_t							m_id;
+	std::vector<PendingIndirect>			m_pendingIndirect;
+};
+
+struct CaptureStats
+{
+	std::uint64_t							Signals = 0;
+	std::uint64_t							Commands = 0;
+	// Upload buffer contents logged, after dropping unchanged blocks.
+	std::uint64_t							UploadBytes = 0;
+};
+
+// Records every call made through it to a CommandLog file while forwarding
+// it to the target device.
+//
+// Writes to upload buffers go straight to mapped memory, so they are found
+// by comparing each upload buffer with a shadow copy on every Execute, in
+// blocks of BlockSize bytes: only constants that changed since the last
+// submission are logged, without the padding of 256-byte constant buffer
+// elements. Each Signal carries the CPU time since the previous one, which
+// is a frame time when the renderer signals once per frame.
+//
+// ExecuteIndirect argument and count buffers must be upload buffers while
+// capturing: the arguments are read back when the list executes, and the
+// addresses in them are logged rebased, like those of direct commands.
+//
+// Open() before the renderer creates any object: the log must see every
+// object it refers to. Fence polling through GetCompletedValue() is not
+// logged; a replay only waits where the renderer called Wait().
+class CaptureRenderDevice : public RenderDevice, public GpuQueue
+{
+public:
+
+	static const std::uint32_t				BlockSize = 64;
+
+											CaptureRenderDevice(RenderDevice& target);
+											CaptureRenderDevice(const CaptureRenderDevice& rhs) = delete;
+											CaptureRenderDevice& operator=(const CaptureRenderDevice& rhs) = delete;
+											~CaptureRenderDevice() override;
+
+	// Returns false if the log cannot be created. Closing flushes the log;
+	// calls made while closed are forwarded but not logged.
+	bool									Open(const std::string& path);
+	void									Close();
+	bool									IsCapturing()		const	{	return m_log.IsOpen();	}
+
+	std::unique_ptr<GpuBuffer>				CreateBuffer(std::uint64_t size, GpuBufferUsage usage) override;
+	std::unique_ptr<GpuCommandList>			CreateCommandList() override;
+	std::unique_ptr<GpuFence>				CreateFence(std::uint64_t initialValue = 0) override;
+	std::unique_ptr<GpuCommandSignature>	CreateCommandSignature(const CommandSignatureDesc& desc, std::uint64_t rootSignatureHash) override;
+	GpuQueue&								GetQueue() override		{	return *this;	}
+
+	void									Execute(GpuCommandList& commandList) override;
+	void									Signal(GpuFence& fence, std::uint64_t value) override;
+
+	const CaptureStats&						GetStats()			const	{	return m_stats;	}
+	std::uint64_t							GetLogSize()		const	{	return m_log.GetSize();	}
+
+private:
+
+	friend class CaptureBuffer;
+	friend class CaptureFence;
+	friend class CaptureCommandList;
+	friend class CaptureCommandSignature;
+
+	// Starts a command list record; nullptr when not capturing.
+	CommandLogWriter*						Record(CommandLogOp op);
+	void									WriteAddress(CommandLogWriter& log, GpuAddress address)	const;
+	void									LogUploads();
+	void									LogIndirectArguments(CaptureCommandList& commandList);
+	void									Unregister(const CaptureBuffer& buffer);
+
+	RenderDevice&							m_target;
+	CommandLogWriter						m_log;
+
+	std::uint32_t							m_nextBufferId = 1;
+	std::uint32_t							m_nextCommandListId = 1;
+	std::uint32_t							m_nextFenceId = 1;
+	std::uint32_t							m_nextCommandSignatureId = 1;
+
+	// Live buffers by target address, to turn addresses into buffer offsets.
+	std::map<GpuAddress, CaptureBuffer*>	m_buffers;
+	std::vector<CaptureBuffer*>				m_uploadBuffers;
+
+	double									m_lastSignalTime = 0.0;
+	CaptureStats							m_stats;
+};
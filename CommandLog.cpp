@@ -0,0 +1,120 @@
+#include "CommandLog.h"
+#include <cstring>
+
+CommandLogWriter::~CommandLogWriter()
+{
+	Close();
+}
+
+bool CommandLogWriter::Open(const std::string& path)
+{
+	Close();
+
+	m_file.open(path, std::ios::binary | std::ios::trunc);
+	if (!m_file)
+		return false;
+
+	m_written = 0;
+	m_buffer.clear();
+	Fixed(((std::uint64_t)Version << 32) | Magic);
+	return true;
+}
+
+void CommandLogWriter::Close()
+{
+	if (!m_file.is_open())
+		return;
+
+	Flush();
+	m_file.close();
+}
+
+CommandLogWriter& CommandLogWriter::U(std::uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		m_buffer.push_back((std::uint8_t)(value | 0x80));
+		value >>= 7;
+	}
+	m_buffer.push_back((std::uint8_t)value);
+	FlushIfFull();
+	return *this;
+}
+
+CommandLogWriter& CommandLogWriter::Fixed(std::uint64_t value)
+{
+	for (int i = 0; i < 8; ++i)
+		m_buffer.push_back((std::uint8_t)(value >> (8 * i)));
+	FlushIfFull();
+	return *this;
+}
+
+CommandLogWriter& CommandLogWriter::Bytes(const void* data, std::size_t size)
+{
+	const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+	m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+	FlushIfFull();
+	return *this;
+}
+
+void CommandLogWriter::Flush()
+{
+	if (m_buffer.empty() || !m_file.is_open())
+		return;
+
+	m_file.write(reinterpret_cast<const char*>(m_buffer.data()), (std::streamsize)m_buffer.size());
+	m_written += m_buffer.size();
+	m_buffer.clear();
+}
+
+bool CommandLogReader::ReadHeader()
+{
+	std::uint64_t header = Fixed();
+	return !m_failed
+		&& (std::uint32_t)header == CommandLogWriter::Magic
+		&& (std::uint32_t)(header >> 32) == CommandLogWriter::Version;
+}
+
+std::uint64_t CommandLogReader::ReadVarint()
+{
+	std::uint64_t value = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		if (m_cursor == m_end)
+			break;
+
+		std::uint8_t byte = *m_cursor++;
+		value |= (std::uint64_t)(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0)
+			return value;
+	}
+
+	m_failed = true;
+	return 0;
+}
+
+std::uint64_t CommandLogReader::Fixed()
+{
+	const std::uint8_t* bytes = Bytes(8);
+	if (bytes == nullptr)
+		return 0;
+
+	std::uint64_t value = 0;
+	for (int i = 0; i < 8; ++i)
+		value |= (std::uint64_t)bytes[i] << (8 * i);
+	return value;
+}
+
+const std::uint8_t* CommandLogReader::Bytes(std::size_t size)
+{
+	if ((std::size_t)(m_end - m_cursor) < size)
+	{
+		m_failed = true;
+		m_cursor = m_end;
+		return nullptr;
+	}
+
+	const std::uint8_t* bytes = m_cursor;
+	m_cursor += size;
+	return bytes;
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Binary command stream of a capture: a header, then one record per backend
+// call. A record is an opcode byte followed by its operands as LEB128
+// varints, except hashes, which are 8 raw bytes since they would not shrink.
+//
+// Objects are numbered in creation order, from 1 within each kind. A GPU
+// address is written as (buffer id, offset) so it can be rebased onto the
+// buffers of the replay; buffer id 0 means an address outside any buffer,
+// written as is.
+enum class CommandLogOp : std::uint8_t
+{
+	CreateBuffer = 1,			// buffer, size, usage
+	DestroyBuffer,				// buffer
+	CreateCommandList,			// list
+	CreateFence,				// fence, initial value
+	BufferData,					// buffer, offset, size, bytes
+
+	Reset,						// list
+	Close,						// list
+	SetPipelineState,			// list, hash
+	SetRootSignature,			// list, hash
+	SetRootConstantBuffer,		// list, root parameter, address
+	SetRootConstant,			// list, root parameter, value, offset
+	SetVertexBuffer,			// list, address, size, stride
+	SetIndexBuffer,				// list, address, size, format
+	SetPrimitiveTopology,		// list, topology
+	DrawIndexedInstanced,		// list, index count, instance count, start index, zigzag base vertex, start instance
+	Barrier,					// list, buffer, before, after
+	CopyBuffer,					// list, destination, destination offset, source, source offset, size
+
+	Execute,					// list
+	Signal,						// fence, value, microseconds since the previous signal
+	Wait,						// fence, value
+
+	CreateCommandSignature,		// signature, root signature hash, byte stride, argument count, (type, root parameter) per argument
+	DestroyCommandSignature,	// signature
+	ExecuteIndirect,			// list, signature, max command count, argument buffer, offset, count buffer or 0, count offset
+	// Addresses in an argument buffer, rebased: buffer, offset, signature,
+	// command count, then one address per constant buffer view argument of
+	// each command. Follows the BufferData records of an Execute, whose
+	// bytes still hold the captured addresses.
+	IndirectArguments,
+
+	Count
+};
+
+class CommandLogWriter
+{
+public:
+
+	static const std::uint32_t				Magic = 0x4c444d43;		// "CMDL"
+	static const std::uint32_t				Version = 2;
+
+											CommandLogWriter() = default;
+											CommandLogWriter(const CommandLogWriter& rhs) = delete;
+											CommandLogWriter& operator=(const CommandLogWriter& rhs) = delete;
+											~CommandLogWriter();
+
+	// Returns false if the file cannot be created.
+	bool									Open(const std::string& path);
+	void									Close();
+	bool									IsOpen()		const	{	return m_file.is_open();	}
+
+	CommandLogWriter&						Op(CommandLogOp op)					{	m_buffer.push_back((std::uint8_t)op);	return *this;	}
+	CommandLogWriter&						U(std::uint64_t value);
+	CommandLogWriter&						S(std::int64_t value)				{	return U(((std::uint64_t)value << 1) ^ (std::uint64_t)(value >> 63));	}
+	CommandLogWriter&						Fixed(std::uint64_t value);
+	CommandLogWriter&						Bytes(const void* data, std::size_t size);
+
+	// Bytes written so far, including those still buffered.
+	std::uint64_t							GetSize()		const	{	return m_written + m_buffer.size();	}
+
+	// Hands buffered records to the file.
+	void									Flush();
+
+private:
+
+	static const std::size_t				FlushThreshold = 1 << 20;
+
+	void									FlushIfFull()		{	if (m_buffer.size() >= FlushThreshold)	Flush();	}
+
+	std::ofstream							m_file;
+	std::vector<std::uint8_t>				m_buffer;
+	std::uint64_t							m_written = 0;
+};
+
+// Cursor over a log in memory. Reads past the end or overlong varints set
+// the failed flag and return zeros, so a truncated capture is detected once,
+// at the record that runs out.
+class CommandLogReader
+{
+public:
+
+											CommandLogReader(const std::uint8_t* data, std::size_t size)
+												: m_data(data), m_end(data + size), m_cursor(data)	{}
+
+	// Checks the magic and version.
+	bool									ReadHeader();
+
+	bool									AtEnd()			const	{	return m_cursor == m_end;	}
+	bool									Failed()		const	{	return m_failed;	}
+	std::size_t								GetOffset()		const	{	return (std::size_t)(m_cursor - m_data);	}
+
+	// Most operands fit in one byte: that case stays inline.
+	CommandLogOp							Op()
+	{
+		if (m_cursor != m_end && *m_cursor != 0 && *m_cursor < (std::uint8_t)CommandLogOp::Count)
+			return (CommandLogOp)*m_cursor++;
+		m_failed = true;
+		return CommandLogOp::Count;
+	}
+	std::uint64_t							U()
+	{
+		if (m_cursor != m_end && *m_cursor < 0x80)
+			return *m_cursor++;
+		return ReadVarint();
+	}
+	std::int64_t							S()					{	std::uint64_t u = U();	return (std::int64_t)(u >> 1) ^ -(std::int64_t)(u & 1);	}
+	std::uint64_t							Fixed();
+	// Points into the log; nullptr if fewer than `size` bytes remain.
+	const std::uint8_t*						Bytes(std::size_t size);
+
+	// For operands that decode but make no sense.
+	void									Fail()				{	m_failed = true;	}
+
+private:
+
+	std::uint64_t							ReadVarint();
+
+	const std::uint8_t*						m_data;
+	const std::uint8_t*						m_end;
+	const std::uint8_t*						m_cursor;
+	bool									m_failed = false;
+};
@@ -0,0 +1,444 @@
+#include "CommandReplay.h"
+#include "Profiler.h"
+#include <cstring>
+
+namespace
+{
+	double Now()
+	{
+		return GameTimer::QueryCounter() * GameTimer::SecondsPerCount();
+	}
+
+	template<typename T>
+	T* FindObject(const std::vector<std::unique_ptr<T>>& objects, std::uint64_t id)
+	{
+		return id < objects.size() ? objects[(std::size_t)id].get() : nullptr;
+	}
+
+	// Ids are dense, so the tables grow one slot at a time.
+	template<typename T>
+	bool PlaceObject(std::vector<std::unique_ptr<T>>& objects, std::uint64_t id, std::unique_ptr<T> object)
+	{
+		if (id == 0 || id > objects.size() + 1024)
+			return false;
+
+		if (id >= objects.size())
+			objects.resize((std::size_t)id + 1);
+		objects[(std::size_t)id] = std::move(object);
+		return true;
+	}
+}
+
+CommandReplayer::CommandReplayer(RenderDevice& device)
+	: m_device(device)
+{
+}
+
+CommandReplayer::~CommandReplayer()
+{
+	Release();
+}
+
+bool CommandReplayer::Open(const std::string& path)
+{
+	if (!m_file.Open(path))
+		return false;
+
+	return Open(m_file.Data(), m_file.Size());
+}
+
+bool CommandReplayer::Open(const std::uint8_t* data, std::size_t size)
+{
+	m_data = data;
+	m_size = size;
+
+	CommandLogReader reader(data, size);
+	return reader.ReadHeader();
+}
+
+bool CommandReplayer::Replay()
+{
+	PROFILE_FUNCTION();
+
+	m_stats = ReplayStats();
+	m_frameTimes.Clear();
+	m_errorOffset = 0;
+
+	CommandLogReader reader(m_data, m_size);
+	if (!reader.ReadHeader())
+		return false;
+
+	double start = Now();
+	m_lastSignalTime = start;
+
+	bool ok = true;
+	while (!reader.AtEnd())
+	{
+		std::size_t offset = reader.GetOffset();
+		CommandLogOp op = reader.Op();
+		if (reader.Failed() || !ReplayRecord(reader, op) || reader.Failed())
+		{
+			m_errorOffset = offset;
+			ok = false;
+			break;
+		}
+		m_stats.Commands++;
+	}
+
+	// Everything the log submitted is finished before its objects go away.
+	for (std::size_t id = 0; id < m_fences.size(); ++id)
+	{
+		if (m_fences[id] != nullptr && m_signaled[id] > m_fences[id]->GetCompletedValue())
+			m_fences[id]->Wait(m_signaled[id]);
+	}
+
+	m_stats.Seconds = Now() - start;
+	Release();
+	return ok;
+}
+
+bool CommandReplayer::ReplayRecord(CommandLogReader& reader, CommandLogOp op)
+{
+	switch (op)
+	{
+	case CommandLogOp::CreateBuffer:
+	{
+		std::uint64_t id = reader.U();
+		std::uint64_t size = reader.U();
+		std::uint64_t usage = reader.U();
+		if (reader.Failed() || size == 0 || usage > (std::uint64_t)GpuBufferUsage::Default)
+			return false;
+		return PlaceObject(m_buffers, id, m_device.CreateBuffer(size, (GpuBufferUsage)usage));
+	}
+	case CommandLogOp::DestroyBuffer:
+	{
+		std::uint64_t id = reader.U();
+		if (FindBuffer(id) == nullptr)
+			return false;
+		m_buffers[(std::size_t)id].reset();
+		return true;
+	}
+	case CommandLogOp::CreateCommandList:
+	{
+		std::uint64_t id = reader.U();
+		if (reader.Failed() || !PlaceObject(m_commandLists, id, m_device.CreateCommandList()))
+			return false;
+		// Lists are created open, ready to record.
+		m_closed.resize(m_commandLists.size(), 0);
+		m_closed[(std::size_t)id] = 0;
+		return true;
+	}
+	case CommandLogOp::CreateFence:
+	{
+		std::uint64_t id = reader.U();
+		std::uint64_t initialValue = reader.U();
+		if (reader.Failed() || !PlaceObject(m_fences, id, m_device.CreateFence(initialValue)))
+			return false;
+		m_signaled.resize(m_fences.size(), 0);
+		m_signaled[(std::size_t)id] = initialValue;
+		return true;
+	}
+	case CommandLogOp::BufferData:
+	{
+		GpuBuffer* buffer = FindBuffer(reader.U());
+		std::uint64_t offset = reader.U();
+		std::uint64_t size = reader.U();
+		// Written so that no sum can wrap around.
+		if (buffer == nullptr || buffer->GetMappedData() == nullptr
+			|| size > buffer->GetSize() || offset > buffer->GetSize() - size)
+			return false;
+		const std::uint8_t* bytes = reader.Bytes((std::size_t)size);
+		if (bytes == nullptr)
+			return false;
+		std::memcpy(buffer->GetMappedData() + offset, bytes, (std::size_t)size);
+		m_stats.UploadBytes += size;
+		return true;
+	}
+	case CommandLogOp::CreateCommandSignature:
+	{
+		std::uint64_t id = reader.U();
+		std::uint64_t rootSignatureHash = reader.Fixed();
+		CommandSignatureDesc desc;
+		desc.ByteStride = (std::uint32_t)reader.U();
+		std::uint64_t argumentCount = reader.U();
+		if (reader.Failed() || argumentCount == 0 || argumentCount > 16)
+			return false;
+
+		std::uint64_t commandSize = 0;
+		for (std::uint64_t i = 0; i < argumentCount; ++i)
+		{
+			IndirectArgument argument;
+			argument.Type = (IndirectArgumentType)reader.U();
+			argument.RootParameter = (std::uint32_t)reader.U();
+			if (argument.Type != IndirectArgumentType::DrawIndexed && argument.Type != IndirectArgumentType::Constant
+				&& argument.Type != IndirectArgumentType::ConstantBufferView)
+				return false;
+			commandSize += IndirectArgumentSize(argument.Type);
+			desc.Arguments.push_back(argument);
+		}
+		if (reader.Failed() || commandSize > desc.ByteStride)
+			return false;
+		return PlaceObject(m_commandSignatures, id, m_device.CreateCommandSignature(desc, rootSignatureHash));
+	}
+	case CommandLogOp::DestroyCommandSignature:
+	{
+		std::uint64_t id = reader.U();
+		if (FindCommandSignature(id) == nullptr)
+			return false;
+		m_commandSignatures[(std::size_t)id].reset();
+		return true;
+	}
+	case CommandLogOp::IndirectArguments:
+	{
+		GpuBuffer* buffer = FindBuffer(reader.U());
+		std::uint64_t offset = reader.U();
+		GpuCommandSignature* signature = FindCommandSignature(reader.U());
+		std::uint64_t commandCount = reader.U();
+		if (buffer == nullptr || signature == nullptr || reader.Failed() || buffer->GetMappedData() == nullptr)
+			return false;
+
+		const CommandSignatureDesc& desc = signature->GetDesc();
+		std::uint64_t bufferSize = buffer->GetSize();
+		if (commandCount > bufferSize / desc.ByteStride || offset > bufferSize - commandCount * desc.ByteStride)
+			return false;
+
+		std::uint8_t* data = buffer->GetMappedData() + offset;
+		for (std::uint64_t i = 0; i < commandCount; ++i, data += desc.ByteStride)
+		{
+			std::uint8_t* argument = data;
+			for (const IndirectArgument& arg : desc.Arguments)
+			{
+				if (arg.Type == IndirectArgumentType::ConstantBufferView)
+				{
+					GpuAddress address = ReadAddress(reader);
+					if (reader.Failed())
+						return false;
+					std::memcpy(argument, &address, sizeof(address));
+				}
+				else if (arg.Type == IndirectArgumentType::DrawIndexed)
+				{
+					m_stats.Draws++;
+				}
+				argument += IndirectArgumentSize(arg.Type);
+			}
+		}
+		return true;
+	}
+	case CommandLogOp::Execute:
+	{
+		std::uint64_t id = reader.U();
+		GpuCommandList* list = FindCommandList(id);
+		if (list == nullptr || !m_closed[(std::size_t)id])
+			return false;
+		m_device.GetQueue().Execute(*list);
+		return true;
+	}
+	case CommandLogOp::Signal:
+	{
+		std::uint64_t id = reader.U();
+		GpuFence* fence = FindFence(id);
+		std::uint64_t value = reader.U();
+		std::uint64_t capturedMicroseconds = reader.U();
+		if (fence == nullptr || reader.Failed())
+			return false;
+		m_device.GetQueue().Signal(*fence, value);
+		m_signaled[(std::size_t)id] = value;
+
+		double now = Now();
+		m_frameTimes.Record(now - m_lastSignalTime);
+		m_lastSignalTime = now;
+		m_stats.Frames++;
+		m_stats.CapturedSeconds += capturedMicroseconds * 1e-6;
+		return true;
+	}
+	case CommandLogOp::Wait:
+	{
+		std::uint64_t id = reader.U();
+		GpuFence* fence = FindFence(id);
+		std::uint64_t value = reader.U();
+		// Waiting for a value nothing will signal would hang the GPU.
+		if (fence == nullptr || reader.Failed() || value > m_signaled[(std::size_t)id])
+			return false;
+		fence->Wait(value);
+		return true;
+	}
+	default:
+		break;
+	}
+
+	// Command list records. Only Reset is valid on a closed list; closing
+	// one twice or recording into it is an error on every backend.
+	std::uint64_t listId = reader.U();
+	GpuCommandList* list = FindCommandList(listId);
+	if (list == nullptr)
+		return false;
+
+	std::uint8_t& closed = m_closed[(std::size_t)listId];
+	if (op == CommandLogOp::Reset)
+	{
+		list->Reset();
+		closed = 0;
+		return true;
+	}
+	if (closed)
+		return false;
+
+	switch (op)
+	{
+	case CommandLogOp::Close:
+		list->Close();
+		closed = 1;
+		return true;
+	case CommandLogOp::SetPipelineState:
+		list->SetPipelineState(reader.Fixed());
+		return true;
+	case CommandLogOp::SetRootSignature:
+		list->SetRootSignature(reader.Fixed());
+		return true;
+	case CommandLogOp::SetRootConstantBuffer:
+	{
+		std::uint32_t rootParameter = (std::uint32_t)reader.U();
+		GpuAddress address = ReadAddress(reader);
+		if (reader.Failed())
+			return false;
+		list->SetRootConstantBuffer(rootParameter, address);
+		return true;
+	}
+	case CommandLogOp::SetRootConstant:
+	{
+		std::uint32_t rootParameter = (std::uint32_t)reader.U();
+		std::uint32_t value = (std::uint32_t)reader.U();
+		std::uint32_t offset = (std::uint32_t)reader.U();
+		list->SetRootConstant(rootParameter, value, offset);
+		return true;
+	}
+	case CommandLogOp::SetVertexBuffer:
+	{
+		GpuAddress address = ReadAddress(reader);
+		std::uint32_t size = (std::uint32_t)reader.U();
+		std::uint32_t stride = (std::uint32_t)reader.U();
+		if (reader.Failed())
+			return false;
+		list->SetVertexBuffer(address, size, stride);
+		return true;
+	}
+	case CommandLogOp::SetIndexBuffer:
+	{
+		GpuAddress address = ReadAddress(reader);
+		std::uint32_t size = (std::uint32_t)reader.U();
+		IndexFormat format = (IndexFormat)reader.U();
+		if (reader.Failed())
+			return false;
+		list->SetIndexBuffer(address, size, format);
+		return true;
+	}
+	case CommandLogOp::SetPrimitiveTopology:
+		list->SetPrimitiveTopology((PrimitiveTopology)reader.U());
+		return true;
+	case CommandLogOp::DrawIndexedInstanced:
+	{
+		std::uint32_t indexCount = (std::uint32_t)reader.U();
+		std::uint32_t instanceCount = (std::uint32_t)reader.U();
+		std::uint32_t startIndex = (std::uint32_t)reader.U();
+		std::int32_t baseVertex = (std::int32_t)reader.S();
+		std::uint32_t startInstance = (std::uint32_t)reader.U();
+		if (reader.Failed())
+			return false;
+		list->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+		m_stats.Draws++;
+		return true;
+	}
+	case CommandLogOp::ExecuteIndirect:
+	{
+		GpuCommandSignature* signature = FindCommandSignature(reader.U());
+		std::uint32_t maxCommandCount = (std::uint32_t)reader.U();
+		GpuBuffer* arguments = FindBuffer(reader.U());
+		std::uint64_t argumentOffset = reader.U();
+		std::uint64_t countId = reader.U();
+		GpuBuffer* count = countId != 0 ? FindBuffer(countId) : nullptr;
+		std::uint64_t countOffset = reader.U();
+		if (signature == nullptr || arguments == nullptr || (countId != 0 && count == nullptr) || reader.Failed())
+			return false;
+
+		std::uint64_t argumentBytes = (std::uint64_t)maxCommandCount * signature->GetDesc().ByteStride;
+		if (argumentBytes > arguments->GetSize() || argumentOffset > arguments->GetSize() - argumentBytes
+			|| (count != nullptr && (count->GetSize() < sizeof(std::uint32_t) || countOffset > count->GetSize() - sizeof(std::uint32_t))))
+			return false;
+		list->ExecuteIndirect(*signature, maxCommandCount, *arguments, argumentOffset, count, countOffset);
+		return true;
+	}
+	case CommandLogOp::Barrier:
+	{
+		GpuBuffer* buffer = FindBuffer(reader.U());
+		ResourceState before = (ResourceState)reader.U();
+		ResourceState after = (ResourceState)reader.U();
+		if (buffer == nullptr || reader.Failed())
+			return false;
+		list->Barrier(*buffer, before, after);
+		return true;
+	}
+	case CommandLogOp::CopyBuffer:
+	{
+		GpuBuffer* destination = FindBuffer(reader.U());
+		std::uint64_t destinationOffset = reader.U();
+		GpuBuffer* source = FindBuffer(reader.U());
+		std::uint64_t sourceOffset = reader.U();
+		std::uint64_t size = reader.U();
+		if (destination == nullptr || source == nullptr || reader.Failed()
+			|| size > destination->GetSize() || destinationOffset > destination->GetSize() - size
+			|| size > source->GetSize() || sourceOffset > source->GetSize() - size)
+			return false;
+		list->CopyBuffer(*destination, destinationOffset, *source, sourceOffset, size);
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+GpuAddress CommandReplayer::ReadAddress(CommandLogReader& reader)
+{
+	std::uint64_t id = reader.U();
+	std::uint64_t offset = reader.U();
+	if (id == 0)
+		return offset;
+
+	// A stale id would point the GPU anywhere: fail the read instead.
+	GpuBuffer* buffer = FindBuffer(id);
+	if (buffer == nullptr || offset >= buffer->GetSize())
+	{
+		reader.Fail();
+		return 0;
+	}
+	return buffer->GetGpuAddress() + offset;
+}
+
+GpuBuffer* CommandReplayer::FindBuffer(std::uint64_t id) const
+{
+	return FindObject(m_buffers, id);
+}
+
+GpuCommandList* CommandReplayer::FindCommandList(std::uint64_t id) const
+{
+	return FindObject(m_commandLists, id);
+}
+
+GpuFence* CommandReplayer::FindFence(std::uint64_t id) const
+{
+	return FindObject(m_fences, id);
+}
+
+GpuCommandSignature* CommandReplayer::FindCommandSignature(std::uint64_t id) const
+{
+	return FindObject(m_commandSignatures, id);
+}
+
+void CommandReplayer::Release()
+{
+	m_commandLists.clear();
+	m_closed.clear();
+	m_commandSignatures.clear();
+	m_buffers.clear();
+	m_fences.clear();
+	m_signaled.clear();
+}
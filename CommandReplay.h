@@ -0,0 +1,82 @@
+#pragma once
+#include "RenderBackend.h"
+#include "CommandLog.h"
+#include "GameTimer.h"
+#include "MappedFile.h"
+#include <vector>
+
+struct ReplayStats
+{
+	std::uint64_t							Frames = 0;			// signals
+	std::uint64_t							Commands = 0;		// records
+	std::uint64_t							Draws = 0;
+	std::uint64_t							UploadBytes = 0;
+	// Wall time of the replay, and the frame time the capture recorded.
+	double									Seconds = 0.0;
+	double									CapturedSeconds = 0.0;
+};
+
+// Feeds a CommandLog back through a RenderDevice at full speed.
+//
+// Objects are created on the target as the log creates them, GPU addresses
+// are rebased onto the target's buffers, and fence waits happen where the
+// capture waited, so the target sees the same submissions in the same order.
+// Captured timing is kept for comparison but not reproduced. The time
+// between consecutive signals goes into a FrameTimeHistogram.
+class CommandReplayer
+{
+public:
+
+											CommandReplayer(RenderDevice& device);
+											CommandReplayer(const CommandReplayer& rhs) = delete;
+											CommandReplayer& operator=(const CommandReplayer& rhs) = delete;
+											~CommandReplayer();
+
+	// Maps the log; returns false if it cannot be opened or has a bad header.
+	bool									Open(const std::string& path);
+	// Uses a log already in memory; it must outlive the replayer.
+	bool									Open(const std::uint8_t* data, std::size_t size);
+
+	// Replays the whole log, waiting for the GPU at the end. Objects the log
+	// created are released afterwards, so Replay() can run again. Returns
+	// false, having replayed what came before, if the log is malformed:
+	// undecodable, or asking for something no device could do (accesses
+	// outside a buffer, a wait no signal satisfies, recording into or
+	// executing a list in the wrong state).
+	bool									Replay();
+
+	const ReplayStats&						GetStats()			const	{	return m_stats;	}
+	const FrameTimeHistogram&				GetFrameTimes()		const	{	return m_frameTimes;	}
+	// Offset of the record that failed to decode.
+	std::size_t								GetErrorOffset()	const	{	return m_errorOffset;	}
+
+private:
+
+	bool									ReplayRecord(CommandLogReader& reader, CommandLogOp op);
+	GpuAddress								ReadAddress(CommandLogReader& reader);
+
+	GpuBuffer*								FindBuffer(std::uint64_t id)		const;
+	GpuCommandList*							FindCommandList(std::uint64_t id)	const;
+	GpuFence*								FindFence(std::uint64_t id)			const;
+	GpuCommandSignature*					FindCommandSignature(std::uint64_t id)	const;
+
+	void									Release();
+
+	RenderDevice&							m_device;
+	MappedFile								m_file;
+	const std::uint8_t*						m_data = nullptr;
+	std::size_t								m_size = 0;
+
+	// Indexed by log id.
+	std::vector<std::unique_ptr<GpuBuffer>>			m_buffers;
+	std::vector<std::unique_ptr<GpuCommandList>>	m_commandLists;
+	std::vector<std::uint8_t>						m_closed;
+	std::vector<std::unique_ptr<GpuFence>>			m_fences;
+	std::vector<std::unique_ptr<GpuCommandSignature>>	m_commandSignatures;
+	std::vector<std::uint64_t>						m_signaled;
+
+	double									m_lastSignalTime = 0.0;
+	ReplayStats								m_stats;
+	FrameTimeHistogram						m_frameTimes;
+	std::size_t								m_errorOffset = 0;
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include "MathTypes.h"
+#include "MeshGeometry.h"
+#include "Transform.h"
+#include "TransformHierarchy.h"
+#include "ObjectPool.h"
+
+using namespace DirectX;
+
+// Components of the entities owned by GameObject. They are stored in
+// EntityWorld chunks, so they must stay plain, trivially copyable data.
+// There is no Transform component: the entity's local transform lives in
+// GameObject's TransformHierarchy, at RenderLink::Node, and nowhere else.
+
+// Submesh drawn by the entity.
+struct MeshRef
+{
+	MeshGeometry*								Geo = nullptr;
+	PrimitiveTopology							PrimitiveType = PrimitiveTopology::TriangleList;
+	UINT										IndexCount = 0;
+	UINT										StartIndexLocation = 0;
+	INT											BaseVertexLocation = 0;
+};
+
+// Object-space box of the submesh and its world-space box, refreshed when
+// the entity's world transform changes.
+struct Bounds
+{
+	BoundingBox									Local;
+	BoundingBox									World;
+};
+
+// Whether the entity is drawn. Culling writes here; GameObject copies it to
+// the render item.
+struct Visibility
+{
+	bool										Visible = true;
+};
+
+// Render item and transform node backing the entity.
+struct RenderLink
+{
+	PoolHandle									Item;
+	TransformHierarchy::NodeId					Node = TransformHierarchy::InvalidNode;
+};
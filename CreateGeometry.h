@@ -1,5 +1,6 @@
 #pragma once
-#include "framework.h"
+#include "MathTypes.h"
+#include "MemoryTracker.h"
 
 using namespace DirectX;
 
@@ -40,10 +41,10 @@ public:
 
 	struct MeshData
 	{
-		std::vector<Vertex> Vertices;
-		std::vector<uint32> Indices32;
+		TrackedVector<Vertex, MemTag::Geometry> Vertices;
+		TrackedVector<uint32, MemTag::Geometry> Indices32;
 
-		std::vector<uint16>& GetIndices16()
+		TrackedVector<uint16, MemTag::Geometry>& GetIndices16()
 		{
 			if (mIndices16.empty())
 			{
@@ -56,7 +57,7 @@ public:
 		}
 
 	private:
-		std::vector<uint16> mIndices16;
+		TrackedVector<uint16, MemTag::Geometry> mIndices16;
 	};
 
 	MeshData								CreateBox(float width, float height, float depth, uint32 numSubdivisions);
@@ -0,0 +1,255 @@
+#include "D3D12Backend.h"
+
+// Backend enums are passed to D3D12 as they are.
+static_assert((UINT)PrimitiveTopology::TriangleList == D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, "PrimitiveTopology must match D3D_PRIMITIVE_TOPOLOGY.");
+static_assert((UINT)IndexFormat::UInt16 == DXGI_FORMAT_R16_UINT && (UINT)IndexFormat::UInt32 == DXGI_FORMAT_R32_UINT, "IndexFormat must match DXGI_FORMAT.");
+static_assert((UINT)ResourceState::GenericRead == D3D12_RESOURCE_STATE_GENERIC_READ, "ResourceState must match D3D12_RESOURCE_STATES.");
+static_assert((UINT)IndirectArgumentType::DrawIndexed == D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED
+	&& (UINT)IndirectArgumentType::Constant == D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT
+	&& (UINT)IndirectArgumentType::ConstantBufferView == D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT_BUFFER_VIEW, "IndirectArgumentType must match D3D12_INDIRECT_ARGUMENT_TYPE.");
+static_assert(sizeof(DrawIndexedArguments) == sizeof(D3D12_DRAW_INDEXED_ARGUMENTS), "DrawIndexedArguments must match D3D12_DRAW_INDEXED_ARGUMENTS.");
+
+D3D12Buffer::D3D12Buffer(ID3D12Device* device, std::uint64_t size, GpuBufferUsage usage)
+	: m_size(size), m_usage(usage)
+{
+	bool upload = usage == GpuBufferUsage::Upload;
+
+	// Upload heap buffers must start in GENERIC_READ; default buffers start
+	// in COMMON and are promoted on first use.
+	DX::ThrowIfFailed(device->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(upload ? D3D12_HEAP_TYPE_UPLOAD : D3D12_HEAP_TYPE_DEFAULT),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(size),
+		upload ? D3D12_RESOURCE_STATE_GENERIC_READ : D3D12_RESOURCE_STATE_COMMON,
+		nullptr,
+		IID_PPV_ARGS(&m_resource)));
+
+	// Upload buffers stay mapped for their whole life.
+	if (upload)
+		DX::ThrowIfFailed(m_resource->Map(0, nullptr, reinterpret_cast<void**>(&m_mappedData)));
+}
+
+D3D12Buffer::~D3D12Buffer()
+{
+	if (m_mappedData != nullptr)
+		m_resource->Unmap(0, nullptr);
+}
+
+D3D12Fence::D3D12Fence(ID3D12Device* device, std::uint64_t initialValue)
+{
+	DX::ThrowIfFailed(device->CreateFence(initialValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence)));
+
+	m_event = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
+	if (m_event == nullptr)
+		DX::ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+}
+
+D3D12Fence::~D3D12Fence()
+{
+	if (m_event != nullptr)
+		CloseHandle(m_event);
+}
+
+void D3D12Fence::Wait(std::uint64_t value)
+{
+	if (m_fence->GetCompletedValue() >= value)
+		return;
+
+	DX::ThrowIfFailed(m_fence->SetEventOnCompletion(value, m_event));
+	WaitForSingleObject(m_event, INFINITE);
+}
+
+D3D12CommandSignature::D3D12CommandSignature(D3D12RenderDevice& device, const CommandSignatureDesc& desc, std::uint64_t rootSignatureHash)
+	: m_desc(desc)
+{
+	std::vector<D3D12_INDIRECT_ARGUMENT_DESC> argumentDescs(desc.Arguments.size());
+	bool setsRootArguments = false;
+	for (size_t i = 0; i < desc.Arguments.size(); ++i)
+	{
+		const IndirectArgument& argument = desc.Arguments[i];
+		argumentDescs[i].Type = (D3D12_INDIRECT_ARGUMENT_TYPE)argument.Type;
+		if (argument.Type == IndirectArgumentType::ConstantBufferView)
+		{
+			argumentDescs[i].ConstantBufferView.RootParameterIndex = argument.RootParameter;
+			setsRootArguments = true;
+		}
+		else if (argument.Type == IndirectArgumentType::Constant)
+		{
+			argumentDescs[i].Constant.RootParameterIndex = argument.RootParameter;
+			argumentDescs[i].Constant.DestOffsetIn32BitValues = 0;
+			argumentDescs[i].Constant.Num32BitValuesToSet = 1;
+			setsRootArguments = true;
+		}
+	}
+
+	D3D12_COMMAND_SIGNATURE_DESC commandSignatureDesc = {};
+	commandSignatureDesc.pArgumentDescs = argumentDescs.data();
+	commandSignatureDesc.NumArgumentDescs = (UINT)argumentDescs.size();
+	commandSignatureDesc.ByteStride = desc.ByteStride;
+
+	// A signature that changes root arguments must be tied to the root signature.
+	ID3D12RootSignature* rootSignature = setsRootArguments ? device.FindRootSignature(rootSignatureHash) : nullptr;
+	assert((!setsRootArguments || rootSignature != nullptr) && "Root signature was not registered.");
+	DX::ThrowIfFailed(device.GetDevice()->CreateCommandSignature(&commandSignatureDesc, rootSignature,
+		IID_PPV_ARGS(&m_signature)));
+}
+
+D3D12CommandList::D3D12CommandList(D3D12RenderDevice& device)
+	: m_device(device)
+{
+	ID3D12Device* d3dDevice = device.GetDevice();
+	DX::ThrowIfFailed(d3dDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&m_allocator)));
+	DX::ThrowIfFailed(d3dDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_allocator.Get(), nullptr,
+		IID_PPV_ARGS(&m_commandList)));
+
+	// Lists are created open; start closed so the first Reset() is valid.
+	DX::ThrowIfFailed(m_commandList->Close());
+}
+
+void D3D12CommandList::Reset()
+{
+	DX::ThrowIfFailed(m_allocator->Reset());
+	DX::ThrowIfFailed(m_commandList->Reset(m_allocator.Get(), nullptr));
+}
+
+void D3D12CommandList::Close()
+{
+	DX::ThrowIfFailed(m_commandList->Close());
+}
+
+void D3D12CommandList::SetPipelineState(std::uint64_t pipelineHash)
+{
+	ID3D12PipelineState* pipeline = m_device.FindPipeline(pipelineHash);
+	assert(pipeline != nullptr && "Pipeline was not registered.");
+	m_commandList->SetPipelineState(pipeline);
+}
+
+void D3D12CommandList::SetRootSignature(std::uint64_t rootSignatureHash)
+{
+	ID3D12RootSignature* rootSignature = m_device.FindRootSignature(rootSignatureHash);
+	assert(rootSignature != nullptr && "Root signature was not registered.");
+	m_commandList->SetGraphicsRootSignature(rootSignature);
+}
+
+void D3D12CommandList::SetRootConstantBuffer(std::uint32_t rootParameter, GpuAddress address)
+{
+	m_commandList->SetGraphicsRootConstantBufferView(rootParameter, address);
+}
+
+void D3D12CommandList::SetRootConstant(std::uint32_t rootParameter, std::uint32_t value, std::uint32_t offset)
+{
+	m_commandList->SetGraphicsRoot32BitConstant(rootParameter, value, offset);
+}
+
+void D3D12CommandList::SetVertexBuffer(GpuAddress address, std::uint32_t size, std::uint32_t stride)
+{
+	D3D12_VERTEX_BUFFER_VIEW vbv;
+	vbv.BufferLocation = address;
+	vbv.SizeInBytes = size;
+	vbv.StrideInBytes = stride;
+	m_commandList->IASetVertexBuffers(0, 1, &vbv);
+}
+
+void D3D12CommandList::SetIndexBuffer(GpuAddress address, std::uint32_t size, IndexFormat format)
+{
+	D3D12_INDEX_BUFFER_VIEW ibv;
+	ibv.BufferLocation = address;
+	ibv.SizeInBytes = size;
+	ibv.Format = (DXGI_FORMAT)format;
+	m_commandList->IASetIndexBuffer(&ibv);
+}
+
+void D3D12CommandList::SetPrimitiveTopology(PrimitiveTopology topology)
+{
+	m_commandList->IASetPrimitiveTopology((D3D12_PRIMITIVE_TOPOLOGY)topology);
+}
+
+void D3D12CommandList::DrawIndexedInstanced(std::uint32_t indexCount, std::uint32_t instanceCount,
+	std::uint32_t startIndex, std::int32_t baseVertex, std::uint32_t startInstance)
+{
+	m_commandList->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
+
+void D3D12CommandList::ExecuteIndirect(GpuCommandSignature& signature, std::uint32_t maxCommandCount,
+	GpuBuffer& arguments, std::uint64_t argumentOffset, GpuBuffer* count, std::uint64_t countOffset)
+{
+	m_commandList->ExecuteIndirect(static_cast<D3D12CommandSignature&>(signature).GetSignature(), maxCommandCount,
+		static_cast<D3D12Buffer&>(arguments).GetResource(), argumentOffset,
+		count != nullptr ? static_cast<D3D12Buffer*>(count)->GetResource() : nullptr, countOffset);
+}
+
+void D3D12CommandList::Barrier(GpuBuffer& buffer, ResourceState before, ResourceState after)
+{
+	ID3D12Resource* resource = static_cast<D3D12Buffer&>(buffer).GetResource();
+	m_commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(resource,
+		(D3D12_RESOURCE_STATES)before, (D3D12_RESOURCE_STATES)after));
+}
+
+void D3D12CommandList::CopyBuffer(GpuBuffer& destination, std::uint64_t destinationOffset,
+	GpuBuffer& source, std::uint64_t sourceOffset, std::uint64_t size)
+{
+	m_commandList->CopyBufferRegion(static_cast<D3D12Buffer&>(destination).GetResource(), destinationOffset,
+		static_cast<D3D12Buffer&>(source).GetResource(), sourceOffset, size);
+}
+
+D3D12RenderDevice::D3D12RenderDevice(ID3D12Device* device, ID3D12CommandQueue* queue)
+	: m_device(device), m_queue(queue)
+{
+}
+
+D3D12RenderDevice::~D3D12RenderDevice()
+{
+}
+
+std::unique_ptr<GpuBuffer> D3D12RenderDevice::CreateBuffer(std::uint64_t size, GpuBufferUsage usage)
+{
+	return std::make_unique<D3D12Buffer>(m_device.Get(), size, usage);
+}
+
+std::unique_ptr<GpuCommandList> D3D12RenderDevice::CreateCommandList()
+{
+	return std::make_unique<D3D12CommandList>(*this);
+}
+
+std::unique_ptr<GpuFence> D3D12RenderDevice::CreateFence(std::uint64_t initialValue)
+{
+	return std::make_unique<D3D12Fence>(m_device.Get(), initialValue);
+}
+
+std::unique_ptr<GpuCommandSignature> D3D12RenderDevice::CreateCommandSignature(const CommandSignatureDesc& desc, std::uint64_t rootSignatureHash)
+{
+	return std::make_unique<D3D12CommandSignature>(*this, desc, rootSignatureHash);
+}
+
+void D3D12RenderDevice::Execute(GpuCommandList& commandList)
+{
+	ID3D12CommandList* cmdsLists[] = { static_cast<D3D12CommandList&>(commandList).GetCommandList() };
+	m_queue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
+}
+
+void D3D12RenderDevice::Signal(GpuFence& fence, std::uint64_t value)
+{
+	DX::ThrowIfFailed(m_queue->Signal(static_cast<D3D12Fence&>(fence).GetFence(), value));
+}
+
+void D3D12RenderDevice::RegisterPipeline(std::uint64_t hash, ID3D12PipelineState* pipeline)
+{
+	m_pipelines[hash] = pipeline;
+}
+
+void D3D12RenderDevice::RegisterRootSignature(std::uint64_t hash, ID3D12RootSignature* rootSignature)
+{
+	m_rootSignatures[hash] = rootSignature;
+}
+
+ID3D12PipelineState* D3D12RenderDevice::FindPipeline(std::uint64_t hash) const
+{
+	auto it = m_pipelines.find(hash);
+	return it != m_pipelines.end() ? it->second.Get() : nullptr;
+}
+
+ID3D12RootSignature* D3D12RenderDevice::FindRootSignature(std::uint64_t hash) const
+{
+	auto it = m_rootSignatures.find(hash);
+	return it != m_rootSignatures.end() ? it->second.Get() : nullptr;
+}
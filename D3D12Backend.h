@@ -0,0 +1,145 @@
+#pragma once
+#include "framework.h"
+#include "d3dUtil.h"
+#include "RenderBackend.h"
+#include <unordered_map>
+
+using Microsoft::WRL::ComPtr;
+
+class D3D12RenderDevice;
+
+class D3D12Buffer : public GpuBuffer
+{
+public:
+
+											D3D12Buffer(ID3D12Device* device, std::uint64_t size, GpuBufferUsage usage);
+											~D3D12Buffer() override;
+
+	std::uint8_t*							GetMappedData()		override	{	return m_mappedData;	}
+	GpuAddress								GetGpuAddress()		const override	{	return m_resource->GetGPUVirtualAddress();	}
+	std::uint64_t							GetSize()			const override	{	return m_size;	}
+	GpuBufferUsage							GetUsage()			const override	{	return m_usage;	}
+
+	ID3D12Resource*							GetResource()		const	{	return m_resource.Get();	}
+
+private:
+
+	ComPtr<ID3D12Resource>					m_resource;
+	std::uint8_t*							m_mappedData = nullptr;
+	std::uint64_t							m_size;
+	GpuBufferUsage							m_usage;
+};
+
+class D3D12Fence : public GpuFence
+{
+public:
+
+											D3D12Fence(ID3D12Device* device, std::uint64_t initialValue);
+											~D3D12Fence() override;
+
+	std::uint64_t							GetCompletedValue()	const override	{	return m_fence->GetCompletedValue();	}
+	void									Wait(std::uint64_t value) override;
+
+	ID3D12Fence*							GetFence()			const	{	return m_fence.Get();	}
+
+private:
+
+	ComPtr<ID3D12Fence>						m_fence;
+	HANDLE									m_event = nullptr;
+};
+
+class D3D12CommandSignature : public GpuCommandSignature
+{
+public:
+
+											D3D12CommandSignature(D3D12RenderDevice& device, const CommandSignatureDesc& desc, std::uint64_t rootSignatureHash);
+
+	const CommandSignatureDesc&				GetDesc()			const override	{	return m_desc;	}
+
+	ID3D12CommandSignature*					GetSignature()		const	{	return m_signature.Get();	}
+
+private:
+
+	CommandSignatureDesc					m_desc;
+	ComPtr<ID3D12CommandSignature>			m_signature;
+};
+
+// A graphics command list with its own allocator: Reset() resets both, so
+// the renderer keeps one list per frame resource.
+class D3D12CommandList : public GpuCommandList
+{
+public:
+
+											D3D12CommandList(D3D12RenderDevice& device);
+
+	void									Reset() override;
+	void									Close() override;
+
+	void									SetPipelineState(std::uint64_t pipelineHash) override;
+	void									SetRootSignature(std::uint64_t rootSignatureHash) override;
+	void									SetRootConstantBuffer(std::uint32_t rootParameter, GpuAddress address) override;
+	void									SetRootConstant(std::uint32_t rootParameter, std::uint32_t value, std::uint32_t offset) override;
+
+	void									SetVertexBuffer(GpuAddress address, std::uint32_t size, std::uint32_t stride) override;
+	void									SetIndexBuffer(GpuAddress address, std::uint32_t size, IndexFormat format) override;
+	void									SetPrimitiveTopology(PrimitiveTopology topology) override;
+	void									DrawIndexedInstanced(std::uint32_t indexCount, std::uint32_t instanceCount,
+												std::uint32_t startIndex, std::int32_t baseVertex, std::uint32_t startInstance) override;
+	void									ExecuteIndirect(GpuCommandSignature& signature, std::uint32_t maxCommandCount,
+												GpuBuffer& arguments, std::uint64_t argumentOffset,
+												GpuBuffer* count, std::uint64_t countOffset) override;
+
+	void									Barrier(GpuBuffer& buffer, ResourceState before, ResourceState after) override;
+	void									CopyBuffer(GpuBuffer& destination, std::uint64_t destinationOffset,
+												GpuBuffer& source, std::uint64_t sourceOffset, std::uint64_t size) override;
+
+	ID3D12GraphicsCommandList*				GetCommandList()	const	{	return m_commandList.Get();	}
+
+private:
+
+	D3D12RenderDevice&						m_device;
+	ComPtr<ID3D12CommandAllocator>			m_allocator;
+	ComPtr<ID3D12GraphicsCommandList>		m_commandList;
+};
+
+// RenderDevice over an existing D3D12 device and direct queue, such as the
+// ones DataGlobal creates.
+//
+// Command lists name pipelines and root signatures by hash; the objects are
+// registered here first, typically straight from PipelineStateCache and
+// RootSignatureCache.
+class D3D12RenderDevice : public RenderDevice, public GpuQueue
+{
+public:
+
+											D3D12RenderDevice(ID3D12Device* device, ID3D12CommandQueue* queue);
+											D3D12RenderDevice(const D3D12RenderDevice& rhs) = delete;
+											D3D12RenderDevice& operator=(const D3D12RenderDevice& rhs) = delete;
+											~D3D12RenderDevice() override;
+
+	std::unique_ptr<GpuBuffer>				CreateBuffer(std::uint64_t size, GpuBufferUsage usage) override;
+	std::unique_ptr<GpuCommandList>			CreateCommandList() override;
+	std::unique_ptr<GpuFence>				CreateFence(std::uint64_t initialValue = 0) override;
+	// The root signature must have been registered.
+	std::unique_ptr<GpuCommandSignature>	CreateCommandSignature(const CommandSignatureDesc& desc, std::uint64_t rootSignatureHash) override;
+	GpuQueue&								GetQueue() override		{	return *this;	}
+
+	void									Execute(GpuCommandList& commandList) override;
+	void									Signal(GpuFence& fence, std::uint64_t value) override;
+
+	void									RegisterPipeline(std::uint64_t hash, ID3D12PipelineState* pipeline);
+	void									RegisterRootSignature(std::uint64_t hash, ID3D12RootSignature* rootSignature);
+
+	ID3D12PipelineState*					FindPipeline(std::uint64_t hash)		const;
+	ID3D12RootSignature*					FindRootSignature(std::uint64_t hash)	const;
+
+	ID3D12Device*							GetDevice()			const	{	return m_device.Get();	}
+
+private:
+
+	ComPtr<ID3D12Device>					m_device;
+	ComPtr<ID3D12CommandQueue>				m_queue;
+
+	std::unordered_map<std::uint64_t, ComPtr<ID3D12PipelineState>>	m_pipelines;
+	std::unordered_map<std::uint64_t, ComPtr<ID3D12RootSignature>>	m_rootSignatures;
+};
@@ -1,5 +1,7 @@
 #include "DataD3D12.h"
 #include "Resource.h"
+#include "Profiler.h"
+#include "MemoryTracker.h"
 
 LRESULT CALLBACK
 MainWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
@@ -43,6 +45,7 @@ int DataGlobal::run()
 {
 	MSG msg = { 0 };
 
+	PROFILE_THREAD_NAME("Main");
 	m_timer.Reset();
 
 	while (msg.message != WM_QUIT)
@@ -56,12 +59,41 @@ int DataGlobal::run()
 		// Otherwise, do animation/game stuff.
 		else
 		{
+			// Allocations of the previous frame; zero once the scene is loaded
+			// and nothing is spawned or destroyed.
+			MemoryTracker::BeginFrame();
+			PROFILE_COUNTER("Allocations", MemoryTracker::GetFrameAllocations());
+
+			// Pace the loop, then start measuring latency from the point where
+			// this frame samples its input.
+			{
+				PROFILE_SCOPE("FrameLimiter");
+				m_frameLimiter.WaitForNextFrame();
+			}
+			m_frameLimiter.MarkInput();
+
 			m_timer.Tick();
+
+			// The simulation advances in fixed steps, independent of the frame rate.
+			m_simulationAlpha = m_simulation->Advance(m_timer.DeltaTime());
+
 			Update(m_timer);
 			Draw(m_timer);
 		}
 	}
 
+	// Stop the worker while the derived class is still alive to receive FixedUpdate.
+	m_simulation.reset();
+
+#if MEMORY_TRACKING_ENABLED
+	OutputDebugStringA(MemoryTracker::Report().c_str());
+#endif
+
+#if PROFILER_ENABLED
+	// Last few seconds of zones, for chrome://tracing or ui.perfetto.dev.
+	Profiler::Get().ExportChromeTrace("profile.trace.json");
+#endif
+
 	return (int)msg.wParam;
 }
 
@@ -79,6 +111,11 @@ bool DataGlobal::Initialize()
 
 	OnResize();
 
+	m_simulation = std::make_unique<FixedStepLoop>(1.0 / 60.0, 5,
+		[this](double stepSeconds) { FixedUpdate((float)stepSeconds); },
+		[this] { PublishSimulation(); },
+		m_threadedSimulation);
+
 	return true;
 }
 
@@ -93,6 +130,9 @@ DataGlobal::DataGlobal(HINSTANCE hInstance)
 {
 	assert(mApp == nullptr);
 	mApp = this;
+
+	m_frameLimiter.SetTargetFrameRate(60.0);
+	m_frameLimiter.SetMaxQueuedFrames(2);
 }
 
 DataGlobal::~DataGlobal()
@@ -350,15 +390,24 @@ void DataGlobal::CreateRtvAndDsvDescriptorHeaps()
 
 void DataGlobal::FlushCommandQueue()
 {
+	PROFILE_FUNCTION();
+
 	m_currentFence++;
 
 	ThrowIfFailed(m_commandQueue->Signal(m_fence.Get(), m_currentFence));
 
-	if (m_fence->GetCompletedValue() < m_currentFence)
+	WaitForFence(m_currentFence);
+}
+
+void DataGlobal::WaitForFence(UINT64 fenceValue)
+{
+	PROFILE_FUNCTION();
+
+	if (m_fence->GetCompletedValue() < fenceValue)
 	{
 		HANDLE eventHandle = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
 
-		ThrowIfFailed(m_fence->SetEventOnCompletion(m_currentFence, eventHandle));
+		ThrowIfFailed(m_fence->SetEventOnCompletion(fenceValue, eventHandle));
 
 		WaitForSingleObject(eventHandle, INFINITE);
 		CloseHandle(eventHandle);
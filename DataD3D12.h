@@ -1,6 +1,8 @@
 #pragma once
 #include "framework.h"
 #include "GameTimer.h"
+#include "FixedStepScheduler.h"
+#include "FrameLimiter.h"
 #include "d3dUtil.h"
 
 using namespace Microsoft::WRL;
@@ -34,6 +36,13 @@ public:
 
 protected:
 
+	// Called zero or more times per frame with a constant step, before Update;
+	// on the simulation thread if m_threadedSimulation is set.
+	virtual void						FixedUpdate(float stepSeconds) {}
+	// Called once per frame on the main thread while no FixedUpdate runs:
+	// copy the simulation state that Update reads. Update interpolates it
+	// with m_simulationAlpha.
+	virtual void						PublishSimulation() {}
 	virtual void						Update(const GameTimer& gt) = 0;
 	virtual void						Draw(const GameTimer& gt) = 0;
 	bool								InitDriect3D();
@@ -42,6 +51,7 @@ protected:
 	void								CreateSwapChain();
 	virtual void						CreateRtvAndDsvDescriptorHeaps();
 	void								FlushCommandQueue();
+	void								WaitForFence(UINT64 fenceValue);
 
 protected:
 
@@ -56,6 +66,13 @@ protected:
 	UINT								m4xMsaaQuality = 0;
 
 	GameTimer							m_timer;
+	FrameLimiter						m_frameLimiter;
+
+	// Set before Initialize() to run FixedUpdate on its own thread.
+	bool								m_threadedSimulation = false;
+	std::unique_ptr<FixedStepLoop>		m_simulation;
+	// Interpolation alpha of the published simulation state, for Update.
+	float								m_simulationAlpha = 0.0f;
 
 	ComPtr<IDXGIFactory4>				m_dxgiFactory;
 	ComPtr<IDXGISwapChain>				m_swapChain;
@@ -0,0 +1,143 @@
+#include "DescriptorAllocator.h"
+#include <algorithm>
+#include <cassert>
+
+DescriptorFreeList::DescriptorFreeList(std::uint32_t base, std::uint32_t capacity)
+	: m_base(base), m_capacity(capacity), m_freeCount(capacity)
+{
+	if (capacity > 0)
+		m_free.push_back(DescriptorSpan{ base, capacity });
+}
+
+DescriptorSpan DescriptorFreeList::Allocate(std::uint32_t count)
+{
+	assert(count > 0);
+
+	for (std::size_t i = m_free.size(); i-- > 0;)
+	{
+		DescriptorSpan& range = m_free[i];
+		if (range.Count < count)
+			continue;
+
+		range.Count -= count;
+		DescriptorSpan span { range.Offset + range.Count, count };
+		if (range.Count == 0)
+			m_free.erase(m_free.begin() + i);
+
+		m_freeCount -= count;
+		return span;
+	}
+
+	return DescriptorSpan();
+}
+
+void DescriptorFreeList::Free(DescriptorSpan span)
+{
+	if (!span.IsValid())
+		return;
+
+	assert(span.Offset >= m_base && span.Offset + span.Count <= m_base + m_capacity);
+	m_pending.push_back(span);
+}
+
+void DescriptorFreeList::FreeNow(DescriptorSpan span)
+{
+	if (!span.IsValid())
+		return;
+
+	assert(span.Offset >= m_base && span.Offset + span.Count <= m_base + m_capacity);
+	Insert(span);
+}
+
+void DescriptorFreeList::EndFrame(std::uint64_t fence)
+{
+	for (const DescriptorSpan& span : m_pending)
+		m_retired.push_back(Retired{ span, fence });
+	m_pending.clear();
+}
+
+void DescriptorFreeList::ReleaseCompleted(std::uint64_t completedFence)
+{
+	std::size_t released = 0;
+	while (released < m_retired.size() && m_retired[released].Fence <= completedFence)
+		Insert(m_retired[released++].Span);
+
+	m_retired.erase(m_retired.begin(), m_retired.begin() + released);
+}
+
+void DescriptorFreeList::Insert(DescriptorSpan span)
+{
+	auto next = std::lower_bound(m_free.begin(), m_free.end(), span.Offset,
+		[](const DescriptorSpan& range, std::uint32_t offset) { return range.Offset < offset; });
+
+	assert(next == m_free.end() || span.Offset + span.Count <= next->Offset);
+	assert(next == m_free.begin() || std::prev(next)->Offset + std::prev(next)->Count <= span.Offset);
+
+	m_freeCount += span.Count;
+
+	bool joinsPrevious = next != m_free.begin() && std::prev(next)->Offset + std::prev(next)->Count == span.Offset;
+	bool joinsNext = next != m_free.end() && span.Offset + span.Count == next->Offset;
+
+	if (joinsPrevious && joinsNext)
+	{
+		std::prev(next)->Count += span.Count + next->Count;
+		m_free.erase(next);
+	}
+	else if (joinsPrevious)
+	{
+		std::prev(next)->Count += span.Count;
+	}
+	else if (joinsNext)
+	{
+		next->Offset = span.Offset;
+		next->Count += span.Count;
+	}
+	else
+	{
+		m_free.insert(next, span);
+	}
+}
+
+DescriptorRing::DescriptorRing(std::uint32_t base, std::uint32_t capacity)
+	: m_base(base), m_capacity(capacity)
+{
+}
+
+DescriptorSpan DescriptorRing::Allocate(std::uint32_t count)
+{
+	assert(count > 0);
+
+	// Nothing in flight: restart at the beginning, no need to skip anything.
+	if (m_used == 0)
+		m_head = 0;
+
+	// Skip the end of the ring rather than splitting the span.
+	std::uint32_t skipped = m_head + count > m_capacity ? m_capacity - m_head : 0;
+	if (m_used + skipped + count > m_capacity)
+		return DescriptorSpan();
+
+	if (skipped > 0)
+		m_head = 0;
+
+	DescriptorSpan span { m_base + m_head, count };
+	m_head = (m_head + count) % m_capacity;
+	m_used += skipped + count;
+	m_frameUsed += skipped + count;
+	return span;
+}
+
+void DescriptorRing::EndFrame(std::uint64_t fence)
+{
+	if (m_frameUsed > 0)
+		m_frames.push_back(FrameMark{ fence, m_frameUsed });
+	m_frameUsed = 0;
+}
+
+void DescriptorRing::ReleaseCompleted(std::uint64_t completedFence)
+{
+	std::size_t released = 0;
+	while (released < m_frames.size() && m_frames[released].Fence <= completedFence)
+		m_used -= m_frames[released++].Used;
+
+	m_frames.erase(m_frames.begin(), m_frames.begin() + released);
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Contiguous descriptors of a heap, as offsets from the heap start.
+struct DescriptorSpan
+{
+	static constexpr std::uint32_t			InvalidOffset = 0xffffffffu;
+
+	std::uint32_t							Offset = InvalidOffset;
+	std::uint32_t							Count = 0;
+
+	bool									IsValid()		const	{	return Offset != InvalidOffset;	}
+};
+
+// Long-lived descriptors: textures, buffers, anything bound across frames.
+//
+// Free ranges are kept sorted and coalesced. Allocation takes from the tail of
+// the last range that fits, so the common single-descriptor churn only
+// shrinks and grows the back of the list and never allocates memory once the
+// lists have reached their working size.
+//
+// A freed span may still be referenced by frames the GPU has not finished:
+// Free() holds it until EndFrame() tags it with that frame's fence, and
+// ReleaseCompleted() returns it once the fence has passed.
+class DescriptorFreeList
+{
+public:
+
+											DescriptorFreeList(std::uint32_t base, std::uint32_t capacity);
+
+	// Invalid span if no free range is large enough.
+	DescriptorSpan							Allocate(std::uint32_t count);
+	void									Free(DescriptorSpan span);
+	// For spans the GPU never sees.
+	void									FreeNow(DescriptorSpan span);
+
+	void									EndFrame(std::uint64_t fence);
+	void									ReleaseCompleted(std::uint64_t completedFence);
+
+	std::uint32_t							GetFreeCount()		const	{	return m_freeCount;	}
+	std::uint32_t							GetCapacity()		const	{	return m_capacity;	}
+	// Number of separate free ranges: a measure of fragmentation.
+	std::uint32_t							GetFreeRangeCount()	const	{	return (std::uint32_t)m_free.size();	}
+
+private:
+
+	struct Retired
+	{
+		DescriptorSpan						Span;
+		std::uint64_t						Fence;
+	};
+
+	void									Insert(DescriptorSpan span);
+
+	std::uint32_t							m_base;
+	std::uint32_t							m_capacity;
+	std::uint32_t							m_freeCount;
+	std::vector<DescriptorSpan>				m_free;			// sorted by offset, never adjacent
+	std::vector<DescriptorSpan>				m_pending;		// freed during the current frame
+	std::vector<Retired>					m_retired;		// in fence order
+};
+
+// Descriptors that live for one frame: tables built while recording.
+//
+// Allocation is a linear walk through a ring. Each frame's share of the ring
+// is tagged with its fence at EndFrame() and given back as a whole when the
+// GPU has passed it. A span never wraps: when it does not fit before the end
+// of the ring, the tail is skipped and charged to the frame.
+class DescriptorRing
+{
+public:
+
+											DescriptorRing(std::uint32_t base, std::uint32_t capacity);
+
+	// Invalid span if the frames in flight hold too much of the ring.
+	DescriptorSpan							Allocate(std::uint32_t count);
+
+	void									EndFrame(std::uint64_t fence);
+	void									ReleaseCompleted(std::uint64_t completedFence);
+
+	std::uint32_t							GetUsedCount()		const	{	return m_used;	}
+	std::uint32_t							GetCapacity()		const	{	return m_capacity;	}
+
+private:
+
+	struct FrameMark
+	{
+		std::uint64_t						Fence;
+		std::uint32_t						Used;
+	};
+
+	std::uint32_t							m_base;
+	std::uint32_t							m_capacity;
+	std::uint32_t							m_head = 0;			// next offset, relative to m_base
+	std::uint32_t							m_used = 0;			// by frames in flight and the current one
+	std::uint32_t							m_frameUsed = 0;	// by the current frame
+	std::vector<FrameMark>					m_frames;			// in fence order
+};
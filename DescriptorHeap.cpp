@@ -0,0 +1,104 @@
+#include "DescriptorHeap.h"
+
+DescriptorHeapManager::DescriptorHeapManager()
+{
+}
+
+DescriptorHeapManager::~DescriptorHeapManager()
+{
+}
+
+void DescriptorHeapManager::Initialize(ID3D12Device* device, UINT persistentCount, UINT transientCount, UINT stagingCount)
+{
+	m_device = device;
+	m_descriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+	D3D12_DESCRIPTOR_HEAP_DESC heapDesc;
+	heapDesc.NumDescriptors = persistentCount + transientCount;
+	heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+	heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+	heapDesc.NodeMask = 0;
+	DX::ThrowIfFailed(device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_heap)));
+
+	D3D12_DESCRIPTOR_HEAP_DESC stagingDesc = heapDesc;
+	stagingDesc.NumDescriptors = stagingCount;
+	stagingDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+	DX::ThrowIfFailed(device->CreateDescriptorHeap(&stagingDesc, IID_PPV_ARGS(&m_stagingHeap)));
+
+	// Persistent descriptors first, then the ring.
+	m_persistent = std::make_unique<DescriptorFreeList>(0, persistentCount);
+	m_transient = std::make_unique<DescriptorRing>(persistentCount, transientCount);
+	m_staging = std::make_unique<DescriptorFreeList>(0, stagingCount);
+}
+
+DescriptorHandle DescriptorHeapManager::MakeHandle(DescriptorSpan span, bool shaderVisible) const
+{
+	DescriptorHandle handle;
+	handle.Span = span;
+
+	ID3D12DescriptorHeap* heap = shaderVisible ? m_heap.Get() : m_stagingHeap.Get();
+	handle.Cpu = CD3DX12_CPU_DESCRIPTOR_HANDLE(heap->GetCPUDescriptorHandleForHeapStart(), span.Offset, m_descriptorSize);
+	if (shaderVisible)
+		handle.Gpu = CD3DX12_GPU_DESCRIPTOR_HANDLE(heap->GetGPUDescriptorHandleForHeapStart(), span.Offset, m_descriptorSize);
+	return handle;
+}
+
+DescriptorHandle DescriptorHeapManager::AllocatePersistent(UINT count)
+{
+	DescriptorSpan span = m_persistent->Allocate(count);
+	if (!span.IsValid())
+		DX::ThrowIfFailed(E_OUTOFMEMORY);
+	return MakeHandle(span, true);
+}
+
+DescriptorHandle DescriptorHeapManager::AllocateTransient(UINT count)
+{
+	DescriptorSpan span = m_transient->Allocate(count);
+	if (!span.IsValid())
+		DX::ThrowIfFailed(E_OUTOFMEMORY);
+	return MakeHandle(span, true);
+}
+
+DescriptorHandle DescriptorHeapManager::AllocateStaging(UINT count)
+{
+	DescriptorSpan span = m_staging->Allocate(count);
+	if (!span.IsValid())
+		DX::ThrowIfFailed(E_OUTOFMEMORY);
+	return MakeHandle(span, false);
+}
+
+void DescriptorHeapManager::FreePersistent(const DescriptorHandle& handle)
+{
+	m_persistent->Free(handle.Span);
+}
+
+void DescriptorHeapManager::FreeStaging(const DescriptorHandle& handle)
+{
+	m_staging->FreeNow(handle.Span);
+}
+
+DescriptorHandle DescriptorHeapManager::CopyToTransient(const D3D12_CPU_DESCRIPTOR_HANDLE* sources, UINT count)
+{
+	DescriptorHandle table = AllocateTransient(count);
+
+	// One destination range, `count` single-descriptor source ranges.
+	m_device->CopyDescriptors(1, &table.Cpu, &count, count, sources, nullptr, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	return table;
+}
+
+void DescriptorHeapManager::Copy(const DescriptorHandle& destination, const DescriptorHandle& source, UINT count)
+{
+	m_device->CopyDescriptorsSimple(count, destination.Cpu, source.Cpu, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+}
+
+void DescriptorHeapManager::BeginFrame(UINT64 completedFence)
+{
+	m_persistent->ReleaseCompleted(completedFence);
+	m_transient->ReleaseCompleted(completedFence);
+}
+
+void DescriptorHeapManager::EndFrame(UINT64 fence)
+{
+	m_persistent->EndFrame(fence);
+	m_transient->EndFrame(fence);
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "framework.h"
+#include "d3dUtil.h"
+#include "DescriptorAllocator.h"
+
+using Microsoft::WRL::ComPtr;
+
+// Descriptors of a DescriptorHeapManager allocation. Cpu and Gpu point at
+// the first one; Gpu is null for staging descriptors, which are not shader
+// visible.
+struct DescriptorHandle
+{
+	DescriptorSpan							Span;
+	D3D12_CPU_DESCRIPTOR_HANDLE				Cpu = {};
+	D3D12_GPU_DESCRIPTOR_HANDLE				Gpu = {};
+
+	bool									IsValid()		const	{	return Span.IsValid();	}
+};
+
+// CBV/SRV/UAV descriptors for the renderer.
+//
+// One shader-visible heap, bound once per command list, split in two:
+// - a persistent region with a free list, for descriptors that outlive a
+//   frame; freeing is deferred until the GPU is done with the frame,
+// - a transient ring, for tables built while recording a frame; a frame's
+//   share is recycled as a whole once its fence has passed.
+// A separate CPU-only staging heap is where descriptors are created: staging
+// descriptors can be written at any time and copied into either region, the
+// shader-visible heap being slow to write from the CPU on some hardware.
+class DescriptorHeapManager
+{
+public:
+
+											DescriptorHeapManager();
+											DescriptorHeapManager(const DescriptorHeapManager& rhs) = delete;
+											DescriptorHeapManager& operator=(const DescriptorHeapManager& rhs) = delete;
+											~DescriptorHeapManager();
+
+	void									Initialize(ID3D12Device* device, UINT persistentCount, UINT transientCount, UINT stagingCount);
+
+	ID3D12DescriptorHeap*					GetHeap()				const	{	return m_heap.Get();	}
+	UINT									GetDescriptorSize()		const	{	return m_descriptorSize;	}
+
+	// Throw E_OUTOFMEMORY when the region is exhausted.
+	DescriptorHandle						AllocatePersistent(UINT count = 1);
+	DescriptorHandle						AllocateTransient(UINT count);
+	DescriptorHandle						AllocateStaging(UINT count = 1);
+
+	// Persistent descriptors come back after the current frame's fence.
+	void									FreePersistent(const DescriptorHandle& handle);
+	// Staging descriptors are never read by the GPU: freed at once.
+	void									FreeStaging(const DescriptorHandle& handle);
+
+	// Copies staging descriptors, one by one, into a contiguous transient
+	// table and returns it.
+	DescriptorHandle						CopyToTransient(const D3D12_CPU_DESCRIPTOR_HANDLE* sources, UINT count);
+	void									Copy(const DescriptorHandle& destination, const DescriptorHandle& source, UINT count);
+
+	// Call once the GPU has reached `completedFence`, before allocating
+	// transient descriptors for the new frame.
+	void									BeginFrame(UINT64 completedFence);
+	// Call with the fence signaled after the frame's command lists.
+	void									EndFrame(UINT64 fence);
+
+	const DescriptorFreeList&				GetPersistent()			const	{	return *m_persistent;	}
+	const DescriptorRing&					GetTransient()			const	{	return *m_transient;	}
+
+private:
+
+	DescriptorHandle						MakeHandle(DescriptorSpan span, bool shaderVisible)	const;
+
+	ComPtr<ID3D12Device>					m_device = nullptr;
+	ComPtr<ID3D12DescriptorHeap>			m_heap = nullptr;
+	ComPtr<ID3D12DescriptorHeap>			m_stagingHeap = nullptr;
+	UINT									m_descriptorSize = 0;
+
+	std::unique_ptr<DescriptorFreeList>		m_persistent;
+	std::unique_ptr<DescriptorRing>			m_transient;
+	std::unique_ptr<DescriptorFreeList>		m_staging;
+};
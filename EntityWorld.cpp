@@ -0,0 +1,233 @@
+#include "EntityWorld.h"
+#include "MemoryTracker.h"
+#include <atomic>
+
+namespace
+{
+	ComponentRegistry::Info					g_componentInfo[ComponentRegistry::MaxComponentTypes];
+	std::atomic<std::uint32_t>				g_componentCount { 0 };
+
+	std::size_t AlignUp(std::size_t value, std::size_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+}
+
+ComponentTypeId ComponentRegistry::Register(std::size_t size, std::size_t alignment)
+{
+	ComponentTypeId id = g_componentCount.fetch_add(1);
+	assert(id < MaxComponentTypes && "Too many component types.");
+
+	g_componentInfo[id].Size = size;
+	g_componentInfo[id].Alignment = alignment;
+	return id;
+}
+
+const ComponentRegistry::Info& ComponentRegistry::Get(ComponentTypeId id)
+{
+	return g_componentInfo[id];
+}
+
+Archetype::Archetype(ComponentMask mask)
+	: m_mask(mask)
+{
+	std::size_t bytesPerEntity = sizeof(Entity);
+	std::size_t padding = 0;
+
+	for (ComponentTypeId id = 0; id < ComponentRegistry::MaxComponentTypes; ++id)
+	{
+		if (!Has(id))
+			continue;
+
+		const ComponentRegistry::Info& info = ComponentRegistry::Get(id);
+		m_types.push_back(id);
+		bytesPerEntity += info.Size;
+		padding += info.Alignment;
+	}
+
+	m_chunkCapacity = (std::uint32_t)((ChunkBytes - padding) / bytesPerEntity);
+	assert(m_chunkCapacity > 0 && "Archetype does not fit in a chunk.");
+
+	// Entity array first, then each column at its natural alignment.
+	std::size_t offset = sizeof(Entity) * m_chunkCapacity;
+	for (ComponentTypeId id : m_types)
+	{
+		const ComponentRegistry::Info& info = ComponentRegistry::Get(id);
+		offset = AlignUp(offset, info.Alignment);
+		m_columnOffset[id] = offset;
+		offset += info.Size * m_chunkCapacity;
+	}
+	assert(offset <= ChunkBytes);
+}
+
+EntityWorld::EntityWorld()
+{
+}
+
+EntityWorld::~EntityWorld()
+{
+	for (Archetype* archetype : m_archetypes)
+	{
+		for (Archetype::Chunk& chunk : archetype->m_chunks)
+			FreeChunk(chunk.Data);
+	}
+
+	for (std::uint8_t* data : m_freeChunks)
+		MemoryTracker::Free(MemTag::Entities, data, Archetype::ChunkBytes);
+}
+
+bool EntityWorld::IsAlive(Entity entity) const
+{
+	return entity.Index < m_records.size()
+		&& m_records[entity.Index].Owner != nullptr
+		&& m_records[entity.Index].Generation == entity.Generation;
+}
+
+void EntityWorld::Destroy(Entity entity)
+{
+	if (!IsAlive(entity))
+		return;
+
+	Record& record = m_records[entity.Index];
+	RemoveRow(record);
+
+	record.Owner = nullptr;
+	record.Generation++;
+	m_freeIndices.push_back(entity.Index);
+	m_entityCount--;
+}
+
+Archetype* EntityWorld::GetArchetype(ComponentMask mask)
+{
+	auto it = m_archetypeByMask.find(mask);
+	if (it != m_archetypeByMask.end())
+		return it->second.get();
+
+	auto archetype = std::make_unique<Archetype>(mask);
+	Archetype* result = archetype.get();
+	m_archetypes.push_back(result);
+	m_archetypeByMask[mask] = std::move(archetype);
+	return result;
+}
+
+Entity EntityWorld::AllocateEntity()
+{
+	Entity entity;
+	if (!m_freeIndices.empty())
+	{
+		entity.Index = m_freeIndices.back();
+		m_freeIndices.pop_back();
+	}
+	else
+	{
+		entity.Index = (std::uint32_t)m_records.size();
+		m_records.emplace_back();
+	}
+
+	entity.Generation = m_records[entity.Index].Generation;
+	m_entityCount++;
+	return entity;
+}
+
+void EntityWorld::AppendRow(Archetype* archetype, Entity entity)
+{
+	auto& chunks = archetype->m_chunks;
+	if (chunks.empty() || chunks.back().Count == archetype->m_chunkCapacity)
+	{
+		Archetype::Chunk chunk;
+		chunk.Data = AllocateChunk();
+		chunks.push_back(chunk);
+	}
+
+	Archetype::Chunk& chunk = chunks.back();
+	std::uint32_t row = chunk.Count++;
+	archetype->Entities(chunk)[row] = entity;
+	archetype->m_entityCount++;
+
+	Record& record = m_records[entity.Index];
+	record.Owner = archetype;
+	record.Chunk = (std::uint32_t)chunks.size() - 1;
+	record.Row = row;
+}
+
+void EntityWorld::RemoveRow(const Record& record)
+{
+	Archetype* archetype = record.Owner;
+	auto& chunks = archetype->m_chunks;
+
+	Archetype::Chunk& hole = chunks[record.Chunk];
+	Archetype::Chunk& last = chunks.back();
+	std::uint32_t lastRow = last.Count - 1;
+
+	if (&hole != &last || record.Row != lastRow)
+	{
+		Entity moved = archetype->Entities(last)[lastRow];
+		archetype->Entities(hole)[record.Row] = moved;
+
+		for (ComponentTypeId id : archetype->m_types)
+		{
+			std::size_t size = ComponentRegistry::Get(id).Size;
+			std::memcpy(static_cast<std::uint8_t*>(archetype->Column(hole, id)) + record.Row * size,
+				static_cast<std::uint8_t*>(archetype->Column(last, id)) + lastRow * size, size);
+		}
+
+		Record& movedRecord = m_records[moved.Index];
+		movedRecord.Chunk = record.Chunk;
+		movedRecord.Row = record.Row;
+	}
+
+	last.Count--;
+	archetype->m_entityCount--;
+
+	if (last.Count == 0)
+	{
+		FreeChunk(last.Data);
+		chunks.pop_back();
+	}
+}
+
+void EntityWorld::MoveToArchetype(Entity entity, Archetype* target)
+{
+	Record source = m_records[entity.Index];
+
+	AppendRow(target, entity);
+	const Record& destination = m_records[entity.Index];
+
+	// Components present on both sides are carried over; new ones are left
+	// for the caller to write, dropped ones are simply not copied.
+	for (ComponentTypeId id : target->m_types)
+	{
+		if (source.Owner->Has(id))
+			std::memcpy(ComponentAddress(destination, id), ComponentAddress(source, id), ComponentRegistry::Get(id).Size);
+	}
+
+	// RemoveRow may move another entity of the source archetype into the
+	// hole, but never the one being moved, whose record now points at the
+	// target.
+	RemoveRow(source);
+}
+
+void* EntityWorld::ComponentAddress(const Record& record, ComponentTypeId id) const
+{
+	const Archetype::Chunk& chunk = record.Owner->m_chunks[record.Chunk];
+	return static_cast<std::uint8_t*>(record.Owner->Column(chunk, id)) + (std::size_t)record.Row * ComponentRegistry::Get(id).Size;
+}
+
+std::uint8_t* EntityWorld::AllocateChunk()
+{
+	if (!m_freeChunks.empty())
+	{
+		std::uint8_t* data = m_freeChunks.back();
+		m_freeChunks.pop_back();
+		return data;
+	}
+
+	return static_cast<std::uint8_t*>(MemoryTracker::Allocate(MemTag::Entities, Archetype::ChunkBytes));
+}
+
+void EntityWorld::FreeChunk(std::uint8_t* data)
+{
+	// Chunks are kept for reuse by any archetype; spawn/despawn churn around
+	// a chunk boundary would otherwise hit the heap every time.
+	m_freeChunks.push_back(data);
+}
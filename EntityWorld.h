@@ -0,0 +1,318 @@
+#pragma once
+#include "FrameArena.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <execution>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// Reference to an entity of an EntityWorld. Like PoolHandle, the generation
+// changes when an index is reused, so a destroyed entity never aliases the
+// one created after it.
+struct Entity
+{
+	static constexpr std::uint32_t			InvalidIndex = 0xffffffffu;
+
+	std::uint32_t							Index = InvalidIndex;
+	std::uint32_t							Generation = 0;
+
+	bool									IsValid()						const	{	return Index != InvalidIndex;	}
+	bool									operator==(const Entity& rhs)	const	{	return Index == rhs.Index && Generation == rhs.Generation;	}
+	bool									operator!=(const Entity& rhs)	const	{	return !(*this == rhs);	}
+};
+
+using ComponentTypeId = std::uint32_t;
+using ComponentMask = std::uint64_t;
+
+// Component types get a small id on first use. Components are plain data:
+// they are moved between chunks with memcpy and never destroyed.
+class ComponentRegistry
+{
+public:
+
+	static const std::uint32_t				MaxComponentTypes = 64;
+
+	struct Info
+	{
+		std::size_t							Size = 0;
+		std::size_t							Alignment = 0;
+	};
+
+	template<typename T>
+	static ComponentTypeId Id()
+	{
+		// `const T` in a query must map to the same id as `T`.
+		if constexpr (std::is_const<T>::value || std::is_volatile<T>::value)
+		{
+			return Id<std::remove_cv_t<T>>();
+		}
+		else
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "Components must be trivially copyable.");
+			static const ComponentTypeId id = Register(sizeof(T), alignof(T));
+			return id;
+		}
+	}
+
+	template<typename... C>
+	static ComponentMask Mask()
+	{
+		return (ComponentMask(0) | ... | (ComponentMask(1) << Id<C>()));
+	}
+
+	static const Info&						Get(ComponentTypeId id);
+
+private:
+
+	static ComponentTypeId					Register(std::size_t size, std::size_t alignment);
+};
+
+// Every entity with exactly the same set of components lives in the same
+// archetype. An archetype stores its entities in fixed-size chunks, and each
+// chunk is structure-of-arrays: the Entity array first, then one tightly
+// packed array per component. Queries walk whole chunks, so a system only
+// touches the arrays it asks for.
+class Archetype
+{
+public:
+
+	static const std::size_t				ChunkBytes = 16 * 1024;
+
+	struct Chunk
+	{
+		std::uint8_t*						Data = nullptr;
+		std::uint32_t						Count = 0;
+	};
+
+											Archetype(ComponentMask mask);
+
+	ComponentMask							GetMask()							const	{	return m_mask;	}
+	std::uint32_t							GetChunkCapacity()					const	{	return m_chunkCapacity;	}
+	std::uint32_t							GetEntityCount()					const	{	return m_entityCount;	}
+	std::vector<Chunk>&						GetChunks()									{	return m_chunks;	}
+	bool									Has(ComponentTypeId id)				const	{	return (m_mask >> id) & 1;	}
+
+	Entity*									Entities(const Chunk& chunk)		const	{	return reinterpret_cast<Entity*>(chunk.Data);	}
+	void*									Column(const Chunk& chunk, ComponentTypeId id)	const	{	return chunk.Data + m_columnOffset[id];	}
+
+	template<typename T>
+	T*										Column(const Chunk& chunk)			const	{	return static_cast<T*>(Column(chunk, ComponentRegistry::Id<T>()));	}
+
+private:
+
+	friend class EntityWorld;
+
+	ComponentMask							m_mask;
+	std::vector<ComponentTypeId>			m_types;
+	std::size_t								m_columnOffset[ComponentRegistry::MaxComponentTypes] = {};
+	std::uint32_t							m_chunkCapacity = 0;
+	std::uint32_t							m_entityCount = 0;
+	std::vector<Chunk>						m_chunks;
+};
+
+// Archetype-based entity/component store.
+//
+// Creating and destroying entities is O(1): a new entity goes at the end of
+// its archetype's last chunk, and a destroyed one is replaced by that last
+// entity. Adding or removing a component moves the entity to another
+// archetype. Structural changes must not happen while a query is running.
+class EntityWorld
+{
+public:
+
+											EntityWorld();
+											EntityWorld(const EntityWorld& rhs) = delete;
+											EntityWorld& operator=(const EntityWorld& rhs) = delete;
+											~EntityWorld();
+
+	template<typename... C>
+	Entity									Create(const C&... components);
+	void									Destroy(Entity entity);
+	bool									IsAlive(Entity entity)	const;
+
+	// nullptr if the entity is stale or does not have the component.
+	template<typename T>
+	T*										Get(Entity entity)		const;
+
+	// Overwrites the component if the entity already has it.
+	template<typename T>
+	void									Add(Entity entity, const T& component);
+	template<typename T>
+	void									Remove(Entity entity);
+
+	// Calls f(Entity, C&...) for every entity that has all of C.
+	template<typename... C, typename F>
+	void									ForEach(F&& f);
+
+	// Same, but chunks are spread over the worker threads. `f` must only
+	// write to the components it is handed.
+	template<typename... C, typename F>
+	void									ParallelForEach(F&& f);
+
+	// Calls f(count, const Entity*, C*...) once per matching chunk.
+	template<typename... C, typename F>
+	void									ForEachChunk(F&& f);
+
+	std::uint32_t							GetEntityCount()		const	{	return m_entityCount;	}
+	std::uint32_t							GetArchetypeCount()		const	{	return (std::uint32_t)m_archetypes.size();	}
+
+private:
+
+	struct Record
+	{
+		Archetype*							Owner = nullptr;
+		std::uint32_t						Chunk = 0;
+		std::uint32_t						Row = 0;
+		std::uint32_t						Generation = 0;
+	};
+
+	struct ChunkRef
+	{
+		Archetype*							Owner;
+		Archetype::Chunk*					Chunk;
+	};
+
+	Archetype*								GetArchetype(ComponentMask mask);
+	Entity									AllocateEntity();
+	// Appends a row for `entity` to `archetype` and points its record at it.
+	void									AppendRow(Archetype* archetype, Entity entity);
+	// Fills the hole at the record's row with the archetype's last row.
+	void									RemoveRow(const Record& record);
+	void									MoveToArchetype(Entity entity, Archetype* target);
+	void*									ComponentAddress(const Record& record, ComponentTypeId id)	const;
+
+	template<typename... C>
+	void									GatherChunks(FrameVector<ChunkRef>& chunks);
+
+	std::uint8_t*							AllocateChunk();
+	void									FreeChunk(std::uint8_t* data);
+
+	std::unordered_map<ComponentMask, std::unique_ptr<Archetype>>	m_archetypeByMask;
+	std::vector<Archetype*>					m_archetypes;
+
+	std::vector<Record>						m_records;
+	std::vector<std::uint32_t>				m_freeIndices;
+	std::vector<std::uint8_t*>				m_freeChunks;
+	std::uint32_t							m_entityCount = 0;
+};
+
+template<typename... C>
+Entity EntityWorld::Create(const C&... components)
+{
+	Archetype* archetype = GetArchetype(ComponentRegistry::Mask<C...>());
+
+	Entity entity = AllocateEntity();
+	AppendRow(archetype, entity);
+
+	const Record& record = m_records[entity.Index];
+	((*static_cast<C*>(ComponentAddress(record, ComponentRegistry::Id<C>())) = components), ...);
+
+	return entity;
+}
+
+template<typename T>
+T* EntityWorld::Get(Entity entity) const
+{
+	if (!IsAlive(entity))
+		return nullptr;
+
+	const Record& record = m_records[entity.Index];
+	ComponentTypeId id = ComponentRegistry::Id<T>();
+	if (!record.Owner->Has(id))
+		return nullptr;
+
+	return static_cast<T*>(ComponentAddress(record, id));
+}
+
+template<typename T>
+void EntityWorld::Add(Entity entity, const T& component)
+{
+	assert(IsAlive(entity));
+
+	ComponentTypeId id = ComponentRegistry::Id<T>();
+	Archetype* owner = m_records[entity.Index].Owner;
+	if (!owner->Has(id))
+		MoveToArchetype(entity, GetArchetype(owner->GetMask() | (ComponentMask(1) << id)));
+
+	*static_cast<T*>(ComponentAddress(m_records[entity.Index], id)) = component;
+}
+
+template<typename T>
+void EntityWorld::Remove(Entity entity)
+{
+	assert(IsAlive(entity));
+
+	ComponentTypeId id = ComponentRegistry::Id<T>();
+	Archetype* owner = m_records[entity.Index].Owner;
+	if (owner->Has(id))
+		MoveToArchetype(entity, GetArchetype(owner->GetMask() & ~(ComponentMask(1) << id)));
+}
+
+template<typename... C>
+void EntityWorld::GatherChunks(FrameVector<ChunkRef>& chunks)
+{
+	const ComponentMask mask = ComponentRegistry::Mask<C...>();
+
+	for (Archetype* archetype : m_archetypes)
+	{
+		if ((archetype->GetMask() & mask) != mask)
+			continue;
+
+		for (Archetype::Chunk& chunk : archetype->GetChunks())
+		{
+			if (chunk.Count > 0)
+				chunks.push_back(ChunkRef{ archetype, &chunk });
+		}
+	}
+}
+
+template<typename... C, typename F>
+void EntityWorld::ForEachChunk(F&& f)
+{
+	const ComponentMask mask = ComponentRegistry::Mask<C...>();
+
+	for (Archetype* archetype : m_archetypes)
+	{
+		if ((archetype->GetMask() & mask) != mask)
+			continue;
+
+		for (Archetype::Chunk& chunk : archetype->GetChunks())
+		{
+			if (chunk.Count > 0)
+				f(chunk.Count, static_cast<const Entity*>(archetype->Entities(chunk)), archetype->Column<C>(chunk)...);
+		}
+	}
+}
+
+template<typename... C, typename F>
+void EntityWorld::ForEach(F&& f)
+{
+	ForEachChunk<C...>([&f](std::uint32_t count, const Entity* entities, C*... columns)
+	{
+		for (std::uint32_t i = 0; i < count; ++i)
+			f(entities[i], columns[i]...);
+	});
+}
+
+template<typename... C, typename F>
+void EntityWorld::ParallelForEach(F&& f)
+{
+	FrameVector<ChunkRef> chunks;
+	GatherChunks<C...>(chunks);
+
+	std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&f](const ChunkRef& ref)
+	{
+		const Entity* entities = ref.Owner->Entities(*ref.Chunk);
+		std::uint32_t count = ref.Chunk->Count;
+
+		auto columns = std::make_tuple(ref.Owner->Column<C>(*ref.Chunk)...);
+		for (std::uint32_t i = 0; i < count; ++i)
+			std::apply([&](C*... column) { f(entities[i], column[i]...); }, columns);
+	});
+}
@@ -0,0 +1,155 @@
+#include "FixedStepScheduler.h"
+#include "Profiler.h"
+#include <cassert>
+
+FixedStepScheduler::FixedStepScheduler(double stepSeconds, std::uint32_t maxStepsPerFrame)
+	: m_stepSeconds(stepSeconds), m_maxStepsPerFrame(maxStepsPerFrame)
+{
+	assert(stepSeconds > 0.0);
+	assert(maxStepsPerFrame > 0);
+}
+
+std::uint32_t FixedStepScheduler::Advance(double frameSeconds)
+{
+	if (frameSeconds < 0.0)
+		frameSeconds = 0.0;
+
+	m_accumulator += frameSeconds;
+
+	std::uint64_t steps = (std::uint64_t)(m_accumulator / m_stepSeconds);
+	m_accumulator -= steps * m_stepSeconds;
+
+	// Guard against rounding leaving the accumulator a hair below zero or at
+	// a full step.
+	if (m_accumulator < 0.0)
+		m_accumulator = 0.0;
+	if (m_accumulator >= m_stepSeconds)
+	{
+		m_accumulator -= m_stepSeconds;
+		steps++;
+	}
+
+	if (steps > m_maxStepsPerFrame)
+	{
+		m_droppedSteps += steps - m_maxStepsPerFrame;
+		steps = m_maxStepsPerFrame;
+	}
+
+	m_stepCount += steps;
+	return (std::uint32_t)steps;
+}
+
+void FixedStepScheduler::Reset()
+{
+	m_accumulator = 0.0;
+	m_stepCount = 0;
+	m_droppedSteps = 0;
+}
+
+FixedStepWorker::FixedStepWorker(std::function<void(double)> step)
+	: m_step(std::move(step))
+{
+	m_thread = std::thread(&FixedStepWorker::ThreadMain, this);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_cv.wait(lock, [this] { return m_started; });
+}
+
+FixedStepWorker::~FixedStepWorker()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_cv.notify_all();
+	m_thread.join();
+}
+
+void FixedStepWorker::Kick(std::uint32_t steps, double stepSeconds)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_cv.wait(lock, [this] { return !m_busy; });
+
+	m_pendingSteps = steps;
+	m_stepSeconds = stepSeconds;
+	m_busy = steps > 0;
+	lock.unlock();
+
+	m_cv.notify_all();
+}
+
+void FixedStepWorker::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_cv.wait(lock, [this] { return !m_busy; });
+}
+
+void FixedStepWorker::ThreadMain()
+{
+	PROFILE_THREAD_NAME("Simulation");
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_started = true;
+	m_cv.notify_all();
+
+	while (true)
+	{
+		m_cv.wait(lock, [this] { return m_busy || m_quit; });
+		if (m_quit)
+			return;
+
+		std::uint32_t steps = m_pendingSteps;
+		double stepSeconds = m_stepSeconds;
+		lock.unlock();
+
+		for (std::uint32_t i = 0; i < steps; ++i)
+		{
+			PROFILE_SCOPE("FixedUpdate");
+			m_step(stepSeconds);
+		}
+
+		lock.lock();
+		m_busy = false;
+		m_cv.notify_all();
+	}
+}
+
+FixedStepLoop::FixedStepLoop(double stepSeconds, std::uint32_t maxStepsPerFrame,
+	std::function<void(double)> step, std::function<void()> publish, bool threaded)
+	: m_scheduler(stepSeconds, maxStepsPerFrame), m_step(std::move(step)), m_publish(std::move(publish))
+{
+	if (threaded)
+		m_worker = std::make_unique<FixedStepWorker>(m_step);
+}
+
+FixedStepLoop::~FixedStepLoop()
+{
+	// Joins the worker before the step callback's state goes away.
+	m_worker.reset();
+}
+
+float FixedStepLoop::Advance(double frameSeconds)
+{
+	std::uint32_t steps = m_scheduler.Advance(frameSeconds);
+
+	if (m_worker == nullptr)
+	{
+		for (std::uint32_t i = 0; i < steps; ++i)
+		{
+			PROFILE_SCOPE("FixedUpdate");
+			m_step(m_scheduler.StepSeconds());
+		}
+		m_publish();
+		return m_scheduler.Alpha();
+	}
+
+	// Publish what the previous frame's steps produced, then hand this
+	// frame's steps to the worker.
+	m_worker->Wait();
+	m_publish();
+	float alpha = m_workerAlpha;
+
+	m_worker->Kick(steps, m_scheduler.StepSeconds());
+	m_workerAlpha = m_scheduler.Alpha();
+	return alpha;
+}
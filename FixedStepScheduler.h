@@ -0,0 +1,110 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Fixed timestep accumulator. The caller feeds it the elapsed frame time and
+// runs as many fixed simulation steps as it returns, then renders with
+// Alpha() to interpolate between the last two simulation states.
+//
+// The scheduler never reads a clock itself, so the same sequence of frame
+// times always produces the same sequence of steps.
+class FixedStepScheduler
+{
+public:
+
+	explicit							FixedStepScheduler(double stepSeconds = 1.0 / 60.0, std::uint32_t maxStepsPerFrame = 5);
+
+	// Adds `frameSeconds` to the accumulator and returns the number of steps
+	// to run. At most maxStepsPerFrame are returned; time beyond that is
+	// dropped so one slow frame cannot snowball into ever longer frames.
+	std::uint32_t						Advance(double frameSeconds);
+	void								Reset();
+
+	double								StepSeconds()			const	{	return m_stepSeconds;	}
+	// Fraction of a step left in the accumulator, in [0, 1).
+	float								Alpha()					const	{	return (float)(m_accumulator / m_stepSeconds);	}
+	std::uint64_t						StepCount()				const	{	return m_stepCount;	}
+	// Steps discarded by the spiral-of-death clamp since Reset().
+	std::uint64_t						DroppedSteps()			const	{	return m_droppedSteps;	}
+
+private:
+
+	double								m_stepSeconds;
+	std::uint32_t						m_maxStepsPerFrame;
+	double								m_accumulator = 0.0;
+	std::uint64_t						m_stepCount = 0;
+	std::uint64_t						m_droppedSteps = 0;
+};
+
+// Runs fixed steps on a dedicated thread. Kick() hands over the steps of one
+// frame and returns immediately, so the simulation overlaps render
+// submission; Wait() blocks until they are done. The step callback must
+// only touch simulation state that the render thread does not read between
+// Kick() and Wait(). The constructor returns once the thread is running, so
+// its start-up cost is paid at load time rather than in some later frame.
+class FixedStepWorker
+{
+public:
+
+										FixedStepWorker(std::function<void(double)> step);
+										FixedStepWorker(const FixedStepWorker& rhs) = delete;
+										FixedStepWorker& operator=(const FixedStepWorker& rhs) = delete;
+										~FixedStepWorker();
+
+	void								Kick(std::uint32_t steps, double stepSeconds);
+	void								Wait();
+
+private:
+
+	void								ThreadMain();
+
+	std::function<void(double)>			m_step;
+	std::thread							m_thread;
+	std::mutex							m_mutex;
+	std::condition_variable				m_cv;
+	std::uint32_t						m_pendingSteps = 0;
+	double								m_stepSeconds = 0.0;
+	bool								m_started = false;
+	bool								m_busy = false;
+	bool								m_quit = false;
+};
+
+// The fixed-step half of a frame loop: advances the scheduler by the frame
+// time, runs the steps serially or on a FixedStepWorker, and publishes the
+// simulation state for rendering.
+//
+// `publish` runs on the calling thread while no step is running, which is
+// the only point where the simulation's output may be copied to what the
+// render side reads. With a worker the steps of a frame overlap the render of
+// that frame, so rendering sees the state one frame later than it would
+// serially, paired with the alpha of the steps that produced it. Given the
+// same frame times, both modes publish the same sequence of states.
+class FixedStepLoop
+{
+public:
+
+										FixedStepLoop(double stepSeconds, std::uint32_t maxStepsPerFrame,
+											std::function<void(double)> step, std::function<void()> publish, bool threaded);
+										FixedStepLoop(const FixedStepLoop& rhs) = delete;
+										FixedStepLoop& operator=(const FixedStepLoop& rhs) = delete;
+										~FixedStepLoop();
+
+	// Returns the interpolation alpha that goes with the published state.
+	float								Advance(double frameSeconds);
+
+	const FixedStepScheduler&			GetScheduler()			const	{	return m_scheduler;	}
+	bool								IsThreaded()			const	{	return m_worker != nullptr;	}
+
+private:
+
+	FixedStepScheduler					m_scheduler;
+	std::function<void(double)>			m_step;
+	std::function<void()>				m_publish;
+	std::unique_ptr<FixedStepWorker>	m_worker;
+	// Alpha after the steps the worker is running.
+	float								m_workerAlpha = 0.0f;
+};
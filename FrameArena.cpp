@@ -0,0 +1,148 @@
+#include "FrameArena.h"
+#include "MemoryTracker.h"
+#include <atomic>
+#include <cassert>
+
+LinearArena::LinearArena(std::size_t blockSize)
+	: m_blockSize(blockSize)
+{
+}
+
+LinearArena::~LinearArena()
+{
+	FreeBlocks();
+}
+
+void* LinearArena::Allocate(std::size_t bytes, std::size_t alignment)
+{
+	assert((alignment & (alignment - 1)) == 0 && "Alignment must be a power of two.");
+
+	if (!m_blocks.empty())
+	{
+		const Block& block = m_blocks.back();
+		std::uintptr_t base = reinterpret_cast<std::uintptr_t>(block.Data);
+		std::uintptr_t aligned = (base + m_offset + alignment - 1) & ~(std::uintptr_t)(alignment - 1);
+		std::size_t end = (std::size_t)(aligned - base) + bytes;
+
+		if (end <= block.Size)
+		{
+			m_offset = end;
+			return reinterpret_cast<void*>(aligned);
+		}
+	}
+
+	AddBlock(bytes + alignment);
+	return Allocate(bytes, alignment);
+}
+
+void LinearArena::Free(void* p, std::size_t bytes) noexcept
+{
+	if (m_blocks.empty())
+		return;
+
+	std::uint8_t* top = m_blocks.back().Data + m_offset;
+	if (static_cast<std::uint8_t*>(p) + bytes == top)
+		m_offset -= bytes;
+}
+
+void LinearArena::Reset()
+{
+	if (m_blocks.size() > 1)
+	{
+		// Coalesce: one block sized for the whole of the previous use.
+		std::size_t needed = m_capacity;
+		FreeBlocks();
+		AddBlock(needed);
+	}
+
+	m_offset = 0;
+	m_usedBefore = 0;
+}
+
+void LinearArena::AddBlock(std::size_t minBytes)
+{
+	if (!m_blocks.empty())
+		m_usedBefore += m_offset;
+
+	Block block;
+	block.Size = minBytes > m_blockSize ? minBytes : m_blockSize;
+	block.Data = static_cast<std::uint8_t*>(MemoryTracker::Allocate(MemTag::Frame, block.Size));
+
+	m_blocks.push_back(block);
+	m_capacity += block.Size;
+	m_offset = 0;
+}
+
+void LinearArena::FreeBlocks()
+{
+	for (const Block& block : m_blocks)
+		MemoryTracker::Free(MemTag::Frame, block.Data, block.Size);
+
+	m_blocks.clear();
+	m_capacity = 0;
+}
+
+namespace
+{
+	std::atomic<std::uint32_t>				g_currentFrame { 0 };
+	// Bumped every time a frame slot is reused.
+	std::atomic<std::uint32_t>				g_frameGeneration[FrameArena::MaxFrames] = {};
+
+	struct ThreadArenas
+	{
+		LinearArena							Arenas[FrameArena::MaxFrames];
+		std::uint32_t						Generation[FrameArena::MaxFrames] = {};
+	};
+
+	ThreadArenas& GetThreadArenas()
+	{
+		thread_local ThreadArenas arenas;
+		return arenas;
+	}
+}
+
+void FrameArena::BeginFrame(std::uint32_t frameIndex)
+{
+	assert(frameIndex < MaxFrames);
+
+	g_frameGeneration[frameIndex].fetch_add(1, std::memory_order_relaxed);
+	g_currentFrame.store(frameIndex, std::memory_order_release);
+}
+
+std::uint32_t FrameArena::CurrentFrame()
+{
+	return g_currentFrame.load(std::memory_order_acquire);
+}
+
+LinearArena& FrameArena::ThreadArena()
+{
+	ThreadArenas& arenas = GetThreadArenas();
+	std::uint32_t frame = CurrentFrame();
+	std::uint32_t generation = g_frameGeneration[frame].load(std::memory_order_relaxed);
+
+	LinearArena& arena = arenas.Arenas[frame];
+	if (arenas.Generation[frame] != generation)
+	{
+		arena.Reset();
+		arenas.Generation[frame] = generation;
+	}
+
+	return arena;
+}
+
+void* FrameArena::Allocate(std::size_t bytes, std::size_t alignment)
+{
+	return ThreadArena().Allocate(bytes, alignment);
+}
+
+void FrameArena::Free(void* p, std::size_t bytes) noexcept
+{
+	// Not through ThreadArena(): resetting there can allocate a block, and
+	// this runs inside noexcept deallocate. A stale arena is reset by the
+	// next Allocate anyway, so nothing in it is worth giving back. A block
+	// from an older frame never matches the top of the current arena.
+	ThreadArenas& arenas = GetThreadArenas();
+	std::uint32_t frame = CurrentFrame();
+	if (arenas.Generation[frame] == g_frameGeneration[frame].load(std::memory_order_relaxed))
+		arenas.Arenas[frame].Free(p, bytes);
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// Bump allocator over a chain of blocks. Allocation is a pointer increment;
+// memory is only given back all at once by Reset(). After a reset with more
+// than one block, the chain is replaced by a single block large enough for
+// everything the previous use needed, so a steady workload ends up doing no
+// heap allocation at all.
+class LinearArena
+{
+public:
+
+	static const std::size_t				DefaultBlockSize = 64 * 1024;
+
+											LinearArena(std::size_t blockSize = DefaultBlockSize);
+											LinearArena(const LinearArena& rhs) = delete;
+											LinearArena& operator=(const LinearArena& rhs) = delete;
+											~LinearArena();
+
+	void*									Allocate(std::size_t bytes, std::size_t alignment);
+	// Gives the memory back if it is the most recent allocation, so scratch
+	// freed in LIFO order keeps reusing the same hot bytes. No-op otherwise.
+	void									Free(void* p, std::size_t bytes) noexcept;
+	void									Reset();
+
+	std::size_t								BytesUsed()			const	{	return m_usedBefore + m_offset;	}
+	std::size_t								Capacity()			const	{	return m_capacity;	}
+
+private:
+
+	struct Block
+	{
+		std::uint8_t*						Data;
+		std::size_t							Size;
+	};
+
+	void									AddBlock(std::size_t minBytes);
+	void									FreeBlocks();
+
+	std::vector<Block>						m_blocks;
+	std::size_t								m_blockSize;
+	std::size_t								m_offset = 0;		// into m_blocks.back()
+	std::size_t								m_usedBefore = 0;	// bytes used in the earlier blocks
+	std::size_t								m_capacity = 0;
+};
+
+// Transient memory that lives for one frame in flight.
+//
+// Every thread owns one LinearArena per frame resource. BeginFrame(i) is
+// called by the render thread once the fence of frame resource i has
+// completed; from then on every thread allocates from its arena i, and each
+// arena resets itself lazily on the first allocation after the frame moved
+// on. Memory from FrameArena must not be kept past the frame that allocated
+// it: it is overwritten gNumFrameResources frames later. Nor is it for work
+// outside a frame, such as loading: that would land in whichever arena is
+// current and grow it for good.
+class FrameArena
+{
+public:
+
+	static const std::uint32_t				MaxFrames = 4;
+
+	static void								BeginFrame(std::uint32_t frameIndex);
+	static std::uint32_t					CurrentFrame();
+
+	static void*							Allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+	// Never resets or allocates: a block freed after its frame's arena came
+	// round again is simply dropped.
+	static void								Free(void* p, std::size_t bytes) noexcept;
+
+	// Arena of the calling thread for the current frame.
+	static LinearArena&						ThreadArena();
+};
+
+// STL allocator over FrameArena. deallocate only reclaims the most recent
+// allocation; everything else comes back when the frame's arena is reset.
+template<typename T>
+class FrameArenaAllocator
+{
+public:
+
+	using value_type = T;
+
+	FrameArenaAllocator() noexcept = default;
+	template<typename U>
+	FrameArenaAllocator(const FrameArenaAllocator<U>&) noexcept {}
+
+	T* allocate(std::size_t n)
+	{
+		return static_cast<T*>(FrameArena::Allocate(n * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T* p, std::size_t n) noexcept
+	{
+		FrameArena::Free(p, n * sizeof(T));
+	}
+
+	template<typename U>
+	bool operator==(const FrameArenaAllocator<U>&) const noexcept { return true; }
+	template<typename U>
+	bool operator!=(const FrameArenaAllocator<U>&) const noexcept { return false; }
+};
+
+template<typename T>
+using FrameVector = std::vector<T, FrameArenaAllocator<T>>;
@@ -0,0 +1,82 @@
+#include "FrameLimiter.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+FrameLimiter::FrameLimiter()
+	: FrameLimiter(
+		[] { return GameTimer::QueryCounter() * GameTimer::SecondsPerCount(); },
+		[](double seconds) { std::this_thread::sleep_for(std::chrono::duration<double>(seconds)); })
+{
+}
+
+FrameLimiter::FrameLimiter(ClockFn clock, SleepFn sleep)
+	: m_clock(std::move(clock)), m_sleep(std::move(sleep))
+{
+}
+
+void FrameLimiter::SetTargetFrameRate(double framesPerSecond)
+{
+	m_period = framesPerSecond > 0.0 ? 1.0 / framesPerSecond : 0.0;
+	m_started = false;
+}
+
+void FrameLimiter::WaitForNextFrame()
+{
+	if (m_period <= 0.0)
+		return;
+
+	double now = m_clock();
+
+	// First frame, or we fell more than a whole frame behind: restart the
+	// schedule instead of running several frames back to back to catch up.
+	if (!m_started || now > m_nextFrame + m_period)
+	{
+		m_started = true;
+		m_nextFrame = now + m_period;
+		return;
+	}
+
+	double deadline = m_nextFrame;
+	m_nextFrame += m_period;
+
+	// Sleep through the bulk of the wait, leaving room for the usual
+	// oversleep, then spin to the deadline.
+	double spin = std::max(m_spinThreshold, m_sleepOvershoot);
+	double sleepTime = deadline - now - spin;
+	if (sleepTime > 0.0)
+	{
+		double before = m_clock();
+		m_sleep(sleepTime);
+		double overshoot = (m_clock() - before) - sleepTime;
+
+		// Track the overshoot quickly when it grows, slowly when it shrinks.
+		if (overshoot > m_sleepOvershoot)
+			m_sleepOvershoot = overshoot;
+		else
+			m_sleepOvershoot += (overshoot - m_sleepOvershoot) * 0.05;
+	}
+
+	double wake = m_clock();
+	while (wake < deadline)
+	{
+		std::this_thread::yield();
+		wake = m_clock();
+	}
+
+	m_wakeError.Record(wake - deadline);
+}
+
+void FrameLimiter::MarkInput()
+{
+	m_inputTime = m_clock();
+}
+
+void FrameLimiter::MarkPresent()
+{
+	if (m_inputTime < 0.0)
+		return;
+
+	m_latency.Record(m_clock() - m_inputTime);
+	m_inputTime = -1.0;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "GameTimer.h"
+#include <functional>
+
+// Caps the frame rate and measures input-to-present latency.
+//
+// WaitForNextFrame() sleeps for most of the time left until the next frame
+// boundary and spins for the rest, because OS sleeps routinely overshoot by
+// a millisecond or more. The spin window grows on its own when the sleeps
+// it observes overshoot more than expected.
+//
+// Clock and sleep are injectable so the pacing logic can be driven by a fake
+// clock; by default they use GameTimer's counter and std::this_thread.
+class FrameLimiter
+{
+public:
+
+	using ClockFn = std::function<double()>;			// seconds, monotonic
+	using SleepFn = std::function<void(double)>;		// seconds
+
+										FrameLimiter();
+										FrameLimiter(ClockFn clock, SleepFn sleep);
+
+	// 0 disables the cap.
+	void								SetTargetFrameRate(double framesPerSecond);
+	double								GetTargetFrameRate()		const	{	return m_period > 0.0 ? 1.0 / m_period : 0.0;	}
+
+	// Minimum time spun at the end of each wait.
+	void								SetSpinThreshold(double seconds)	{	m_spinThreshold = seconds;	}
+
+	// Number of frames the GPU may have queued before the CPU blocks. The
+	// renderer enforces it against its frame fences.
+	void								SetMaxQueuedFrames(std::uint32_t frames)	{	m_maxQueuedFrames = frames > 0 ? frames : 1;	}
+	std::uint32_t						GetMaxQueuedFrames()		const	{	return m_maxQueuedFrames;	}
+
+	// Blocks until the next frame boundary. If the previous frame overran
+	// the budget the schedule restarts from now instead of bursting.
+	void								WaitForNextFrame();
+
+	// Input-to-present latency: MarkInput() where input is sampled,
+	// MarkPresent() once Present has returned. Both are CPU timestamps, so
+	// this is the CPU side only: the time the GPU spends on the frame and
+	// the wait for scanout after Present are not included.
+	void								MarkInput();
+	void								MarkPresent();
+
+	// Latency samples, and how late each wait woke up relative to its deadline.
+	const FrameTimeHistogram&			Latency()					const	{	return m_latency;	}
+	const FrameTimeHistogram&			WakeError()					const	{	return m_wakeError;	}
+
+private:
+
+	ClockFn								m_clock;
+	SleepFn								m_sleep;
+
+	double								m_period = 0.0;
+	double								m_spinThreshold = 0.002;
+	double								m_sleepOvershoot = 0.0;
+	double								m_nextFrame = 0.0;
+	bool								m_started = false;
+	std::uint32_t						m_maxQueuedFrames = 2;
+
+	double								m_inputTime = -1.0;
+
+	FrameTimeHistogram					m_latency;
+	FrameTimeHistogram					m_wakeError;
+};
@@ -0,0 +1,21 @@
+#include "FrameResource.h"
+#include "IndirectDraw.h"
+#include "ShaderStructures.h"
+
+FrameResource::FrameResource(RenderDevice& device, std::uint32_t maxObjects)
+{
+	CommandList = device.CreateCommandList();
+
+	PassCB = device.CreateBuffer(ConstantBufferByteSize(sizeof(PassConstants)), GpuBufferUsage::Upload);
+	ObjectCB = device.CreateBuffer((std::uint64_t)ConstantBufferByteSize(sizeof(ObjectConstants)) * (maxObjects > 0 ? maxObjects : 1),
+		GpuBufferUsage::Upload);
+
+	// Upload heap buffers are in GENERIC_READ, which includes INDIRECT_ARGUMENT,
+	// so the CPU-built arguments can be consumed directly.
+	IndirectCommands = device.CreateBuffer((std::uint64_t)sizeof(IndirectCommand) * (maxObjects > 0 ? maxObjects : 1), GpuBufferUsage::Upload);
+	IndirectCount = device.CreateBuffer(sizeof(std::uint32_t), GpuBufferUsage::Upload);
+}
+
+FrameResource::~FrameResource()
+{
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "RenderBackend.h"
+
+// Number of frames the CPU may record ahead of the GPU. Every per-frame
+// resource (command lists, upload buffers, dirty counters) is sized from this.
+const int gNumFrameResources = 3;
+
+// Everything the CPU writes while recording one frame. The renderer keeps
+// gNumFrameResources of these and cycles through them, so the CPU can record
+// frame N while the GPU is still consuming frames N-1 and N-2.
+struct FrameResource
+{
+public:
+
+	FrameResource(RenderDevice& device, std::uint32_t maxObjects);
+	FrameResource(const FrameResource& rhs) = delete;
+	FrameResource& operator=(const FrameResource& rhs) = delete;
+	~FrameResource();
+
+	// Can only be reset once the GPU is done with this frame.
+	std::unique_ptr<GpuCommandList>						CommandList;
+
+	std::unique_ptr<GpuBuffer>							PassCB;
+	// One 256-byte element per render item, indexed by RenderItem::ObjCBIndex.
+	std::unique_ptr<GpuBuffer>							ObjectCB;
+
+	// IndirectCommand array, and the command count ExecuteIndirect reads.
+	std::unique_ptr<GpuBuffer>							IndirectCommands;
+	std::unique_ptr<GpuBuffer>							IndirectCount;
+
+	// Fence value marking commands up to this frame. The GPU is done with the
+	// resources above once the fence has reached it.
+	std::uint64_t										Fence = 0;
+};
@@ -1,9 +1,16 @@
 #include "GameObject.h"
-using namespace DX;
+#include "Profiler.h"
+#include "FrameArena.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
 
 
 
-GameObject::GameObject()
+GameObject::GameObject(UINT maxRenderItems)
+	: m_renderItems(maxRenderItems)
 {
 }
 
@@ -11,8 +18,10 @@ GameObject::~GameObject()
 {
 }
 
-void GameObject::Init(ComPtr<ID3D12GraphicsCommandList> cmdList, ComPtr<ID3D12Device> device) 
+void GameObject::Init(RenderDevice& device, GpuCommandList& commandList)
 {
+	PROFILE_FUNCTION();
+
 	CreateGeometry geoGen;
 
 	CreateGeometry::MeshData box = geoGen.CreateBox(1.5f, 1.5f, 1.5f, 3);
@@ -34,8 +43,16 @@ void GameObject::Init(ComPtr<ID3D12GraphicsCommandList> cmdList, ComPtr<ID3D12De
 	sphereSubmesh.StartIndexLocation = sphereIndexOffset;
 	sphereSubmesh.BaseVertexLocation = sphereVertexOffset;
 
+	BoundingBox::CreateFromPoints(boxSubmesh.Bounds, box.Vertices.size(),
+		&box.Vertices[0].Position, sizeof(CreateGeometry::Vertex));
+	BoundingBox::CreateFromPoints(sphereSubmesh.Bounds, sphere.Vertices.size(),
+		&sphere.Vertices[0].Position, sizeof(CreateGeometry::Vertex));
+
 	auto totalVertexCount = box.Vertices.size() + sphere.Vertices.size();
-	std::vector<Vertex> vertices(totalVertexCount);
+	// Staging copies: they only live until the upload below is recorded.
+	// Init runs at load time, outside any frame, so they come from the heap
+	// rather than FrameArena.
+	TrackedVector<Vertex, MemTag::Geometry> vertices(totalVertexCount);
 	UINT k = 0;
 	for (size_t i = 0; i < box.Vertices.size(); ++i, ++k)
 	{
@@ -48,7 +65,8 @@ void GameObject::Init(ComPtr<ID3D12GraphicsCommandList> cmdList, ComPtr<ID3D12De
 		vertices[k].Color = XMFLOAT4(DirectX::Colors::Crimson);
 	}
 
-	std::vector<std::uint16_t> indices;
+	TrackedVector<std::uint16_t, MemTag::Geometry> indices;
+	indices.reserve(box.Indices32.size() + sphere.Indices32.size());
 
 	indices.insert(indices.end(),
 		std::begin(box.GetIndices16()),
@@ -64,75 +82,338 @@ void GameObject::Init(ComPtr<ID3D12GraphicsCommandList> cmdList, ComPtr<ID3D12De
 	auto geo = std::make_unique<MeshGeometry>();
 
 	geo->Name = "shapeGeo";
-	ThrowIfFailed(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
-	CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), vertices.data(),
-		vbByteSize);
-	ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
-	CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), indices.data(),
-		ibByteSize);
-	geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(device.Get(),
-		cmdList.Get(), vertices.data(), vbByteSize, geo->VertexBufferUploader);
-	geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(device.Get(),
-		cmdList.Get(), indices.data(), ibByteSize, geo->IndexBufferUploader);
+	geo->VertexBufferCPU.resize(vbByteSize);
+	std::memcpy(geo->VertexBufferCPU.data(), vertices.data(), vbByteSize);
+	geo->IndexBufferCPU.resize(ibByteSize);
+	std::memcpy(geo->IndexBufferCPU.data(), indices.data(), ibByteSize);
+	geo->VertexBufferGPU = CreateDefaultBuffer(device, commandList,
+		vertices.data(), vbByteSize, geo->VertexBufferUploader);
+	geo->IndexBufferGPU = CreateDefaultBuffer(device, commandList,
+		indices.data(), ibByteSize, geo->IndexBufferUploader);
 	geo->VertexByteStride = sizeof(Vertex);
 	geo->VertexBufferByteSize = vbByteSize;
-	geo->IndexFormat = DXGI_FORMAT_R16_UINT;
+	geo->IndexFormat = IndexFormat::UInt16;
 	geo->IndexBufferByteSize = ibByteSize;
 	geo->DrawArgs["box"] = boxSubmesh;
 	geo->DrawArgs["sphere"] = sphereSubmesh;
 	m_geometries[geo->Name] = std::move(geo);
 }
 
-void GameObject::BuildRenderOpBox(ComPtr<ID3D12Device> device) 
+void GameObject::DisposeUploaders()
 {
-	auto boxRitem = std::make_unique<RenderItem>();
-	XMStoreFloat4x4(&boxRitem->World, XMMatrixScaling(1.0f, 1.0f, 1.0f) * XMMatrixTranslation(0.0f, 0.5f, 0.0f));
-	boxRitem->ObjCBIndex = ObjIndex;
-	boxRitem->Geo = m_geometries["shapeGeo"].get();
-	boxRitem->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-	boxRitem->IndexCount = boxRitem->Geo->DrawArgs["box"].IndexCount;
-	boxRitem->StartIndexLocation = boxRitem->Geo->DrawArgs["box"].StartIndexLocation;
-	boxRitem->BaseVertexLocation = boxRitem->Geo->DrawArgs["box"].BaseVertexLocation;
+	m_geometries.ForEach([](StringId, std::unique_ptr<MeshGeometry>& geo)
+	{
+		geo->DisposeUploaders();
+	});
+}
+
+static const StringId s_shapeGeo("shapeGeo");
+static const StringId s_box("box");
+static const StringId s_sphere("sphere");
+
+void GameObject::BuildRenderOpBox() 
+{
+	Spawn(s_shapeGeo, s_box,
+		Transform(XMFLOAT3(0.0f, 0.5f, 0.0f), XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f), 1.0f));
+}
+
+void GameObject::BuildRenderOpCircle() 
+{
+	Spawn(s_shapeGeo, s_sphere,
+		Transform(XMFLOAT3(1.0f, 1.0f, -1.0f), XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f), 1.0f));
+}
 
-	BuildObjectConstantBuffers(device, &boxRitem);
+Entity GameObject::Spawn(const std::string& geoName, const std::string& drawArg, const Transform& local)
+{
+	// Find, not intern: a name no geometry uses must not stay in the table.
+	StringId geoId = StringId::Find(geoName);
+	StringId drawArgId = StringId::Find(drawArg);
+	if (!geoId.IsValid() || !drawArgId.IsValid())
+		return Entity();
 
-	m_allRitems.push_back(std::move(boxRitem));
-	m_opaqueRitems.push_back(m_allRitems[ObjIndex].get());
-	ObjIndex++;
+	return Spawn(geoId, drawArgId, local);
 }
 
-void GameObject::BuildRenderOpCircle(ComPtr<ID3D12Device> device) 
+Entity GameObject::Spawn(StringId geoName, StringId drawArg, const Transform& local)
 {
-	auto leftSphereRitem = std::make_unique<RenderItem>();
-	XMMATRIX leftSphereWorld = XMMatrixTranslation(1.0f, 1.0f, -1.0f);
-	XMStoreFloat4x4(&leftSphereRitem->World, leftSphereWorld);
-	leftSphereRitem->ObjCBIndex = ObjIndex;
-	leftSphereRitem->Geo = m_geometries["shapeGeo"].get();
-	leftSphereRitem->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-	leftSphereRitem->IndexCount = leftSphereRitem->Geo->DrawArgs["sphere"].IndexCount;
-	leftSphereRitem->StartIndexLocation = leftSphereRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
-	leftSphereRitem->BaseVertexLocation = leftSphereRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+	auto* geoEntry = m_geometries.Find(geoName);
+	if (geoEntry == nullptr)
+		return Entity();
+	MeshGeometry* geo = geoEntry->get();
+
+	const SubmeshGeometry* submeshEntry = geo->DrawArgs.Find(drawArg);
+	if (submeshEntry == nullptr)
+		return Entity();
+	const SubmeshGeometry& submesh = *submeshEntry;
+
+	RenderItemHandle handle = m_renderItems.Create();
+	if (!handle.IsValid())
+		return Entity();
+
+	MeshRef mesh;
+	mesh.Geo = geo;
+	mesh.PrimitiveType = PrimitiveTopology::TriangleList;
+	mesh.IndexCount = submesh.IndexCount;
+	mesh.StartIndexLocation = submesh.StartIndexLocation;
+	mesh.BaseVertexLocation = submesh.BaseVertexLocation;
+
+	Bounds bounds;
+	bounds.Local = submesh.Bounds;
+	bounds.World = submesh.Bounds;
+
+	RenderLink link;
+	link.Item = handle;
+	link.Node = m_transforms.AddNode(TransformHierarchy::InvalidNode, local);
 
-	BuildObjectConstantBuffers(device, &leftSphereRitem);
+	RenderItem* ri = m_renderItems.Get(handle);
+	ri->TransformNode = link.Node;
+	ri->ObjCBIndex = handle.Index;
+	ri->Geo = mesh.Geo;
+	ri->PrimitiveType = mesh.PrimitiveType;
+	ri->IndexCount = mesh.IndexCount;
+	ri->StartIndexLocation = mesh.StartIndexLocation;
+	ri->BaseVertexLocation = mesh.BaseVertexLocation;
 
-	m_allRitems.push_back(std::move(leftSphereRitem));
-	m_opaqueRitems.push_back(m_allRitems[ObjIndex].get());
-	ObjIndex++;
+	return m_entities.Create(mesh, bounds, Visibility(), link);
 }
 
-const std::vector<RenderItem*>& GameObject::GetOpaqueItems()
+bool GameObject::Despawn(Entity entity)
 {
-	return m_opaqueRitems;
+	const RenderLink* link = m_entities.Get<RenderLink>(entity);
+	if (link == nullptr)
+		return false;
+
+	m_transforms.RemoveNode(link->Node);
+	m_renderItems.Destroy(link->Item);
+	m_entities.Destroy(entity);
+	return true;
 }
 
-std::vector<std::unique_ptr<RenderItem>>& GameObject::GetAllItems()
+RenderItem* GameObject::GetRenderItem(Entity entity)
 {
-	return m_allRitems;
+	const RenderLink* link = m_entities.Get<RenderLink>(entity);
+	return link ? m_renderItems.Get(link->Item) : nullptr;
 }
 
-void GameObject::BuildObjectConstantBuffers(ComPtr<ID3D12Device> device, std::unique_ptr<RenderItem>* object)
+const Transform* GameObject::GetTransform(Entity entity) const
 {
-	object->get()->GetObjectCB() = std::make_unique<UploadBuffer<ObjectConstants>>(device.Get(), 1, true);
+	const RenderLink* link = m_entities.Get<RenderLink>(entity);
+	return link ? &m_transforms.GetLocal(link->Node) : nullptr;
+}
+
+void GameObject::Update(const Camera& camera)
+{
+	PROFILE_FUNCTION();
+
+	m_transforms.Update();
+
+	// Transform system: items whose world transform moved need new
+	// constants, and their world bounds follow.
+	m_entities.ParallelForEach<const RenderLink, Bounds>([this](Entity, const RenderLink& link, Bounds& bounds)
+	{
+		if (!m_transforms.WasUpdated(link.Node))
+			return;
+
+		m_renderItems.Get(link.Item)->MarkDirty();
+		XMFLOAT4X4 world = m_transforms.GetWorldMatrix(link.Node);
+		bounds.Local.Transform(bounds.World, XMLoadFloat4x4(&world));
+	});
+
+	if (m_occlusionCulling)
+		CullOccluded(camera);
+
+	// Visibility system.
+	m_entities.ParallelForEach<const Visibility, const RenderLink>([this](Entity, const Visibility& visibility, const RenderLink& link)
+	{
+		m_renderItems.Get(link.Item)->Visible = visibility.Visible;
+	});
 }
 
+// Below this screen-size score an item hides too little to be worth rasterizing.
+static const float s_minOccluderScore = 0.002f;
+
+void GameObject::CullOccluded(const Camera& camera)
+{
+	PROFILE_FUNCTION();
+
+	double start = GameTimer::QueryCounter() * GameTimer::SecondsPerCount();
+
+	// Occluders are the items that look largest from the camera.
+	struct Candidate
+	{
+		float														Score;
+		const RenderLink*											Link;
+		const MeshRef*												Mesh;
+	};
+
+	FrameVector<Candidate> candidates;
+	XMFLOAT3 eye = camera.GetPosition();
+	m_entities.ForEach<const RenderLink, const MeshRef, const Bounds>(
+		[&candidates, &eye](Entity, const RenderLink& link, const MeshRef& mesh, const Bounds& bounds)
+	{
+		float score = OccluderScore(&bounds.World.Center.x, &bounds.World.Extents.x, &eye.x);
+		if (score >= s_minOccluderScore)
+			candidates.push_back(Candidate{ score, &link, &mesh });
+	});
+
+	size_t occluderCount = MathHelper::Min<size_t>(candidates.size(), m_maxOccluders);
+	std::partial_sort(candidates.begin(), candidates.begin() + occluderCount, candidates.end(),
+		[](const Candidate& a, const Candidate& b) { return a.Score > b.Score; });
+
+	XMFLOAT4X4 viewProj;
+	XMStoreFloat4x4(&viewProj, XMMatrixMultiply(camera.GetView(), camera.GetProj()));
+	m_occlusion.BeginFrame(&viewProj._11);
+	for (size_t i = 0; i < occluderCount; ++i)
+	{
+		const MeshRef& mesh = *candidates[i].Mesh;
+		const MeshGeometry* geo = mesh.Geo;
+		assert(geo->IndexFormat == IndexFormat::UInt16 && mesh.PrimitiveType == PrimitiveTopology::TriangleList);
+
+		const std::uint16_t* indices = reinterpret_cast<const std::uint16_t*>(geo->IndexBufferCPU.data());
+		XMFLOAT4X4 world = m_transforms.GetWorldMatrix(candidates[i].Link->Node);
+		m_occlusion.AddOccluder(&world._11,
+			geo->VertexBufferCPU.data(), geo->VertexByteStride,
+			indices + mesh.StartIndexLocation, mesh.IndexCount, mesh.BaseVertexLocation);
+	}
+	m_occlusion.Rasterize();
+
+	const OcclusionBuffer& occlusion = m_occlusion;
+	std::atomic<UINT> occluded = 0;
+	m_entities.ParallelForEach<const Bounds, Visibility>([&occlusion, &occluded](Entity, const Bounds& bounds, Visibility& visibility)
+	{
+		visibility.Visible = occlusion.IsVisible(&bounds.World.Center.x, &bounds.World.Extents.x);
+		if (!visibility.Visible)
+			occluded.fetch_add(1, std::memory_order_relaxed);
+	});
+
+	m_occludedCount = occluded.load();
+	PROFILE_COUNTER("Occluded", m_occludedCount);
+	m_occlusionTimes.Record(GameTimer::QueryCounter() * GameTimer::SecondsPerCount() - start);
+}
+
+void GameObject::SetOcclusionCulling(bool enabled)
+{
+	m_occlusionCulling = enabled;
+	if (enabled)
+		return;
+
+	m_entities.ForEach<Visibility>([](Entity, Visibility& visibility)
+	{
+		visibility.Visible = true;
+	});
+	m_occludedCount = 0;
+}
+
+void GameObject::SetTransform(Entity entity, const Transform& local)
+{
+	const RenderLink* link = m_entities.Get<RenderLink>(entity);
+	assert(link != nullptr);
+
+	m_transforms.SetLocal(link->Node, local);
+}
+
+void GameObject::FixedUpdate(float stepSeconds)
+{
+	PROFILE_FUNCTION();
+
+	for (SpinState& spin : m_simulatedSpins)
+	{
+		spin.PreviousAngle = spin.Angle;
+		spin.Angle += spin.RadiansPerSecond * stepSeconds;
+		if (spin.Angle >= XM_2PI)
+		{
+			spin.Angle -= XM_2PI;
+			spin.PreviousAngle -= XM_2PI;
+		}
+		else if (spin.Angle < 0.0f)
+		{
+			spin.Angle += XM_2PI;
+			spin.PreviousAngle += XM_2PI;
+		}
+	}
+}
+
+void GameObject::PublishSimulation()
+{
+	PROFILE_FUNCTION();
+
+	m_simulatedSpins.erase(std::remove_if(m_simulatedSpins.begin(), m_simulatedSpins.end(),
+		[this](const SpinState& spin) { return !m_entities.IsAlive(spin.Target); }), m_simulatedSpins.end());
+
+	if (!m_pendingSpins.empty())
+	{
+		std::unordered_map<std::uint32_t, size_t> indices;
+		for (size_t i = 0; i < m_simulatedSpins.size(); ++i)
+			indices.emplace(m_simulatedSpins[i].Target.Index, i);
+
+		for (const auto& [entity, radiansPerSecond] : m_pendingSpins)
+		{
+			if (!m_entities.IsAlive(entity))
+				continue;
+
+			auto [it, added] = indices.emplace(entity.Index, m_simulatedSpins.size());
+			if (added)
+			{
+				// The yaw turns on top of whatever rotation the entity has now.
+				SpinState spin;
+				spin.Target = entity;
+				spin.BaseRotation = m_transforms.GetLocal(m_entities.Get<RenderLink>(entity)->Node).Rotation;
+				m_simulatedSpins.push_back(spin);
+			}
+			m_simulatedSpins[it->second].RadiansPerSecond = radiansPerSecond;
+		}
+		m_pendingSpins.clear();
+	}
+
+	// Entries keep their order, so the yaw the render side last wrote carries
+	// over for every entity still at the same index. Copied in place: once
+	// the spin set stops changing, publishing does not allocate.
+	m_publishedSpins.resize(m_simulatedSpins.size());
+	for (size_t i = 0; i < m_simulatedSpins.size(); ++i)
+	{
+		SpinState& published = m_publishedSpins[i];
+		float appliedAngle = published.Target == m_simulatedSpins[i].Target ? published.AppliedAngle : std::numeric_limits<float>::quiet_NaN();
+		published = m_simulatedSpins[i];
+		published.AppliedAngle = appliedAngle;
+	}
+}
+
+void GameObject::Interpolate(float alpha)
+{
+	PROFILE_FUNCTION();
+
+	// Serial: SetLocal marks the hierarchy dirty, which is not thread-safe.
+	for (SpinState& spin : m_publishedSpins)
+	{
+		float angle = spin.PreviousAngle + (spin.Angle - spin.PreviousAngle) * alpha;
+		if (angle == spin.AppliedAngle)
+			continue;
+
+		const RenderLink* link = m_entities.Get<RenderLink>(spin.Target);
+		if (link == nullptr)
+			continue;
+
+		spin.AppliedAngle = angle;
+		Transform local = m_transforms.GetLocal(link->Node);
+		XMVECTOR yaw = XMQuaternionRotationAxis(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), angle);
+		XMStoreFloat4(&local.Rotation, XMQuaternionMultiply(yaw, XMLoadFloat4(&spin.BaseRotation)));
+		m_transforms.SetLocal(link->Node, local);
+	}
+}
+
+void GameObject::SetSpin(Entity entity, float radiansPerSecond)
+{
+	assert(m_entities.IsAlive(entity));
+
+	m_pendingSpins.emplace_back(entity, radiansPerSecond);
+}
+
+bool GameObject::Attach(Entity child, Entity parent)
+{
+	const RenderLink* childLink = m_entities.Get<RenderLink>(child);
+	const RenderLink* parentLink = m_entities.Get<RenderLink>(parent);
+	assert(childLink != nullptr);
+
+	return m_transforms.SetParent(childLink->Node, parentLink ? parentLink->Node : TransformHierarchy::InvalidNode);
+}
 
@@ -1,65 +1,185 @@
 #pragma once
 #include "MathHelper.h"
-#include "UploadBuffer.h"
 #include "CreateGeometry.h"
-#include "d3dUtil.h"
+#include "RenderBackend.h"
+#include "MeshGeometry.h"
+#include "FrameResource.h"
 #include "ShaderStructures.h"
-
-using Microsoft::WRL::ComPtr;
-
-struct ObjectConstants
-{
-	XMFLOAT4X4 WorldViewProj = MathHelper::Identity4x4();
-};
+#include "TransformHierarchy.h"
+#include "MemoryTracker.h"
+#include "ObjectPool.h"
+#include "EntityWorld.h"
+#include "Components.h"
+#include "OcclusionBuffer.h"
+#include "Camera.h"
+#include "GameTimer.h"
+#include <limits>
+#include <span>
 
 struct RenderItem {
 	RenderItem() = default;
-	XMFLOAT4X4 World = MathHelper::Identity4x4();
 
+	// Number of frame resources whose object constants are still stale. Every
+	// frame resource holds its own copy, so a change must be uploaded
+	// gNumFrameResources times before the item can be skipped again.
+	int NumFramesDirty = gNumFrameResources;
+
+	// Element of the per-frame object constant buffer. This is the item's
+	// pool slot, so it stays unique among live items and is reused once the
+	// item is despawned.
 	UINT ObjCBIndex = -1;
 
+	// Node in GameObject's transform hierarchy, which holds the item's local
+	// Transform and its world transform.
+	TransformHierarchy::NodeId TransformNode = TransformHierarchy::InvalidNode;
+
 	MeshGeometry* Geo = nullptr;
 
 	// Primitive topology.
-	D3D12_PRIMITIVE_TOPOLOGY PrimitiveType = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-	std::unique_ptr<UploadBuffer<ObjectConstants>> m_objectCB = nullptr;
+	PrimitiveTopology PrimitiveType = PrimitiveTopology::TriangleList;
 	// DrawIndexedInstanced parameters.
 	UINT IndexCount = 0;
 	UINT StartIndexLocation = 0;
 	int BaseVertexLocation = 0;
 
-	std::unique_ptr<UploadBuffer<ObjectConstants>>& GetObjectCB() 
+	// Cleared by culling; invisible items are dropped from the draw lists.
+	bool Visible = true;
+
+	void MarkDirty()
 	{
-		return m_objectCB;
+		NumFramesDirty = gNumFrameResources;
+	}
+
+	// Address of this item's constants in a frame resource's object buffer.
+	GpuAddress ObjectCBAddress(GpuAddress objectCBBase) const
+	{
+		UINT objCBByteSize = ConstantBufferByteSize(sizeof(ObjectConstants));
+		return objectCBBase + (UINT64)ObjCBIndex * objCBByteSize;
 	}
 
 };
 
 
+using RenderItemPool = ObjectPool<RenderItem, MemTag::RenderItems>;
+using RenderItemSpan = std::span<RenderItem>;
+using RenderItemHandle = PoolHandle;
+
 class GameObject {
 public:
-	GameObject();
+	static const UINT												DefaultMaxRenderItems = 4096;
+
+	GameObject(UINT maxRenderItems = DefaultMaxRenderItems);
 	~GameObject();
 
-	void															Init(ComPtr<ID3D12GraphicsCommandList> cmdList, ComPtr<ID3D12Device> device);
-	void															BuildRenderOpBox(ComPtr<ID3D12Device> device);
-	void															BuildRenderOpCircle(ComPtr<ID3D12Device> device);
-	
-	const std::vector<RenderItem*>&									GetOpaqueItems();
-	std::vector<std::unique_ptr<RenderItem>>&						GetAllItems();
+	// Records the geometry upload on `commandList`; the uploaders can be
+	// disposed of with DisposeUploaders once it has executed.
+	void															Init(RenderDevice& device, GpuCommandList& commandList);
+	void															DisposeUploaders();
+	// Scene presets, kept for the existing callers; both are a single Spawn.
+	void															BuildRenderOpBox();
+	void															BuildRenderOpCircle();
+
+	// Creates an entity drawing submesh `drawArg` of geometry `geoName`, with
+	// MeshRef, Bounds, Visibility and RenderLink components. Its local
+	// transform is only held by the hierarchy node RenderLink::Node.
+	// Returns an invalid entity if the geometry (built by Init) or its
+	// submesh is unknown, or once GetMaxRenderItems() items are alive.
+	Entity															Spawn(StringId geoName, StringId drawArg, const Transform& local);
+	// Slow path: looks both names up on every call, without interning them.
+	Entity															Spawn(const std::string& geoName, const std::string& drawArg, const Transform& local);
+	// Children of the entity are detached and become roots. Returns false if
+	// the entity was already gone.
+	bool															Despawn(Entity entity);
+	// nullptr once the entity has been despawned. Despawning another entity
+	// may move the item, so do not keep the pointer.
+	RenderItem*														GetRenderItem(Entity entity);
+	UINT															GetMaxRenderItems()	const	{	return m_renderItems.Capacity();	}
+
+	// Per-frame systems: propagates the transform hierarchy, marks dirty every
+	// item whose world transform changed, refreshes world bounds, culls items
+	// hidden behind the largest ones from `camera` and copies Visibility to
+	// the render items.
+	void															Update(const Camera& camera);
+	void															SetTransform(Entity entity, const Transform& local);
+	// nullptr once the entity has been despawned.
+	const Transform*												GetTransform(Entity entity)	const;
+
+	// Fixed-step simulation, see FixedStepLoop. FixedUpdate only touches the
+	// simulation's own copy of the state, so it may run on another thread
+	// while the caller renders; PublishSimulation and Interpolate must not
+	// overlap it.
+	//
+	// Turns every spinning entity by one step.
+	void															FixedUpdate(float stepSeconds);
+	// Makes the last steps' state the one Interpolate reads, and hands
+	// SetSpin changes and despawns to the simulation.
+	void															PublishSimulation();
+	// Poses spinning entities between the published previous and current
+	// steps; `alpha` is FixedStepScheduler::Alpha().
+	void															Interpolate(float alpha);
+	// Turns the entity about its local Y axis from the next published step
+	// on, on top of the rotation it has when its spin starts. Zero stops it;
+	// its current yaw is kept.
+	void															SetSpin(Entity entity, float radiansPerSecond);
+	// Composed from the item's world transform on every call.
+	XMFLOAT4X4														GetWorld(const RenderItem& item)	const	{	return m_transforms.GetWorldMatrix(item.TransformNode);	}
+	// Parents `child` to `parent` (an invalid entity detaches); the child keeps its local transform.
+	// Returns false if `parent` is `child` or one of its descendants.
+	bool															Attach(Entity child, Entity parent);
+	TransformHierarchy&												GetTransforms()		{	return m_transforms;	}
+	EntityWorld&													GetEntities()		{	return m_entities;	}
 	
-	void															BuildObjectConstantBuffers(ComPtr<ID3D12Device> device, std::unique_ptr<RenderItem>* object);
+	// Live items, densely packed. Despawning swaps the last item into the
+	// hole, so the order is not stable. Everything is drawn opaque.
+	RenderItemSpan													GetRenderItems()			{	return m_renderItems.Items();	}
+
+	// Disabling makes every entity visible again.
+	void															SetOcclusionCulling(bool enabled);
+	bool															GetOcclusionCulling()	const	{	return m_occlusionCulling;	}
+	void															SetMaxOccluders(UINT maxOccluders)	{	m_maxOccluders = maxOccluders;	}
+	const OcclusionStats&											GetOcclusionStats()		const	{	return m_occlusion.GetStats();	}
+	const OcclusionBuffer&											GetOcclusionBuffer()	const	{	return m_occlusion;	}
+	// Entities hidden by the last occlusion pass.
+	UINT															GetOccludedCount()		const	{	return m_occludedCount;	}
+	// CPU time of the occlusion pass, from picking occluders to the last test.
+	FrameTimeHistogram&												OcclusionTimes()			{	return m_occlusionTimes;	}
 
 private:
-	std::unordered_map<std::string, std::unique_ptr<MeshGeometry>>	m_geometries;
-	UINT															ObjIndex = 0;
+	void															CullOccluded(const Camera& camera);
+
+	// Yaw of a spinning entity over the last two steps, on top of the
+	// rotation it had when the spin was added. Angle stays in [0, 2pi); a
+	// wrap in either direction moves PreviousAngle with it, so the two stay
+	// within one step of each other and lerping never crosses the wrap.
+	struct SpinState
+	{
+		Entity														Target;
+		float														RadiansPerSecond = 0.0f;
+		float														PreviousAngle = 0.0f;
+		float														Angle = 0.0f;
+		XMFLOAT4													BaseRotation = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
+		// Render side only: the yaw Interpolate last wrote, NaN for none.
+		float														AppliedAngle = std::numeric_limits<float>::quiet_NaN();
+	};
+
+	StringIdMap<std::unique_ptr<MeshGeometry>>						m_geometries;
 
 	//Stock RenderItem
-	std::vector<std::unique_ptr<RenderItem>>						m_allRitems;
+	RenderItemPool													m_renderItems;
+
+	TransformHierarchy												m_transforms;
+	EntityWorld														m_entities;
+
+	OcclusionBuffer													m_occlusion;
+	bool															m_occlusionCulling = true;
+	UINT															m_maxOccluders = 16;
+	UINT															m_occludedCount = 0;
+	FrameTimeHistogram												m_occlusionTimes;
 
-	std::vector<RenderItem*>										m_opaqueRitems;
-	std::vector<RenderItem*>										m_transparentRitems;
-	UINT															m_passCbvOffset = 0;
-	std::unique_ptr<MeshGeometry>									m_boxGeo = nullptr;
+	// Double buffer: FixedUpdate writes m_simulatedSpins, Interpolate reads
+	// m_publishedSpins, and PublishSimulation copies one to the other.
+	std::vector<SpinState>											m_simulatedSpins;
+	std::vector<SpinState>											m_publishedSpins;
+	std::vector<std::pair<Entity, float>>							m_pendingSpins;
 
 };
\ No newline at end of file
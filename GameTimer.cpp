@@ -2,16 +2,168 @@
 // GameTimer.cpp by Frank Luna (C) 2011 All Rights Reserved.
 //***************************************************************************************
 
-#include <windows.h>
 #include "GameTimer.h"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <time.h>
+#endif
+
+#if defined(GAMETIMER_USE_TSC)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#include <thread>
+#endif
+
+namespace
+{
+	// The platform counter, before any TSC override.
+	std::int64_t QueryPlatformCounter()
+	{
+#if defined(_WIN32)
+		LARGE_INTEGER count;
+		QueryPerformanceCounter(&count);
+		return count.QuadPart;
+#elif defined(__linux__)
+		timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (std::int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+		return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+	}
+
+	double QueryPlatformSecondsPerCount()
+	{
+#if defined(_WIN32)
+		LARGE_INTEGER countsPerSec;
+		QueryPerformanceFrequency(&countsPerSec);
+		return 1.0 / (double)countsPerSec.QuadPart;
+#elif defined(__linux__)
+		return 1e-9;
+#else
+		return (double)std::chrono::steady_clock::period::num / std::chrono::steady_clock::period::den;
+#endif
+	}
+
+#if defined(GAMETIMER_USE_TSC)
+	// Measures the TSC rate against the platform counter over a short window.
+	double CalibrateTsc()
+	{
+		std::int64_t counter0 = QueryPlatformCounter();
+		std::uint64_t tsc0 = __rdtsc();
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		std::int64_t counter1 = QueryPlatformCounter();
+		std::uint64_t tsc1 = __rdtsc();
+
+		double seconds = (counter1 - counter0) * QueryPlatformSecondsPerCount();
+		return seconds / (double)(tsc1 - tsc0);
+	}
+#endif
+}
+
+std::int64_t GameTimer::QueryCounter()
+{
+#if defined(GAMETIMER_USE_TSC)
+	return (std::int64_t)__rdtsc();
+#else
+	return QueryPlatformCounter();
+#endif
+}
+
+double GameTimer::SecondsPerCount()
+{
+#if defined(GAMETIMER_USE_TSC)
+	static const double secondsPerTick = CalibrateTsc();
+	return secondsPerTick;
+#else
+	static const double secondsPerCount = QueryPlatformSecondsPerCount();
+	return secondsPerCount;
+#endif
+}
+
+FrameTimeHistogram::FrameTimeHistogram()
+{
+	Clear();
+}
+
+void FrameTimeHistogram::Record(double seconds)
+{
+	double micro = seconds * 1e6;
+	std::uint32_t value = micro >= 4294967295.0 ? 0xffffffffu : (std::uint32_t)micro;
+
+	// Single writer: publish the sample before bumping the count so readers
+	// never look at a slot that has not been written yet.
+	std::uint64_t count = mCount.load(std::memory_order_relaxed);
+	mSamples[count % Capacity].store(value, std::memory_order_relaxed);
+	mCount.store(count + 1, std::memory_order_release);
+}
+
+void FrameTimeHistogram::Clear()
+{
+	for (auto& sample : mSamples)
+		sample.store(0, std::memory_order_relaxed);
+	mCount.store(0, std::memory_order_release);
+}
+
+FrameTimeStats FrameTimeHistogram::Compute(float hitchFactor)const
+{
+	FrameTimeStats stats;
+
+	std::uint64_t count = mCount.load(std::memory_order_acquire);
+	std::uint32_t n = (std::uint32_t)std::min<std::uint64_t>(count, Capacity);
+	if (n == 0)
+		return stats;
+
+	std::array<std::uint32_t, Capacity> sorted;
+	for (std::uint32_t i = 0; i < n; ++i)
+		sorted[i] = mSamples[i].load(std::memory_order_relaxed);
+	std::sort(sorted.begin(), sorted.begin() + n);
+
+	// Nearest-rank percentile, ceil(percent * n / 100) in integers: in float
+	// the rounding pushes exact ranks one sample up.
+	auto percentile = [&](std::uint32_t percent)
+	{
+		std::uint32_t rank = (percent * n + 99) / 100;
+		rank = std::clamp<std::uint32_t>(rank, 1, n);
+		return sorted[rank - 1] * 1e-3f;
+	};
+
+	stats.P50 = percentile(50);
+	stats.P95 = percentile(95);
+	stats.P99 = percentile(99);
+	stats.Max = sorted[n - 1] * 1e-3f;
+	stats.SampleCount = n;
+
+	float hitchThreshold = stats.P50 * hitchFactor;
+	for (std::uint32_t i = 0; i < n; ++i)
+	{
+		if (sorted[i] * 1e-3f > hitchThreshold)
+		{
+			stats.HitchCount = n - i;
+			break;
+		}
+	}
+
+	return stats;
+}
+
 GameTimer::GameTimer()
 	: mSecondsPerCount(0.0), mDeltaTime(-1.0), mBaseTime(0),
-	mPausedTime(0), mPrevTime(0), mCurrTime(0), mStopped(false)
+	mPausedTime(0), mStopTime(0), mPrevTime(0), mCurrTime(0), mStopped(false)
 {
-	__int64 countsPerSec;
-	QueryPerformanceFrequency((LARGE_INTEGER*)&countsPerSec);
-	mSecondsPerCount = 1.0 / (double)countsPerSec;
+	mSecondsPerCount = SecondsPerCount();
 }
 
 // Returns the total time elapsed since Reset() was called, NOT counting any
@@ -55,19 +207,21 @@ float GameTimer::DeltaTime()const
 
 void GameTimer::Reset()
 {
-	__int64 currTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
+	std::int64_t currTime = QueryCounter();
 
 	mBaseTime = currTime;
 	mPrevTime = currTime;
+	mCurrTime = currTime;
+	mPausedTime = 0;
 	mStopTime = 0;
 	mStopped = false;
+
+	mFrameTimes.Clear();
 }
 
 void GameTimer::Start()
 {
-	__int64 startTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&startTime);
+	std::int64_t startTime = QueryCounter();
 
 
 	// Accumulate the time elapsed between stop and start pairs.
@@ -90,8 +244,7 @@ void GameTimer::Stop()
 {
 	if (!mStopped)
 	{
-		__int64 currTime;
-		QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
+		std::int64_t currTime = QueryCounter();
 
 		mStopTime = currTime;
 		mStopped = true;
@@ -106,9 +259,7 @@ void GameTimer::Tick()
 		return;
 	}
 
-	__int64 currTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
-	mCurrTime = currTime;
+	mCurrTime = QueryCounter();
 
 	// Time difference between this frame and the previous.
 	mDeltaTime = (mCurrTime - mPrevTime) * mSecondsPerCount;
@@ -123,4 +274,6 @@ void GameTimer::Tick()
 	{
 		mDeltaTime = 0.0;
 	}
+
+	mFrameTimes.Record(mDeltaTime);
 }
\ No newline at end of file
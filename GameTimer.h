@@ -5,6 +5,53 @@
 #ifndef GAMETIMER_H
 #define GAMETIMER_H
 
+#include <atomic>
+#include <cstdint>
+
+// Summary of the frame times currently held by a FrameTimeHistogram.
+// All times are in milliseconds.
+struct FrameTimeStats
+{
+	float P50 = 0.0f;
+	float P95 = 0.0f;
+	float P99 = 0.0f;
+	float Max = 0.0f;
+
+	// Frames longer than the hitch threshold passed to Compute().
+	std::uint32_t HitchCount = 0;
+	std::uint32_t SampleCount = 0;
+};
+
+// Rolling window of the last Capacity frame times. Record() is meant to be
+// called by the thread that ticks the timer; Compute() can run on any thread
+// at any time without locking. A reader racing the writer may see a mix of
+// two consecutive windows, which is fine for statistics.
+class FrameTimeHistogram
+{
+public:
+	static const std::uint32_t Capacity = 1024;
+
+	FrameTimeHistogram();
+
+	void Record(double seconds);
+	void Clear();
+
+	// A frame is a hitch if it is longer than hitchFactor times the median.
+	FrameTimeStats Compute(float hitchFactor = 2.0f)const;
+
+private:
+	// Frame times in microseconds.
+	std::atomic<std::uint32_t> mSamples[Capacity];
+	std::atomic<std::uint64_t> mCount;
+};
+
+// Counter backend:
+//  - QueryPerformanceCounter on Windows,
+//  - clock_gettime(CLOCK_MONOTONIC) on Linux,
+//  - std::chrono::steady_clock everywhere else.
+// Define GAMETIMER_USE_TSC to read the x86 time stamp counter instead; it is
+// calibrated against the default backend at construction and assumes an
+// invariant TSC.
 class GameTimer
 {
 public:
@@ -18,17 +65,29 @@ public:
 	void Stop();  // Call when paused.
 	void Tick();  // Call every frame.
 
+	bool IsStopped()const { return mStopped; }
+
+	// Distribution of the recent DeltaTime values.
+	const FrameTimeHistogram& FrameTimes()const { return mFrameTimes; }
+	FrameTimeHistogram& FrameTimes() { return mFrameTimes; }
+
+	// Raw counter used by the timer and the length of one count in seconds.
+	static std::int64_t QueryCounter();
+	static double SecondsPerCount();
+
 private:
 	double mSecondsPerCount;
 	double mDeltaTime;
 
-	__int64 mBaseTime;
-	__int64 mPausedTime;
-	__int64 mStopTime;
-	__int64 mPrevTime;
-	__int64 mCurrTime;
+	std::int64_t mBaseTime;
+	std::int64_t mPausedTime;
+	std::int64_t mStopTime;
+	std::int64_t mPrevTime;
+	std::int64_t mCurrTime;
 
 	bool mStopped;
+
+	FrameTimeHistogram mFrameTimes;
 };
 
-#endif // GAMETIMER_H
\ No newline at end of file
+#endif // GAMETIMER_H
@@ -0,0 +1,125 @@
+#include "GpuTimer.h"
+#include "GameTimer.h"
+
+GpuTimer::GpuTimer()
+{
+}
+
+GpuTimer::~GpuTimer()
+{
+}
+
+void GpuTimer::Initialize(ID3D12Device* device, ID3D12CommandQueue* queue, UINT frameCount, UINT maxZonesPerFrame)
+{
+	m_queue = queue;
+	m_ring = std::make_unique<GpuTimestampRing>(frameCount, maxZonesPerFrame);
+	m_pending.assign(frameCount, 0);
+
+	DX::ThrowIfFailed(m_queue->GetTimestampFrequency(&m_frequency));
+
+	D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+	queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+	queryHeapDesc.Count = m_ring->TotalQueries();
+	queryHeapDesc.NodeMask = 0;
+	DX::ThrowIfFailed(device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&m_queryHeap)));
+
+	DX::ThrowIfFailed(device->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer((UINT64)m_ring->TotalQueries() * sizeof(UINT64)),
+		D3D12_RESOURCE_STATE_COPY_DEST,
+		nullptr,
+		IID_PPV_ARGS(&m_readback)));
+
+	Calibrate();
+}
+
+void GpuTimer::Calibrate()
+{
+	// The queue calibrates against QueryPerformanceCounter. Re-express that
+	// sample on the GameTimer counter, which may be the TSC instead.
+	UINT64 gpuTicks = 0;
+	UINT64 qpcTicks = 0;
+	DX::ThrowIfFailed(m_queue->GetClockCalibration(&gpuTicks, &qpcTicks));
+
+	LARGE_INTEGER qpcNow;
+	LARGE_INTEGER qpcFrequency;
+	INT64 cpuNow = GameTimer::QueryCounter();
+	QueryPerformanceCounter(&qpcNow);
+	QueryPerformanceFrequency(&qpcFrequency);
+
+	double secondsAgo = (double)(qpcNow.QuadPart - (INT64)qpcTicks) / (double)qpcFrequency.QuadPart;
+
+	m_gpuCalibration = gpuTicks;
+	m_cpuCalibration = cpuNow - (INT64)(secondsAgo / GameTimer::SecondsPerCount());
+}
+
+void GpuTimer::BeginFrame(UINT frameIndex)
+{
+	PROFILE_FUNCTION();
+
+	if (m_pending[frameIndex])
+	{
+		UINT first = m_ring->FirstQuery(frameIndex);
+		UINT count = m_ring->QueryCount(frameIndex);
+
+		D3D12_RANGE readRange = { first * sizeof(UINT64), (first + count) * sizeof(UINT64) };
+		UINT8* mapped = nullptr;
+		DX::ThrowIfFailed(m_readback->Map(0, &readRange, reinterpret_cast<void**>(&mapped)));
+		m_ring->Resolve(frameIndex, reinterpret_cast<const std::uint64_t*>(mapped) + first, m_frequency, m_lastFrame);
+
+		D3D12_RANGE writeRange = { 0, 0 };
+		m_readback->Unmap(0, &writeRange);
+
+		// GPU and CPU clocks drift apart over time, so sample a fresh pair
+		// every frame; the call is cheap.
+		Calibrate();
+
+		double secondsPerCount = GameTimer::SecondsPerCount();
+		for (const GpuZoneTiming& zone : m_lastFrame)
+		{
+			INT64 begin = GpuTimestampRing::GpuToCpuTicks(zone.Begin, m_frequency, m_gpuCalibration, m_cpuCalibration, secondsPerCount);
+			INT64 end = GpuTimestampRing::GpuToCpuTicks(zone.End, m_frequency, m_gpuCalibration, m_cpuCalibration, secondsPerCount);
+			Profiler::Get().RecordTrackZone("GPU", zone.Name, begin, end, zone.Depth);
+		}
+
+		m_pending[frameIndex] = 0;
+	}
+
+	m_currentFrame = frameIndex;
+	m_ring->BeginFrame(frameIndex);
+}
+
+UINT GpuTimer::BeginZone(ID3D12GraphicsCommandList* cmdList, const char* name)
+{
+	UINT query = m_ring->BeginZone(name);
+	if (query != GpuTimestampRing::InvalidZone)
+		cmdList->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, query);
+
+	return query;
+}
+
+void GpuTimer::EndZone(ID3D12GraphicsCommandList* cmdList, UINT zone)
+{
+	UINT query = m_ring->EndZone(zone);
+	if (query != GpuTimestampRing::InvalidZone)
+		cmdList->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, query);
+}
+
+void GpuTimer::EndFrame(ID3D12GraphicsCommandList* cmdList)
+{
+	// ResolveQueryData must not read queries that were never written, so
+	// zones still open end here.
+	for (UINT query = m_ring->EndOpenZone(); query != GpuTimestampRing::InvalidZone; query = m_ring->EndOpenZone())
+		cmdList->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, query);
+
+	UINT first = m_ring->FirstQuery(m_currentFrame);
+	UINT count = m_ring->QueryCount(m_currentFrame);
+	if (count == 0)
+		return;
+
+	cmdList->ResolveQueryData(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, first, count,
+		m_readback.Get(), (UINT64)first * sizeof(UINT64));
+
+	m_pending[m_currentFrame] = 1;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "framework.h"
+#include "d3dUtil.h"
+#include "GpuTimestampRing.h"
+#include "Profiler.h"
+
+using Microsoft::WRL::ComPtr;
+
+// Per-pass GPU timings from timestamp queries.
+//
+// Zones are bracketed with EndQuery calls on the command list and resolved
+// into a readback buffer at the end of the frame. Each frame resource owns a
+// region of the query heap and of the readback buffer, so results are read
+// once the renderer cycles back to that frame resource and has waited on its
+// fence: no extra GPU sync is ever needed. Collected zones are converted to
+// the GameTimer clock and pushed to the "GPU" track of the profiler.
+class GpuTimer
+{
+public:
+
+											GpuTimer();
+											GpuTimer(const GpuTimer& rhs) = delete;
+											GpuTimer& operator=(const GpuTimer& rhs) = delete;
+											~GpuTimer();
+
+	void									Initialize(ID3D12Device* device, ID3D12CommandQueue* queue, UINT frameCount, UINT maxZonesPerFrame);
+
+	// Call after the fence of `frameIndex` has completed and before recording
+	// into it again: collects the zones the GPU wrote there last time.
+	void									BeginFrame(UINT frameIndex);
+
+	UINT									BeginZone(ID3D12GraphicsCommandList* cmdList, const char* name);
+	void									EndZone(ID3D12GraphicsCommandList* cmdList, UINT zone);
+
+	// Copies this frame's queries into the readback buffer. Record before
+	// closing the command list.
+	void									EndFrame(ID3D12GraphicsCommandList* cmdList);
+
+	// Zones of the most recently collected frame.
+	const std::vector<GpuZoneTiming>&		GetLastFrame()		const	{	return m_lastFrame;	}
+
+private:
+
+	void									Calibrate();
+
+	ComPtr<ID3D12QueryHeap>					m_queryHeap = nullptr;
+	ComPtr<ID3D12Resource>					m_readback = nullptr;
+	ComPtr<ID3D12CommandQueue>				m_queue = nullptr;
+
+	std::unique_ptr<GpuTimestampRing>		m_ring;
+	std::vector<std::uint8_t>				m_pending;		// frame regions holding unread results
+	std::vector<GpuZoneTiming>				m_lastFrame;
+
+	UINT									m_currentFrame = 0;
+	UINT64									m_frequency = 0;
+
+	// Same instant on the GPU clock and on the GameTimer counter.
+	UINT64									m_gpuCalibration = 0;
+	INT64									m_cpuCalibration = 0;
+};
+
+// RAII GPU zone.
+class GpuScope
+{
+public:
+
+											GpuScope(GpuTimer& timer, ID3D12GraphicsCommandList* cmdList, const char* name)
+												: m_timer(timer), m_cmdList(cmdList), m_zone(timer.BeginZone(cmdList, name))	{}
+											~GpuScope()		{	m_timer.EndZone(m_cmdList, m_zone);	}
+
+											GpuScope(const GpuScope& rhs) = delete;
+											GpuScope& operator=(const GpuScope& rhs) = delete;
+
+private:
+
+	GpuTimer&								m_timer;
+	ID3D12GraphicsCommandList*				m_cmdList;
+	UINT									m_zone;
+};
+
+#if PROFILER_ENABLED
+#define GPU_PROFILE_SCOPE(timer, cmdList, name)		GpuScope PROFILE_CONCAT(gpuProfileScope_, __LINE__)(timer, cmdList, name)
+#else
+#define GPU_PROFILE_SCOPE(timer, cmdList, name)		((void)0)
+#endif
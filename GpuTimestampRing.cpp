@@ -0,0 +1,100 @@
+#include "GpuTimestampRing.h"
+#include <cassert>
+
+GpuTimestampRing::GpuTimestampRing(std::uint32_t frameCount, std::uint32_t maxZonesPerFrame)
+	: m_frameCount(frameCount), m_maxZonesPerFrame(maxZonesPerFrame), m_frames(frameCount)
+{
+	for (Frame& frame : m_frames)
+	{
+		frame.Names.reserve(maxZonesPerFrame);
+		frame.Depths.reserve(maxZonesPerFrame);
+		frame.Closed.reserve(maxZonesPerFrame);
+	}
+}
+
+void GpuTimestampRing::BeginFrame(std::uint32_t frameIndex)
+{
+	assert(frameIndex < m_frameCount);
+
+	m_currentFrame = frameIndex;
+	m_depth = 0;
+
+	Frame& frame = m_frames[frameIndex];
+	frame.Names.clear();
+	frame.Depths.clear();
+	frame.Closed.clear();
+}
+
+std::uint32_t GpuTimestampRing::BeginZone(const char* name)
+{
+	Frame& frame = m_frames[m_currentFrame];
+	if (frame.Names.size() >= m_maxZonesPerFrame)
+		return InvalidZone;
+
+	std::uint32_t zone = (std::uint32_t)frame.Names.size();
+	frame.Names.push_back(name);
+	frame.Depths.push_back(m_depth++);
+	frame.Closed.push_back(0);
+
+	return FirstQuery(m_currentFrame) + zone * 2;
+}
+
+std::uint32_t GpuTimestampRing::EndZone(std::uint32_t query)
+{
+	if (query == InvalidZone)
+		return InvalidZone;
+
+	std::uint32_t zone = (query - FirstQuery(m_currentFrame)) / 2;
+	Frame& frame = m_frames[m_currentFrame];
+	assert(zone < frame.Names.size() && !frame.Closed[zone]);
+
+	frame.Closed[zone] = 1;
+	m_depth--;
+
+	return query + 1;
+}
+
+std::uint32_t GpuTimestampRing::EndOpenZone()
+{
+	const Frame& frame = m_frames[m_currentFrame];
+	for (std::uint32_t zone = (std::uint32_t)frame.Closed.size(); zone-- > 0;)
+	{
+		if (!frame.Closed[zone])
+			return EndZone(FirstQuery(m_currentFrame) + zone * 2);
+	}
+
+	return InvalidZone;
+}
+
+void GpuTimestampRing::Resolve(std::uint32_t frameIndex, const std::uint64_t* timestamps, std::uint64_t gpuFrequency, std::vector<GpuZoneTiming>& out) const
+{
+	out.clear();
+
+	const Frame& frame = m_frames[frameIndex];
+	for (std::uint32_t zone = 0; zone < (std::uint32_t)frame.Names.size(); ++zone)
+	{
+		// A zone left open has no end timestamp.
+		if (!frame.Closed[zone])
+			continue;
+
+		GpuZoneTiming timing;
+		timing.Name = frame.Names[zone];
+		timing.Begin = timestamps[zone * 2];
+		timing.End = timestamps[zone * 2 + 1];
+		timing.Depth = frame.Depths[zone];
+
+		// Timestamps can come back out of order on some drivers after a
+		// power state change; clamp instead of reporting a negative time.
+		if (timing.End < timing.Begin)
+			timing.End = timing.Begin;
+
+		timing.Milliseconds = (double)(timing.End - timing.Begin) * 1000.0 / (double)gpuFrequency;
+		out.push_back(timing);
+	}
+}
+
+std::int64_t GpuTimestampRing::GpuToCpuTicks(std::uint64_t gpuTicks, std::uint64_t gpuFrequency, std::uint64_t gpuCalibration, std::int64_t cpuCalibration, double cpuSecondsPerCount)
+{
+	double seconds = ((double)(std::int64_t)(gpuTicks - gpuCalibration)) / (double)gpuFrequency;
+	return cpuCalibration + (std::int64_t)(seconds / cpuSecondsPerCount);
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// One GPU zone once its timestamps have been read back.
+struct GpuZoneTiming
+{
+	const char*								Name = nullptr;
+	std::uint64_t							Begin = 0;		// GPU ticks
+	std::uint64_t							End = 0;
+	std::uint32_t							Depth = 0;
+	double									Milliseconds = 0.0;
+};
+
+// API-independent bookkeeping for GPU timestamp queries.
+//
+// The query heap is split into one region per frame in flight. Zone i of a
+// frame uses queries 2i (begin) and 2i+1 (end) of that frame's region. A
+// region is only read back once the frame that wrote it has finished on
+// the GPU, i.e. when the renderer comes back to the same frame resource,
+// so results arrive frameCount frames late and reading never stalls.
+class GpuTimestampRing
+{
+public:
+
+	static const std::uint32_t				InvalidZone = 0xffffffffu;
+
+											GpuTimestampRing(std::uint32_t frameCount, std::uint32_t maxZonesPerFrame);
+
+	// Starts recording into `frameIndex`'s region. Any zones previously
+	// recorded there must have been collected with Resolve() first.
+	void									BeginFrame(std::uint32_t frameIndex);
+
+	// Returns the query index to write, or InvalidZone once the region is full.
+	std::uint32_t							BeginZone(const char* name);
+	std::uint32_t							EndZone(std::uint32_t zone);
+
+	// Ends the innermost zone still open and returns its end query, or
+	// InvalidZone once every zone is closed. Call until InvalidZone before
+	// resolving the frame's region, so every query in it is written.
+	std::uint32_t							EndOpenZone();
+
+	// Region written by the current frame, for the resolve copy.
+	std::uint32_t							FirstQuery(std::uint32_t frameIndex)	const	{	return frameIndex * m_maxZonesPerFrame * 2;	}
+	std::uint32_t							QueryCount(std::uint32_t frameIndex)	const	{	return (std::uint32_t)m_frames[frameIndex].Names.size() * 2;	}
+	std::uint32_t							TotalQueries()							const	{	return m_frameCount * m_maxZonesPerFrame * 2;	}
+
+	// Turns the read-back timestamps of `frameIndex`'s region into timings.
+	// `timestamps` points at the first query of that region.
+	void									Resolve(std::uint32_t frameIndex, const std::uint64_t* timestamps, std::uint64_t gpuFrequency, std::vector<GpuZoneTiming>& out)	const;
+
+	// Maps a GPU tick to the CPU counter using a calibration pair sampled at
+	// the same instant on both clocks.
+	static std::int64_t						GpuToCpuTicks(std::uint64_t gpuTicks, std::uint64_t gpuFrequency, std::uint64_t gpuCalibration, std::int64_t cpuCalibration, double cpuSecondsPerCount);
+
+private:
+
+	struct Frame
+	{
+		std::vector<const char*>			Names;
+		std::vector<std::uint32_t>			Depths;
+		std::vector<std::uint8_t>			Closed;
+	};
+
+	std::uint32_t							m_frameCount;
+	std::uint32_t							m_maxZonesPerFrame;
+	std::uint32_t							m_currentFrame = 0;
+	std::uint32_t							m_depth = 0;
+	std::vector<Frame>						m_frames;
+};
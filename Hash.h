@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// 64-bit FNV-1a, for cache keys built from descriptions and file contents.
+// Not cryptographic; keys are only compared against our own cache.
+class Hasher
+{
+public:
+
+	static const std::uint64_t				OffsetBasis = 14695981039346656037ull;
+	static const std::uint64_t				Prime = 1099511628211ull;
+
+	Hasher&									Bytes(const void* data, std::size_t size)
+	{
+		const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			m_hash ^= bytes[i];
+			m_hash *= Prime;
+		}
+		return *this;
+	}
+
+	// Length-prefixed, so ("ab", "c") and ("a", "bc") hash differently.
+	Hasher&									String(std::string_view s)
+	{
+		Value((std::uint64_t)s.size());
+		return Bytes(s.data(), s.size());
+	}
+
+	// Plain values only: padding bytes would make the hash unstable.
+	template<typename T>
+	Hasher&									Value(const T& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Hash plain values only.");
+		return Bytes(&value, sizeof(T));
+	}
+
+	std::uint64_t							Get()				const	{	return m_hash;	}
+
+	// 16 lowercase hex digits, usable as a file name.
+	static std::string						ToHex(std::uint64_t hash)
+	{
+		static const char digits[] = "0123456789abcdef";
+		std::string hex(16, '0');
+		for (int i = 15; i >= 0; --i, hash >>= 4)
+			hex[i] = digits[hash & 0xf];
+		return hex;
+	}
+
+private:
+
+	std::uint64_t							m_hash = OffsetBasis;
+};
@@ -0,0 +1,248 @@
+// Entry point of the headless build: runs the frame loop on the null backend
+// and prints CPU frame times. Not part of the Windows project; see README.md.
+
+#include "CommandCapture.h"
+#include "CommandReplay.h"
+#include "HeadlessRenderer.h"
+#include "NullBackend.h"
+#include "ReferenceRasterizer.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+	void PrintUsage()
+	{
+		std::cout << "usage: headless [--frames N] [--warmup N] [--items N] [--moving FRACTION] [--sim-thread 0|1]\n"
+			"                [--gpu-list-us US] [--gpu-draw-us US] [--occlusion 0|1] [--occluders N]\n"
+			"                [--capture FILE] [--reference-frames N] [--image FILE]\n"
+			"                [--golden FILE] [--golden-tolerance PIXELS]\n"
+			"       headless --replay FILE [--repeat N] [--gpu-list-us US] [--gpu-draw-us US]\n";
+	}
+
+	void PrintFrameTimes(const char* label, const FrameTimeHistogram& frameTimes)
+	{
+		FrameTimeStats stats = frameTimes.Compute();
+		std::cout << label << " ms: p50 " << stats.P50 << ", p95 " << stats.P95 << ", p99 " << stats.P99
+			<< ", max " << stats.Max << ", hitches " << stats.HitchCount << " of " << stats.SampleCount << "\n";
+	}
+
+	// Colors::LightSteelBlue, as RenderWindow clears the back buffer.
+	const float ClearColor[4] = { 0.690196097f, 0.768627524f, 0.870588303f, 1.0f };
+
+	// Golden images may differ by this much per channel, for compilers that
+	// round a few pixels differently.
+	const std::uint32_t GoldenChannelTolerance = 1;
+
+	int RenderReference(const HeadlessSettings& settings, std::uint32_t frames, const char* imagePath,
+		const char* goldenPath, std::uint32_t goldenTolerance)
+	{
+		NullRenderDevice device;
+		ReferenceRasterizer rasterizer(settings.RenderTargetWidth, settings.RenderTargetHeight);
+		device.SetRasterizer(&rasterizer);
+
+		HeadlessRenderer renderer(device, settings);
+		renderer.Initialize();
+
+		// A stopped timer keeps DeltaTime at zero: every frame draws the scene
+		// as built, so the image does not depend on timing.
+		GameTimer timer;
+		timer.Reset();
+		timer.Stop();
+		for (std::uint32_t i = 0; i < frames; ++i)
+		{
+			rasterizer.Clear(ClearColor);
+			renderer.Run(timer, 1);
+		}
+		renderer.Flush();
+
+		const ReferenceStats& stats = rasterizer.GetStats();
+		std::cout << "reference: " << frames << " frames, per frame " << stats.Draws / frames << " draws, "
+			<< stats.Triangles / frames << " triangles (" << stats.SetupTriangles / frames << " set up), "
+			<< stats.PixelsCovered / frames << " pixels (" << stats.PixelsWritten / frames << " written) in "
+			<< stats.Seconds / frames * 1e3 << " ms: " << stats.Triangles / stats.Seconds * 1e-6 << " M triangles/s, "
+			<< stats.PixelsCovered / stats.Seconds * 1e-6 << " M pixels/s\n";
+
+		if (imagePath != nullptr && !rasterizer.SaveImage(imagePath))
+		{
+			std::cout << "cannot write image " << imagePath << "\n";
+			return 1;
+		}
+
+		if (goldenPath != nullptr)
+		{
+			ImageDiff diff;
+			if (!rasterizer.CompareImage(goldenPath, GoldenChannelTolerance, diff))
+			{
+				std::cout << "cannot compare with golden image " << goldenPath << "\n";
+				return 1;
+			}
+
+			bool passed = diff.Pixels <= goldenTolerance;
+			std::cout << "golden: " << diff.Pixels << " pixels differ, max channel delta " << diff.MaxDelta
+				<< (passed ? ", passed\n" : ", FAILED\n");
+			return passed ? 0 : 1;
+		}
+
+		return 0;
+	}
+
+	int Replay(const char* path, std::uint32_t repeat, const NullBackendSettings& backend)
+	{
+		NullRenderDevice device(backend);
+		CommandReplayer replayer(device);
+		if (!replayer.Open(path))
+		{
+			std::cout << "cannot read command log " << path << "\n";
+			return 1;
+		}
+
+		for (std::uint32_t i = 0; i < repeat; ++i)
+		{
+			if (!replayer.Replay())
+			{
+				std::cout << "command log is malformed at offset " << replayer.GetErrorOffset() << "\n";
+				return 1;
+			}
+
+			const ReplayStats& stats = replayer.GetStats();
+			std::cout << "replay " << i << ": " << stats.Frames << " frames, " << stats.Commands << " records, "
+				<< stats.Draws << " draws in " << stats.Seconds * 1e3 << " ms ("
+				<< stats.Commands / stats.Seconds * 1e-6 << " M records/s), captured " << stats.CapturedSeconds * 1e3 << " ms\n";
+		}
+
+		PrintFrameTimes("replay frame", replayer.GetFrameTimes());
+		return 0;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::uint32_t frames = 1000;
+	std::uint32_t warmup = 60;
+	std::uint32_t repeat = 1;
+	const char* capturePath = nullptr;
+	const char* replayPath = nullptr;
+	std::uint32_t referenceFrames = 0;
+	const char* imagePath = nullptr;
+	const char* goldenPath = nullptr;
+	std::uint32_t goldenTolerance = 0;
+	HeadlessSettings settings;
+	NullBackendSettings backend;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* option = argv[i];
+		if (i + 1 >= argc)
+		{
+			PrintUsage();
+			return 1;
+		}
+		const char* value = argv[++i];
+
+		if (std::strcmp(option, "--frames") == 0)
+			frames = (std::uint32_t)std::strtoul(value, nullptr, 10);
+		else if (std::strcmp(option, "--warmup") == 0)
+			warmup = (std::uint32_t)std::strtoul(value, nullptr, 10);
+		else if (std::strcmp(option, "--items") == 0)
+			settings.ItemCount = (std::uint32_t)std::strtoul(value, nullptr, 10);
+		else if (std::strcmp(option, "--moving") == 0)
+			settings.MovingFraction = std::strtof(value, nullptr);
+		else if (std::strcmp(option, "--sim-thread") == 0)
+			settings.ThreadedSimulation = std::strtoul(value, nullptr, 10) != 0;
+		else if (std::strcmp(option, "--gpu-list-us") == 0)
+			backend.FixedCost = std::strtod(value, nullptr) * 1e-6;
+		else if (std::strcmp(option, "--gpu-draw-us") == 0)
+			backend.DrawCost = std::strtod(value, nullptr) * 1e-6;
+		else if (std::strcmp(option, "--occlusion") == 0)
+			settings.OcclusionCulling = std::strtoul(value, nullptr, 10) != 0;
+		else if (std::strcmp(option, "--occluders") == 0)
+			settings.MaxOccluders = (std::uint32_t)std::strtoul(value, nullptr, 10);
+		else if (std::strcmp(option, "--capture") == 0)
+			capturePath = value;
+		else if (std::strcmp(option, "--replay") == 0)
+			replayPath = value;
+		else if (std::strcmp(option, "--repeat") == 0)
+			repeat = (std::uint32_t)std::strtoul(value, nullptr, 10);
+		else if (std::strcmp(option, "--reference-frames") == 0)
+			referenceFrames = (std::uint32_t)std::strtoul(value, nullptr, 10);
+		else if (std::strcmp(option, "--image") == 0)
+			imagePath = value;
+		else if (std::strcmp(option, "--golden") == 0)
+			goldenPath = value;
+		else if (std::strcmp(option, "--golden-tolerance") == 0)
+			goldenTolerance = (std::uint32_t)std::strtoul(value, nullptr, 10);
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (replayPath != nullptr)
+		return Replay(replayPath, repeat, backend);
+
+	NullRenderDevice nullDevice(backend);
+	CaptureRenderDevice capture(nullDevice);
+	if (capturePath != nullptr && !capture.Open(capturePath))
+	{
+		std::cout << "cannot create command log " << capturePath << "\n";
+		return 1;
+	}
+
+	// Capturing from the start, warm-up frames included, so the log holds
+	// everything the frames refer to.
+	RenderDevice& device = capturePath != nullptr ? (RenderDevice&)capture : (RenderDevice&)nullDevice;
+	{
+		HeadlessRenderer renderer(device, settings);
+		renderer.Initialize();
+
+		GameTimer timer;
+		timer.Reset();
+		renderer.Run(timer, warmup);
+
+		// Only the measured frames go into the histogram.
+		timer.FrameTimes().Clear();
+		renderer.OcclusionTimes().Clear();
+		nullDevice.ResetStats();
+		renderer.Run(timer, frames);
+		renderer.Flush();
+
+		const NullQueueStats& queue = nullDevice.GetStats();
+		const HeadlessFrameStats& last = renderer.GetFrameStats();
+
+		std::cout << "frames " << frames << ", items " << settings.ItemCount
+			<< ", last frame: " << last.ObjectCBWritten << " constants written, " << last.ObjectCBSkipped << " skipped, "
+			<< last.Draws << " draws\n";
+#if ENGINE_PORTABLE_MATH
+		std::cout << "math: scalar stand-in (Portable/), not the shipped SSE DirectXMath\n";
+#endif
+		PrintFrameTimes("cpu frame", timer.FrameTimes());
+		if (settings.OcclusionCulling)
+		{
+			const OcclusionStats& occlusion = renderer.GetOcclusionBuffer().GetStats();
+			std::cout << "occlusion: " << last.Occluded << " of " << settings.ItemCount << " items culled, "
+				<< occlusion.Occluders << " occluders, " << occlusion.Triangles << " triangles, "
+				<< occlusion.TileTriangles << " tile triangles\n";
+			PrintFrameTimes("occlusion", renderer.OcclusionTimes());
+		}
+		std::cout << "queue: " << queue.Submissions << " submissions, " << queue.Commands << " commands, "
+			<< queue.Draws << " draws, " << queue.Stalls << " stalls\n";
+	}
+
+	if (capturePath != nullptr)
+	{
+		capture.Close();
+		const CaptureStats& stats = capture.GetStats();
+		std::cout << "captured " << stats.Signals << " signals, " << stats.Commands << " records, "
+			<< stats.UploadBytes << " upload bytes, " << capture.GetLogSize() << " bytes to " << capturePath << "\n";
+	}
+
+	if ((imagePath != nullptr || goldenPath != nullptr) && referenceFrames == 0)
+		referenceFrames = 1;
+	if (referenceFrames != 0)
+		return RenderReference(settings, referenceFrames, imagePath, goldenPath, goldenTolerance);
+
+	return 0;
+}
@@ -0,0 +1,118 @@
+#include "HeadlessRenderer.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	const StringId ShapeGeo("shapeGeo");
+	const StringId Box("box");
+	const StringId Sphere("sphere");
+
+	SceneRendererSettings RendererSettings(const HeadlessSettings& settings)
+	{
+		SceneRendererSettings renderer;
+		renderer.PipelineHash = settings.PipelineHash;
+		renderer.RootSignatureHash = settings.RootSignatureHash;
+		renderer.IndirectDraw = settings.IndirectDraw;
+		return renderer;
+	}
+}
+
+HeadlessRenderer::HeadlessRenderer(RenderDevice& device, const HeadlessSettings& settings)
+	: m_settings(settings), m_renderer(device, RendererSettings(settings), std::max(settings.ItemCount, 1u)),
+	m_simulation(1.0 / 60.0, 5,
+		[this](double stepSeconds) { m_renderer.GetScene().FixedUpdate((float)stepSeconds); },
+		[this] { m_renderer.GetScene().PublishSimulation(); },
+		settings.ThreadedSimulation)
+{
+}
+
+HeadlessRenderer::~HeadlessRenderer()
+{
+}
+
+void HeadlessRenderer::Initialize()
+{
+	PROFILE_FUNCTION();
+
+	m_renderer.Initialize();
+
+	GameObject& scene = m_renderer.GetScene();
+	scene.SetOcclusionCulling(m_settings.OcclusionCulling);
+	scene.SetMaxOccluders(m_settings.MaxOccluders);
+
+	BuildScene();
+}
+
+void HeadlessRenderer::BuildScene()
+{
+	GameObject& scene = m_renderer.GetScene();
+	std::uint32_t movingCount = (std::uint32_t)(m_settings.ItemCount * std::clamp(m_settings.MovingFraction, 0.0f, 1.0f));
+
+	// Items on a grid centered on the origin, alternating boxes and spheres.
+	std::uint32_t side = std::max((std::uint32_t)std::ceil(std::sqrt((double)m_settings.ItemCount)), 1u);
+	float half = (float)(side - 1);
+	for (std::uint32_t i = 0; i < m_settings.ItemCount; ++i)
+	{
+		XMFLOAT3 position(2.0f * (i % side) - half, 0.5f, 2.0f * (i / side) - half);
+		Transform local(position, XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f), 1.0f);
+
+		Entity entity = scene.Spawn(ShapeGeo, i % 2 == 0 ? Box : Sphere, local);
+		assert(entity.IsValid());
+		if (i < movingCount)
+			scene.SetSpin(entity, 0.5f + 0.001f * i);
+	}
+
+	// Low over the corner of the grid, looking along its diagonal at the
+	// center.
+	float aspectRatio = (float)m_settings.RenderTargetWidth / (float)m_settings.RenderTargetHeight;
+	Camera& camera = m_renderer.GetCamera();
+	camera.SetOrbit(1.5f * half + 4.0f, 1.25f * XM_PI, 0.47f * XM_PI);
+	camera.SetLens(0.25f * XM_PI, aspectRatio, 1.0f, 1000.0f);
+}
+
+void HeadlessRenderer::Update(const GameTimer& gt)
+{
+	PROFILE_FUNCTION();
+
+	m_renderer.BeginFrame(m_settings.MaxQueuedFrames);
+
+	// Fixed steps for the time that passed, then the pose between the last two.
+	float alpha = m_simulation.Advance(gt.DeltaTime());
+	m_renderer.GetScene().Interpolate(alpha);
+	m_renderer.Update(gt, m_settings.RenderTargetWidth, m_settings.RenderTargetHeight);
+
+	const ObjectCBStats& objectCBStats = m_renderer.GetObjectCBStats();
+	m_frameStats.ObjectCBWritten = objectCBStats.Written;
+	m_frameStats.ObjectCBSkipped = objectCBStats.Skipped;
+	m_frameStats.Occluded = m_renderer.GetScene().GetOccludedCount();
+}
+
+void HeadlessRenderer::Draw(const GameTimer& /*gt*/)
+{
+	PROFILE_FUNCTION();
+
+	GpuCommandList& commandList = m_renderer.BeginCommandList();
+	m_renderer.DrawScene(commandList);
+	m_renderer.Submit(commandList);
+	m_renderer.Signal();
+
+	m_frameStats.Draws = m_renderer.GetDrawCount();
+	m_frameCount++;
+}
+
+void HeadlessRenderer::Flush()
+{
+	m_renderer.Flush();
+}
+
+void HeadlessRenderer::Run(GameTimer& timer, std::uint32_t frameCount)
+{
+	for (std::uint32_t i = 0; i < frameCount; ++i)
+	{
+		timer.Tick();
+		Update(timer);
+		Draw(timer);
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include "RenderBackend.h"
+#include "SceneRenderer.h"
+#include "GameTimer.h"
+#include "FixedStepScheduler.h"
+#include "OcclusionBuffer.h"
+
+struct HeadlessSettings
+{
+	std::uint32_t							ItemCount = 4096;
+	// Share of the items that turn every frame; the others are static and
+	// drop out of the constant uploads once every frame resource has them.
+	float									MovingFraction = 0.1f;
+	// Runs the fixed simulation steps on their own thread, overlapping the
+	// frame's render; rendering then shows them one frame later.
+	bool									ThreadedSimulation = false;
+	std::uint32_t							MaxQueuedFrames = 2;
+
+	// Tests every item against the largest items seen from the camera in
+	// GameObject::Update, before the draws are recorded.
+	bool									OcclusionCulling = false;
+	std::uint32_t							MaxOccluders = 16;
+
+	// Sets the aspect ratio and the pass constants; draws go to whatever
+	// target the backend has.
+	std::uint32_t							RenderTargetWidth = 800;
+	std::uint32_t							RenderTargetHeight = 600;
+
+	// As registered with the device; the null backend takes any value.
+	std::uint64_t							PipelineHash = 0;
+	std::uint64_t							RootSignatureHash = 0;
+	bool									IndirectDraw = true;
+};
+
+// Work done by the last frame.
+struct HeadlessFrameStats
+{
+	std::uint32_t							ObjectCBWritten = 0;
+	std::uint32_t							ObjectCBSkipped = 0;
+	std::uint32_t							Draws = 0;
+	std::uint32_t							Occluded = 0;
+};
+
+// RenderWindow's frame loop without a window: a SceneRenderer over a grid of
+// GameObject items, some of them spinning at a fixed 60 Hz step. Run on a
+// NullRenderDevice it gives CPU frame times on machines with no GPU.
+//
+// The camera is fixed, low over one corner of the item grid, so that near
+// items hide most of the others when occlusion culling is on.
+class HeadlessRenderer
+{
+public:
+
+											HeadlessRenderer(RenderDevice& device, const HeadlessSettings& settings = HeadlessSettings());
+											HeadlessRenderer(const HeadlessRenderer& rhs) = delete;
+											HeadlessRenderer& operator=(const HeadlessRenderer& rhs) = delete;
+											~HeadlessRenderer();
+
+	// Builds the scene and uploads its geometry; returns once the GPU has it.
+	void									Initialize();
+
+	void									Update(const GameTimer& gt);
+	void									Draw(const GameTimer& gt);
+	// Waits for every submitted frame.
+	void									Flush();
+
+	// Ticks `timer` and runs that many frames. Frame times are recorded in
+	// the timer's histogram.
+	void									Run(GameTimer& timer, std::uint32_t frameCount);
+
+	const HeadlessFrameStats&				GetFrameStats()		const	{	return m_frameStats;	}
+	std::uint64_t							GetFrameCount()		const	{	return m_frameCount;	}
+
+	GameObject&								GetScene()					{	return m_renderer.GetScene();	}
+	FrameTimeHistogram&						OcclusionTimes()			{	return GetScene().OcclusionTimes();	}
+	const OcclusionBuffer&					GetOcclusionBuffer()		{	return GetScene().GetOcclusionBuffer();	}
+
+private:
+
+	void									BuildScene();
+
+	HeadlessSettings						m_settings;
+	SceneRenderer							m_renderer;
+	// After m_renderer: the worker is joined before the scene goes away.
+	FixedStepLoop							m_simulation;
+
+	HeadlessFrameStats						m_frameStats;
+	std::uint64_t							m_frameCount = 0;
+};
@@ -0,0 +1,79 @@
+#include "IndirectDraw.h"
+#include <execution>
+#include <numeric>
+
+CommandSignatureDesc IndirectCommandSignature()
+{
+	CommandSignatureDesc desc;
+	desc.ByteStride = sizeof(IndirectCommand);
+	desc.Arguments =
+	{
+		{ IndirectArgumentType::ConstantBufferView, 0 },
+		{ IndirectArgumentType::Constant, 2 },
+		{ IndirectArgumentType::DrawIndexed },
+	};
+	return desc;
+}
+
+UINT IndirectDrawBuilder::Build(std::span<const RenderItem> items, GpuAddress objectCBBase)
+{
+	const size_t count = items.size();
+
+	m_visible.resize(count);
+	m_offsets.resize(count);
+	m_visibleItems.resize(count);
+	m_commands.resize(count);
+
+	// Visibility flags, then an exclusive scan gives every visible item its
+	// slot in the compacted buffer. This is the same shape a GPU culling
+	// compute pass would use to write the argument buffer itself.
+	std::transform(std::execution::par, items.begin(), items.end(), m_visible.begin(),
+		[](const RenderItem& ri) { return ri.Visible ? 1u : 0u; });
+
+	std::exclusive_scan(std::execution::par, m_visible.begin(), m_visible.end(), m_offsets.begin(), 0u);
+
+	m_commandCount = count > 0 ? m_offsets[count - 1] + m_visible[count - 1] : 0;
+
+	std::for_each(std::execution::par, items.begin(), items.end(), [&](const RenderItem& ri)
+	{
+		const size_t i = &ri - items.data();
+		if (!m_visible[i])
+			return;
+
+		IndirectCommand& cmd = m_commands[m_offsets[i]];
+		cmd.ObjectCbv = ri.ObjectCBAddress(objectCBBase);
+		cmd.DrawId = (UINT)i;
+		cmd.DrawArguments.IndexCountPerInstance = ri.IndexCount;
+		cmd.DrawArguments.InstanceCount = 1;
+		cmd.DrawArguments.StartIndexLocation = ri.StartIndexLocation;
+		cmd.DrawArguments.BaseVertexLocation = ri.BaseVertexLocation;
+		cmd.DrawArguments.StartInstanceLocation = 0;
+
+		m_visibleItems[m_offsets[i]] = &ri;
+	});
+
+	BuildBatches();
+
+	return m_commandCount;
+}
+
+void IndirectDrawBuilder::BuildBatches()
+{
+	m_batches.clear();
+
+	for (UINT i = 0; i < m_commandCount; ++i)
+	{
+		const RenderItem* ri = m_visibleItems[i];
+
+		if (m_batches.empty() || m_batches.back().Geo != ri->Geo || m_batches.back().PrimitiveType != ri->PrimitiveType)
+		{
+			IndirectBatch batch;
+			batch.Geo = ri->Geo;
+			batch.PrimitiveType = ri->PrimitiveType;
+			batch.FirstCommand = i;
+			m_batches.push_back(batch);
+		}
+
+		m_batches.back().CommandCount++;
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "RenderBackend.h"
+#include "GameObject.h"
+
+// One entry of the ExecuteIndirect argument buffer. The member order must match
+// the argument order of IndirectCommandSignature(): object CBV (root slot 0),
+// draw id root constant (root slot 2), then the indexed draw itself.
+struct IndirectCommand
+{
+	GpuAddress														ObjectCbv;
+	UINT															DrawId;
+	DrawIndexedArguments											DrawArguments;
+};
+
+static_assert(sizeof(IndirectCommand) == 32, "IndirectCommand must stay tightly packed for the command signature.");
+
+// Signature of IndirectCommand.
+CommandSignatureDesc												IndirectCommandSignature();
+
+// A run of consecutive commands that share vertex/index buffers and topology,
+// so they can be submitted with a single ExecuteIndirect.
+struct IndirectBatch
+{
+	MeshGeometry*													Geo = nullptr;
+	PrimitiveTopology												PrimitiveType = PrimitiveTopology::TriangleList;
+	UINT															FirstCommand = 0;
+	UINT															CommandCount = 0;
+};
+
+// Builds the CPU side of the indirect draw path. Everything here only touches
+// RenderItem data and plain arrays, so the generated buffers can be checked
+// without a device.
+class IndirectDrawBuilder
+{
+public:
+
+	// Writes one command per visible item, compacted in item order, and returns
+	// the number of commands written. DrawId is the index of the item in `items`
+	// so a later GPU culling pass can map a command back to its object.
+	// `objectCBBase` is the object constant buffer of the frame being recorded.
+	UINT															Build(std::span<const RenderItem> items, GpuAddress objectCBBase);
+
+	const std::vector<IndirectCommand>&								GetCommands()	const	{	return m_commands;	}
+	const std::vector<IndirectBatch>&								GetBatches()	const	{	return m_batches;	}
+	UINT															GetCommandCount()	const	{	return m_commandCount;	}
+
+private:
+
+	void															BuildBatches();
+
+	std::vector<UINT>												m_visible;
+	std::vector<UINT>												m_offsets;
+	std::vector<const RenderItem*>									m_visibleItems;
+	std::vector<IndirectCommand>									m_commands;
+	std::vector<IndirectBatch>										m_batches;
+	UINT															m_commandCount = 0;
+};
@@ -0,0 +1,193 @@
+#include "MappedFile.h"
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile&& rhs) noexcept
+{
+	*this = std::move(rhs);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept
+{
+	if (this != &rhs)
+	{
+		Close();
+		std::swap(m_data, rhs.m_data);
+		std::swap(m_size, rhs.m_size);
+		std::swap(m_empty, rhs.m_empty);
+#ifdef _WIN32
+		std::swap(m_file, rhs.m_file);
+		std::swap(m_mapping, rhs.m_mapping);
+#else
+		std::swap(m_fd, rhs.m_fd);
+#endif
+	}
+	return *this;
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& path)
+{
+	Close();
+
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size))
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	m_file = file;
+	m_size = (std::size_t)size.QuadPart;
+	if (m_size == 0)
+	{
+		m_empty = true;
+		return true;
+	}
+
+	m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	m_data = static_cast<const std::uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (m_data == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_data != nullptr)
+		UnmapViewOfFile(m_data);
+	if (m_mapping != nullptr)
+		CloseHandle(m_mapping);
+	if (m_file != nullptr)
+		CloseHandle(m_file);
+
+	m_data = nullptr;
+	m_mapping = nullptr;
+	m_file = nullptr;
+	m_size = 0;
+	m_empty = false;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& path)
+{
+	Close();
+
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	m_fd = fd;
+	m_size = (std::size_t)info.st_size;
+	if (m_size == 0)
+	{
+		m_empty = true;
+		return true;
+	}
+
+	void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (data == MAP_FAILED)
+	{
+		Close();
+		return false;
+	}
+
+	m_data = static_cast<const std::uint8_t*>(data);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_data != nullptr)
+		munmap(const_cast<std::uint8_t*>(m_data), m_size);
+	if (m_fd >= 0)
+		close(m_fd);
+
+	m_data = nullptr;
+	m_fd = -1;
+	m_size = 0;
+	m_empty = false;
+}
+
+#endif
+
+bool WriteFileAtomic(const std::string& path, const void* data, std::size_t size)
+{
+	std::string temp = path + ".tmp";
+	{
+		std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+		if (!file)
+			return false;
+		file.write(static_cast<const char*>(data), (std::streamsize)size);
+		if (!file)
+			return false;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temp, path, error);
+	return !error;
+}
+
+std::string ResolveModulePath(const std::string& path)
+{
+	std::filesystem::path relative(path);
+	if (relative.is_absolute())
+		return path;
+
+#ifdef _WIN32
+	char module[MAX_PATH];
+	DWORD length = GetModuleFileNameA(nullptr, module, MAX_PATH);
+	if (length == 0 || length == MAX_PATH)
+		return path;
+	std::filesystem::path executable(std::string(module, length));
+#else
+	std::error_code error;
+	std::filesystem::path executable = std::filesystem::read_symlink("/proc/self/exe", error);
+	if (error)
+		return path;
+#endif
+
+	return (executable.parent_path() / relative).lexically_normal().string();
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file: MapViewOfFile on Windows, mmap
+// elsewhere. The contents are paged in by the OS on first touch and shared
+// with the file cache, so nothing is copied at load time.
+class MappedFile
+{
+public:
+
+											MappedFile() = default;
+											MappedFile(const MappedFile& rhs) = delete;
+											MappedFile& operator=(const MappedFile& rhs) = delete;
+											MappedFile(MappedFile&& rhs) noexcept;
+											MappedFile& operator=(MappedFile&& rhs) noexcept;
+											~MappedFile();
+
+	// Returns false if the file does not exist or cannot be mapped.
+	bool									Open(const std::string& path);
+	void									Close();
+
+	const std::uint8_t*						Data()			const	{	return m_data;	}
+	std::size_t								Size()			const	{	return m_size;	}
+	bool									IsOpen()		const	{	return m_data != nullptr || m_empty;	}
+
+private:
+
+	const std::uint8_t*						m_data = nullptr;
+	std::size_t								m_size = 0;
+	// Empty files cannot be mapped but are still valid.
+	bool									m_empty = false;
+#ifdef _WIN32
+	void*									m_file = nullptr;
+	void*									m_mapping = nullptr;
+#else
+	int										m_fd = -1;
+#endif
+};
+
+// Writes `data` to a temporary file and renames it over `path`, so readers
+// (and the next run, after a crash) see either the old or the new contents.
+bool WriteFileAtomic(const std::string& path, const void* data, std::size_t size);
+
+// `path` if it is absolute, otherwise `path` under the directory of the
+// running executable. Data written next to the binary is then found again
+// whatever the working directory of the next run.
+std::string ResolveModulePath(const std::string& path);
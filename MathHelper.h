@@ -1,30 +1,37 @@
 #pragma once
-#include "framework.h"
+#include "MathTypes.h"
 //***************************************************************************************
 // MathHelper.h by Frank Luna (C) 2011 All Rights Reserved.
 //
 // Helper math class.
 //***************************************************************************************
 #include <cstdint>
+#include "Random.h"
+#include "Transform.h"
 
 class MathHelper
 {
 public:
+	// Random values come from the calling thread's generator; use a seeded
+	// Random directly for reproducible sequences.
+
 	// Returns random float in [0, 1).
 	static float RandF()
 	{
-		return (float)(rand()) / (float)RAND_MAX;
+		return Random::ThreadLocal().NextFloat();
 	}
 
-	// Returns random float in [a, b).
+	// Returns random float from a up to b, b excluded; either may be the
+	// larger.
 	static float RandF(float a, float b)
 	{
-		return a + RandF() * (b - a);
+		return Random::ThreadLocal().NextFloat(a, b);
 	}
 
+	// Returns random int in [a, b].
 	static int Rand(int a, int b)
 	{
-		return a + rand() % ((b - a) + 1);
+		return Random::ThreadLocal().NextInt(a, b);
 	}
 
 	template<typename T>
@@ -75,6 +82,41 @@ public:
 		return DirectX::XMMatrixTranspose(DirectX::XMMatrixInverse(&det, A));
 	}
 
+	// Inverse of a rigid transform (rotation + translation only), such as a view
+	// matrix. The rotation part is orthonormal, so its inverse is its transpose
+	// and the translation is rotated back and negated.
+	static DirectX::XMMATRIX InverseRigid(DirectX::FXMMATRIX M)
+	{
+		DirectX::XMMATRIX R = M;
+		R.r[3] = DirectX::g_XMIdentityR3;
+		R = DirectX::XMMatrixTranspose(R);
+
+		DirectX::XMVECTOR t = DirectX::XMVector3TransformNormal(M.r[3], R);
+		R.r[3] = DirectX::XMVectorSetW(DirectX::XMVectorNegate(t), 1.0f);
+		return R;
+	}
+
+	// Inverse of a left-handed perspective projection built by
+	// XMMatrixPerspectiveFovLH. Only five entries are non-zero:
+	//
+	//  | xs  0  0  0 |          | 1/xs   0    0     0  |
+	//  |  0 ys  0  0 |   ==>    |   0  1/ys   0     0  |
+	//  |  0  0  A  1 |          |   0    0    0    1/B |
+	//  |  0  0  B  0 |          |   0    0    1   -A/B |
+	static DirectX::XMMATRIX InversePerspective(DirectX::FXMMATRIX P)
+	{
+		float xs = DirectX::XMVectorGetX(P.r[0]);
+		float ys = DirectX::XMVectorGetY(P.r[1]);
+		float A = DirectX::XMVectorGetZ(P.r[2]);
+		float B = DirectX::XMVectorGetZ(P.r[3]);
+
+		return DirectX::XMMATRIX(
+			1.0f / xs, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f / ys, 0.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f / B,
+			0.0f, 0.0f, 1.0f, -A / B);
+	}
+
 	static DirectX::XMFLOAT4X4 Identity4x4()
 	{
 		static DirectX::XMFLOAT4X4 I(
@@ -86,6 +128,24 @@ public:
 		return I;
 	}
 
+	// Spherical linear interpolation between two unit quaternions.
+	static DirectX::XMFLOAT4 Slerp(const DirectX::XMFLOAT4& a, const DirectX::XMFLOAT4& b, float t)
+	{
+		DirectX::XMFLOAT4 q;
+		DirectX::XMStoreFloat4(&q, DirectX::XMQuaternionSlerp(DirectX::XMLoadFloat4(&a), DirectX::XMLoadFloat4(&b), t));
+		return q;
+	}
+
+	// Lerps position and scale, slerps rotation.
+	static Transform Interpolate(const Transform& a, const Transform& b, float t)
+	{
+		Transform r;
+		DirectX::XMStoreFloat3(&r.Position, DirectX::XMVectorLerp(DirectX::XMLoadFloat3(&a.Position), DirectX::XMLoadFloat3(&b.Position), t));
+		r.Scale = Lerp(a.Scale, b.Scale, t);
+		r.Rotation = Slerp(a.Rotation, b.Rotation, t);
+		return r;
+	}
+
 	static DirectX::XMVECTOR RandUnitVec3();
 	static DirectX::XMVECTOR RandHemisphereUnitVec3(DirectX::XMVECTOR n);
 
@@ -0,0 +1,25 @@
+#pragma once
+
+// Math and integer types for the engine code that does not talk to D3D12
+// (transforms, camera, geometry, the scene), so that it also builds for the
+// headless backend. Windows builds get them from the SDK as before; other
+// platforms get the open-source DirectXMath headers, or the scalar subset in
+// Portable/ where those are not available (ENGINE_PORTABLE_MATH), and the
+// Windows integer typedefs.
+#ifdef _WIN32
+#include "framework.h"
+#include <DirectXCollision.h>
+#else
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <DirectXColors.h>
+#include <cassert>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+
+using BYTE = std::uint8_t;
+using INT = std::int32_t;
+using UINT = std::uint32_t;
+using UINT64 = std::uint64_t;
+#endif
@@ -0,0 +1,220 @@
+#include "MemoryTracker.h"
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+	// Own cache line per tag so threads charging different tags do not
+	// bounce the same line.
+	struct alignas(64) TagCounters
+	{
+		std::atomic<std::uint64_t>			LiveBytes { 0 };
+		std::atomic<std::uint64_t>			PeakBytes { 0 };
+		std::atomic<std::uint64_t>			LiveCount { 0 };
+		std::atomic<std::uint64_t>			TotalCount { 0 };
+		std::atomic<std::uint64_t>			TotalBytes { 0 };
+
+		// Totals at the start of the current and of the last frame.
+		std::atomic<std::uint64_t>			FrameStartCount { 0 };
+		std::atomic<std::uint64_t>			FrameStartBytes { 0 };
+		std::atomic<std::uint64_t>			LastFrameCount { 0 };
+		std::atomic<std::uint64_t>			LastFrameBytes { 0 };
+	};
+
+	// Zero-initialised before any dynamic initialisation, so it is safe to
+	// use from a replaced global operator new during static construction.
+	TagCounters								g_counters[(size_t)MemTag::Count];
+
+	const char*								g_tagNames[(size_t)MemTag::Count] =
+	{
+		"General",
+		"Geometry",
+		"RenderItems",
+		"Shaders",
+		"Frame",
+		"Entities",
+	};
+}
+
+#if MEMORY_TRACKING_ENABLED
+void MemoryTracker::OnAllocate(MemTag tag, std::size_t bytes)
+{
+	TagCounters& c = g_counters[(size_t)tag];
+
+	std::uint64_t live = c.LiveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+	c.LiveCount.fetch_add(1, std::memory_order_relaxed);
+	c.TotalCount.fetch_add(1, std::memory_order_relaxed);
+	c.TotalBytes.fetch_add(bytes, std::memory_order_relaxed);
+
+	std::uint64_t peak = c.PeakBytes.load(std::memory_order_relaxed);
+	while (live > peak && !c.PeakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+	{
+	}
+}
+
+void MemoryTracker::OnFree(MemTag tag, std::size_t bytes)
+{
+	TagCounters& c = g_counters[(size_t)tag];
+
+	c.LiveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+	c.LiveCount.fetch_sub(1, std::memory_order_relaxed);
+}
+#endif
+
+void MemoryTracker::BeginFrame()
+{
+	for (TagCounters& c : g_counters)
+	{
+		std::uint64_t count = c.TotalCount.load(std::memory_order_relaxed);
+		std::uint64_t bytes = c.TotalBytes.load(std::memory_order_relaxed);
+
+		c.LastFrameCount.store(count - c.FrameStartCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		c.LastFrameBytes.store(bytes - c.FrameStartBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		c.FrameStartCount.store(count, std::memory_order_relaxed);
+		c.FrameStartBytes.store(bytes, std::memory_order_relaxed);
+	}
+}
+
+MemTagStats MemoryTracker::GetStats(MemTag tag)
+{
+	const TagCounters& c = g_counters[(size_t)tag];
+
+	MemTagStats stats;
+	stats.Name = GetTagName(tag);
+	stats.LiveBytes = c.LiveBytes.load(std::memory_order_relaxed);
+	stats.PeakBytes = c.PeakBytes.load(std::memory_order_relaxed);
+	stats.LiveCount = c.LiveCount.load(std::memory_order_relaxed);
+	stats.TotalCount = c.TotalCount.load(std::memory_order_relaxed);
+	stats.FrameCount = c.LastFrameCount.load(std::memory_order_relaxed);
+	stats.FrameBytes = c.LastFrameBytes.load(std::memory_order_relaxed);
+	return stats;
+}
+
+std::uint64_t MemoryTracker::GetFrameAllocations()
+{
+	std::uint64_t count = 0;
+	for (const TagCounters& c : g_counters)
+		count += c.LastFrameCount.load(std::memory_order_relaxed);
+	return count;
+}
+
+const char* MemoryTracker::GetTagName(MemTag tag)
+{
+	return g_tagNames[(size_t)tag];
+}
+
+std::string MemoryTracker::Report()
+{
+	std::string report;
+	char line[192];
+
+	std::snprintf(line, sizeof(line), "%-12s %12s %12s %10s %12s %10s %12s\n",
+		"Tag", "Live KB", "Peak KB", "Live", "Total", "Frame", "Frame KB");
+	report += line;
+
+	for (size_t i = 0; i < (size_t)MemTag::Count; ++i)
+	{
+		MemTagStats s = GetStats((MemTag)i);
+		std::snprintf(line, sizeof(line), "%-12s %12.1f %12.1f %10llu %12llu %10llu %12.1f\n",
+			s.Name, s.LiveBytes / 1024.0, s.PeakBytes / 1024.0,
+			(unsigned long long)s.LiveCount, (unsigned long long)s.TotalCount,
+			(unsigned long long)s.FrameCount, s.FrameBytes / 1024.0);
+		report += line;
+	}
+
+	return report;
+}
+
+#if MEMORY_TRACKING_ENABLED && defined(MEMORY_TRACKING_GLOBAL_NEW)
+
+// Untagged heap allocations. The size is stored in front of the block since
+// unsized operator delete does not receive it.
+static const std::size_t c_globalHeader = alignof(std::max_align_t);
+
+// Over-aligned blocks keep the size and the address malloc returned in the
+// two words in front of the aligned pointer.
+static const std::size_t c_alignedHeader = 2 * sizeof(void*);
+
+static void* TrackedNew(std::size_t bytes) noexcept
+{
+	void* block = std::malloc(bytes + c_globalHeader);
+	if (block == nullptr)
+		return nullptr;
+
+	*static_cast<std::size_t*>(block) = bytes;
+	MemoryTracker::OnAllocate(MemTag::General, bytes);
+	return static_cast<char*>(block) + c_globalHeader;
+}
+
+static void TrackedDelete(void* p) noexcept
+{
+	if (p == nullptr)
+		return;
+
+	void* block = static_cast<char*>(p) - c_globalHeader;
+	MemoryTracker::OnFree(MemTag::General, *static_cast<std::size_t*>(block));
+	std::free(block);
+}
+
+static void* TrackedAlignedNew(std::size_t bytes, std::align_val_t align) noexcept
+{
+	std::size_t alignment = (std::size_t)align > c_alignedHeader ? (std::size_t)align : c_alignedHeader;
+	char* block = static_cast<char*>(std::malloc(bytes + alignment + c_alignedHeader));
+	if (block == nullptr)
+		return nullptr;
+
+	std::uintptr_t aligned = ((std::uintptr_t)block + c_alignedHeader + alignment - 1) & ~(std::uintptr_t)(alignment - 1);
+	void** header = reinterpret_cast<void**>(aligned) - 2;
+	header[0] = reinterpret_cast<void*>(bytes);
+	header[1] = block;
+	MemoryTracker::OnAllocate(MemTag::General, bytes);
+	return reinterpret_cast<void*>(aligned);
+}
+
+static void TrackedAlignedDelete(void* p) noexcept
+{
+	if (p == nullptr)
+		return;
+
+	void** header = static_cast<void**>(p) - 2;
+	MemoryTracker::OnFree(MemTag::General, reinterpret_cast<std::size_t>(header[0]));
+	std::free(header[1]);
+}
+
+void* operator new(std::size_t bytes)
+{
+	void* p = TrackedNew(bytes);
+	if (p == nullptr)
+		throw std::bad_alloc();
+	return p;
+}
+
+void* operator new(std::size_t bytes, std::align_val_t align)
+{
+	void* p = TrackedAlignedNew(bytes, align);
+	if (p == nullptr)
+		throw std::bad_alloc();
+	return p;
+}
+
+void* operator new[](std::size_t bytes)														{	return operator new(bytes);	}
+void* operator new[](std::size_t bytes, std::align_val_t align)								{	return operator new(bytes, align);	}
+void* operator new(std::size_t bytes, const std::nothrow_t&) noexcept						{	return TrackedNew(bytes);	}
+void* operator new[](std::size_t bytes, const std::nothrow_t&) noexcept						{	return TrackedNew(bytes);	}
+void* operator new(std::size_t bytes, std::align_val_t align, const std::nothrow_t&) noexcept	{	return TrackedAlignedNew(bytes, align);	}
+void* operator new[](std::size_t bytes, std::align_val_t align, const std::nothrow_t&) noexcept	{	return TrackedAlignedNew(bytes, align);	}
+
+void operator delete(void* p) noexcept														{	TrackedDelete(p);	}
+void operator delete[](void* p) noexcept													{	TrackedDelete(p);	}
+void operator delete(void* p, std::size_t) noexcept											{	TrackedDelete(p);	}
+void operator delete[](void* p, std::size_t) noexcept										{	TrackedDelete(p);	}
+void operator delete(void* p, const std::nothrow_t&) noexcept								{	TrackedDelete(p);	}
+void operator delete[](void* p, const std::nothrow_t&) noexcept								{	TrackedDelete(p);	}
+void operator delete(void* p, std::align_val_t) noexcept									{	TrackedAlignedDelete(p);	}
+void operator delete[](void* p, std::align_val_t) noexcept									{	TrackedAlignedDelete(p);	}
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept						{	TrackedAlignedDelete(p);	}
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept					{	TrackedAlignedDelete(p);	}
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept				{	TrackedAlignedDelete(p);	}
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept			{	TrackedAlignedDelete(p);	}
+
+#endif
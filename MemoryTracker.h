@@ -0,0 +1,152 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+// Compile with MEMORY_TRACKING_ENABLED=0 to turn the tracking allocator into
+// plain malloc/free and every counter update into a no-op.
+#ifndef MEMORY_TRACKING_ENABLED
+#define MEMORY_TRACKING_ENABLED 1
+#endif
+
+// Subsystem an allocation is charged to.
+enum class MemTag : std::uint8_t
+{
+	General,		// untagged heap use (only with MEMORY_TRACKING_GLOBAL_NEW)
+	Geometry,		// mesh generation temporaries and CPU copies of vertex/index data
+	RenderItems,	// render items and the containers that own them
+	Shaders,		// shader bytecode
+	Frame,			// per-frame transient data
+	Entities,		// entity/component chunks
+	Count
+};
+
+struct MemTagStats
+{
+	const char*								Name = nullptr;
+	std::uint64_t							LiveBytes = 0;
+	std::uint64_t							PeakBytes = 0;
+	std::uint64_t							LiveCount = 0;
+	std::uint64_t							TotalCount = 0;
+
+	// Allocations made during the last completed frame.
+	std::uint64_t							FrameCount = 0;
+	std::uint64_t							FrameBytes = 0;
+};
+
+// Engine-wide allocation counters, one set per MemTag.
+//
+// Counters are relaxed atomics, each tag on its own cache line, so tagged
+// allocations from several threads do not contend. Memory owned by the API
+// (e.g. ID3DBlob) is charged with RecordExternal/ReleaseExternal.
+//
+// Define MEMORY_TRACKING_GLOBAL_NEW to also route the global operator
+// new/delete (every form: array, sized, aligned and nothrow) through the
+// General tag; that makes the per-frame allocation count cover every heap
+// allocation, which is what the steady-state check in the main loop relies on.
+class MemoryTracker
+{
+public:
+
+	static void*							Allocate(MemTag tag, std::size_t bytes);
+	static void								Free(MemTag tag, void* p, std::size_t bytes);
+
+	static void								RecordExternal(MemTag tag, std::size_t bytes);
+	static void								ReleaseExternal(MemTag tag, std::size_t bytes);
+
+	// Closes the current frame: its allocation counts become the FrameCount and
+	// FrameBytes reported by GetStats().
+	static void								BeginFrame();
+
+	static MemTagStats						GetStats(MemTag tag);
+	// Allocations of every tag during the last completed frame.
+	static std::uint64_t					GetFrameAllocations();
+	static const char*						GetTagName(MemTag tag);
+
+	// One line per tag, human readable.
+	static std::string						Report();
+
+#if MEMORY_TRACKING_ENABLED
+	static void								OnAllocate(MemTag tag, std::size_t bytes);
+	static void								OnFree(MemTag tag, std::size_t bytes);
+#else
+	static void								OnAllocate(MemTag, std::size_t)		{}
+	static void								OnFree(MemTag, std::size_t)			{}
+#endif
+};
+
+inline void* MemoryTracker::Allocate(MemTag tag, std::size_t bytes)
+{
+	// malloc rather than operator new, so a replaced global operator new
+	// does not count the block a second time under General.
+	void* p = std::malloc(bytes);
+	if (p == nullptr)
+		throw std::bad_alloc();
+
+	OnAllocate(tag, bytes);
+	return p;
+}
+
+inline void MemoryTracker::Free(MemTag tag, void* p, std::size_t bytes)
+{
+	if (p == nullptr)
+		return;
+
+	OnFree(tag, bytes);
+	std::free(p);
+}
+
+inline void MemoryTracker::RecordExternal(MemTag tag, std::size_t bytes)
+{
+	OnAllocate(tag, bytes);
+}
+
+inline void MemoryTracker::ReleaseExternal(MemTag tag, std::size_t bytes)
+{
+	OnFree(tag, bytes);
+}
+
+// STL allocator charging every allocation to `Tag`.
+template<typename T, MemTag Tag>
+class TrackingAllocator
+{
+public:
+
+	using value_type = T;
+
+	static_assert(alignof(T) <= alignof(std::max_align_t), "TrackingAllocator does not handle over-aligned types.");
+
+	template<typename U>
+	struct rebind { using other = TrackingAllocator<U, Tag>; };
+
+	TrackingAllocator() noexcept = default;
+	template<typename U>
+	TrackingAllocator(const TrackingAllocator<U, Tag>&) noexcept {}
+
+	T* allocate(std::size_t n)
+	{
+		return static_cast<T*>(MemoryTracker::Allocate(Tag, n * sizeof(T)));
+	}
+
+	void deallocate(T* p, std::size_t n) noexcept
+	{
+		MemoryTracker::Free(Tag, p, n * sizeof(T));
+	}
+
+	template<typename U>
+	bool operator==(const TrackingAllocator<U, Tag>&) const noexcept { return true; }
+	template<typename U>
+	bool operator!=(const TrackingAllocator<U, Tag>&) const noexcept { return false; }
+};
+
+template<typename T, MemTag Tag>
+using TrackedVector = std::vector<T, TrackingAllocator<T, Tag>>;
+
+// Class-level operator new/delete charging instances of a class to `tag`.
+#define MEMORY_TRACKED_CLASS(tag)																	\
+	static void* operator new(std::size_t bytes)	{	return MemoryTracker::Allocate(tag, bytes);	}	\
+	static void operator delete(void* p, std::size_t bytes)	{	MemoryTracker::Free(tag, p, bytes);	}
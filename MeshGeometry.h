@@ -0,0 +1,61 @@
+#pragma once
+#include "MathTypes.h"
+#include "MemoryTracker.h"
+#include "RenderBackend.h"
+#include "StringIdMap.h"
+#include <string>
+#include <vector>
+
+struct SubmeshGeometry
+{
+	UINT IndexCount = 0;
+	UINT StartIndexLocation = 0;
+	INT BaseVertexLocation = 0;
+
+	// Object-space bounding box of the submesh.
+	DirectX::BoundingBox Bounds;
+};
+
+struct MeshGeometry
+{
+	// Give it a name so we can look it up by name.
+	std::string Name;
+
+	// System memory copies, for CPU-side passes such as occlusion culling.
+	// The vertex/index format can be generic: it is up to the client to cast
+	// appropriately. Charged to MemTag::Geometry for as long as they live.
+	TrackedVector<BYTE, MemTag::Geometry> VertexBufferCPU;
+	TrackedVector<BYTE, MemTag::Geometry> IndexBufferCPU;
+
+	std::unique_ptr<GpuBuffer> VertexBufferGPU;
+	std::unique_ptr<GpuBuffer> IndexBufferGPU;
+
+	std::unique_ptr<GpuBuffer> VertexBufferUploader;
+	std::unique_ptr<GpuBuffer> IndexBufferUploader;
+
+	// Data about the buffers.
+	UINT VertexByteStride = 0;
+	UINT VertexBufferByteSize = 0;
+	::IndexFormat IndexFormat = ::IndexFormat::UInt16;
+	UINT IndexBufferByteSize = 0;
+
+	// A MeshGeometry may store multiple geometries in one vertex/index buffer.
+	// Use this container to define the Submesh geometries so we can draw
+	// the Submeshes individually. Keyed by interned name; indexing with a
+	// plain string still works but interns it first.
+	StringIdMap<SubmeshGeometry> DrawArgs;
+
+	// Binds the vertex and index buffers.
+	void SetBuffers(GpuCommandList& commandList) const
+	{
+		commandList.SetVertexBuffer(VertexBufferGPU->GetGpuAddress(), VertexBufferByteSize, VertexByteStride);
+		commandList.SetIndexBuffer(IndexBufferGPU->GetGpuAddress(), IndexBufferByteSize, IndexFormat);
+	}
+
+	// We can free this memory after we finish upload to the GPU.
+	void DisposeUploaders()
+	{
+		VertexBufferUploader = nullptr;
+		IndexBufferUploader = nullptr;
+	}
+};
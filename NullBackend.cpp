@@ -0,0 +1,411 @@
+#include "NullBackend.h"
+#include "GameTimer.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+	// Keeps fake addresses away from null and spaced like placed resources.
+	const GpuAddress c_firstAddress = 0x10000;
+	const std::uint64_t c_addressAlignment = 0x10000;
+}
+
+NullBuffer::NullBuffer(NullRenderDevice& device, std::uint64_t size, GpuBufferUsage usage, GpuAddress address)
+	: m_device(device), m_data(new std::uint8_t[size]()), m_size(size), m_usage(usage), m_address(address)
+{
+}
+
+NullBuffer::~NullBuffer()
+{
+	m_device.Unregister(*this);
+}
+
+NullFence::NullFence(NullRenderDevice& device, std::uint64_t initialValue)
+	: m_device(device), m_completed(initialValue)
+{
+}
+
+NullFence::~NullFence()
+{
+	m_device.Forget(*this);
+}
+
+std::uint64_t NullFence::GetCompletedValue() const
+{
+	m_device.Retire(m_device.m_clock());
+	return m_completed;
+}
+
+void NullFence::Wait(std::uint64_t value)
+{
+	if (GetCompletedValue() >= value)
+		return;
+
+	m_device.m_stats.Stalls++;
+	m_device.WaitForSignal(*this, value);
+}
+
+NullCommandSignature::NullCommandSignature(NullRenderDevice& device, const CommandSignatureDesc& desc, std::uint64_t id)
+	: m_device(device), m_desc(desc), m_id(id)
+{
+}
+
+NullCommandSignature::~NullCommandSignature()
+{
+	m_device.Unregister(*this);
+}
+
+void NullCommandList::Record(NullCommandType type, std::uint64_t a, std::uint64_t b, std::uint64_t c, std::uint64_t d, std::uint64_t e)
+{
+	assert(!m_closed && "Recording into a closed command list.");
+	m_commands.push_back(NullCommand{ type, { a, b, c, d, e } });
+}
+
+void NullCommandList::Reset()
+{
+	m_commands.clear();
+	m_closed = false;
+}
+
+void NullCommandList::Close()
+{
+	assert(!m_closed);
+	m_closed = true;
+}
+
+void NullCommandList::SetPipelineState(std::uint64_t pipelineHash)
+{
+	Record(NullCommandType::SetPipelineState, pipelineHash);
+}
+
+void NullCommandList::SetRootSignature(std::uint64_t rootSignatureHash)
+{
+	Record(NullCommandType::SetRootSignature, rootSignatureHash);
+}
+
+void NullCommandList::SetRootConstantBuffer(std::uint32_t rootParameter, GpuAddress address)
+{
+	Record(NullCommandType::SetRootConstantBuffer, rootParameter, address);
+}
+
+void NullCommandList::SetRootConstant(std::uint32_t rootParameter, std::uint32_t value, std::uint32_t offset)
+{
+	Record(NullCommandType::SetRootConstant, rootParameter, value, offset);
+}
+
+void NullCommandList::SetVertexBuffer(GpuAddress address, std::uint32_t size, std::uint32_t stride)
+{
+	Record(NullCommandType::SetVertexBuffer, address, size, stride);
+}
+
+void NullCommandList::SetIndexBuffer(GpuAddress address, std::uint32_t size, IndexFormat format)
+{
+	Record(NullCommandType::SetIndexBuffer, address, size, (std::uint64_t)format);
+}
+
+void NullCommandList::SetPrimitiveTopology(PrimitiveTopology topology)
+{
+	Record(NullCommandType::SetPrimitiveTopology, (std::uint64_t)topology);
+}
+
+void NullCommandList::DrawIndexedInstanced(std::uint32_t indexCount, std::uint32_t instanceCount,
+	std::uint32_t startIndex, std::int32_t baseVertex, std::uint32_t startInstance)
+{
+	Record(NullCommandType::DrawIndexedInstanced, indexCount, instanceCount, startIndex, (std::uint64_t)(std::int64_t)baseVertex, startInstance);
+}
+
+void NullCommandList::ExecuteIndirect(GpuCommandSignature& signature, std::uint32_t maxCommandCount,
+	GpuBuffer& arguments, std::uint64_t argumentOffset, GpuBuffer* count, std::uint64_t countOffset)
+{
+	const NullCommandSignature& nullSignature = static_cast<const NullCommandSignature&>(signature);
+	assert(argumentOffset + (std::uint64_t)maxCommandCount * signature.GetDesc().ByteStride <= arguments.GetSize()
+		&& (count == nullptr || countOffset + sizeof(std::uint32_t) <= count->GetSize()));
+	Record(NullCommandType::ExecuteIndirect, nullSignature.GetId(), maxCommandCount,
+		arguments.GetGpuAddress() + argumentOffset, count != nullptr ? count->GetGpuAddress() + countOffset : 0);
+}
+
+void NullCommandList::Barrier(GpuBuffer& buffer, ResourceState before, ResourceState after)
+{
+	Record(NullCommandType::Barrier, buffer.GetGpuAddress(), (std::uint64_t)before, (std::uint64_t)after);
+}
+
+void NullCommandList::CopyBuffer(GpuBuffer& destination, std::uint64_t destinationOffset,
+	GpuBuffer& source, std::uint64_t sourceOffset, std::uint64_t size)
+{
+	assert(destinationOffset + size <= destination.GetSize() && sourceOffset + size <= source.GetSize());
+	Record(NullCommandType::CopyBuffer, destination.GetGpuAddress(), destinationOffset, source.GetGpuAddress(), sourceOffset, size);
+}
+
+NullRenderDevice::NullRenderDevice(const NullBackendSettings& settings)
+	: NullRenderDevice(settings,
+		[] { return GameTimer::QueryCounter() * GameTimer::SecondsPerCount(); },
+		[](double seconds) { std::this_thread::sleep_for(std::chrono::duration<double>(seconds)); })
+{
+}
+
+NullRenderDevice::NullRenderDevice(const NullBackendSettings& settings, ClockFn clock, SleepFn sleep)
+	: m_settings(settings), m_clock(std::move(clock)), m_sleep(std::move(sleep)), m_nextAddress(c_firstAddress)
+{
+}
+
+NullRenderDevice::~NullRenderDevice()
+{
+	// Buffers and fences hold a reference to the device.
+	assert(m_buffers.empty() && "Null buffers outlive their device.");
+}
+
+std::unique_ptr<GpuBuffer> NullRenderDevice::CreateBuffer(std::uint64_t size, GpuBufferUsage usage)
+{
+	assert(size > 0);
+
+	GpuAddress address = m_nextAddress;
+	m_nextAddress += (size + c_addressAlignment - 1) / c_addressAlignment * c_addressAlignment;
+
+	auto buffer = std::make_unique<NullBuffer>(*this, size, usage, address);
+	m_buffers[address] = buffer.get();
+	return buffer;
+}
+
+std::unique_ptr<GpuCommandList> NullRenderDevice::CreateCommandList()
+{
+	return std::make_unique<NullCommandList>();
+}
+
+std::unique_ptr<GpuFence> NullRenderDevice::CreateFence(std::uint64_t initialValue)
+{
+	return std::make_unique<NullFence>(*this, initialValue);
+}
+
+std::unique_ptr<GpuCommandSignature> NullRenderDevice::CreateCommandSignature(const CommandSignatureDesc& desc, std::uint64_t /*rootSignatureHash*/)
+{
+	auto signature = std::make_unique<NullCommandSignature>(*this, desc, m_nextSignatureId++);
+	m_signatures[signature->GetId()] = signature.get();
+	return signature;
+}
+
+NullBuffer* NullRenderDevice::FindBuffer(GpuAddress address) const
+{
+	auto it = m_buffers.upper_bound(address);
+	if (it == m_buffers.begin())
+		return nullptr;
+
+	--it;
+	NullBuffer* buffer = it->second;
+	return address < buffer->GetGpuAddress() + buffer->GetSize() ? buffer : nullptr;
+}
+
+void NullRenderDevice::Execute(GpuCommandList& commandList)
+{
+	NullCommandList& list = static_cast<NullCommandList&>(commandList);
+	assert(list.IsClosed() && "Executing a command list that is still open.");
+
+	std::uint64_t draws = 0;
+	DrawState state;
+	for (const NullCommand& command : list.GetCommands())
+	{
+		if (command.Type == NullCommandType::DrawIndexedInstanced)
+		{
+			draws++;
+			if (m_rasterizer != nullptr)
+				QueueDraw(state, command);
+		}
+		else if (command.Type == NullCommandType::SetRootConstantBuffer)
+		{
+			if (command.Operands[0] == 0)
+				state.ObjectConstants = command.Operands[1];
+			else if (command.Operands[0] == 1)
+				state.PassConstants = command.Operands[1];
+		}
+		else if (command.Type == NullCommandType::SetVertexBuffer)
+		{
+			state.VertexBuffer = command;
+		}
+		else if (command.Type == NullCommandType::SetIndexBuffer)
+		{
+			state.IndexBuffer = command;
+		}
+		else if (command.Type == NullCommandType::SetPrimitiveTopology)
+		{
+			state.Topology = (PrimitiveTopology)command.Operands[0];
+		}
+		else if (command.Type == NullCommandType::ExecuteIndirect)
+		{
+			draws += ExecuteIndirect(command, state);
+		}
+		else if (command.Type == NullCommandType::CopyBuffer)
+		{
+			// Draws recorded before the copy read the old contents.
+			FlushDraws();
+
+			NullBuffer* destination = FindBuffer(command.Operands[0]);
+			NullBuffer* source = FindBuffer(command.Operands[2]);
+			assert(destination != nullptr && source != nullptr && "Copy between destroyed buffers.");
+			std::memmove(destination->GetData() + command.Operands[1], source->GetData() + command.Operands[3], (std::size_t)command.Operands[4]);
+			m_stats.Copies++;
+		}
+	}
+
+	FlushDraws();
+
+	m_stats.Submissions++;
+	m_stats.Commands += list.GetCommands().size();
+	m_stats.Draws += draws;
+
+	// The GPU starts on the list once it has finished the previous ones.
+	double start = std::max(m_clock(), m_gpuBusyUntil);
+	m_gpuBusyUntil = start + m_settings.FixedCost + m_settings.DrawCost * (double)draws;
+}
+
+std::uint64_t NullRenderDevice::ExecuteIndirect(const NullCommand& command, DrawState& state)
+{
+	auto it = m_signatures.find(command.Operands[0]);
+	NullBuffer* arguments = FindBuffer(command.Operands[2]);
+	NullBuffer* count = command.Operands[3] != 0 ? FindBuffer(command.Operands[3]) : nullptr;
+	assert(it != m_signatures.end() && arguments != nullptr && (command.Operands[3] == 0 || count != nullptr)
+		&& "ExecuteIndirect reads a signature or buffer that was destroyed.");
+	if (it == m_signatures.end() || arguments == nullptr || (command.Operands[3] != 0 && count == nullptr))
+		return 0;
+
+	const CommandSignatureDesc& desc = it->second->GetDesc();
+	std::uint64_t commandCount = command.Operands[1];
+	if (count != nullptr)
+	{
+		std::uint32_t value;
+		std::memcpy(&value, count->GetData() + (command.Operands[3] - count->GetGpuAddress()), sizeof(value));
+		commandCount = std::min<std::uint64_t>(commandCount, value);
+	}
+
+	std::uint64_t draws = 0;
+	const std::uint8_t* data = arguments->GetData() + (command.Operands[2] - arguments->GetGpuAddress());
+	for (std::uint64_t i = 0; i < commandCount; ++i, data += desc.ByteStride)
+	{
+		const std::uint8_t* argument = data;
+		for (const IndirectArgument& arg : desc.Arguments)
+		{
+			if (arg.Type == IndirectArgumentType::ConstantBufferView)
+			{
+				GpuAddress address;
+				std::memcpy(&address, argument, sizeof(address));
+				if (arg.RootParameter == 0)
+					state.ObjectConstants = address;
+				else if (arg.RootParameter == 1)
+					state.PassConstants = address;
+			}
+			else if (arg.Type == IndirectArgumentType::DrawIndexed)
+			{
+				DrawIndexedArguments drawArgs;
+				std::memcpy(&drawArgs, argument, sizeof(drawArgs));
+				NullCommand draw = { NullCommandType::DrawIndexedInstanced, { drawArgs.IndexCountPerInstance, drawArgs.InstanceCount,
+					drawArgs.StartIndexLocation, (std::uint64_t)(std::int64_t)drawArgs.BaseVertexLocation, drawArgs.StartInstanceLocation } };
+				draws++;
+				if (m_rasterizer != nullptr)
+					QueueDraw(state, draw);
+			}
+			argument += IndirectArgumentSize(arg.Type);
+		}
+	}
+	return draws;
+}
+
+void NullRenderDevice::QueueDraw(const DrawState& state, const NullCommand& draw)
+{
+	assert(state.Topology == PrimitiveTopology::TriangleList && "The reference rasterizer only draws triangle lists.");
+
+	NullBuffer* vertexBuffer = FindBuffer(state.VertexBuffer.Operands[0]);
+	NullBuffer* indexBuffer = FindBuffer(state.IndexBuffer.Operands[0]);
+	NullBuffer* objectBuffer = FindBuffer(state.ObjectConstants);
+	NullBuffer* passBuffer = FindBuffer(state.PassConstants);
+	assert(vertexBuffer != nullptr && indexBuffer != nullptr && objectBuffer != nullptr && passBuffer != nullptr
+		&& "Draw reads a buffer that is not bound or was destroyed.");
+	if (state.Topology != PrimitiveTopology::TriangleList
+		|| vertexBuffer == nullptr || indexBuffer == nullptr || objectBuffer == nullptr || passBuffer == nullptr)
+		return;
+
+	auto data = [](NullBuffer* buffer, GpuAddress address) { return buffer->GetData() + (address - buffer->GetGpuAddress()); };
+
+	ReferenceDraw resolved;
+	std::uint32_t vertexStride = (std::uint32_t)state.VertexBuffer.Operands[2];
+	resolved.Vertices = data(vertexBuffer, state.VertexBuffer.Operands[0]);
+	resolved.VertexStride = vertexStride;
+	resolved.VertexCount = vertexStride != 0 ? (std::uint32_t)state.VertexBuffer.Operands[1] / vertexStride : 0;
+
+	resolved.Format = (IndexFormat)state.IndexBuffer.Operands[2];
+	std::uint32_t indexSize = resolved.Format == IndexFormat::UInt16 ? 2 : 4;
+	std::uint32_t indexCount = (std::uint32_t)draw.Operands[0];
+	std::uint32_t startIndex = (std::uint32_t)draw.Operands[2];
+	assert(((std::uint64_t)startIndex + indexCount) * indexSize <= state.IndexBuffer.Operands[1] && "Draw reads past its index buffer.");
+	resolved.Indices = data(indexBuffer, state.IndexBuffer.Operands[0]) + (std::size_t)startIndex * indexSize;
+	resolved.IndexCount = indexCount;
+	resolved.BaseVertex = (std::int32_t)(std::int64_t)draw.Operands[3];
+
+	resolved.ObjectConstants = reinterpret_cast<const float*>(data(objectBuffer, state.ObjectConstants));
+	resolved.PassConstants = reinterpret_cast<const float*>(data(passBuffer, state.PassConstants));
+
+	// color.hlsl ignores the instance ID, so instances draw the same triangles.
+	for (std::uint64_t instance = 0; instance < draw.Operands[1]; ++instance)
+		m_pendingDraws.push_back(resolved);
+}
+
+void NullRenderDevice::FlushDraws()
+{
+	if (m_pendingDraws.empty())
+		return;
+
+	m_rasterizer->Draw(m_pendingDraws.data(), m_pendingDraws.size());
+	m_pendingDraws.clear();
+}
+
+void NullRenderDevice::Signal(GpuFence& fence, std::uint64_t value)
+{
+	NullFence& nullFence = static_cast<NullFence&>(fence);
+	m_pending.push_back(PendingSignal{ &nullFence, value, m_gpuBusyUntil });
+	Retire(m_clock());
+}
+
+void NullRenderDevice::Retire(double now)
+{
+	// Signals are queued in GPU order, so their times never decrease.
+	auto signal = m_pending.begin();
+	for (; signal != m_pending.end() && signal->Time <= now; ++signal)
+		signal->Fence->m_completed = signal->Value;
+	m_pending.erase(m_pending.begin(), signal);
+}
+
+void NullRenderDevice::WaitForSignal(NullFence& fence, std::uint64_t value)
+{
+	auto it = std::find_if(m_pending.begin(), m_pending.end(),
+		[&](const PendingSignal& signal) { return signal.Fence == &fence && signal.Value >= value; });
+
+	// A real GPU would hang here.
+	assert(it != m_pending.end() && "Waiting on a fence value that was never signaled.");
+	if (it == m_pending.end())
+		return;
+
+	double deadline = it->Time;
+	double now = m_clock();
+	if (deadline > now)
+		m_sleep(deadline - now);
+
+	// The clock may not have moved as far as asked (a fake clock, a short
+	// sleep): the GPU is known to be done, so complete up to the deadline.
+	Retire(std::max(m_clock(), deadline));
+}
+
+void NullRenderDevice::Forget(const NullFence& fence)
+{
+	m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(),
+		[&](const PendingSignal& signal) { return signal.Fence == &fence; }), m_pending.end());
+}
+
+void NullRenderDevice::Unregister(const NullBuffer& buffer)
+{
+	m_buffers.erase(buffer.GetGpuAddress());
+}
+
+void NullRenderDevice::Unregister(const NullCommandSignature& signature)
+{
+	m_signatures.erase(signature.GetId());
+}
@@ -0,0 +1,248 @@
+#pragma once
+#include "RenderBackend.h"
+#include "ReferenceRasterizer.h"
+#include <functional>
+#include <map>
+#include <vector>
+
+// Headless backend: no GPU, no window. Buffers live in host memory at fake
+// GPU addresses, command lists record what they are given, and the queue
+// runs a simulated GPU timeline to decide when fences complete.
+//
+// Executing a list applies its copies at once. Draws are only counted,
+// unless SetRasterizer() gave the device a ReferenceRasterizer, which then
+// draws them into its own targets. The list's cost (FixedCost plus DrawCost
+// per draw) is appended to the GPU timeline, and a fence signaled after it
+// completes when the clock passes the end of that work. With the default zero costs every fence
+// completes as it is signaled, which measures the CPU side alone.
+//
+// Clock and sleep are injectable, as for FrameLimiter, so tests can drive
+// the timeline deterministically. Not thread-safe: one recording thread.
+
+struct NullBackendSettings
+{
+	double									FixedCost = 0.0;		// seconds per executed list
+	double									DrawCost = 0.0;			// seconds per draw
+};
+
+enum class NullCommandType : std::uint8_t
+{
+	SetPipelineState,			// hash
+	SetRootSignature,			// hash
+	SetRootConstantBuffer,		// root parameter, address
+	SetRootConstant,			// root parameter, value, offset
+	SetVertexBuffer,			// address, size, stride
+	SetIndexBuffer,				// address, size, format
+	SetPrimitiveTopology,		// topology
+	DrawIndexedInstanced,		// index count, instance count, start index, base vertex, start instance
+	Barrier,					// address, before, after
+	CopyBuffer,					// destination, destination offset, source, source offset, size
+	ExecuteIndirect,			// signature id, max command count, argument address, count address or 0
+};
+
+struct NullCommand
+{
+	NullCommandType							Type;
+	std::uint64_t							Operands[5] = {};
+};
+
+struct NullQueueStats
+{
+	std::uint64_t							Submissions = 0;
+	std::uint64_t							Commands = 0;
+	std::uint64_t							Draws = 0;
+	std::uint64_t							Copies = 0;
+	// Waits that found their fence not yet complete.
+	std::uint64_t							Stalls = 0;
+};
+
+class NullRenderDevice;
+
+class NullBuffer : public GpuBuffer
+{
+public:
+
+											NullBuffer(NullRenderDevice& device, std::uint64_t size, GpuBufferUsage usage, GpuAddress address);
+											~NullBuffer() override;
+
+	std::uint8_t*							GetMappedData()		override	{	return m_usage == GpuBufferUsage::Upload ? m_data.get() : nullptr;	}
+	GpuAddress								GetGpuAddress()		const override	{	return m_address;	}
+	std::uint64_t							GetSize()			const override	{	return m_size;	}
+	GpuBufferUsage							GetUsage()			const override	{	return m_usage;	}
+
+	// Contents of either kind of buffer, as the simulated GPU sees them.
+	std::uint8_t*							GetData()			{	return m_data.get();	}
+
+private:
+
+	NullRenderDevice&						m_device;
+	std::unique_ptr<std::uint8_t[]>			m_data;
+	std::uint64_t							m_size;
+	GpuBufferUsage							m_usage;
+	GpuAddress								m_address;
+};
+
+class NullFence : public GpuFence
+{
+public:
+
+											NullFence(NullRenderDevice& device, std::uint64_t initialValue);
+											~NullFence() override;
+
+	std::uint64_t							GetCompletedValue()	const override;
+	void									Wait(std::uint64_t value) override;
+
+private:
+
+	friend class NullRenderDevice;
+
+	NullRenderDevice&						m_device;
+	std::uint64_t							m_completed;
+};
+
+class NullCommandSignature : public GpuCommandSignature
+{
+public:
+
+											NullCommandSignature(NullRenderDevice& device, const CommandSignatureDesc& desc, std::uint64_t id);
+											~NullCommandSignature() override;
+
+	const CommandSignatureDesc&				GetDesc()			const override	{	return m_desc;	}
+	// Names the signature in recorded commands.
+	std::uint64_t							GetId()				const	{	return m_id;	}
+
+private:
+
+	NullRenderDevice&						m_device;
+	CommandSignatureDesc					m_desc;
+	std::uint64_t							m_id;
+};
+
+class NullCommandList : public GpuCommandList
+{
+public:
+
+	void									Reset() override;
+	void									Close() override;
+
+	void									SetPipelineState(std::uint64_t pipelineHash) override;
+	void									SetRootSignature(std::uint64_t rootSignatureHash) override;
+	void									SetRootConstantBuffer(std::uint32_t rootParameter, GpuAddress address) override;
+	void									SetRootConstant(std::uint32_t rootParameter, std::uint32_t value, std::uint32_t offset) override;
+
+	void									SetVertexBuffer(GpuAddress address, std::uint32_t size, std::uint32_t stride) override;
+	void									SetIndexBuffer(GpuAddress address, std::uint32_t size, IndexFormat format) override;
+	void									SetPrimitiveTopology(PrimitiveTopology topology) override;
+	void									DrawIndexedInstanced(std::uint32_t indexCount, std::uint32_t instanceCount,
+												std::uint32_t startIndex, std::int32_t baseVertex, std::uint32_t startInstance) override;
+	void									ExecuteIndirect(GpuCommandSignature& signature, std::uint32_t maxCommandCount,
+												GpuBuffer& arguments, std::uint64_t argumentOffset,
+												GpuBuffer* count, std::uint64_t countOffset) override;
+
+	void									Barrier(GpuBuffer& buffer, ResourceState before, ResourceState after) override;
+	void									CopyBuffer(GpuBuffer& destination, std::uint64_t destinationOffset,
+												GpuBuffer& source, std::uint64_t sourceOffset, std::uint64_t size) override;
+
+	// Commands recorded since the last Reset, kept after execution.
+	const std::vector<NullCommand>&			GetCommands()		const	{	return m_commands;	}
+	bool									IsClosed()			const	{	return m_closed;	}
+
+private:
+
+	void									Record(NullCommandType type, std::uint64_t a = 0, std::uint64_t b = 0,
+												std::uint64_t c = 0, std::uint64_t d = 0, std::uint64_t e = 0);
+
+	std::vector<NullCommand>				m_commands;
+	bool									m_closed = false;
+};
+
+class NullRenderDevice : public RenderDevice, public GpuQueue
+{
+public:
+
+	using ClockFn = std::function<double()>;			// seconds, monotonic
+	using SleepFn = std::function<void(double)>;		// seconds
+
+											NullRenderDevice(const NullBackendSettings& settings = NullBackendSettings());
+											NullRenderDevice(const NullBackendSettings& settings, ClockFn clock, SleepFn sleep);
+											NullRenderDevice(const NullRenderDevice& rhs) = delete;
+											NullRenderDevice& operator=(const NullRenderDevice& rhs) = delete;
+											~NullRenderDevice() override;
+
+	std::unique_ptr<GpuBuffer>				CreateBuffer(std::uint64_t size, GpuBufferUsage usage) override;
+	std::unique_ptr<GpuCommandList>			CreateCommandList() override;
+	std::unique_ptr<GpuFence>				CreateFence(std::uint64_t initialValue = 0) override;
+	// The root signature is ignored, as it is for draws.
+	std::unique_ptr<GpuCommandSignature>	CreateCommandSignature(const CommandSignatureDesc& desc, std::uint64_t rootSignatureHash) override;
+	GpuQueue&								GetQueue() override		{	return *this;	}
+
+	void									Execute(GpuCommandList& commandList) override;
+	void									Signal(GpuFence& fence, std::uint64_t value) override;
+
+	// Buffer containing `address`, or nullptr.
+	NullBuffer*								FindBuffer(GpuAddress address)	const;
+
+	// While set, executed draws are rasterized as color.hlsl draws them, with
+	// root parameter 0 as cbPerObject and 1 as cbPass. Pipeline and root
+	// signature hashes are ignored. nullptr stops drawing.
+	void									SetRasterizer(ReferenceRasterizer* rasterizer)	{	m_rasterizer = rasterizer;	}
+
+	const NullQueueStats&					GetStats()			const	{	return m_stats;	}
+	void									ResetStats()				{	m_stats = NullQueueStats();	}
+
+private:
+
+	friend class NullBuffer;
+	friend class NullFence;
+	friend class NullCommandSignature;
+
+	struct PendingSignal
+	{
+		NullFence*							Fence;
+		std::uint64_t						Value;
+		double								Time;
+	};
+
+	// Completes the signals whose work has finished by `now`.
+	void									Retire(double now);
+	void									WaitForSignal(NullFence& fence, std::uint64_t value);
+	void									Forget(const NullFence& fence);
+	void									Unregister(const NullBuffer& buffer);
+	void									Unregister(const NullCommandSignature& signature);
+	// What a list has set so far that the rasterizer needs.
+	struct DrawState
+	{
+		GpuAddress							ObjectConstants = 0;
+		GpuAddress							PassConstants = 0;
+		NullCommand							VertexBuffer = { NullCommandType::SetVertexBuffer };
+		NullCommand							IndexBuffer = { NullCommandType::SetIndexBuffer };
+		PrimitiveTopology					Topology = PrimitiveTopology::TriangleList;
+	};
+
+	// Queues the draw for the rasterizer with pointers to the memory it reads.
+	void									QueueDraw(const DrawState& state, const NullCommand& draw);
+	void									FlushDraws();
+	// Runs the commands of an ExecuteIndirect as if each had been recorded
+	// directly; returns the number of draws.
+	std::uint64_t							ExecuteIndirect(const NullCommand& command, DrawState& state);
+
+	NullBackendSettings						m_settings;
+	ClockFn									m_clock;
+	SleepFn									m_sleep;
+
+	// Time the simulated GPU finishes the work executed so far.
+	double									m_gpuBusyUntil = 0.0;
+	// A vector rather than a deque: it holds a few frames' signals at most,
+	// and keeps its capacity, so steady-state frames do not allocate.
+	std::vector<PendingSignal>				m_pending;
+
+	GpuAddress								m_nextAddress;
+	std::map<GpuAddress, NullBuffer*>		m_buffers;
+	std::uint64_t							m_nextSignatureId = 1;
+	std::map<std::uint64_t, NullCommandSignature*>	m_signatures;
+
+	ReferenceRasterizer*					m_rasterizer = nullptr;
+	std::vector<ReferenceDraw>				m_pendingDraws;
+
+	NullQueueStats							m_stats;
+};
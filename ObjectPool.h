@@ -0,0 +1,160 @@
+#pragma once
+#include "MemoryTracker.h"
+#include <cassert>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+// Reference to an object of an ObjectPool. The generation changes every time
+// the slot is reused, so a handle to a destroyed object never resolves to
+// whatever took its slot.
+struct PoolHandle
+{
+	static constexpr std::uint32_t			InvalidIndex = 0xffffffffu;
+
+	std::uint32_t							Index = InvalidIndex;
+	std::uint32_t							Generation = 0;
+
+	bool									IsValid()							const	{	return Index != InvalidIndex;	}
+	bool									operator==(const PoolHandle& rhs)	const	{	return Index == rhs.Index && Generation == rhs.Generation;	}
+	bool									operator!=(const PoolHandle& rhs)	const	{	return !(*this == rhs);	}
+};
+
+// Fixed-capacity pool of T.
+//
+// Live objects are stored packed in one array, so walking Items() is a
+// linear read of the objects themselves. Destroy moves the last object into
+// the hole, so a pointer from Get() is only valid until the next Destroy;
+// hold on to the handle instead. Handles go through a slot index that never
+// moves: freed slots go on a free list and are reused first, and a slot's
+// entry gives the object's current position in the packed array. Create and
+// Destroy are O(1).
+//
+// The slot index is stable for the lifetime of an object and below
+// Capacity(), so it can double as an index into per-object GPU arrays.
+template<typename T, MemTag Tag = MemTag::General>
+class ObjectPool
+{
+public:
+
+	explicit ObjectPool(std::uint32_t capacity)
+		: m_capacity(capacity)
+	{
+		m_generation.resize(capacity, 0);
+		m_denseIndex.resize(capacity, PoolHandle::InvalidIndex);
+		// Reserved once: objects only ever move on Destroy.
+		m_dense.reserve(capacity);
+		m_denseSlot.reserve(capacity);
+
+		// Lowest slots first, so a fresh pool hands out 0, 1, 2...
+		m_freeList.reserve(capacity);
+		for (std::uint32_t i = capacity; i > 0; --i)
+			m_freeList.push_back(i - 1);
+	}
+
+	ObjectPool(const ObjectPool& rhs) = delete;
+	ObjectPool& operator=(const ObjectPool& rhs) = delete;
+
+	~ObjectPool()
+	{
+		Clear();
+	}
+
+	// Returns an invalid handle when the pool is full.
+	template<typename... Args>
+	PoolHandle Create(Args&&... args)
+	{
+		if (m_freeList.empty())
+			return PoolHandle();
+
+		std::uint32_t slot = m_freeList.back();
+		m_freeList.pop_back();
+
+		m_denseIndex[slot] = (std::uint32_t)m_dense.size();
+		m_dense.emplace_back(std::forward<Args>(args)...);
+		m_denseSlot.push_back(slot);
+
+		PoolHandle handle;
+		handle.Index = slot;
+		handle.Generation = m_generation[slot];
+		return handle;
+	}
+
+	// Returns false if the handle was already stale.
+	bool Destroy(PoolHandle handle)
+	{
+		if (!IsAlive(handle))
+			return false;
+
+		std::uint32_t slot = handle.Index;
+		std::uint32_t dense = m_denseIndex[slot];
+
+		// Move the last object into the hole.
+		std::uint32_t last = (std::uint32_t)m_dense.size() - 1;
+		if (dense != last)
+		{
+			m_dense[dense] = std::move(m_dense[last]);
+			m_denseSlot[dense] = m_denseSlot[last];
+			m_denseIndex[m_denseSlot[dense]] = dense;
+		}
+		m_dense.pop_back();
+		m_denseSlot.pop_back();
+
+		m_denseIndex[slot] = PoolHandle::InvalidIndex;
+		m_generation[slot]++;
+		m_freeList.push_back(slot);
+		return true;
+	}
+
+	void Clear()
+	{
+		while (!m_dense.empty())
+			Destroy(HandleAt((std::uint32_t)m_dense.size() - 1));
+	}
+
+	bool IsAlive(PoolHandle handle) const
+	{
+		return handle.Index < m_capacity
+			&& m_denseIndex[handle.Index] != PoolHandle::InvalidIndex
+			&& m_generation[handle.Index] == handle.Generation;
+	}
+
+	// nullptr if the handle is stale. Valid until the next Destroy.
+	T* Get(PoolHandle handle)
+	{
+		return IsAlive(handle) ? &m_dense[m_denseIndex[handle.Index]] : nullptr;
+	}
+	const T* Get(PoolHandle handle) const
+	{
+		return IsAlive(handle) ? &m_dense[m_denseIndex[handle.Index]] : nullptr;
+	}
+
+	// Handle of the i-th object of Items().
+	PoolHandle HandleAt(std::uint32_t denseIndex) const
+	{
+		PoolHandle handle;
+		handle.Index = m_denseSlot[denseIndex];
+		handle.Generation = m_generation[handle.Index];
+		return handle;
+	}
+
+	// Live objects, packed, in no particular order.
+	std::span<T>							Items()					{	return m_dense;	}
+	std::span<const T>						Items()			const	{	return m_dense;	}
+	std::uint32_t							Size()			const	{	return (std::uint32_t)m_dense.size();	}
+	std::uint32_t							Capacity()		const	{	return m_capacity;	}
+	bool									Full()			const	{	return m_freeList.empty();	}
+
+private:
+
+	std::uint32_t							m_capacity;
+
+	// Indexed by slot.
+	TrackedVector<std::uint32_t, Tag>		m_generation;
+	TrackedVector<std::uint32_t, Tag>		m_denseIndex;		// InvalidIndex when the slot is free
+	TrackedVector<std::uint32_t, Tag>		m_freeList;
+
+	// Indexed by dense position.
+	TrackedVector<T, Tag>					m_dense;
+	TrackedVector<std::uint32_t, Tag>		m_denseSlot;
+};
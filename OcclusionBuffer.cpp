@@ -0,0 +1,637 @@
+#include "OcclusionBuffer.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <execution>
+#include <limits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#else
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	// Rows of pixels are filled LaneCount at a time. Coverage is the sign
+	// bit of the three edge functions ORed together: set means outside.
+#if defined(__AVX2__)
+	const int LaneCount = 8;
+	using FloatLanes = __m256;
+	using IntLanes = __m256i;
+
+	FloatLanes SplatF(float value)								{	return _mm256_set1_ps(value);	}
+	IntLanes SplatI(std::int32_t value)							{	return _mm256_set1_epi32(value);	}
+	FloatLanes LaneOffsetsF()									{	return _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);	}
+	IntLanes LaneMultiplesI(std::int32_t s)						{	return _mm256_setr_epi32(0, s, 2 * s, 3 * s, 4 * s, 5 * s, 6 * s, 7 * s);	}
+	FloatLanes LoadF(const float* p)							{	return _mm256_loadu_ps(p);	}
+	void StoreF(float* p, FloatLanes v)							{	_mm256_storeu_ps(p, v);	}
+	FloatLanes AddF(FloatLanes a, FloatLanes b)					{	return _mm256_add_ps(a, b);	}
+	FloatLanes MulF(FloatLanes a, FloatLanes b)					{	return _mm256_mul_ps(a, b);	}
+	FloatLanes MinF(FloatLanes a, FloatLanes b)					{	return _mm256_min_ps(a, b);	}
+	FloatLanes MaxF(FloatLanes a, FloatLanes b)					{	return _mm256_max_ps(a, b);	}
+	IntLanes AddI(IntLanes a, IntLanes b)						{	return _mm256_add_epi32(a, b);	}
+	IntLanes OrI(IntLanes a, IntLanes b)						{	return _mm256_or_si256(a, b);	}
+	int OutsideMask(IntLanes edges)								{	return _mm256_movemask_ps(_mm256_castsi256_ps(edges));	}
+	// `outside` where the edge sign bit is set, `inside` elsewhere.
+	FloatLanes Select(IntLanes edges, FloatLanes inside, FloatLanes outside)
+	{
+		return _mm256_blendv_ps(inside, outside, _mm256_castsi256_ps(edges));
+	}
+	int GreaterEqualMask(FloatLanes a, FloatLanes b)			{	return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GE_OQ));	}
+	float HorizontalMax(FloatLanes v)
+	{
+		__m128 m = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+		m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+		m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+		return _mm_cvtss_f32(m);
+	}
+#else
+	const int LaneCount = 4;
+	using FloatLanes = __m128;
+	using IntLanes = __m128i;
+
+	FloatLanes SplatF(float value)								{	return _mm_set1_ps(value);	}
+	IntLanes SplatI(std::int32_t value)							{	return _mm_set1_epi32(value);	}
+	FloatLanes LaneOffsetsF()									{	return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);	}
+	IntLanes LaneMultiplesI(std::int32_t s)						{	return _mm_setr_epi32(0, s, 2 * s, 3 * s);	}
+	FloatLanes LoadF(const float* p)							{	return _mm_loadu_ps(p);	}
+	void StoreF(float* p, FloatLanes v)							{	_mm_storeu_ps(p, v);	}
+	FloatLanes AddF(FloatLanes a, FloatLanes b)					{	return _mm_add_ps(a, b);	}
+	FloatLanes MulF(FloatLanes a, FloatLanes b)					{	return _mm_mul_ps(a, b);	}
+	FloatLanes MinF(FloatLanes a, FloatLanes b)					{	return _mm_min_ps(a, b);	}
+	FloatLanes MaxF(FloatLanes a, FloatLanes b)					{	return _mm_max_ps(a, b);	}
+	IntLanes AddI(IntLanes a, IntLanes b)						{	return _mm_add_epi32(a, b);	}
+	IntLanes OrI(IntLanes a, IntLanes b)						{	return _mm_or_si128(a, b);	}
+	int OutsideMask(IntLanes edges)								{	return _mm_movemask_ps(_mm_castsi128_ps(edges));	}
+	FloatLanes Select(IntLanes edges, FloatLanes inside, FloatLanes outside)
+	{
+		__m128 mask = _mm_castsi128_ps(_mm_srai_epi32(edges, 31));
+		return _mm_or_ps(_mm_and_ps(mask, outside), _mm_andnot_ps(mask, inside));
+	}
+	int GreaterEqualMask(FloatLanes a, FloatLanes b)			{	return _mm_movemask_ps(_mm_cmpge_ps(a, b));	}
+	float HorizontalMax(FloatLanes v)
+	{
+		__m128 m = _mm_max_ps(v, _mm_movehl_ps(v, v));
+		m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+		return _mm_cvtss_f32(m);
+	}
+#endif
+
+	const int AllLanes = (1 << LaneCount) - 1;
+
+	float HorizontalMin4(__m128 v)
+	{
+		__m128 m = _mm_min_ps(v, _mm_movehl_ps(v, v));
+		return _mm_cvtss_f32(_mm_min_ss(m, _mm_shuffle_ps(m, m, 1)));
+	}
+
+	float HorizontalMax4(__m128 v)
+	{
+		__m128 m = _mm_max_ps(v, _mm_movehl_ps(v, v));
+		return _mm_cvtss_f32(_mm_max_ss(m, _mm_shuffle_ps(m, m, 1)));
+	}
+
+	// 1/8 pixel.
+	const int SubpixelBits = 3;
+	const float SubpixelScale = (float)(1 << SubpixelBits);
+
+	// Triangles are clipped to a guard band twice the size of the view, which
+	// keeps snapped coordinates below 2^14 for buffers up to MaxSize.
+	const float GuardBand = 2.0f;
+
+	enum Outcode : std::uint32_t
+	{
+		OutNear			= 1 << 0,
+		OutFar			= 1 << 1,
+		OutLeft			= 1 << 2,
+		OutRight		= 1 << 3,
+		OutBottom		= 1 << 4,
+		OutTop			= 1 << 5,
+		OutGuardLeft	= 1 << 6,
+		OutGuardRight	= 1 << 7,
+		OutGuardBottom	= 1 << 8,
+		OutGuardTop		= 1 << 9,
+
+		// Triangles entirely out of one of these are dropped.
+		OutView			= OutNear | OutFar | OutLeft | OutRight | OutBottom | OutTop,
+		// Triangles crossing one of these are clipped.
+		OutClip			= OutNear | OutFar | OutGuardLeft | OutGuardRight | OutGuardBottom | OutGuardTop,
+	};
+
+	std::uint32_t ComputeOutcode(const float* v)
+	{
+		float x = v[0], y = v[1], z = v[2], w = v[3];
+		float guard = GuardBand * w;
+
+		std::uint32_t code = 0;
+		if (z < 0.0f)
+			code |= OutNear;
+		if (z > w)
+			code |= OutFar;
+		if (x < -w)
+			code |= OutLeft;
+		if (x > w)
+			code |= OutRight;
+		if (y < -w)
+			code |= OutBottom;
+		if (y > w)
+			code |= OutTop;
+		if (x < -guard)
+			code |= OutGuardLeft;
+		if (x > guard)
+			code |= OutGuardRight;
+		if (y < -guard)
+			code |= OutGuardBottom;
+		if (y > guard)
+			code |= OutGuardTop;
+		return code;
+	}
+
+	// Signed distance to the planes of OutClip, >= 0 inside.
+	float PlaneDistance(const float* v, int plane)
+	{
+		switch (plane)
+		{
+		case 0:		return v[2];
+		case 1:		return v[3] - v[2];
+		case 2:		return v[0] + GuardBand * v[3];
+		case 3:		return GuardBand * v[3] - v[0];
+		case 4:		return v[1] + GuardBand * v[3];
+		default:	return GuardBand * v[3] - v[1];
+		}
+	}
+
+	// out = a * b, row-major.
+	void Multiply(const float* a, const float* b, float* out)
+	{
+		for (int row = 0; row < 4; ++row)
+		{
+			for (int column = 0; column < 4; ++column)
+			{
+				out[row * 4 + column] = a[row * 4 + 0] * b[0 * 4 + column] + a[row * 4 + 1] * b[1 * 4 + column]
+					+ a[row * 4 + 2] * b[2 * 4 + column] + a[row * 4 + 3] * b[3 * 4 + column];
+			}
+		}
+	}
+}
+
+OcclusionBuffer::OcclusionBuffer(std::uint32_t width, std::uint32_t height)
+{
+	Resize(width, height);
+}
+
+void OcclusionBuffer::Resize(std::uint32_t width, std::uint32_t height)
+{
+	assert(width > 0 && width <= MaxSize && height > 0 && height <= MaxSize);
+
+	m_width = (width + BlockSize - 1) / BlockSize * BlockSize;
+	m_height = (height + BlockSize - 1) / BlockSize * BlockSize;
+	m_tilesX = (m_width + TileWidth - 1) / TileWidth;
+	m_tilesY = (m_height + TileHeight - 1) / TileHeight;
+
+	m_depth.assign((std::size_t)m_width * m_height, 1.0f);
+	m_blockMax.assign((std::size_t)(m_width / BlockSize) * (m_height / BlockSize), 1.0f);
+	m_bins.assign((std::size_t)m_tilesX * m_tilesY, std::vector<std::uint32_t>());
+	m_triangles.clear();
+}
+
+void OcclusionBuffer::BeginFrame(const float* viewProj)
+{
+	std::copy(viewProj, viewProj + 16, m_viewProj);
+
+	std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+	std::fill(m_blockMax.begin(), m_blockMax.end(), 1.0f);
+	for (std::vector<std::uint32_t>& bin : m_bins)
+		bin.clear();
+	m_triangles.clear();
+	m_stats = OcclusionStats();
+}
+
+void OcclusionBuffer::AddOccluder(const float* world, const void* vertices, std::uint32_t vertexStride,
+	const std::uint16_t* indices, std::uint32_t indexCount, std::int32_t baseVertex)
+{
+	PROFILE_FUNCTION();
+
+	if (indexCount < 3)
+		return;
+
+	float worldViewProj[16];
+	Multiply(world, m_viewProj, worldViewProj);
+
+	// Every vertex the indices reach is transformed once.
+	auto range = std::minmax_element(indices, indices + indexCount);
+	std::int32_t first = baseVertex + *range.first;
+	std::int32_t count = *range.second - *range.first + 1;
+	assert(first >= 0);
+
+	m_clipVertices.resize((std::size_t)count * 4);
+	m_outcodes.resize((std::size_t)count);
+	m_screenVertices.resize((std::size_t)count);
+
+	__m128 row0 = _mm_loadu_ps(worldViewProj + 0);
+	__m128 row1 = _mm_loadu_ps(worldViewProj + 4);
+	__m128 row2 = _mm_loadu_ps(worldViewProj + 8);
+	__m128 row3 = _mm_loadu_ps(worldViewProj + 12);
+
+	const std::uint8_t* bytes = static_cast<const std::uint8_t*>(vertices) + (std::size_t)first * vertexStride;
+	for (std::int32_t i = 0; i < count; ++i, bytes += vertexStride)
+	{
+		const float* position = reinterpret_cast<const float*>(bytes);
+		__m128 clip = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(_mm_set1_ps(position[0]), row0), _mm_mul_ps(_mm_set1_ps(position[1]), row1)),
+			_mm_add_ps(_mm_mul_ps(_mm_set1_ps(position[2]), row2), row3));
+
+		float* out = &m_clipVertices[(std::size_t)i * 4];
+		_mm_storeu_ps(out, clip);
+		m_outcodes[i] = ComputeOutcode(out);
+
+		// Shared by about six triangles in a closed mesh.
+		if ((m_outcodes[i] & OutClip) == 0)
+			m_screenVertices[i] = Project(out);
+	}
+
+	std::uint32_t indexBias = *range.first;
+	for (std::uint32_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		std::uint32_t i0 = indices[i + 0] - indexBias;
+		std::uint32_t i1 = indices[i + 1] - indexBias;
+		std::uint32_t i2 = indices[i + 2] - indexBias;
+
+		std::uint32_t o0 = m_outcodes[i0], o1 = m_outcodes[i1], o2 = m_outcodes[i2];
+		if ((o0 & o1 & o2 & OutView) != 0)
+			continue;
+
+		if (((o0 | o1 | o2) & OutClip) != 0)
+		{
+			ClipTriangle(&m_clipVertices[(std::size_t)i0 * 4], &m_clipVertices[(std::size_t)i1 * 4], &m_clipVertices[(std::size_t)i2 * 4]);
+			continue;
+		}
+
+		EmitTriangle(m_screenVertices[i0], m_screenVertices[i1], m_screenVertices[i2]);
+	}
+
+	m_stats.Occluders++;
+}
+
+void OcclusionBuffer::ClipTriangle(const float* a, const float* b, const float* c)
+{
+	// Sutherland-Hodgman: each plane adds at most one vertex.
+	const int MaxVertices = 3 + 6;
+	float buffers[2][MaxVertices][4];
+	int count = 3;
+	std::copy(a, a + 4, buffers[0][0]);
+	std::copy(b, b + 4, buffers[0][1]);
+	std::copy(c, c + 4, buffers[0][2]);
+
+	int current = 0;
+	for (int plane = 0; plane < 6 && count >= 3; ++plane)
+	{
+		const float (*in)[4] = buffers[current];
+		float (*out)[4] = buffers[current ^ 1];
+		int outCount = 0;
+
+		for (int i = 0; i < count; ++i)
+		{
+			const float* p = in[i];
+			const float* q = in[(i + 1) % count];
+			float dp = PlaneDistance(p, plane);
+			float dq = PlaneDistance(q, plane);
+
+			if (dp >= 0.0f)
+				std::copy(p, p + 4, out[outCount++]);
+			if ((dp >= 0.0f) != (dq >= 0.0f))
+			{
+				// Always from the inside vertex, so that the two triangles
+				// sharing the edge compute the same point and leave no crack.
+				const float* from = dp >= 0.0f ? p : q;
+				const float* to = dp >= 0.0f ? q : p;
+				float dFrom = dp >= 0.0f ? dp : dq;
+				float dTo = dp >= 0.0f ? dq : dp;
+				float t = dFrom / (dFrom - dTo);
+				for (int k = 0; k < 4; ++k)
+					out[outCount][k] = from[k] + t * (to[k] - from[k]);
+				outCount++;
+			}
+		}
+
+		count = outCount;
+		current ^= 1;
+	}
+
+	if (count < 3)
+		return;
+
+	ScreenVertex first = Project(buffers[current][0]);
+	ScreenVertex previous = Project(buffers[current][1]);
+	for (int i = 2; i < count; ++i)
+	{
+		ScreenVertex next = Project(buffers[current][i]);
+		EmitTriangle(first, previous, next);
+		previous = next;
+	}
+}
+
+OcclusionBuffer::ScreenVertex OcclusionBuffer::Project(const float* clip) const
+{
+	float invW = 1.0f / clip[3];
+	float sx = (clip[0] * invW * 0.5f + 0.5f) * (float)m_width;
+	float sy = (0.5f - clip[1] * invW * 0.5f) * (float)m_height;
+
+	// Rounded to nearest by the conversion itself.
+	ScreenVertex vertex;
+	vertex.X = _mm_cvtss_si32(_mm_set_ss(sx * SubpixelScale));
+	vertex.Y = _mm_cvtss_si32(_mm_set_ss(sy * SubpixelScale));
+	vertex.ExactX = sx;
+	vertex.ExactY = sy;
+	vertex.Z = std::clamp(clip[2] * invW, 0.0f, 1.0f);
+	return vertex;
+}
+
+void OcclusionBuffer::EmitTriangle(const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c)
+{
+	const std::int32_t x[3] = { a.X, b.X, c.X };
+	const std::int32_t y[3] = { a.Y, b.Y, c.Y };
+	const float z[3] = { a.Z, b.Z, c.Z };
+
+	// Positive for clockwise triangles on screen, which are front faces.
+	std::int64_t area = (std::int64_t)(x[1] - x[0]) * (y[2] - y[0]) - (std::int64_t)(y[1] - y[0]) * (x[2] - x[0]);
+	if (area <= 0)
+		return;
+
+	// Pixels whose center is inside the bounding box; small triangles often
+	// have none and are dropped here.
+	const std::int32_t half = 1 << (SubpixelBits - 1);
+	Triangle triangle;
+	triangle.MinX = std::max((std::min({ x[0], x[1], x[2] }) - half + (1 << SubpixelBits) - 1) >> SubpixelBits, 0);
+	triangle.MinY = std::max((std::min({ y[0], y[1], y[2] }) - half + (1 << SubpixelBits) - 1) >> SubpixelBits, 0);
+	triangle.MaxX = std::min((std::max({ x[0], x[1], x[2] }) - half) >> SubpixelBits, (std::int32_t)m_width - 1);
+	triangle.MaxY = std::min((std::max({ y[0], y[1], y[2] }) - half) >> SubpixelBits, (std::int32_t)m_height - 1);
+	if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY)
+		return;
+
+	for (int i = 0; i < 3; ++i)
+	{
+		int j = (i + 1) % 3;
+		triangle.A[i] = y[i] - y[j];
+		triangle.B[i] = x[j] - x[i];
+		triangle.C[i] = x[i] * y[j] - y[i] * x[j];
+
+		// Top-left rule: pixel centers exactly on an edge belong to the
+		// triangle only if the edge is a top or a left edge.
+		bool topLeft = triangle.A[i] > 0 || (triangle.A[i] == 0 && triangle.B[i] > 0);
+		if (!topLeft)
+			triangle.C[i] -= 1;
+	}
+
+	// Depth plane in pixels, through the exact positions unless snapping
+	// turned the triangle over.
+	double x0 = a.ExactX, y0 = a.ExactY;
+	double dx1 = (double)b.ExactX - x0, dy1 = (double)b.ExactY - y0;
+	double dx2 = (double)c.ExactX - x0, dy2 = (double)c.ExactY - y0;
+	if (dx1 * dy2 - dy1 * dx2 <= 0.0)
+	{
+		double scale = 1.0 / SubpixelScale;
+		x0 = x[0] * scale;
+		y0 = y[0] * scale;
+		dx1 = (x[1] - x[0]) * scale;
+		dy1 = (y[1] - y[0]) * scale;
+		dx2 = (x[2] - x[0]) * scale;
+		dy2 = (y[2] - y[0]) * scale;
+	}
+	double dz1 = (double)z[1] - z[0], dz2 = (double)z[2] - z[0];
+	double invArea = 1.0 / (dx1 * dy2 - dy1 * dx2);
+	double zx = (dz1 * dy2 - dz2 * dy1) * invArea;
+	double zy = (dz2 * dx1 - dz1 * dx2) * invArea;
+	triangle.ZX = (float)zx;
+	triangle.ZY = (float)zy;
+	triangle.ZOrigin = (float)(z[0] + zx * (triangle.MinX + 0.5 - x0) + zy * (triangle.MinY + 0.5 - y0));
+
+	std::uint32_t index = (std::uint32_t)m_triangles.size();
+	m_triangles.push_back(triangle);
+	m_stats.Triangles++;
+
+	for (std::int32_t ty = triangle.MinY / (std::int32_t)TileHeight; ty <= triangle.MaxY / (std::int32_t)TileHeight; ++ty)
+	{
+		for (std::int32_t tx = triangle.MinX / (std::int32_t)TileWidth; tx <= triangle.MaxX / (std::int32_t)TileWidth; ++tx)
+		{
+			m_bins[(std::size_t)ty * m_tilesX + tx].push_back(index);
+			m_stats.TileTriangles++;
+		}
+	}
+}
+
+void OcclusionBuffer::Rasterize()
+{
+	PROFILE_FUNCTION();
+
+	m_tileIndices.clear();
+	for (std::uint32_t tile = 0; tile < (std::uint32_t)m_bins.size(); ++tile)
+	{
+		if (!m_bins[tile].empty())
+			m_tileIndices.push_back(tile);
+	}
+
+	// Tiles own disjoint pixels and blocks, so they need no synchronization.
+	std::for_each(std::execution::par, m_tileIndices.begin(), m_tileIndices.end(), [this](std::uint32_t tile)
+	{
+		RasterizeTile(tile);
+	});
+}
+
+void OcclusionBuffer::RasterizeTile(std::uint32_t tile)
+{
+	std::int32_t tileX = (std::int32_t)(tile % m_tilesX * TileWidth);
+	std::int32_t tileY = (std::int32_t)(tile / m_tilesX * TileHeight);
+	std::int32_t tileMaxX = std::min(tileX + (std::int32_t)TileWidth, (std::int32_t)m_width) - 1;
+	std::int32_t tileMaxY = std::min(tileY + (std::int32_t)TileHeight, (std::int32_t)m_height) - 1;
+
+	const FloatLanes laneOffsets = LaneOffsetsF();
+	const std::int32_t subpixel = 1 << SubpixelBits;
+	const std::int32_t half = subpixel / 2;
+
+	for (std::uint32_t index : m_bins[tile])
+	{
+		const Triangle& t = m_triangles[index];
+
+		// Rows start on a lane boundary; the width is a multiple of
+		// BlockSize, so the last group stays inside the row.
+		std::int32_t minX = std::max(t.MinX, tileX) & ~(LaneCount - 1);
+		std::int32_t maxX = std::min(t.MaxX, tileMaxX);
+		std::int32_t minY = std::max(t.MinY, tileY);
+		std::int32_t maxY = std::min(t.MaxY, tileMaxY);
+		if (minX > maxX || minY > maxY)
+			continue;
+
+		IntLanes rowEdges[3];
+		IntLanes rowSteps[3];
+		IntLanes groupSteps[3];
+		for (int e = 0; e < 3; ++e)
+		{
+			std::int32_t start = t.A[e] * (minX * subpixel + half) + t.B[e] * (minY * subpixel + half) + t.C[e];
+			rowEdges[e] = AddI(SplatI(start), LaneMultiplesI(t.A[e] * subpixel));
+			rowSteps[e] = SplatI(t.B[e] * subpixel);
+			groupSteps[e] = SplatI(t.A[e] * subpixel * LaneCount);
+		}
+
+		const FloatLanes zX = SplatF(t.ZX);
+
+		for (std::int32_t y = minY; y <= maxY; ++y)
+		{
+			IntLanes e0 = rowEdges[0], e1 = rowEdges[1], e2 = rowEdges[2];
+			FloatLanes zRow = SplatF(t.ZOrigin + t.ZY * (float)(y - t.MinY));
+			float* row = &m_depth[(std::size_t)y * m_width];
+
+			for (std::int32_t x = minX; x <= maxX; x += LaneCount)
+			{
+				IntLanes edges = OrI(OrI(e0, e1), e2);
+				if (OutsideMask(edges) != AllLanes)
+				{
+					// Evaluated, not accumulated, to keep steep planes exact.
+					FloatLanes z = AddF(zRow, MulF(zX, AddF(laneOffsets, SplatF((float)(x - t.MinX)))));
+					FloatLanes depth = LoadF(row + x);
+					StoreF(row + x, Select(edges, MinF(depth, z), depth));
+				}
+
+				e0 = AddI(e0, groupSteps[0]);
+				e1 = AddI(e1, groupSteps[1]);
+				e2 = AddI(e2, groupSteps[2]);
+			}
+
+			rowEdges[0] = AddI(rowEdges[0], rowSteps[0]);
+			rowEdges[1] = AddI(rowEdges[1], rowSteps[1]);
+			rowEdges[2] = AddI(rowEdges[2], rowSteps[2]);
+		}
+	}
+
+	// Farthest depth of the tile's blocks.
+	std::uint32_t blocksX = m_width / BlockSize;
+	for (std::int32_t by = tileY; by <= tileMaxY; by += BlockSize)
+	{
+		for (std::int32_t bx = tileX; bx <= tileMaxX; bx += BlockSize)
+		{
+			FloatLanes blockMax = SplatF(0.0f);
+			for (std::int32_t y = by; y < by + (std::int32_t)BlockSize; ++y)
+			{
+				const float* row = &m_depth[(std::size_t)y * m_width + bx];
+				for (std::int32_t x = 0; x < (std::int32_t)BlockSize; x += LaneCount)
+					blockMax = MaxF(blockMax, LoadF(row + x));
+			}
+			m_blockMax[(std::size_t)(by / BlockSize) * blocksX + bx / BlockSize] = HorizontalMax(blockMax);
+		}
+	}
+}
+
+bool OcclusionBuffer::IsVisible(const float* center, const float* extents) const
+{
+	const float* m = m_viewProj;
+
+	// The corners are the clip-space center plus or minus each scaled axis,
+	// one corner per lane: x, y, z and w of corners 0-3, which have the
+	// negative third axis, then of corners 4-7.
+	const __m128 signX = _mm_setr_ps(-1.0f, 1.0f, -1.0f, 1.0f);
+	const __m128 signY = _mm_setr_ps(-1.0f, -1.0f, 1.0f, 1.0f);
+	__m128 corners[4][2];
+	for (int k = 0; k < 4; ++k)
+	{
+		float base = center[0] * m[k] + center[1] * m[4 + k] + center[2] * m[8 + k] + m[12 + k];
+		__m128 side = _mm_add_ps(_mm_set1_ps(base),
+			_mm_add_ps(_mm_mul_ps(signX, _mm_set1_ps(extents[0] * m[k])), _mm_mul_ps(signY, _mm_set1_ps(extents[1] * m[4 + k]))));
+		__m128 depthAxis = _mm_set1_ps(extents[2] * m[8 + k]);
+		corners[k][0] = _mm_sub_ps(side, depthAxis);
+		corners[k][1] = _mm_add_ps(side, depthAxis);
+	}
+
+	// Outside if all corners are out of one plane; undecided if the box
+	// crosses the near plane.
+	int left = 0xff, right = 0xff, bottom = 0xff, top = 0xff, beyond = 0xff, behind = 0;
+	for (int h = 0; h < 2; ++h)
+	{
+		__m128 x = corners[0][h], y = corners[1][h], z = corners[2][h], w = corners[3][h];
+		__m128 negW = _mm_sub_ps(_mm_setzero_ps(), w);
+		int shift = 4 * h;
+		left &= _mm_movemask_ps(_mm_cmplt_ps(x, negW)) << shift | (0xf0 >> shift);
+		right &= _mm_movemask_ps(_mm_cmpgt_ps(x, w)) << shift | (0xf0 >> shift);
+		bottom &= _mm_movemask_ps(_mm_cmplt_ps(y, negW)) << shift | (0xf0 >> shift);
+		top &= _mm_movemask_ps(_mm_cmpgt_ps(y, w)) << shift | (0xf0 >> shift);
+		beyond &= _mm_movemask_ps(_mm_cmpgt_ps(z, w)) << shift | (0xf0 >> shift);
+		behind |= _mm_movemask_ps(_mm_cmplt_ps(z, _mm_setzero_ps()));
+	}
+	if (left == 0xff || right == 0xff || bottom == 0xff || top == 0xff || beyond == 0xff)
+		return false;
+	if (behind != 0)
+		return true;
+
+	// Screen rectangle and nearest depth of the box.
+	__m128 minX4 = _mm_set1_ps(std::numeric_limits<float>::max());
+	__m128 maxX4 = _mm_set1_ps(-std::numeric_limits<float>::max());
+	__m128 minY4 = minX4, maxY4 = maxX4, minZ4 = minX4;
+	for (int h = 0; h < 2; ++h)
+	{
+		__m128 invW = _mm_div_ps(_mm_set1_ps(1.0f), corners[3][h]);
+		__m128 x = _mm_mul_ps(corners[0][h], invW);
+		__m128 y = _mm_mul_ps(corners[1][h], invW);
+		minX4 = _mm_min_ps(minX4, x);
+		maxX4 = _mm_max_ps(maxX4, x);
+		minY4 = _mm_min_ps(minY4, y);
+		maxY4 = _mm_max_ps(maxY4, y);
+		minZ4 = _mm_min_ps(minZ4, _mm_mul_ps(corners[2][h], invW));
+	}
+
+	// Corners next to the near plane can project far out; the clamp keeps
+	// the conversions below in range.
+	float minX = std::max(HorizontalMin4(minX4), -2.0f);
+	float maxX = std::min(HorizontalMax4(maxX4), 2.0f);
+	float minY = std::max(HorizontalMin4(minY4), -2.0f);
+	float maxY = std::min(HorizontalMax4(maxY4), 2.0f);
+	float minZ = HorizontalMin4(minZ4);
+
+	std::int32_t width = (std::int32_t)m_width;
+	std::int32_t height = (std::int32_t)m_height;
+	std::int32_t x0 = std::max((std::int32_t)std::floor((minX * 0.5f + 0.5f) * width), 0);
+	std::int32_t x1 = std::min((std::int32_t)std::floor((maxX * 0.5f + 0.5f) * width), width - 1);
+	std::int32_t y0 = std::max((std::int32_t)std::floor((0.5f - maxY * 0.5f) * height), 0);
+	std::int32_t y1 = std::min((std::int32_t)std::floor((0.5f - minY * 0.5f) * height), height - 1);
+	if (x0 > x1 || y0 > y1)
+		return false;
+
+	const FloatLanes boxDepth = SplatF(minZ);
+	std::int32_t blocksX = width / (std::int32_t)BlockSize;
+	for (std::int32_t by = y0 / (std::int32_t)BlockSize; by <= y1 / (std::int32_t)BlockSize; ++by)
+	{
+		for (std::int32_t bx = x0 / (std::int32_t)BlockSize; bx <= x1 / (std::int32_t)BlockSize; ++bx)
+		{
+			if (minZ > m_blockMax[(std::size_t)by * blocksX + bx])
+				continue;
+
+			// Some pixel of the block is farther than the box: look for one
+			// inside the rectangle.
+			std::int32_t rowStart = std::max(by * (std::int32_t)BlockSize, y0);
+			std::int32_t rowEnd = std::min((by + 1) * (std::int32_t)BlockSize - 1, y1);
+			for (std::int32_t x = bx * (std::int32_t)BlockSize; x < (bx + 1) * (std::int32_t)BlockSize; x += LaneCount)
+			{
+				std::int32_t first = std::max(x0 - x, 0);
+				std::int32_t last = std::min(x1 - x, LaneCount - 1);
+				if (first > last)
+					continue;
+				int columns = ((2 << last) - 1) & ~((1 << first) - 1);
+
+				for (std::int32_t y = rowStart; y <= rowEnd; ++y)
+				{
+					if ((GreaterEqualMask(LoadF(&m_depth[(std::size_t)y * m_width + x]), boxDepth) & columns) != 0)
+						return true;
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+float OccluderScore(const float* center, const float* extents, const float* eye)
+{
+	float radius2 = extents[0] * extents[0] + extents[1] * extents[1] + extents[2] * extents[2];
+	float dx = center[0] - eye[0], dy = center[1] - eye[1], dz = center[2] - eye[2];
+	return radius2 / std::max(dx * dx + dy * dy + dz * dz, 1e-6f);
+}
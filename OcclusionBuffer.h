@@ -0,0 +1,132 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Work done by the last frame of an OcclusionBuffer.
+struct OcclusionStats
+{
+	std::uint32_t							Occluders = 0;
+	// Triangles left after clipping and back-face culling.
+	std::uint32_t							Triangles = 0;
+	// Triangle and tile pairs rasterized; a triangle counts once per tile it overlaps.
+	std::uint32_t							TileTriangles = 0;
+};
+
+// Low-resolution depth buffer for CPU occlusion culling.
+//
+// A few large occluders are rasterized depth-only, then item bounds are
+// tested against the result before draw submission. Occluder triangles are
+// clipped, snapped to 1/8 pixel and binned by screen tile when added;
+// Rasterize() then fills the tiles in parallel, several pixels per
+// instruction (SSE2, or AVX2 when the compiler targets it), and keeps the
+// farthest depth of every BlockSize x BlockSize block so that most tests
+// are settled without reading pixels.
+//
+// Conventions are those of the renderer: row-major matrices applied to row
+// vectors (DirectXMath layout), clip-space depth in [0, 1] with 0 at the
+// near plane, and clockwise front faces, as in the default rasterizer state.
+// Occluders must be closed meshes, since back faces are culled.
+class OcclusionBuffer
+{
+public:
+
+	static const std::uint32_t				BlockSize = 8;
+	static const std::uint32_t				TileWidth = 64;
+	static const std::uint32_t				TileHeight = 32;
+	// Bounds the snapped coordinates so edge functions fit in 32 bits.
+	static const std::uint32_t				MaxSize = 1024;
+
+	// Sizes are rounded up to a multiple of BlockSize.
+											OcclusionBuffer(std::uint32_t width = 320, std::uint32_t height = 192);
+
+	void									Resize(std::uint32_t width, std::uint32_t height);
+	std::uint32_t							GetWidth()			const	{	return m_width;	}
+	std::uint32_t							GetHeight()			const	{	return m_height;	}
+
+	// Clears the depth to the far plane and drops last frame's occluders.
+	void									BeginFrame(const float* viewProj);
+
+	// Adds the indexed triangle list `indices[0, indexCount)` of a mesh whose
+	// positions are three floats at the start of every `vertexStride` bytes.
+	// Indices are offset by `baseVertex`, as in DrawIndexedInstanced.
+	void									AddOccluder(const float* world, const void* vertices, std::uint32_t vertexStride,
+												const std::uint16_t* indices, std::uint32_t indexCount, std::int32_t baseVertex = 0);
+
+	// Fills the depth buffer with the occluders added since BeginFrame.
+	void									Rasterize();
+
+	// False if the world-space box is hidden behind the occluders or entirely
+	// outside the view. Boxes crossing the near plane are always visible.
+	// Safe to call from several threads once Rasterize() has returned.
+	bool									IsVisible(const float* center, const float* extents)	const;
+
+	// Row-major, GetWidth() floats per row.
+	const float*							GetDepth()			const	{	return m_depth.data();	}
+	const OcclusionStats&					GetStats()			const	{	return m_stats;	}
+
+private:
+
+	// Edge functions are A * x + B * y + C at pixel centers, in 1/8 pixel
+	// units, and are >= 0 inside the triangle; C carries the fill rule.
+	// Depth is ZOrigin + ZX * (x - MinX) + ZY * (y - MinY) at the center of
+	// pixel (x, y); relative to the corner so that steep planes keep precision.
+	struct Triangle
+	{
+		std::int32_t						A[3];
+		std::int32_t						B[3];
+		std::int32_t						C[3];
+		float								ZOrigin;
+		float								ZX;
+		float								ZY;
+		// Covered pixels, inclusive.
+		std::int32_t						MinX;
+		std::int32_t						MinY;
+		std::int32_t						MaxX;
+		std::int32_t						MaxY;
+	};
+
+	// Snapped to the subpixel grid for coverage. The depth plane goes through
+	// the exact position instead: snapping would tilt it on thin triangles.
+	struct ScreenVertex
+	{
+		std::int32_t						X;
+		std::int32_t						Y;
+		float								ExactX;
+		float								ExactY;
+		float								Z;
+	};
+
+	// Clip-space vertices are x, y, z, w.
+	ScreenVertex							Project(const float* clip)		const;
+	void									ClipTriangle(const float* a, const float* b, const float* c);
+	void									EmitTriangle(const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c);
+	void									RasterizeTile(std::uint32_t tile);
+
+	std::uint32_t							m_width = 0;
+	std::uint32_t							m_height = 0;
+	std::uint32_t							m_tilesX = 0;
+	std::uint32_t							m_tilesY = 0;
+
+	float									m_viewProj[16] = {};
+
+	std::vector<float>						m_depth;
+	// Farthest depth of every block.
+	std::vector<float>						m_blockMax;
+
+	// Vertices of the occluder being added. Screen positions are only valid
+	// for vertices that need no clipping.
+	std::vector<float>						m_clipVertices;
+	std::vector<std::uint32_t>				m_outcodes;
+	std::vector<ScreenVertex>				m_screenVertices;
+
+	std::vector<Triangle>					m_triangles;
+	// Triangle indices per tile, in submission order.
+	std::vector<std::vector<std::uint32_t>>	m_bins;
+	std::vector<std::uint32_t>				m_tileIndices;
+
+	OcclusionStats							m_stats;
+};
+
+// Screen-size proxy for picking occluders: the squared radius of the box
+// over its squared distance from the eye.
+float OccluderScore(const float* center, const float* extents, const float* eye);
@@ -0,0 +1,282 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Creates pipelines once per key, on background threads.
+//
+// Keys are hashes of everything that defines a pipeline (see
+// HashGraphicsPipelineDesc); the cache does not know what a pipeline is, so
+// it works with any backend and with plain values in tests. A pipeline
+// counts as created when the creation function returns a value that tests
+// true; a function that throws leaves the pipeline failed and Get()
+// rethrows.
+//
+// Request() queues a creation and returns immediately, so pipelines a level
+// will need can be warmed up ahead of their first draw. Get() returns the
+// pipeline, creating it on the calling thread if no worker has started it
+// yet rather than waiting behind the queue.
+template<typename T>
+class PipelineCache
+{
+public:
+
+	using CreateFn = std::function<T()>;
+
+	enum class State
+	{
+		Missing,
+		Queued,
+		Creating,
+		Ready,
+		Failed,
+	};
+
+	struct Stats
+	{
+		std::uint32_t						Requests = 0;
+		// Requests that found the key already known, whatever its state.
+		std::uint32_t						Hits = 0;
+		std::uint32_t						Creations = 0;
+	};
+
+	explicit								PipelineCache(std::uint32_t workerCount = 1);
+											PipelineCache(const PipelineCache& rhs) = delete;
+											PipelineCache& operator=(const PipelineCache& rhs) = delete;
+	// Waits for the creations in progress; queued ones are dropped.
+											~PipelineCache();
+
+	void									Request(std::uint64_t key, CreateFn create);
+	T										Get(std::uint64_t key, CreateFn create);
+
+	// Never blocks. Returns false unless the pipeline is ready.
+	bool									TryGet(std::uint64_t key, T& pipeline)	const;
+	State									GetState(std::uint64_t key)			const;
+
+	// Blocks until the queue is empty and no creation is in progress.
+	void									WaitIdle();
+
+	Stats									GetStats()			const;
+
+private:
+
+	struct Entry
+	{
+		State								Status = State::Missing;
+		CreateFn							Create;
+		T									Pipeline {};
+		std::exception_ptr					Error;
+	};
+
+	// Returns the entry, adding it as queued if it is new.
+	Entry&									Find(std::uint64_t key, CreateFn& create, bool& added);
+	// Runs the creation of a Creating entry. Called with `lock` held; releases
+	// it while the creation function runs.
+	void									Run(std::unique_lock<std::mutex>& lock, std::uint64_t key);
+	void									WorkerMain();
+
+	mutable std::mutex						m_mutex;
+	std::condition_variable					m_workAvailable;
+	std::condition_variable					m_entryDone;
+	// Entries are never erased, so references stay valid while unlocked.
+	std::unordered_map<std::uint64_t, Entry>	m_entries;
+	std::deque<std::uint64_t>				m_queue;
+	std::uint32_t							m_creating = 0;
+	bool									m_stopping = false;
+	Stats									m_stats;
+	std::vector<std::thread>				m_workers;
+};
+
+template<typename T>
+PipelineCache<T>::PipelineCache(std::uint32_t workerCount)
+{
+	for (std::uint32_t i = 0; i < workerCount; ++i)
+		m_workers.emplace_back([this]() { WorkerMain(); });
+}
+
+template<typename T>
+PipelineCache<T>::~PipelineCache()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_workAvailable.notify_all();
+
+	for (std::thread& worker : m_workers)
+		worker.join();
+}
+
+template<typename T>
+typename PipelineCache<T>::Entry& PipelineCache<T>::Find(std::uint64_t key, CreateFn& create, bool& added)
+{
+	m_stats.Requests++;
+
+	auto [it, inserted] = m_entries.try_emplace(key);
+	added = inserted;
+	if (inserted)
+	{
+		it->second.Status = State::Queued;
+		it->second.Create = std::move(create);
+	}
+	else
+	{
+		m_stats.Hits++;
+	}
+	return it->second;
+}
+
+template<typename T>
+void PipelineCache<T>::Request(std::uint64_t key, CreateFn create)
+{
+	bool added = false;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Find(key, create, added);
+		if (added)
+			m_queue.push_back(key);
+	}
+
+	if (added)
+		m_workAvailable.notify_one();
+}
+
+template<typename T>
+T PipelineCache<T>::Get(std::uint64_t key, CreateFn create)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	bool added = false;
+	Entry& entry = Find(key, create, added);
+
+	// Not started yet: take it over. A worker popping the key later sees it
+	// is no longer queued and skips it.
+	if (entry.Status == State::Queued)
+	{
+		entry.Status = State::Creating;
+		Run(lock, key);
+	}
+
+	m_entryDone.wait(lock, [&entry]() { return entry.Status == State::Ready || entry.Status == State::Failed; });
+
+	if (entry.Error)
+		std::rethrow_exception(entry.Error);
+	return entry.Pipeline;
+}
+
+template<typename T>
+bool PipelineCache<T>::TryGet(std::uint64_t key, T& pipeline) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto it = m_entries.find(key);
+	if (it == m_entries.end() || it->second.Status != State::Ready)
+		return false;
+
+	pipeline = it->second.Pipeline;
+	return true;
+}
+
+template<typename T>
+typename PipelineCache<T>::State PipelineCache<T>::GetState(std::uint64_t key) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto it = m_entries.find(key);
+	return it == m_entries.end() ? State::Missing : it->second.Status;
+}
+
+template<typename T>
+void PipelineCache<T>::WaitIdle()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	// Without workers nobody would drain the queue.
+	while (m_workers.empty() && !m_queue.empty())
+	{
+		std::uint64_t key = m_queue.front();
+		m_queue.pop_front();
+
+		Entry& entry = m_entries[key];
+		if (entry.Status == State::Queued)
+		{
+			entry.Status = State::Creating;
+			Run(lock, key);
+		}
+	}
+
+	m_entryDone.wait(lock, [this]() { return m_queue.empty() && m_creating == 0; });
+}
+
+template<typename T>
+typename PipelineCache<T>::Stats PipelineCache<T>::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+template<typename T>
+void PipelineCache<T>::Run(std::unique_lock<std::mutex>& lock, std::uint64_t key)
+{
+	Entry& entry = m_entries[key];
+	CreateFn create = std::move(entry.Create);
+	m_creating++;
+	lock.unlock();
+
+	T pipeline {};
+	std::exception_ptr error;
+	try
+	{
+		pipeline = create();
+		if (!pipeline)
+			error = std::make_exception_ptr(std::runtime_error("Pipeline creation returned nothing."));
+	}
+	catch (...)
+	{
+		error = std::current_exception();
+	}
+
+	lock.lock();
+	entry.Pipeline = std::move(pipeline);
+	entry.Error = error;
+	entry.Status = error ? State::Failed : State::Ready;
+	m_creating--;
+	m_stats.Creations++;
+	m_entryDone.notify_all();
+}
+
+template<typename T>
+void PipelineCache<T>::WorkerMain()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	for (;;)
+	{
+		m_workAvailable.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+		if (m_stopping)
+			return;
+
+		std::uint64_t key = m_queue.front();
+		m_queue.pop_front();
+
+		Entry& entry = m_entries[key];
+		if (entry.Status == State::Queued)
+		{
+			entry.Status = State::Creating;
+			Run(lock, key);
+		}
+		else if (m_queue.empty())
+		{
+			// The key was taken over by Get(); WaitIdle() may be waiting on
+			// the queue becoming empty.
+			m_entryDone.notify_all();
+		}
+	}
+}
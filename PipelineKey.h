@@ -0,0 +1,74 @@
+#pragma once
+#include "Hash.h"
+#include "ShaderCache.h"
+#include <cstdint>
+
+// Builds the key a pipeline is cached under (see HashGraphicsPipelineDesc).
+//
+// Descriptions the driver treats as the same pipeline must give the same key,
+// so the builder canonicalizes what the raw bytes would not:
+//  - shaders are identified by the hash of their bytecode, never by address,
+//    the same hash ShaderBytecode::Hash() returns;
+//  - a null name and an empty one are the same name;
+//  - only the used prefix of a fixed-size array counts;
+//  - fields that only matter when a feature is enabled are hashed inside
+//    `if (key.Enabled(...))`, so their values are ignored while it is off.
+// Everything else is hashed as given, field by field: padding bytes are not
+// guaranteed to be zero.
+class PipelineKeyBuilder
+{
+public:
+
+	explicit								PipelineKeyBuilder(std::uint64_t rootSignatureHash)
+	{
+		m_hasher.Value(rootSignatureHash);
+	}
+
+	// A missing shader (null or empty) hashes as 0.
+	PipelineKeyBuilder&						Shader(const void* bytecode, std::size_t size)
+	{
+		return Shader(bytecode != nullptr && size != 0 ? ShaderBytecode::HashOf(bytecode, size) : 0);
+	}
+	PipelineKeyBuilder&						Shader(std::uint64_t bytecodeHash)
+	{
+		m_hasher.Value(bytecodeHash);
+		return *this;
+	}
+
+	PipelineKeyBuilder&						Name(const char* name)
+	{
+		m_hasher.String(name != nullptr ? name : "");
+		return *this;
+	}
+
+	template<typename T>
+	PipelineKeyBuilder&						Value(const T& value)
+	{
+		m_hasher.Value(value);
+		return *this;
+	}
+
+	// The count and the first `count` values; the rest of the array is unused.
+	template<typename T>
+	PipelineKeyBuilder&						Prefix(const T* values, std::uint32_t count)
+	{
+		m_hasher.Value(count);
+		for (std::uint32_t i = 0; i < count; ++i)
+			m_hasher.Value(values[i]);
+		return *this;
+	}
+
+	// Hashes the switch itself and returns it, for the caller to hash the
+	// fields it governs only when it is on.
+	bool									Enabled(bool enabled)
+	{
+		m_hasher.Value(enabled);
+		return enabled;
+	}
+
+	std::uint64_t							Get()				const	{	return m_hasher.Get();	}
+
+private:
+
+	Hasher									m_hasher;
+};
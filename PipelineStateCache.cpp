@@ -0,0 +1,217 @@
+#include "PipelineStateCache.h"
+#include "Hash.h"
+#include "MappedFile.h"
+#include "PipelineKey.h"
+#include <fstream>
+#include <sstream>
+
+static void HashShader(PipelineKeyBuilder& key, const D3D12_SHADER_BYTECODE& shader)
+{
+	key.Shader(shader.pShaderBytecode, shader.BytecodeLength);
+}
+
+static void HashStencilOp(PipelineKeyBuilder& key, const D3D12_DEPTH_STENCILOP_DESC& op)
+{
+	key.Value(op.StencilFailOp)
+		.Value(op.StencilDepthFailOp)
+		.Value(op.StencilPassOp)
+		.Value(op.StencilFunc);
+}
+
+// Canonicalized as PipelineKeyBuilder describes: blend, logic op, depth and
+// stencil settings are left out while their switch is off, and so are render
+// targets 1-7 without independent blending, since D3D12 ignores them then.
+std::uint64_t HashGraphicsPipelineDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, std::uint64_t rootSignatureHash)
+{
+	PipelineKeyBuilder key(rootSignatureHash);
+
+	HashShader(key, desc.VS);
+	HashShader(key, desc.PS);
+	HashShader(key, desc.DS);
+	HashShader(key, desc.HS);
+	HashShader(key, desc.GS);
+
+	const D3D12_STREAM_OUTPUT_DESC& so = desc.StreamOutput;
+	key.Value(so.NumEntries);
+	for (UINT i = 0; i < so.NumEntries; ++i)
+	{
+		const D3D12_SO_DECLARATION_ENTRY& entry = so.pSODeclaration[i];
+		key.Value(entry.Stream)
+			.Name(entry.SemanticName)
+			.Value(entry.SemanticIndex)
+			.Value(entry.StartComponent)
+			.Value(entry.ComponentCount)
+			.Value(entry.OutputSlot);
+	}
+	key.Prefix(so.pBufferStrides, so.NumStrides);
+	key.Value(so.RasterizedStream);
+
+	const D3D12_BLEND_DESC& blend = desc.BlendState;
+	key.Value(blend.AlphaToCoverageEnable);
+	UINT blendTargets = key.Enabled(blend.IndependentBlendEnable != FALSE) ? D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT : 1;
+	for (UINT i = 0; i < blendTargets; ++i)
+	{
+		const D3D12_RENDER_TARGET_BLEND_DESC& rt = blend.RenderTarget[i];
+		if (key.Enabled(rt.BlendEnable != FALSE))
+		{
+			key.Value(rt.SrcBlend)
+				.Value(rt.DestBlend)
+				.Value(rt.BlendOp)
+				.Value(rt.SrcBlendAlpha)
+				.Value(rt.DestBlendAlpha)
+				.Value(rt.BlendOpAlpha);
+		}
+		if (key.Enabled(rt.LogicOpEnable != FALSE))
+			key.Value(rt.LogicOp);
+		key.Value(rt.RenderTargetWriteMask);
+	}
+	key.Value(desc.SampleMask);
+
+	// Only 4-byte members: no padding.
+	key.Value(desc.RasterizerState);
+
+	const D3D12_DEPTH_STENCIL_DESC& ds = desc.DepthStencilState;
+	if (key.Enabled(ds.DepthEnable != FALSE))
+	{
+		key.Value(ds.DepthWriteMask)
+			.Value(ds.DepthFunc);
+	}
+	if (key.Enabled(ds.StencilEnable != FALSE))
+	{
+		key.Value(ds.StencilReadMask)
+			.Value(ds.StencilWriteMask);
+		HashStencilOp(key, ds.FrontFace);
+		HashStencilOp(key, ds.BackFace);
+	}
+
+	key.Value(desc.InputLayout.NumElements);
+	for (UINT i = 0; i < desc.InputLayout.NumElements; ++i)
+	{
+		const D3D12_INPUT_ELEMENT_DESC& element = desc.InputLayout.pInputElementDescs[i];
+		key.Name(element.SemanticName)
+			.Value(element.SemanticIndex)
+			.Value(element.Format)
+			.Value(element.InputSlot)
+			.Value(element.AlignedByteOffset)
+			.Value(element.InputSlotClass)
+			.Value(element.InstanceDataStepRate);
+	}
+
+	key.Value(desc.IBStripCutValue);
+	key.Value(desc.PrimitiveTopologyType);
+	key.Prefix(desc.RTVFormats, desc.NumRenderTargets);
+	key.Value(desc.DSVFormat);
+	key.Value(desc.SampleDesc);
+	key.Value(desc.NodeMask);
+	key.Value(desc.Flags);
+
+	return key.Get();
+}
+
+PipelineStateCache::PipelineStateCache()
+{
+}
+
+PipelineStateCache::~PipelineStateCache()
+{
+	// Workers must be gone before the library they store into.
+	m_pipelines.reset();
+}
+
+void PipelineStateCache::Initialize(ID3D12Device* device, const std::string& libraryPath, UINT workerCount)
+{
+	m_device = device;
+	m_libraryPath = libraryPath;
+	m_pipelines = std::make_unique<PipelineCache<ComPtr<ID3D12PipelineState>>>(workerCount);
+
+	// Pipeline libraries need ID3D12Device1; without it pipelines are simply
+	// compiled every run.
+	ComPtr<ID3D12Device1> device1;
+	if (m_libraryPath.empty() || FAILED(device->QueryInterface(IID_PPV_ARGS(&device1))))
+		return;
+
+	// Read rather than mapped: the file is replaced by Save() while the
+	// library still references this copy.
+	std::ifstream file(m_libraryPath, std::ios::binary);
+	if (file)
+	{
+		std::ostringstream stream;
+		stream << file.rdbuf();
+		const std::string contents = stream.str();
+		m_libraryData.assign(contents.begin(), contents.end());
+	}
+
+	HRESULT hr = E_FAIL;
+	if (!m_libraryData.empty())
+		hr = device1->CreatePipelineLibrary(m_libraryData.data(), m_libraryData.size(), IID_PPV_ARGS(&m_library));
+
+	// Missing, corrupt, or written by another driver or adapter
+	// (D3D12_ERROR_DRIVER_VERSION_MISMATCH, D3D12_ERROR_ADAPTER_NOT_FOUND):
+	// start an empty library.
+	if (FAILED(hr))
+	{
+		m_libraryData.clear();
+		m_library = nullptr;
+		device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&m_library));
+	}
+}
+
+void PipelineStateCache::Request(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, std::uint64_t rootSignatureHash)
+{
+	std::uint64_t key = HashGraphicsPipelineDesc(desc, rootSignatureHash);
+	m_pipelines->Request(key, MakeCreate(desc, key));
+}
+
+ComPtr<ID3D12PipelineState> PipelineStateCache::Get(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, std::uint64_t rootSignatureHash)
+{
+	std::uint64_t key = HashGraphicsPipelineDesc(desc, rootSignatureHash);
+	return m_pipelines->Get(key, MakeCreate(desc, key));
+}
+
+PipelineCache<ComPtr<ID3D12PipelineState>>::CreateFn PipelineStateCache::MakeCreate(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, std::uint64_t key)
+{
+	// The root signature is kept alive by the closure; the rest of what the
+	// desc points to is the caller's.
+	ComPtr<ID3D12RootSignature> rootSignature = desc.pRootSignature;
+
+	return [this, desc, key, rootSignature]()
+	{
+		std::string hex = Hasher::ToHex(key);
+		std::wstring name(hex.begin(), hex.end());
+
+		ComPtr<ID3D12PipelineState> pso;
+		if (m_library != nullptr)
+		{
+			std::lock_guard<std::mutex> lock(m_libraryMutex);
+			if (SUCCEEDED(m_library->LoadGraphicsPipeline(name.c_str(), &desc, IID_PPV_ARGS(&pso))))
+			{
+				m_libraryHits++;
+				return pso;
+			}
+		}
+
+		DX::ThrowIfFailed(m_device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pso)));
+
+		if (m_library != nullptr)
+		{
+			std::lock_guard<std::mutex> lock(m_libraryMutex);
+			if (SUCCEEDED(m_library->StorePipeline(name.c_str(), pso.Get())))
+				m_libraryDirty = true;
+		}
+		return pso;
+	};
+}
+
+void PipelineStateCache::Save()
+{
+	std::lock_guard<std::mutex> lock(m_libraryMutex);
+	if (m_library == nullptr || !m_libraryDirty)
+		return;
+
+	std::vector<std::uint8_t> data(m_library->GetSerializedSize());
+	if (data.empty() || FAILED(m_library->Serialize(data.data(), data.size())))
+		return;
+
+	if (WriteFileAtomic(m_libraryPath, data.data(), data.size()))
+		m_libraryDirty = false;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "framework.h"
+#include "d3dUtil.h"
+#include "PipelineCache.h"
+#include <atomic>
+
+using Microsoft::WRL::ComPtr;
+
+// Hash of everything in `desc` that affects the pipeline. The desc only
+// points at the root signature, so the caller identifies it; shaders are
+// identified by their bytecode hash and the input layout by content. Fields
+// the driver ignores (see the .cpp) and CachedPSO are left out.
+std::uint64_t HashGraphicsPipelineDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, std::uint64_t rootSignatureHash);
+
+// Graphics PSOs created once per distinct description, on a background
+// thread, and persisted across runs in an ID3D12PipelineLibrary.
+//
+// On a library hit the driver skips compilation, which is where nearly all
+// of CreateGraphicsPipelineState's time goes. The library file is
+// invalidated by the runtime whenever the driver or adapter changes; it is
+// then rebuilt from scratch.
+//
+// The memory `desc` points to (shaders, input layout) must stay valid until
+// the pipeline is created, that is until Get() returns or WaitIdle().
+class PipelineStateCache
+{
+public:
+
+											PipelineStateCache();
+											PipelineStateCache(const PipelineStateCache& rhs) = delete;
+											PipelineStateCache& operator=(const PipelineStateCache& rhs) = delete;
+											~PipelineStateCache();
+
+	// An empty path disables persistence.
+	void									Initialize(ID3D12Device* device, const std::string& libraryPath, UINT workerCount = 1);
+
+	// Starts creating the pipeline in the background, if it is new.
+	void									Request(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, std::uint64_t rootSignatureHash);
+	// Returns the pipeline, waiting for or doing its creation.
+	ComPtr<ID3D12PipelineState>				Get(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, std::uint64_t rootSignatureHash);
+
+	void									WaitIdle()							{	m_pipelines->WaitIdle();	}
+
+	// Writes the library back if pipelines were added to it.
+	void									Save();
+
+	// Pipelines loaded from the library rather than compiled.
+	UINT									GetLibraryHits()			const	{	return m_libraryHits;	}
+	PipelineCache<ComPtr<ID3D12PipelineState>>::Stats	GetStats()	const	{	return m_pipelines->GetStats();	}
+
+private:
+
+	PipelineCache<ComPtr<ID3D12PipelineState>>::CreateFn	MakeCreate(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, std::uint64_t key);
+
+	ComPtr<ID3D12Device>					m_device = nullptr;
+	// Must outlive m_library, which references it: declared first so it is
+	// destroyed last.
+	std::vector<std::uint8_t>				m_libraryData;
+	ComPtr<ID3D12PipelineLibrary>			m_library = nullptr;
+	std::string								m_libraryPath;
+
+	// Library calls are serialized; compilation is not.
+	std::mutex								m_libraryMutex;
+	bool									m_libraryDirty = false;
+	std::atomic<UINT>						m_libraryHits { 0 };
+
+	std::unique_ptr<PipelineCache<ComPtr<ID3D12PipelineState>>>	m_pipelines;
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include "DirectXMath.h"
+#include <cstddef>
+#include <cstdint>
+
+// BoundingBox from DirectXCollision, for builds without the Windows SDK; see
+// DirectXMath.h in this directory.
+
+namespace DirectX
+{
+	struct BoundingBox
+	{
+		XMFLOAT3							Center = { 0.0f, 0.0f, 0.0f };
+		XMFLOAT3							Extents = { 1.0f, 1.0f, 1.0f };
+
+		BoundingBox() = default;
+		constexpr BoundingBox(const XMFLOAT3& center, const XMFLOAT3& extents) : Center(center), Extents(extents) {}
+
+		// Box around the eight transformed corners.
+		void Transform(BoundingBox& out, FXMMATRIX M) const
+		{
+			XMVECTOR center = XMLoadFloat3(&Center);
+			XMVECTOR extents = XMLoadFloat3(&Extents);
+
+			XMVECTOR lo = XMVectorReplicate(INFINITY);
+			XMVECTOR hi = XMVectorReplicate(-INFINITY);
+			for (int i = 0; i < 8; ++i)
+			{
+				XMVECTOR corner = XMVectorSet((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f, 0.0f);
+				XMVECTOR p = XMVector3Transform(XMVectorAdd(XMVectorMultiply(corner, extents), center), M);
+				lo = XMVectorMin(lo, p);
+				hi = XMVectorMax(hi, p);
+			}
+
+			XMStoreFloat3(&out.Center, XMVectorScale(XMVectorAdd(lo, hi), 0.5f));
+			XMStoreFloat3(&out.Extents, XMVectorScale(XMVectorSubtract(hi, lo), 0.5f));
+		}
+
+		// `points` are `stride` bytes apart.
+		static void CreateFromPoints(BoundingBox& out, std::size_t count, const XMFLOAT3* points, std::size_t stride)
+		{
+			XMVECTOR lo = XMVectorReplicate(INFINITY);
+			XMVECTOR hi = XMVectorReplicate(-INFINITY);
+			const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(points);
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				XMVECTOR p = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(bytes + i * stride));
+				lo = XMVectorMin(lo, p);
+				hi = XMVectorMax(hi, p);
+			}
+
+			XMStoreFloat3(&out.Center, XMVectorScale(XMVectorAdd(lo, hi), 0.5f));
+			XMStoreFloat3(&out.Extents, XMVectorScale(XMVectorSubtract(hi, lo), 0.5f));
+		}
+	};
+}
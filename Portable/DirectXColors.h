@@ -0,0 +1,15 @@
+#pragma once
+#include "DirectXMath.h"
+
+// The DirectX::Colors the engine uses, with the SDK's values, for builds
+// without the Windows SDK; see DirectXMath.h in this directory.
+
+namespace DirectX
+{
+	namespace Colors
+	{
+		constexpr XMVECTORF32 Crimson			= { { 0.862745166f, 0.078431375f, 0.235294133f, 1.000000000f } };
+		constexpr XMVECTORF32 DarkGreen			= { { 0.000000000f, 0.392156899f, 0.000000000f, 1.000000000f } };
+		constexpr XMVECTORF32 LightSteelBlue	= { { 0.690196097f, 0.768627524f, 0.870588303f, 1.000000000f } };
+	}
+}
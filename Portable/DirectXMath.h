@@ -0,0 +1,489 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+// The part of DirectXMath the engine code uses, in plain C++, for headless
+// builds that cannot use the real DirectXMath package: non-x86 CPUs, or x86
+// machines without the package installed (CMake warns). Windows builds get
+// the SDK headers and other x86 builds the open-source DirectXMath.
+//
+// Types have the SDK's layouts and the functions follow its formulas, so
+// results match the SDK up to float rounding. XMVECTOR is a struct of four
+// floats rather than an SSE register: nothing here is meant to be fast, and
+// timings taken on it say nothing about the shipped code.
+
+#define XM_CALLCONV
+
+namespace DirectX
+{
+	constexpr float XM_PI = 3.141592654f;
+	constexpr float XM_2PI = 6.283185307f;
+	constexpr float XM_1DIVPI = 0.318309886f;
+	constexpr float XM_1DIV2PI = 0.159154943f;
+	constexpr float XM_PIDIV2 = 1.570796327f;
+	constexpr float XM_PIDIV4 = 0.785398163f;
+
+	struct alignas(16) XMVECTOR
+	{
+		float								f[4];
+	};
+
+	using FXMVECTOR = XMVECTOR;
+	using GXMVECTOR = XMVECTOR;
+	using HXMVECTOR = XMVECTOR;
+	using CXMVECTOR = const XMVECTOR&;
+
+	struct alignas(16) XMVECTORF32
+	{
+		float								f[4];
+
+		operator XMVECTOR() const			{	return XMVECTOR{ { f[0], f[1], f[2], f[3] } };	}
+		operator const float*() const		{	return f;	}
+	};
+
+	struct XMMATRIX
+	{
+		XMVECTOR							r[4];
+
+		XMMATRIX() = default;
+		XMMATRIX(FXMVECTOR r0, FXMVECTOR r1, FXMVECTOR r2, CXMVECTOR r3) : r{ r0, r1, r2, r3 } {}
+		XMMATRIX(float m00, float m01, float m02, float m03,
+				 float m10, float m11, float m12, float m13,
+				 float m20, float m21, float m22, float m23,
+				 float m30, float m31, float m32, float m33)
+			: r{ { { m00, m01, m02, m03 } }, { { m10, m11, m12, m13 } }, { { m20, m21, m22, m23 } }, { { m30, m31, m32, m33 } } } {}
+	};
+
+	using FXMMATRIX = XMMATRIX;
+	using CXMMATRIX = const XMMATRIX&;
+
+	struct XMFLOAT2
+	{
+		float								x;
+		float								y;
+
+		XMFLOAT2() = default;
+		constexpr XMFLOAT2(float _x, float _y) : x(_x), y(_y) {}
+		explicit XMFLOAT2(const float* p) : x(p[0]), y(p[1]) {}
+	};
+
+	struct XMFLOAT3
+	{
+		float								x;
+		float								y;
+		float								z;
+
+		XMFLOAT3() = default;
+		constexpr XMFLOAT3(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {}
+		explicit XMFLOAT3(const float* p) : x(p[0]), y(p[1]), z(p[2]) {}
+	};
+
+	struct XMFLOAT4
+	{
+		float								x;
+		float								y;
+		float								z;
+		float								w;
+
+		XMFLOAT4() = default;
+		constexpr XMFLOAT4(float _x, float _y, float _z, float _w) : x(_x), y(_y), z(_z), w(_w) {}
+		explicit XMFLOAT4(const float* p) : x(p[0]), y(p[1]), z(p[2]), w(p[3]) {}
+	};
+
+	struct XMFLOAT4X4
+	{
+		union
+		{
+			struct
+			{
+				float						_11, _12, _13, _14;
+				float						_21, _22, _23, _24;
+				float						_31, _32, _33, _34;
+				float						_41, _42, _43, _44;
+			};
+			float							m[4][4];
+		};
+
+		XMFLOAT4X4() = default;
+		constexpr XMFLOAT4X4(float m00, float m01, float m02, float m03,
+							 float m10, float m11, float m12, float m13,
+							 float m20, float m21, float m22, float m23,
+							 float m30, float m31, float m32, float m33)
+			: _11(m00), _12(m01), _13(m02), _14(m03),
+			  _21(m10), _22(m11), _23(m12), _24(m13),
+			  _31(m20), _32(m21), _33(m22), _34(m23),
+			  _41(m30), _42(m31), _43(m32), _44(m33) {}
+	};
+
+	constexpr XMVECTORF32 g_XMIdentityR0 = { { 1.0f, 0.0f, 0.0f, 0.0f } };
+	constexpr XMVECTORF32 g_XMIdentityR1 = { { 0.0f, 1.0f, 0.0f, 0.0f } };
+	constexpr XMVECTORF32 g_XMIdentityR2 = { { 0.0f, 0.0f, 1.0f, 0.0f } };
+	constexpr XMVECTORF32 g_XMIdentityR3 = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+
+	// Loads and stores. Missing components load as zero.
+
+	inline XMVECTOR XMLoadFloat2(const XMFLOAT2* p)			{	return XMVECTOR{ { p->x, p->y, 0.0f, 0.0f } };	}
+	inline XMVECTOR XMLoadFloat3(const XMFLOAT3* p)			{	return XMVECTOR{ { p->x, p->y, p->z, 0.0f } };	}
+	inline XMVECTOR XMLoadFloat4(const XMFLOAT4* p)			{	return XMVECTOR{ { p->x, p->y, p->z, p->w } };	}
+
+	inline XMMATRIX XMLoadFloat4x4(const XMFLOAT4X4* p)
+	{
+		XMMATRIX M;
+		for (int i = 0; i < 4; ++i)
+			M.r[i] = XMVECTOR{ { p->m[i][0], p->m[i][1], p->m[i][2], p->m[i][3] } };
+		return M;
+	}
+
+	inline void XMStoreFloat2(XMFLOAT2* p, FXMVECTOR v)		{	p->x = v.f[0];	p->y = v.f[1];	}
+	inline void XMStoreFloat3(XMFLOAT3* p, FXMVECTOR v)		{	p->x = v.f[0];	p->y = v.f[1];	p->z = v.f[2];	}
+	inline void XMStoreFloat4(XMFLOAT4* p, FXMVECTOR v)		{	p->x = v.f[0];	p->y = v.f[1];	p->z = v.f[2];	p->w = v.f[3];	}
+
+	inline void XMStoreFloat4x4(XMFLOAT4X4* p, FXMMATRIX M)
+	{
+		for (int i = 0; i < 4; ++i)
+			for (int j = 0; j < 4; ++j)
+				p->m[i][j] = M.r[i].f[j];
+	}
+
+	// Vectors.
+
+	inline XMVECTOR XMVectorSet(float x, float y, float z, float w)	{	return XMVECTOR{ { x, y, z, w } };	}
+	inline XMVECTOR XMVectorZero()									{	return XMVECTOR{ { 0.0f, 0.0f, 0.0f, 0.0f } };	}
+	inline XMVECTOR XMVectorReplicate(float value)					{	return XMVECTOR{ { value, value, value, value } };	}
+
+	inline float XMVectorGetX(FXMVECTOR v)							{	return v.f[0];	}
+	inline float XMVectorGetY(FXMVECTOR v)							{	return v.f[1];	}
+	inline float XMVectorGetZ(FXMVECTOR v)							{	return v.f[2];	}
+	inline float XMVectorGetW(FXMVECTOR v)							{	return v.f[3];	}
+
+	inline XMVECTOR XMVectorSetW(FXMVECTOR v, float w)				{	return XMVECTOR{ { v.f[0], v.f[1], v.f[2], w } };	}
+
+	inline XMVECTOR XMVectorAdd(FXMVECTOR a, FXMVECTOR b)
+	{
+		return XMVECTOR{ { a.f[0] + b.f[0], a.f[1] + b.f[1], a.f[2] + b.f[2], a.f[3] + b.f[3] } };
+	}
+
+	inline XMVECTOR XMVectorSubtract(FXMVECTOR a, FXMVECTOR b)
+	{
+		return XMVECTOR{ { a.f[0] - b.f[0], a.f[1] - b.f[1], a.f[2] - b.f[2], a.f[3] - b.f[3] } };
+	}
+
+	inline XMVECTOR XMVectorMultiply(FXMVECTOR a, FXMVECTOR b)
+	{
+		return XMVECTOR{ { a.f[0] * b.f[0], a.f[1] * b.f[1], a.f[2] * b.f[2], a.f[3] * b.f[3] } };
+	}
+
+	inline XMVECTOR XMVectorScale(FXMVECTOR v, float s)
+	{
+		return XMVECTOR{ { v.f[0] * s, v.f[1] * s, v.f[2] * s, v.f[3] * s } };
+	}
+
+	inline XMVECTOR XMVectorNegate(FXMVECTOR v)
+	{
+		return XMVECTOR{ { -v.f[0], -v.f[1], -v.f[2], -v.f[3] } };
+	}
+
+	inline XMVECTOR XMVectorMin(FXMVECTOR a, FXMVECTOR b)
+	{
+		return XMVECTOR{ { std::fmin(a.f[0], b.f[0]), std::fmin(a.f[1], b.f[1]), std::fmin(a.f[2], b.f[2]), std::fmin(a.f[3], b.f[3]) } };
+	}
+
+	inline XMVECTOR XMVectorMax(FXMVECTOR a, FXMVECTOR b)
+	{
+		return XMVECTOR{ { std::fmax(a.f[0], b.f[0]), std::fmax(a.f[1], b.f[1]), std::fmax(a.f[2], b.f[2]), std::fmax(a.f[3], b.f[3]) } };
+	}
+
+	// a + t * (b - a)
+	inline XMVECTOR XMVectorLerp(FXMVECTOR a, FXMVECTOR b, float t)
+	{
+		return XMVectorAdd(a, XMVectorScale(XMVectorSubtract(b, a), t));
+	}
+
+	inline float XMVector3DotScalar(FXMVECTOR a, FXMVECTOR b)
+	{
+		return a.f[0] * b.f[0] + a.f[1] * b.f[1] + a.f[2] * b.f[2];
+	}
+
+	inline XMVECTOR XMVector3Dot(FXMVECTOR a, FXMVECTOR b)
+	{
+		return XMVectorReplicate(XMVector3DotScalar(a, b));
+	}
+
+	inline XMVECTOR XMVector3Cross(FXMVECTOR a, FXMVECTOR b)
+	{
+		return XMVECTOR{ {
+			a.f[1] * b.f[2] - a.f[2] * b.f[1],
+			a.f[2] * b.f[0] - a.f[0] * b.f[2],
+			a.f[0] * b.f[1] - a.f[1] * b.f[0],
+			0.0f } };
+	}
+
+	inline XMVECTOR XMVector3Length(FXMVECTOR v)
+	{
+		return XMVectorReplicate(std::sqrt(XMVector3DotScalar(v, v)));
+	}
+
+	// Zero stays zero, as in the SDK.
+	inline XMVECTOR XMVector3Normalize(FXMVECTOR v)
+	{
+		float length = std::sqrt(XMVector3DotScalar(v, v));
+		float scale = length > 0.0f ? 1.0f / length : 0.0f;
+		return XMVECTOR{ { v.f[0] * scale, v.f[1] * scale, v.f[2] * scale, v.f[3] * scale } };
+	}
+
+	// Position: w is taken as 1.
+	inline XMVECTOR XMVector3Transform(FXMVECTOR v, FXMMATRIX M)
+	{
+		XMVECTOR r;
+		for (int j = 0; j < 4; ++j)
+			r.f[j] = v.f[0] * M.r[0].f[j] + v.f[1] * M.r[1].f[j] + v.f[2] * M.r[2].f[j] + M.r[3].f[j];
+		return r;
+	}
+
+	// Direction: translation is ignored.
+	inline XMVECTOR XMVector3TransformNormal(FXMVECTOR v, FXMMATRIX M)
+	{
+		XMVECTOR r;
+		for (int j = 0; j < 4; ++j)
+			r.f[j] = v.f[0] * M.r[0].f[j] + v.f[1] * M.r[1].f[j] + v.f[2] * M.r[2].f[j];
+		return r;
+	}
+
+	inline XMVECTOR XMVector4Transform(FXMVECTOR v, FXMMATRIX M)
+	{
+		XMVECTOR r;
+		for (int j = 0; j < 4; ++j)
+			r.f[j] = v.f[0] * M.r[0].f[j] + v.f[1] * M.r[1].f[j] + v.f[2] * M.r[2].f[j] + v.f[3] * M.r[3].f[j];
+		return r;
+	}
+
+	inline XMVECTOR operator+(FXMVECTOR a, FXMVECTOR b)		{	return XMVectorAdd(a, b);	}
+	inline XMVECTOR operator-(FXMVECTOR a, FXMVECTOR b)		{	return XMVectorSubtract(a, b);	}
+	inline XMVECTOR operator*(FXMVECTOR a, FXMVECTOR b)		{	return XMVectorMultiply(a, b);	}
+	inline XMVECTOR operator*(FXMVECTOR v, float s)			{	return XMVectorScale(v, s);	}
+	inline XMVECTOR operator*(float s, FXMVECTOR v)			{	return XMVectorScale(v, s);	}
+	inline XMVECTOR operator-(FXMVECTOR v)					{	return XMVectorNegate(v);	}
+
+	// Quaternions, (x, y, z) vector part and w scalar part.
+
+	inline XMVECTOR XMQuaternionIdentity()					{	return g_XMIdentityR3;	}
+
+	inline XMVECTOR XMQuaternionRotationAxis(FXMVECTOR axis, float angle)
+	{
+		XMVECTOR n = XMVector3Normalize(axis);
+		float s = std::sin(0.5f * angle);
+		return XMVECTOR{ { n.f[0] * s, n.f[1] * s, n.f[2] * s, std::cos(0.5f * angle) } };
+	}
+
+	inline XMVECTOR XMQuaternionMultiply(FXMVECTOR q1, FXMVECTOR q2)
+	{
+		// q2 * q1: rotates by q1, then by q2.
+		const float* a = q2.f;
+		const float* b = q1.f;
+		return XMVECTOR{ {
+			a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1],
+			a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0],
+			a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3],
+			a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2] } };
+	}
+
+	// Takes the shorter arc, and falls back to a lerp when the quaternions
+	// are nearly equal.
+	inline XMVECTOR XMQuaternionSlerp(FXMVECTOR q0, FXMVECTOR q1, float t)
+	{
+		const float oneMinusEpsilon = 1.0f - 0.00001f;
+
+		float cosOmega = q0.f[0] * q1.f[0] + q0.f[1] * q1.f[1] + q0.f[2] * q1.f[2] + q0.f[3] * q1.f[3];
+		float sign = cosOmega < 0.0f ? -1.0f : 1.0f;
+		cosOmega *= sign;
+
+		float s0, s1;
+		if (cosOmega < oneMinusEpsilon)
+		{
+			float sinOmega = std::sqrt(1.0f - cosOmega * cosOmega);
+			float omega = std::atan2(sinOmega, cosOmega);
+			s0 = std::sin((1.0f - t) * omega) / sinOmega;
+			s1 = std::sin(t * omega) / sinOmega;
+		}
+		else
+		{
+			s0 = 1.0f - t;
+			s1 = t;
+		}
+		s1 *= sign;
+
+		return XMVectorAdd(XMVectorScale(q0, s0), XMVectorScale(q1, s1));
+	}
+
+	// Matrices: row-major, applied to row vectors.
+
+	inline XMMATRIX XMMatrixIdentity()
+	{
+		return XMMATRIX(g_XMIdentityR0, g_XMIdentityR1, g_XMIdentityR2, g_XMIdentityR3);
+	}
+
+	inline XMMATRIX XMMatrixMultiply(FXMMATRIX a, CXMMATRIX b)
+	{
+		XMMATRIX r;
+		for (int i = 0; i < 4; ++i)
+			r.r[i] = XMVector4Transform(a.r[i], b);
+		return r;
+	}
+
+	inline XMMATRIX XMMatrixTranspose(FXMMATRIX M)
+	{
+		return XMMATRIX(
+			M.r[0].f[0], M.r[1].f[0], M.r[2].f[0], M.r[3].f[0],
+			M.r[0].f[1], M.r[1].f[1], M.r[2].f[1], M.r[3].f[1],
+			M.r[0].f[2], M.r[1].f[2], M.r[2].f[2], M.r[3].f[2],
+			M.r[0].f[3], M.r[1].f[3], M.r[2].f[3], M.r[3].f[3]);
+	}
+
+	inline XMMATRIX XMMatrixTranslation(float x, float y, float z)
+	{
+		return XMMATRIX(
+			1.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			x, y, z, 1.0f);
+	}
+
+	inline XMMATRIX XMMatrixScaling(float x, float y, float z)
+	{
+		return XMMATRIX(
+			x, 0.0f, 0.0f, 0.0f,
+			0.0f, y, 0.0f, 0.0f,
+			0.0f, 0.0f, z, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+	inline XMMATRIX XMMatrixRotationY(float angle)
+	{
+		float s = std::sin(angle);
+		float c = std::cos(angle);
+		return XMMATRIX(
+			c, 0.0f, -s, 0.0f,
+			0.0f, 1.0f, 0.0f, 0.0f,
+			s, 0.0f, c, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+	inline XMMATRIX XMMatrixRotationQuaternion(FXMVECTOR q)
+	{
+		float x = q.f[0], y = q.f[1], z = q.f[2], w = q.f[3];
+		return XMMATRIX(
+			1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w), 0.0f,
+			2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w), 0.0f,
+			2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y), 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+	// Scales, rotates about `rotationOrigin`, then translates.
+	inline XMMATRIX XMMatrixAffineTransformation(FXMVECTOR scaling, FXMVECTOR rotationOrigin,
+		FXMVECTOR rotationQuaternion, GXMVECTOR translation)
+	{
+		XMMATRIX M = XMMatrixScaling(scaling.f[0], scaling.f[1], scaling.f[2]);
+		XMVECTOR origin = XMVectorSetW(rotationOrigin, 0.0f);
+		M.r[3] = XMVectorSubtract(M.r[3], origin);
+		M = XMMatrixMultiply(M, XMMatrixRotationQuaternion(rotationQuaternion));
+		M.r[3] = XMVectorAdd(M.r[3], origin);
+		M.r[3] = XMVectorAdd(M.r[3], XMVectorSetW(translation, 0.0f));
+		return M;
+	}
+
+	inline XMMATRIX XMMatrixLookToLH(FXMVECTOR eyePosition, FXMVECTOR eyeDirection, FXMVECTOR upDirection)
+	{
+		XMVECTOR r2 = XMVector3Normalize(eyeDirection);
+		XMVECTOR r0 = XMVector3Normalize(XMVector3Cross(upDirection, r2));
+		XMVECTOR r1 = XMVector3Cross(r2, r0);
+		XMVECTOR negEye = XMVectorNegate(eyePosition);
+
+		return XMMATRIX(
+			r0.f[0], r1.f[0], r2.f[0], 0.0f,
+			r0.f[1], r1.f[1], r2.f[1], 0.0f,
+			r0.f[2], r1.f[2], r2.f[2], 0.0f,
+			XMVector3DotScalar(r0, negEye), XMVector3DotScalar(r1, negEye), XMVector3DotScalar(r2, negEye), 1.0f);
+	}
+
+	inline XMMATRIX XMMatrixLookAtLH(FXMVECTOR eyePosition, FXMVECTOR focusPosition, FXMVECTOR upDirection)
+	{
+		return XMMatrixLookToLH(eyePosition, XMVectorSubtract(focusPosition, eyePosition), upDirection);
+	}
+
+	inline XMMATRIX XMMatrixPerspectiveFovLH(float fovAngleY, float aspectRatio, float nearZ, float farZ)
+	{
+		float height = std::cos(0.5f * fovAngleY) / std::sin(0.5f * fovAngleY);
+		float width = height / aspectRatio;
+		float range = farZ / (farZ - nearZ);
+
+		return XMMATRIX(
+			width, 0.0f, 0.0f, 0.0f,
+			0.0f, height, 0.0f, 0.0f,
+			0.0f, 0.0f, range, 1.0f,
+			0.0f, 0.0f, -range * nearZ, 0.0f);
+	}
+
+	inline XMVECTOR XMMatrixDeterminant(FXMMATRIX M)
+	{
+		const float (*m)[4] = reinterpret_cast<const float (*)[4]>(&M.r[0].f[0]);
+
+		float s0 = m[2][2] * m[3][3] - m[2][3] * m[3][2];
+		float s1 = m[2][1] * m[3][3] - m[2][3] * m[3][1];
+		float s2 = m[2][1] * m[3][2] - m[2][2] * m[3][1];
+		float s3 = m[2][0] * m[3][3] - m[2][3] * m[3][0];
+		float s4 = m[2][0] * m[3][2] - m[2][2] * m[3][0];
+		float s5 = m[2][0] * m[3][1] - m[2][1] * m[3][0];
+
+		float det = m[0][0] * (m[1][1] * s0 - m[1][2] * s1 + m[1][3] * s2)
+			- m[0][1] * (m[1][0] * s0 - m[1][2] * s3 + m[1][3] * s4)
+			+ m[0][2] * (m[1][0] * s1 - m[1][1] * s3 + m[1][3] * s5)
+			- m[0][3] * (m[1][0] * s2 - m[1][1] * s4 + m[1][2] * s5);
+		return XMVectorReplicate(det);
+	}
+
+	// Adjugate over determinant. A singular matrix gives infinities, as in
+	// the SDK.
+	inline XMMATRIX XMMatrixInverse(XMVECTOR* determinant, FXMMATRIX M)
+	{
+		const float (*m)[4] = reinterpret_cast<const float (*)[4]>(&M.r[0].f[0]);
+
+		float a0 = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+		float a1 = m[0][0] * m[1][2] - m[0][2] * m[1][0];
+		float a2 = m[0][0] * m[1][3] - m[0][3] * m[1][0];
+		float a3 = m[0][1] * m[1][2] - m[0][2] * m[1][1];
+		float a4 = m[0][1] * m[1][3] - m[0][3] * m[1][1];
+		float a5 = m[0][2] * m[1][3] - m[0][3] * m[1][2];
+		float b0 = m[2][0] * m[3][1] - m[2][1] * m[3][0];
+		float b1 = m[2][0] * m[3][2] - m[2][2] * m[3][0];
+		float b2 = m[2][0] * m[3][3] - m[2][3] * m[3][0];
+		float b3 = m[2][1] * m[3][2] - m[2][2] * m[3][1];
+		float b4 = m[2][1] * m[3][3] - m[2][3] * m[3][1];
+		float b5 = m[2][2] * m[3][3] - m[2][3] * m[3][2];
+
+		float det = a0 * b5 - a1 * b4 + a2 * b3 + a3 * b2 - a4 * b1 + a5 * b0;
+		if (determinant != nullptr)
+			*determinant = XMVectorReplicate(det);
+		float inv = 1.0f / det;
+
+		return XMMATRIX(
+			(m[1][1] * b5 - m[1][2] * b4 + m[1][3] * b3) * inv,
+			(-m[0][1] * b5 + m[0][2] * b4 - m[0][3] * b3) * inv,
+			(m[3][1] * a5 - m[3][2] * a4 + m[3][3] * a3) * inv,
+			(-m[2][1] * a5 + m[2][2] * a4 - m[2][3] * a3) * inv,
+
+			(-m[1][0] * b5 + m[1][2] * b2 - m[1][3] * b1) * inv,
+			(m[0][0] * b5 - m[0][2] * b2 + m[0][3] * b1) * inv,
+			(-m[3][0] * a5 + m[3][2] * a2 - m[3][3] * a1) * inv,
+			(m[2][0] * a5 - m[2][2] * a2 + m[2][3] * a1) * inv,
+
+			(m[1][0] * b4 - m[1][1] * b2 + m[1][3] * b0) * inv,
+			(-m[0][0] * b4 + m[0][1] * b2 - m[0][3] * b0) * inv,
+			(m[3][0] * a4 - m[3][1] * a2 + m[3][3] * a0) * inv,
+			(-m[2][0] * a4 + m[2][1] * a2 - m[2][3] * a0) * inv,
+
+			(-m[1][0] * b3 + m[1][1] * b1 - m[1][2] * b0) * inv,
+			(m[0][0] * b3 - m[0][1] * b1 + m[0][2] * b0) * inv,
+			(-m[3][0] * a3 + m[3][1] * a1 - m[3][2] * a0) * inv,
+			(m[2][0] * a3 - m[2][1] * a1 + m[2][2] * a0) * inv);
+	}
+}
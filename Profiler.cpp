@@ -0,0 +1,225 @@
+#include "Profiler.h"
+#include "GameTimer.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	// JSON string escaping for zone and track names.
+	void WriteJsonString(std::ostringstream& out, const char* s)
+	{
+		out << '"';
+		for (; *s; ++s)
+		{
+			switch (*s)
+			{
+			case '"':	out << "\\\""; break;
+			case '\\':	out << "\\\\"; break;
+			case '\n':	out << "\\n"; break;
+			default:
+				if ((unsigned char)*s < 0x20)
+				{
+					char buf[8];
+					snprintf(buf, sizeof(buf), "\\u%04x", *s);
+					out << buf;
+				}
+				else
+				{
+					out << *s;
+				}
+			}
+		}
+		out << '"';
+	}
+}
+
+Profiler& Profiler::Get()
+{
+	static Profiler profiler;
+	return profiler;
+}
+
+Profiler::Profiler()
+	: m_epoch(GameTimer::QueryCounter())
+{
+}
+
+std::uint32_t& Profiler::ThreadDepth()
+{
+	thread_local std::uint32_t depth = 0;
+	return depth;
+}
+
+// The caller holds m_mutex.
+Profiler::ThreadBuffer* Profiler::CreateBufferLocked(const std::string& name)
+{
+	auto buffer = std::make_unique<ThreadBuffer>();
+	buffer->Id = (std::uint32_t)m_buffers.size();
+	buffer->Name = name.empty() ? "Thread " + std::to_string(buffer->Id) : name;
+	m_buffers.push_back(std::move(buffer));
+	return m_buffers.back().get();
+}
+
+Profiler::ThreadBuffer* Profiler::GetThreadBuffer()
+{
+	// Buffers are never freed while the profiler lives, so exports still see
+	// the events of threads that have exited.
+	thread_local ThreadBuffer* buffer = nullptr;
+	if (buffer == nullptr)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		buffer = CreateBufferLocked(std::string());
+	}
+	return buffer;
+}
+
+Profiler::ThreadBuffer* Profiler::GetTrackBuffer(const char* track)
+{
+	// Look up and create under one lock, so two threads recording on a new
+	// track at once do not create it twice.
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (auto& buffer : m_buffers)
+	{
+		if (buffer->Name == track)
+			return buffer.get();
+	}
+	return CreateBufferLocked(track);
+}
+
+void Profiler::Push(ThreadBuffer* buffer, const ProfileEvent& e)
+{
+	std::uint64_t head = buffer->Head.load(std::memory_order_relaxed);
+	buffer->Events[head % EventsPerThread] = e;
+	buffer->Head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::RecordZone(const char* name, std::int64_t begin, std::int64_t end, std::uint32_t depth)
+{
+	ProfileEvent e;
+	e.Name = name;
+	e.Begin = begin;
+	e.End = end;
+	e.Depth = depth;
+	e.EventType = ProfileEvent::Type::Zone;
+	Push(GetThreadBuffer(), e);
+}
+
+void Profiler::RecordCounter(const char* name, double value)
+{
+	ProfileEvent e;
+	e.Name = name;
+	e.Begin = e.End = GameTimer::QueryCounter();
+	e.Value = value;
+	e.EventType = ProfileEvent::Type::Counter;
+	Push(GetThreadBuffer(), e);
+}
+
+void Profiler::RecordTrackZone(const char* track, const char* name, std::int64_t begin, std::int64_t end, std::uint32_t depth)
+{
+	ProfileEvent e;
+	e.Name = name;
+	e.Begin = begin;
+	e.End = end;
+	e.Depth = depth;
+	e.EventType = ProfileEvent::Type::Zone;
+
+	// Track buffers are shared, unlike thread buffers, so serialise writers.
+	ThreadBuffer* buffer = GetTrackBuffer(track);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Push(buffer, e);
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+	ThreadBuffer* buffer = GetThreadBuffer();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	buffer->Name = name;
+}
+
+std::string Profiler::ExportChromeTrace() const
+{
+	const double microPerCount = GameTimer::SecondsPerCount() * 1e6;
+
+	std::ostringstream out;
+	out.precision(3);
+	out << std::fixed;
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	bool first = true;
+	auto separator = [&]()
+	{
+		if (!first)
+			out << ",\n";
+		first = false;
+	};
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (const auto& buffer : m_buffers)
+	{
+		separator();
+		out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":0,\"tid\":" << buffer->Id << ",\"args\":{\"name\":";
+		WriteJsonString(out, buffer->Name.c_str());
+		out << "}}";
+
+		std::uint64_t head = buffer->Head.load(std::memory_order_acquire);
+		std::uint64_t count = std::min<std::uint64_t>(head - buffer->ClearedHead, EventsPerThread);
+		for (std::uint64_t i = head - count; i < head; ++i)
+		{
+			const ProfileEvent& e = buffer->Events[i % EventsPerThread];
+			double ts = (e.Begin - m_epoch) * microPerCount;
+
+			separator();
+			out << "{\"name\":";
+			WriteJsonString(out, e.Name);
+			if (e.EventType == ProfileEvent::Type::Zone)
+			{
+				out << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->Id
+					<< ",\"ts\":" << ts << ",\"dur\":" << (e.End - e.Begin) * microPerCount
+					<< ",\"args\":{\"depth\":" << e.Depth << "}}";
+			}
+			else
+			{
+				out << ",\"ph\":\"C\",\"pid\":0,\"tid\":" << buffer->Id
+					<< ",\"ts\":" << ts << ",\"args\":{\"value\":" << e.Value << "}}";
+			}
+		}
+	}
+
+	out << "]}\n";
+	return out.str();
+}
+
+bool Profiler::ExportChromeTrace(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+
+	file << ExportChromeTrace();
+	return (bool)file;
+}
+
+void Profiler::Clear()
+{
+	// Writers own Head: resetting it here could race a Push that read the old
+	// value and bring the cleared events back. Skip past them instead.
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (auto& buffer : m_buffers)
+		buffer->ClearedHead = buffer->Head.load(std::memory_order_acquire);
+	m_epoch = GameTimer::QueryCounter();
+}
+
+ProfileScope::ProfileScope(const char* name)
+	: m_name(name), m_depth(Profiler::ThreadDepth()++)
+{
+	m_begin = GameTimer::QueryCounter();
+}
+
+ProfileScope::~ProfileScope()
+{
+	std::int64_t end = GameTimer::QueryCounter();
+	Profiler::ThreadDepth()--;
+	Profiler::Get().RecordZone(m_name, m_begin, end, m_depth);
+}
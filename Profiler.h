@@ -0,0 +1,118 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Compile with PROFILER_ENABLED=0 to strip every PROFILE_* macro.
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+// One recorded zone or counter sample. Names must be string literals (or
+// otherwise outlive the capture): only the pointer is stored.
+struct ProfileEvent
+{
+	enum class Type : std::uint8_t { Zone, Counter };
+
+	const char*								Name = nullptr;
+	std::int64_t							Begin = 0;		// GameTimer counter ticks
+	std::int64_t							End = 0;
+	double									Value = 0.0;	// counters only
+	std::uint32_t							Depth = 0;
+	Type									EventType = Type::Zone;
+};
+
+// Hierarchical CPU profiler.
+//
+// Each thread writes into its own fixed-size ring buffer, so recording takes
+// no lock: a zone costs two counter reads and one store into thread-local
+// memory. Once a ring is full the oldest events are overwritten. Export reads
+// the rings from another thread; events written while an export is running
+// may be torn, so capture at a quiet point (e.g. between frames). Clear only
+// moves each ring's read position and never touches what writers own, so it
+// is safe to call at any time.
+//
+// Captures export to the Chrome trace event JSON format, which both
+// chrome://tracing and the Perfetto UI open directly.
+class Profiler
+{
+public:
+
+	static const std::uint32_t				EventsPerThread = 1 << 16;
+
+	static Profiler&						Get();
+
+	void									RecordZone(const char* name, std::int64_t begin, std::int64_t end, std::uint32_t depth);
+	void									RecordCounter(const char* name, double value);
+
+	// Adds events timed elsewhere (e.g. on the GPU) on a named track of
+	// their own. Tracks are created on first use.
+	void									RecordTrackZone(const char* track, const char* name, std::int64_t begin, std::int64_t end, std::uint32_t depth);
+
+	void									SetThreadName(const char* name);
+
+	// Zone nesting depth of the calling thread.
+	static std::uint32_t&					ThreadDepth();
+
+	std::string								ExportChromeTrace()		const;
+	bool									ExportChromeTrace(const std::string& path)	const;
+	void									Clear();
+
+private:
+
+	struct ThreadBuffer
+	{
+		std::string							Name;
+		std::uint32_t						Id = 0;
+		std::atomic<std::uint64_t>			Head { 0 };
+		std::uint64_t						ClearedHead = 0;	// guarded by m_mutex
+		std::unique_ptr<ProfileEvent[]>		Events { new ProfileEvent[EventsPerThread] };
+	};
+
+											Profiler();
+
+	ThreadBuffer*							GetThreadBuffer();
+	ThreadBuffer*							GetTrackBuffer(const char* track);
+	ThreadBuffer*							CreateBufferLocked(const std::string& name);
+	static void								Push(ThreadBuffer* buffer, const ProfileEvent& e);
+
+	mutable std::mutex						m_mutex;
+	std::vector<std::unique_ptr<ThreadBuffer>>	m_buffers;
+	std::int64_t							m_epoch = 0;
+};
+
+// RAII zone: records [construction, destruction) on the calling thread.
+class ProfileScope
+{
+public:
+
+											ProfileScope(const char* name);
+											~ProfileScope();
+
+											ProfileScope(const ProfileScope& rhs) = delete;
+											ProfileScope& operator=(const ProfileScope& rhs) = delete;
+
+private:
+
+	const char*								m_name;
+	std::int64_t							m_begin;
+	std::uint32_t							m_depth;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if PROFILER_ENABLED
+#define PROFILE_SCOPE(name)					ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#define PROFILE_FUNCTION()					PROFILE_SCOPE(__FUNCTION__)
+#define PROFILE_COUNTER(name, value)		Profiler::Get().RecordCounter(name, (double)(value))
+#define PROFILE_THREAD_NAME(name)			Profiler::Get().SetThreadName(name)
+#else
+#define PROFILE_SCOPE(name)					((void)0)
+#define PROFILE_FUNCTION()					((void)0)
+#define PROFILE_COUNTER(name, value)		((void)0)
+#define PROFILE_THREAD_NAME(name)			((void)0)
+#endif
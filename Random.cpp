@@ -0,0 +1,297 @@
+#include "Random.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#else
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	// Batches run the eight streams side by side. Every register holds
+	// 64-bit words of LaneRegisterStreams streams, which are used as twice
+	// as many 32-bit values.
+#if defined(__AVX2__)
+	const int LaneRegisterStreams = 4;
+	using Lanes = __m256i;
+	using FloatLanes = __m256;
+
+	Lanes Load(const std::uint64_t* p)							{	return _mm256_load_si256(reinterpret_cast<const __m256i*>(p));	}
+	void Store(std::uint64_t* p, Lanes v)						{	_mm256_store_si256(reinterpret_cast<__m256i*>(p), v);	}
+	void StoreU(std::uint32_t* p, Lanes v)						{	_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);	}
+	void StoreF(float* p, FloatLanes v)							{	_mm256_storeu_ps(p, v);	}
+	Lanes Splat32(std::uint32_t value)							{	return _mm256_set1_epi32((std::int32_t)value);	}
+	Lanes Splat64(std::uint64_t value)							{	return _mm256_set1_epi64x((long long)value);	}
+	FloatLanes SplatF(float value)								{	return _mm256_set1_ps(value);	}
+	Lanes Add64(Lanes a, Lanes b)								{	return _mm256_add_epi64(a, b);	}
+	Lanes Xor(Lanes a, Lanes b)									{	return _mm256_xor_si256(a, b);	}
+	Lanes Or(Lanes a, Lanes b)									{	return _mm256_or_si256(a, b);	}
+	Lanes And(Lanes a, Lanes b)									{	return _mm256_and_si256(a, b);	}
+	template<int K> Lanes Shl64(Lanes a)						{	return _mm256_slli_epi64(a, K);	}
+	template<int K> Lanes Shr64(Lanes a)						{	return _mm256_srli_epi64(a, K);	}
+	template<int K> Lanes Shr32(Lanes a)						{	return _mm256_srli_epi32(a, K);	}
+	// Products of the low 32 bits of every 64-bit word.
+	Lanes MulLow32(Lanes a, Lanes b)							{	return _mm256_mul_epu32(a, b);	}
+	int LessMask32(Lanes a, Lanes b)							{	return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(b, a)));	}
+	FloatLanes ToFloat(Lanes a)									{	return _mm256_cvtepi32_ps(a);	}
+	FloatLanes AddF(FloatLanes a, FloatLanes b)					{	return _mm256_add_ps(a, b);	}
+	FloatLanes MulF(FloatLanes a, FloatLanes b)					{	return _mm256_mul_ps(a, b);	}
+	FloatLanes MinF(FloatLanes a, FloatLanes b)					{	return _mm256_min_ps(a, b);	}
+	FloatLanes MaxF(FloatLanes a, FloatLanes b)					{	return _mm256_max_ps(a, b);	}
+#else
+	const int LaneRegisterStreams = 2;
+	using Lanes = __m128i;
+	using FloatLanes = __m128;
+
+	Lanes Load(const std::uint64_t* p)							{	return _mm_load_si128(reinterpret_cast<const __m128i*>(p));	}
+	void Store(std::uint64_t* p, Lanes v)						{	_mm_store_si128(reinterpret_cast<__m128i*>(p), v);	}
+	void StoreU(std::uint32_t* p, Lanes v)						{	_mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);	}
+	void StoreF(float* p, FloatLanes v)							{	_mm_storeu_ps(p, v);	}
+	Lanes Splat32(std::uint32_t value)							{	return _mm_set1_epi32((std::int32_t)value);	}
+	Lanes Splat64(std::uint64_t value)							{	return _mm_set1_epi64x((long long)value);	}
+	FloatLanes SplatF(float value)								{	return _mm_set1_ps(value);	}
+	Lanes Add64(Lanes a, Lanes b)								{	return _mm_add_epi64(a, b);	}
+	Lanes Xor(Lanes a, Lanes b)									{	return _mm_xor_si128(a, b);	}
+	Lanes Or(Lanes a, Lanes b)									{	return _mm_or_si128(a, b);	}
+	Lanes And(Lanes a, Lanes b)									{	return _mm_and_si128(a, b);	}
+	template<int K> Lanes Shl64(Lanes a)						{	return _mm_slli_epi64(a, K);	}
+	template<int K> Lanes Shr64(Lanes a)						{	return _mm_srli_epi64(a, K);	}
+	template<int K> Lanes Shr32(Lanes a)						{	return _mm_srli_epi32(a, K);	}
+	Lanes MulLow32(Lanes a, Lanes b)							{	return _mm_mul_epu32(a, b);	}
+	int LessMask32(Lanes a, Lanes b)							{	return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(a, b)));	}
+	FloatLanes ToFloat(Lanes a)									{	return _mm_cvtepi32_ps(a);	}
+	FloatLanes AddF(FloatLanes a, FloatLanes b)					{	return _mm_add_ps(a, b);	}
+	FloatLanes MulF(FloatLanes a, FloatLanes b)					{	return _mm_mul_ps(a, b);	}
+	FloatLanes MinF(FloatLanes a, FloatLanes b)					{	return _mm_min_ps(a, b);	}
+	FloatLanes MaxF(FloatLanes a, FloatLanes b)					{	return _mm_max_ps(a, b);	}
+#endif
+
+	const int LaneRegisters = Random::StreamCount / LaneRegisterStreams;
+	const int ValuesPerRegister = LaneRegisterStreams * 2;
+	const std::size_t ValuesPerStep = Random::StreamCount * 2;
+
+	template<int K> Lanes Rotl64(Lanes a)						{	return Or(Shl64<K>(a), Shr64<64 - K>(a));	}
+
+	// Unsigned a < b on 32-bit values, one mask bit per value.
+	int UnsignedLessMask32(Lanes a, Lanes b)
+	{
+		const Lanes sign = Splat32(0x80000000u);
+		return LessMask32(Xor(a, sign), Xor(b, sign));
+	}
+
+	std::uint64_t SplitMix64(std::uint64_t& state)
+	{
+		std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	// Steps the streams, ValuesPerStep 32-bit values at a time, and hands
+	// every register of output bits to `convert` with where its values go.
+	// The last partial step goes through scratch, so the streams advance the
+	// same way whatever `count` is rounded to.
+	template<typename T, typename Convert>
+	void GenerateBatch(std::uint64_t (&streams)[4][Random::StreamCount], T* out, std::size_t count, Convert convert)
+	{
+		Lanes s[4][LaneRegisters];
+		for (int w = 0; w < 4; ++w)
+			for (int r = 0; r < LaneRegisters; ++r)
+				s[w][r] = Load(&streams[w][r * LaneRegisterStreams]);
+
+		T scratch[ValuesPerStep];
+		for (std::size_t i = 0; i < count; i += ValuesPerStep)
+		{
+			const std::size_t n = std::min(count - i, ValuesPerStep);
+			T* dst = n == ValuesPerStep ? out + i : scratch;
+
+			for (int r = 0; r < LaneRegisters; ++r)
+			{
+				const Lanes result = Add64(Rotl64<23>(Add64(s[0][r], s[3][r])), s[0][r]);
+				const Lanes t = Shl64<17>(s[1][r]);
+				s[2][r] = Xor(s[2][r], s[0][r]);
+				s[3][r] = Xor(s[3][r], s[1][r]);
+				s[1][r] = Xor(s[1][r], s[2][r]);
+				s[0][r] = Xor(s[0][r], s[3][r]);
+				s[2][r] = Xor(s[2][r], t);
+				s[3][r] = Rotl64<45>(s[3][r]);
+
+				convert(result, dst + r * ValuesPerRegister);
+			}
+
+			if (dst == scratch)
+				std::copy(scratch, scratch + n, out + i);
+		}
+
+		for (int w = 0; w < 4; ++w)
+			for (int r = 0; r < LaneRegisters; ++r)
+				Store(&streams[w][r * LaneRegisterStreams], s[w][r]);
+	}
+
+	std::atomic<std::uint64_t>				g_threadCount { 0 };
+}
+
+Random::Random(std::uint64_t seed)
+{
+	Seed(seed);
+}
+
+void Random::Seed(std::uint64_t seed)
+{
+	for (int i = 0; i < 4; ++i)
+		m_state[i] = SplitMix64(seed);
+
+	// Batch stream k is the main sequence jumped k + 1 times and the redraw
+	// stream comes after them, so no two overlap for 2^128 outputs.
+	std::uint64_t state[4];
+	std::copy(m_state, m_state + 4, state);
+	for (std::uint32_t k = 0; k < StreamCount; ++k)
+	{
+		Jump();
+		for (int w = 0; w < 4; ++w)
+			m_streams[w][k] = m_state[w];
+	}
+	Jump();
+	std::copy(m_state, m_state + 4, m_redrawState);
+	std::copy(state, state + 4, m_state);
+}
+
+std::uint32_t Random::NextUInt(std::uint32_t bound)
+{
+	return Bounded(m_state, bound);
+}
+
+std::uint32_t Random::Bounded(std::uint64_t* s, std::uint32_t bound)
+{
+	// Lemire's multiply-shift: the high half of x * bound is in range, and
+	// the few low halves that would make some results more likely than
+	// others are redrawn. The division only runs when a redraw is possible.
+	std::uint64_t m = (Step(s) >> 32) * bound;
+	std::uint32_t low = (std::uint32_t)m;
+	if (low < bound)
+	{
+		const std::uint32_t threshold = (0u - bound) % bound;
+		while (low < threshold)
+		{
+			m = (Step(s) >> 32) * bound;
+			low = (std::uint32_t)m;
+		}
+	}
+	return (std::uint32_t)(m >> 32);
+}
+
+std::int32_t Random::NextInt(std::int32_t a, std::int32_t b)
+{
+	assert(a <= b);
+	// A range of 2^32 wraps to 0: every value is in it.
+	const std::uint32_t range = (std::uint32_t)b - (std::uint32_t)a + 1u;
+	const std::uint32_t offset = range == 0 ? NextUInt32() : NextUInt(range);
+	return (std::int32_t)((std::uint32_t)a + offset);
+}
+
+void Random::UnitVector(float v[3])
+{
+	// z is uniform in [-1, 1] by Archimedes' hat-box theorem, and the angle
+	// around z is uniform.
+	const float z = 1.0f - 2.0f * NextFloat();
+	const float phi = 6.2831853f * NextFloat();
+	const float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+	v[0] = r * std::cos(phi);
+	v[1] = r * std::sin(phi);
+	v[2] = z;
+}
+
+void Random::HemisphereVector(const float n[3], float v[3])
+{
+	// Mirroring the other half keeps the distribution uniform.
+	UnitVector(v);
+	if (n[0] * v[0] + n[1] * v[1] + n[2] * v[2] < 0.0f)
+	{
+		v[0] = -v[0];
+		v[1] = -v[1];
+		v[2] = -v[2];
+	}
+}
+
+void Random::FillFloats(float* out, std::size_t count, float a, float b)
+{
+	// Each 32-bit half gives a float from its top 24 bits.
+	const FloatLanes scale = SplatF((b - a) * (1.0f / 16777216.0f));
+	const FloatLanes offset = SplatF(a);
+	const FloatLanes last = SplatF(std::nextafter(b, a));
+	if (a < b)
+	{
+		GenerateBatch(m_streams, out, count, [&](Lanes bits, float* dst)
+		{
+			StoreF(dst, MinF(AddF(offset, MulF(ToFloat(Shr32<8>(bits)), scale)), last));
+		});
+	}
+	else
+	{
+		GenerateBatch(m_streams, out, count, [&](Lanes bits, float* dst)
+		{
+			StoreF(dst, MaxF(AddF(offset, MulF(ToFloat(Shr32<8>(bits)), scale)), last));
+		});
+	}
+}
+
+void Random::FillUInts(std::uint32_t* out, std::size_t count, std::uint32_t bound)
+{
+	if (bound == 0)
+	{
+		std::fill(out, out + count, 0u);
+		return;
+	}
+	// NextUInt on every 32-bit half. Redraws are needed for fewer than one
+	// value in 2^32 / bound.
+	const Lanes bounds = Splat32(bound);
+	const Lanes threshold = Splat32((0u - bound) % bound);
+	const Lanes lowHalves = Splat64(0xffffffffull);
+	const Lanes highHalves = Splat64(0xffffffff00000000ull);
+	GenerateBatch(m_streams, out, count, [&](Lanes bits, std::uint32_t* dst)
+	{
+		const Lanes even = MulLow32(bits, bounds);
+		const Lanes odd = MulLow32(Shr64<32>(bits), bounds);
+		StoreU(dst, Or(Shr64<32>(even), And(odd, highHalves)));
+
+		int redraw = UnsignedLessMask32(Or(And(even, lowHalves), Shl64<32>(odd)), threshold);
+		while (redraw != 0)
+		{
+			const int i = std::countr_zero((unsigned)redraw);
+			dst[i] = Bounded(m_redrawState, bound);
+			redraw &= redraw - 1;
+		}
+	});
+}
+
+void Random::Jump()
+{
+	static const std::uint64_t jump[4] = { 0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull, 0xa9582618e03fc9aaull, 0x39abdc4529b1661cull };
+
+	std::uint64_t s[4] = {};
+	for (std::uint64_t word : jump)
+	{
+		for (int bit = 0; bit < 64; ++bit)
+		{
+			if (word & (1ull << bit))
+			{
+				for (int i = 0; i < 4; ++i)
+					s[i] ^= m_state[i];
+			}
+			Next();
+		}
+	}
+	for (int i = 0; i < 4; ++i)
+		m_state[i] = s[i];
+}
+
+Random& Random::ThreadLocal()
+{
+	thread_local Random random(DefaultSeed + 0x9e3779b97f4a7c15ull * g_threadCount.fetch_add(1, std::memory_order_relaxed));
+	return random;
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// xoshiro256++ pseudo-random generator: 256 bits of state, a period of
+// 2^256 - 1, and a handful of adds, shifts and xors per 64-bit output. Not
+// cryptographic.
+//
+// A Random is not shared between threads: use one per thread, either seeded
+// explicitly for reproducible sequences or ThreadLocal(). Ranges are
+// unbiased and unit vectors are sampled directly, without rejection loops.
+//
+// The Fill functions generate batches on eight more streams, each the main
+// sequence jumped ahead by a multiple of 2^128, four or eight outputs per
+// instruction. Batches depend only on the seed, not on the instruction set
+// the build targets or on calls to Next(), whose sequence they do not
+// continue.
+class Random
+{
+public:
+
+	static const std::uint64_t				DefaultSeed = 0x853c49e6748fea9bull;
+	static const std::uint32_t				StreamCount = 8;
+
+											Random(std::uint64_t seed = DefaultSeed);
+
+	// Expands `seed` into the state with splitmix64, so nearby seeds give
+	// unrelated sequences.
+	void									Seed(std::uint64_t seed);
+
+	std::uint64_t							Next()						{	return Step(m_state);	}
+	std::uint32_t							NextUInt32()				{	return (std::uint32_t)(Next() >> 32);	}
+
+	// Returns a float in [0, 1) with 24 random bits.
+	float									NextFloat()					{	return (float)(Next() >> 40) * (1.0f / 16777216.0f);	}
+	// Returns a float from a up to b, b excluded, or a if a == b. Either
+	// bound may be the larger one. Values that round onto b become the
+	// float next to it on a's side.
+	float									NextFloat(float a, float b)	{	return ShortOf(a + NextFloat() * (b - a), a, b);	}
+
+	// Returns an integer in [0, bound), or 0 if bound is 0.
+	std::uint32_t							NextUInt(std::uint32_t bound);
+	// Returns an integer in [a, b], both included.
+	std::int32_t							NextInt(std::int32_t a, std::int32_t b);
+
+	// Uniform on the unit sphere.
+	void									UnitVector(float v[3]);
+	// Uniform on the half of the unit sphere on the side `n` points to.
+	// `n` does not need to be normalized.
+	void									HemisphereVector(const float n[3], float v[3]);
+
+	// Floats from a up to b and integers in [0, bound), as NextFloat and
+	// NextUInt.
+	void									FillFloats(float* out, std::size_t count, float a = 0.0f, float b = 1.0f);
+	void									FillUInts(std::uint32_t* out, std::size_t count, std::uint32_t bound);
+
+	// Advances the main sequence by 2^128 outputs, for non-overlapping
+	// sequences from one seed.
+	void									Jump();
+
+	// Generator of the calling thread. Threads get distinct seeds in the
+	// order they first call it.
+	static Random&							ThreadLocal();
+
+private:
+
+	static std::uint64_t					Rotl(std::uint64_t x, int k)	{	return (x << k) | (x >> (64 - k));	}
+
+	static std::uint64_t					Step(std::uint64_t* s)
+	{
+		const std::uint64_t result = Rotl(s[0] + s[3], 23) + s[0];
+		const std::uint64_t t = s[1] << 17;
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = Rotl(s[3], 45);
+		return result;
+	}
+
+	static std::uint32_t					Bounded(std::uint64_t* s, std::uint32_t bound);
+
+	// `value` moved back to the float next to b on a's side if it reached b.
+	static float							ShortOf(float value, float a, float b)	{	return a < b ? std::min(value, std::nextafter(b, a)) : std::max(value, std::nextafter(b, a));	}
+
+	std::uint64_t							m_state[4];
+
+	// Word w of batch stream k is m_streams[w][k]. Values FillUInts has to
+	// redraw come from one more stream.
+	alignas(32) std::uint64_t				m_streams[4][StreamCount];
+	std::uint64_t							m_redrawState[4];
+};
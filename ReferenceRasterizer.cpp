@@ -0,0 +1,721 @@
+#include "ReferenceRasterizer.h"
+#include "GameTimer.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdlib>
+#include <execution>
+#include <fstream>
+#include <limits>
+#include <emmintrin.h>
+
+namespace
+{
+	// 1/16 pixel.
+	const int SubpixelBits = 4;
+	const std::int32_t SubpixelScale = 1 << SubpixelBits;
+
+	// Pixels filled per instruction.
+	const std::int32_t LaneCount = 4;
+
+	// cbPass: View, InvView, Proj and InvProj come before ViewProj.
+	const std::size_t ViewProjOffset = 4 * 16;
+
+	// Batches bound the memory held by set-up triangles.
+	const std::size_t MaxBatchDraws = 256;
+	const std::uint64_t MaxBatchTriangles = 1 << 16;
+
+	enum Outcode : std::uint32_t
+	{
+		OutNear			= 1 << 0,
+		OutFar			= 1 << 1,
+		OutLeft			= 1 << 2,
+		OutRight		= 1 << 3,
+		OutBottom		= 1 << 4,
+		OutTop			= 1 << 5,
+	};
+
+	const int ClipPlaneCount = 6;
+
+	// Triangles are clipped to the view volume itself rather than to a guard
+	// band, which keeps snapped coordinates within 2^15 for targets up to
+	// MaxSize.
+	std::uint32_t ComputeOutcode(const float* v)
+	{
+		float x = v[0], y = v[1], z = v[2], w = v[3];
+
+		std::uint32_t code = 0;
+		if (z < 0.0f)
+			code |= OutNear;
+		if (z > w)
+			code |= OutFar;
+		if (x < -w)
+			code |= OutLeft;
+		if (x > w)
+			code |= OutRight;
+		if (y < -w)
+			code |= OutBottom;
+		if (y > w)
+			code |= OutTop;
+		return code;
+	}
+
+	// Signed distance to the planes of the outcodes, in the same order, >= 0 inside.
+	float PlaneDistance(const float* v, int plane)
+	{
+		switch (plane)
+		{
+		case 0:		return v[2];
+		case 1:		return v[3] - v[2];
+		case 2:		return v[0] + v[3];
+		case 3:		return v[3] - v[0];
+		case 4:		return v[1] + v[3];
+		default:	return v[3] - v[1];
+		}
+	}
+
+	// Rows of the matrix a shader multiplies by, from a constant buffer
+	// matrix with HLSL's default column-major packing.
+	void LoadShaderMatrix(const float* m, __m128* rows)
+	{
+		rows[0] = _mm_loadu_ps(m + 0);
+		rows[1] = _mm_loadu_ps(m + 4);
+		rows[2] = _mm_loadu_ps(m + 8);
+		rows[3] = _mm_loadu_ps(m + 12);
+		_MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+	}
+
+	// mul(v, m) for a row vector.
+	__m128 MultiplyRow(__m128 v, const __m128* rows)
+	{
+		__m128 x = _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+		__m128 y = _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+		__m128 z = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+		__m128 w = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, rows[0]), _mm_mul_ps(y, rows[1])),
+			_mm_add_ps(_mm_mul_ps(z, rows[2]), _mm_mul_ps(w, rows[3])));
+	}
+
+	// Float to UNORM8, as the output merger converts SV_Target.
+	__m128i ToUnorm8(__m128 v)
+	{
+		v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+		return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+	}
+
+	std::uint32_t PackColor(const float* color)
+	{
+		__m128i c = ToUnorm8(_mm_loadu_ps(color));
+		alignas(16) std::int32_t channels[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(channels), c);
+		return (std::uint32_t)channels[0] | ((std::uint32_t)channels[1] << 8)
+			| ((std::uint32_t)channels[2] << 16) | ((std::uint32_t)channels[3] << 24);
+	}
+
+	// Skips whitespace and comments between the fields of a PPM header.
+	bool ReadPpmField(std::istream& in, std::uint32_t& value)
+	{
+		for (;;)
+		{
+			int c = in.peek();
+			if (c == '#')
+				in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+			else if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+				in.get();
+			else
+				break;
+		}
+		return (bool)(in >> value);
+	}
+}
+
+ReferenceRasterizer::ReferenceRasterizer(std::uint32_t width, std::uint32_t height)
+{
+	Resize(width, height);
+}
+
+void ReferenceRasterizer::Resize(std::uint32_t width, std::uint32_t height)
+{
+	assert(width > 0 && width <= MaxSize && height > 0 && height <= MaxSize);
+
+	m_width = width;
+	m_height = height;
+	m_stride = (width + LaneCount - 1) / LaneCount * LaneCount;
+	m_tilesX = (width + TileSize - 1) / TileSize;
+	m_tilesY = (height + TileSize - 1) / TileSize;
+
+	m_color.assign((std::size_t)m_stride * m_height, 0);
+	m_depth.assign((std::size_t)m_stride * m_height, 1.0f);
+	m_bins.assign((std::size_t)m_tilesX * m_tilesY, std::vector<const Triangle*>());
+	m_tileCounters.assign(m_bins.size(), TileCounters());
+}
+
+void ReferenceRasterizer::Clear(const float* color, float depth)
+{
+	std::fill(m_color.begin(), m_color.end(), PackColor(color));
+	std::fill(m_depth.begin(), m_depth.end(), depth);
+}
+
+void ReferenceRasterizer::Draw(const ReferenceDraw* draws, std::size_t count)
+{
+	PROFILE_FUNCTION();
+
+	double start = GameTimer::QueryCounter() * GameTimer::SecondsPerCount();
+
+	std::size_t next = 0;
+	while (next < count)
+	{
+		std::size_t slotCount = 0;
+		std::uint64_t triangles = 0;
+		while (next < count && slotCount < MaxBatchDraws
+			&& (slotCount == 0 || triangles + draws[next].IndexCount / 3 <= MaxBatchTriangles))
+		{
+			if (m_slots.size() == slotCount)
+				m_slots.emplace_back();
+			m_slots[slotCount++].Draw = &draws[next];
+			triangles += draws[next].IndexCount / 3;
+			next++;
+		}
+
+		// Draws only read their inputs and write their own slot.
+		std::for_each(std::execution::par, m_slots.begin(), m_slots.begin() + slotCount, [this](DrawSlot& slot)
+		{
+			ProcessDraw(slot);
+		});
+		Flush(slotCount);
+
+		m_stats.Draws += slotCount;
+		m_stats.Triangles += triangles;
+	}
+
+	m_stats.Seconds += GameTimer::QueryCounter() * GameTimer::SecondsPerCount() - start;
+}
+
+void ReferenceRasterizer::ProcessDraw(DrawSlot& slot) const
+{
+	const ReferenceDraw& draw = *slot.Draw;
+	slot.Vertices.clear();
+	slot.Outcodes.clear();
+	slot.Indices.clear();
+	slot.Triangles.clear();
+
+	std::uint32_t indexCount = draw.IndexCount / 3 * 3;
+	if (indexCount == 0)
+		return;
+
+	auto index = [&draw](std::uint32_t i) -> std::uint32_t
+	{
+		if (draw.Format == IndexFormat::UInt16)
+			return static_cast<const std::uint16_t*>(draw.Indices)[i];
+		return static_cast<const std::uint32_t*>(draw.Indices)[i];
+	};
+
+	// Vertex shader: every vertex the indices reach is shaded once.
+	std::uint32_t minIndex = std::numeric_limits<std::uint32_t>::max();
+	std::uint32_t maxIndex = 0;
+	for (std::uint32_t i = 0; i < indexCount; ++i)
+	{
+		minIndex = std::min(minIndex, index(i));
+		maxIndex = std::max(maxIndex, index(i));
+	}
+
+	std::int64_t first = (std::int64_t)draw.BaseVertex + minIndex;
+	std::uint32_t vertexCount = maxIndex - minIndex + 1;
+	assert(first >= 0 && first + vertexCount <= draw.VertexCount && "Draw reads past its vertex buffer.");
+
+	__m128 world[4];
+	__m128 viewProj[4];
+	LoadShaderMatrix(draw.ObjectConstants, world);
+	LoadShaderMatrix(draw.PassConstants + ViewProjOffset, viewProj);
+
+	slot.Vertices.resize(vertexCount);
+	slot.Outcodes.resize(vertexCount);
+	const std::uint8_t* bytes = draw.Vertices + (std::size_t)first * draw.VertexStride;
+	for (std::uint32_t i = 0; i < vertexCount; ++i, bytes += draw.VertexStride)
+	{
+		const float* position = reinterpret_cast<const float*>(bytes);
+		const float* color = position + 3;
+
+		__m128 posW = MultiplyRow(_mm_setr_ps(position[0], position[1], position[2], 1.0f), world);
+		ClipVertex& vertex = slot.Vertices[i];
+		_mm_storeu_ps(vertex.Position, MultiplyRow(posW, viewProj));
+		std::copy(color, color + 4, vertex.Color);
+		slot.Outcodes[i] = ComputeOutcode(vertex.Position);
+	}
+
+	// Primitive assembly.
+	slot.Indices.reserve(indexCount);
+	for (std::uint32_t i = 0; i < indexCount; i += 3)
+	{
+		std::uint32_t i0 = index(i + 0) - minIndex;
+		std::uint32_t i1 = index(i + 1) - minIndex;
+		std::uint32_t i2 = index(i + 2) - minIndex;
+
+		std::uint32_t o0 = slot.Outcodes[i0], o1 = slot.Outcodes[i1], o2 = slot.Outcodes[i2];
+		if ((o0 & o1 & o2) != 0)
+			continue;
+
+		if ((o0 | o1 | o2) != 0)
+		{
+			ClipTriangle(slot, i0, i1, i2);
+			continue;
+		}
+
+		slot.Indices.insert(slot.Indices.end(), { i0, i1, i2 });
+	}
+
+	SetupTriangles(slot);
+}
+
+void ReferenceRasterizer::ClipTriangle(DrawSlot& slot, std::uint32_t a, std::uint32_t b, std::uint32_t c) const
+{
+	// Sutherland-Hodgman: each plane adds at most one vertex.
+	const int MaxVertices = 3 + ClipPlaneCount;
+	ClipVertex buffers[2][MaxVertices];
+	int count = 3;
+	buffers[0][0] = slot.Vertices[a];
+	buffers[0][1] = slot.Vertices[b];
+	buffers[0][2] = slot.Vertices[c];
+
+	int current = 0;
+	for (int plane = 0; plane < ClipPlaneCount && count >= 3; ++plane)
+	{
+		const ClipVertex* in = buffers[current];
+		ClipVertex* out = buffers[current ^ 1];
+		int outCount = 0;
+
+		for (int i = 0; i < count; ++i)
+		{
+			const ClipVertex& p = in[i];
+			const ClipVertex& q = in[(i + 1) % count];
+			float dp = PlaneDistance(p.Position, plane);
+			float dq = PlaneDistance(q.Position, plane);
+
+			if (dp >= 0.0f)
+				out[outCount++] = p;
+			if ((dp >= 0.0f) != (dq >= 0.0f))
+			{
+				// Always from the inside vertex, so that the two triangles
+				// sharing the edge compute the same point and leave no crack.
+				const ClipVertex& from = dp >= 0.0f ? p : q;
+				const ClipVertex& to = dp >= 0.0f ? q : p;
+				float dFrom = dp >= 0.0f ? dp : dq;
+				float dTo = dp >= 0.0f ? dq : dp;
+				float t = dFrom / (dFrom - dTo);
+
+				ClipVertex& vertex = out[outCount++];
+				for (int k = 0; k < 4; ++k)
+				{
+					vertex.Position[k] = from.Position[k] + t * (to.Position[k] - from.Position[k]);
+					vertex.Color[k] = from.Color[k] + t * (to.Color[k] - from.Color[k]);
+				}
+			}
+		}
+
+		count = outCount;
+		current ^= 1;
+	}
+
+	if (count < 3)
+		return;
+
+	std::uint32_t base = (std::uint32_t)slot.Vertices.size();
+	slot.Vertices.insert(slot.Vertices.end(), buffers[current], buffers[current] + count);
+	for (int i = 2; i < count; ++i)
+		slot.Indices.insert(slot.Indices.end(), { base, base + i - 1, base + i });
+}
+
+void ReferenceRasterizer::SetupTriangles(DrawSlot& slot) const
+{
+	const ClipVertex* vertices = slot.Vertices.data();
+	const std::uint32_t* indices = slot.Indices.data();
+	std::size_t triangleCount = slot.Indices.size() / 3;
+
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 width = _mm_set1_ps((float)m_width);
+	const __m128 height = _mm_set1_ps((float)m_height);
+	const __m128 subpixelScale = _mm_set1_ps((float)SubpixelScale);
+	const __m128 pixelScale = _mm_set1_ps(1.0f / SubpixelScale);
+	const __m128 maxX = _mm_set1_ps((float)(m_width - 1));
+	const __m128 maxY = _mm_set1_ps((float)(m_height - 1));
+	const __m128i halfPixel = _mm_set1_epi32(SubpixelScale / 2);
+	const __m128i roundUp = _mm_set1_epi32(SubpixelScale - 1);
+
+	// Four triangles at a time, one per lane.
+	for (std::size_t firstTriangle = 0; firstTriangle < triangleCount; firstTriangle += 4)
+	{
+		std::size_t laneCount = std::min<std::size_t>(triangleCount - firstTriangle, 4);
+
+		// Missing lanes repeat the last triangle and are dropped below.
+		const std::uint32_t* triangle[4];
+		for (std::size_t lane = 0; lane < 4; ++lane)
+			triangle[lane] = indices + 3 * (firstTriangle + std::min(lane, laneCount - 1));
+
+		__m128i ix[3], iy[3];
+		__m128 x[3], y[3], subX[3], subY[3];
+		// z, 1 / w and color / w.
+		__m128 attributes[6][3];
+		__m128 positiveW = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+		for (int k = 0; k < 3; ++k)
+		{
+			__m128 p0 = _mm_loadu_ps(vertices[triangle[0][k]].Position);
+			__m128 p1 = _mm_loadu_ps(vertices[triangle[1][k]].Position);
+			__m128 p2 = _mm_loadu_ps(vertices[triangle[2][k]].Position);
+			__m128 p3 = _mm_loadu_ps(vertices[triangle[3][k]].Position);
+			_MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+
+			__m128 c0 = _mm_loadu_ps(vertices[triangle[0][k]].Color);
+			__m128 c1 = _mm_loadu_ps(vertices[triangle[1][k]].Color);
+			__m128 c2 = _mm_loadu_ps(vertices[triangle[2][k]].Color);
+			__m128 c3 = _mm_loadu_ps(vertices[triangle[3][k]].Color);
+			_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+			// A full division: reciprocal estimates differ between CPUs.
+			positiveW = _mm_and_ps(positiveW, _mm_cmpgt_ps(p3, _mm_setzero_ps()));
+			__m128 invW = _mm_div_ps(_mm_set1_ps(1.0f), p3);
+
+			__m128 sx = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(p0, invW), half), half), width);
+			__m128 sy = _mm_mul_ps(_mm_sub_ps(half, _mm_mul_ps(_mm_mul_ps(p1, invW), half)), height);
+
+			// Rounded to nearest by the conversion. Attribute planes go through
+			// the snapped positions, as on the GPU; they are exact in float.
+			ix[k] = _mm_cvtps_epi32(_mm_mul_ps(sx, subpixelScale));
+			iy[k] = _mm_cvtps_epi32(_mm_mul_ps(sy, subpixelScale));
+			subX[k] = _mm_cvtepi32_ps(ix[k]);
+			subY[k] = _mm_cvtepi32_ps(iy[k]);
+			x[k] = _mm_mul_ps(subX[k], pixelScale);
+			y[k] = _mm_mul_ps(subY[k], pixelScale);
+
+			attributes[0][k] = _mm_mul_ps(p2, invW);
+			attributes[1][k] = invW;
+			attributes[2][k] = _mm_mul_ps(c0, invW);
+			attributes[3][k] = _mm_mul_ps(c1, invW);
+			attributes[4][k] = _mm_mul_ps(c2, invW);
+			attributes[5][k] = _mm_mul_ps(c3, invW);
+		}
+
+		// Twice the signed area in 1/256 pixel, positive for clockwise
+		// triangles on screen, which are front faces. The products need up to
+		// 31 bits, so they are taken exactly in double, two lanes at a time.
+		__m128i dx1 = _mm_sub_epi32(ix[1], ix[0]), dy1 = _mm_sub_epi32(iy[1], iy[0]);
+		__m128i dx2 = _mm_sub_epi32(ix[2], ix[0]), dy2 = _mm_sub_epi32(iy[2], iy[0]);
+		auto area = [](__m128i ux, __m128i uy, __m128i vx, __m128i vy)
+		{
+			return _mm_sub_pd(_mm_mul_pd(_mm_cvtepi32_pd(ux), _mm_cvtepi32_pd(vy)),
+				_mm_mul_pd(_mm_cvtepi32_pd(uy), _mm_cvtepi32_pd(vx)));
+		};
+		__m128d areaLow = area(dx1, dy1, dx2, dy2);
+		__m128d areaHigh = area(_mm_srli_si128(dx1, 8), _mm_srli_si128(dy1, 8), _mm_srli_si128(dx2, 8), _mm_srli_si128(dy2, 8));
+		int frontFaces = _mm_movemask_pd(_mm_cmpgt_pd(areaLow, _mm_setzero_pd()))
+			| (_mm_movemask_pd(_mm_cmpgt_pd(areaHigh, _mm_setzero_pd())) << 2);
+		__m128 invArea = _mm_div_ps(_mm_set1_ps((float)(SubpixelScale * SubpixelScale)),
+			_mm_movelh_ps(_mm_cvtpd_ps(areaLow), _mm_cvtpd_ps(areaHigh)));
+
+		// Pixels whose center is inside the bounding box.
+		__m128 minSubX = _mm_min_ps(subX[0], _mm_min_ps(subX[1], subX[2]));
+		__m128 minSubY = _mm_min_ps(subY[0], _mm_min_ps(subY[1], subY[2]));
+		__m128 maxSubX = _mm_max_ps(subX[0], _mm_max_ps(subX[1], subX[2]));
+		__m128 maxSubY = _mm_max_ps(subY[0], _mm_max_ps(subY[1], subY[2]));
+		auto firstPixel = [&](__m128 v) { return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_add_epi32(_mm_sub_epi32(_mm_cvtps_epi32(v), halfPixel), roundUp), SubpixelBits)); };
+		auto lastPixel = [&](__m128 v) { return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_sub_epi32(_mm_cvtps_epi32(v), halfPixel), SubpixelBits)); };
+		__m128 minX = _mm_max_ps(firstPixel(minSubX), _mm_setzero_ps());
+		__m128 minY = _mm_max_ps(firstPixel(minSubY), _mm_setzero_ps());
+		__m128 maxXClamped = _mm_min_ps(lastPixel(maxSubX), maxX);
+		__m128 maxYClamped = _mm_min_ps(lastPixel(maxSubY), maxY);
+		int nonEmpty = _mm_movemask_ps(_mm_and_ps(_mm_cmple_ps(minX, maxXClamped), _mm_cmple_ps(minY, maxYClamped)));
+
+		int laneMask = frontFaces & nonEmpty & _mm_movemask_ps(positiveW) & ((1 << laneCount) - 1);
+		if (laneMask == 0)
+			continue;
+
+		// Attribute planes over pixel centers, relative to the bounding box
+		// corner so that steep planes keep precision.
+		__m128 dxf1 = _mm_sub_ps(x[1], x[0]), dyf1 = _mm_sub_ps(y[1], y[0]);
+		__m128 dxf2 = _mm_sub_ps(x[2], x[0]), dyf2 = _mm_sub_ps(y[2], y[0]);
+		__m128 cornerX = _mm_sub_ps(_mm_add_ps(minX, half), x[0]);
+		__m128 cornerY = _mm_sub_ps(_mm_add_ps(minY, half), y[0]);
+
+		alignas(16) float planes[6][3][4];
+		for (int a = 0; a < 6; ++a)
+		{
+			__m128 da1 = _mm_sub_ps(attributes[a][1], attributes[a][0]);
+			__m128 da2 = _mm_sub_ps(attributes[a][2], attributes[a][0]);
+			__m128 ddx = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(da1, dyf2), _mm_mul_ps(da2, dyf1)), invArea);
+			__m128 ddy = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(da2, dxf1), _mm_mul_ps(da1, dxf2)), invArea);
+			__m128 origin = _mm_add_ps(attributes[a][0], _mm_add_ps(_mm_mul_ps(ddx, cornerX), _mm_mul_ps(ddy, cornerY)));
+			_mm_store_ps(planes[a][0], origin);
+			_mm_store_ps(planes[a][1], ddx);
+			_mm_store_ps(planes[a][2], ddy);
+		}
+
+		alignas(16) std::int32_t vx[3][4], vy[3][4];
+		alignas(16) float bounds[4][4];
+		for (int k = 0; k < 3; ++k)
+		{
+			_mm_store_si128(reinterpret_cast<__m128i*>(vx[k]), ix[k]);
+			_mm_store_si128(reinterpret_cast<__m128i*>(vy[k]), iy[k]);
+		}
+		_mm_store_ps(bounds[0], minX);
+		_mm_store_ps(bounds[1], minY);
+		_mm_store_ps(bounds[2], maxXClamped);
+		_mm_store_ps(bounds[3], maxYClamped);
+
+		// Edge functions need 64-bit products at the corner; they are done
+		// per triangle for the few lanes left.
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			if ((laneMask & (1 << lane)) == 0)
+				continue;
+
+			Triangle t;
+			t.MinX = (std::int32_t)bounds[0][lane];
+			t.MinY = (std::int32_t)bounds[1][lane];
+			t.MaxX = (std::int32_t)bounds[2][lane];
+			t.MaxY = (std::int32_t)bounds[3][lane];
+
+			std::int64_t centerX = (std::int64_t)t.MinX * SubpixelScale + SubpixelScale / 2;
+			std::int64_t centerY = (std::int64_t)t.MinY * SubpixelScale + SubpixelScale / 2;
+			for (int i = 0; i < 3; ++i)
+			{
+				int j = (i + 1) % 3;
+				t.A[i] = vy[i][lane] - vy[j][lane];
+				t.B[i] = vx[j][lane] - vx[i][lane];
+				std::int64_t edge = (std::int64_t)t.A[i] * (centerX - vx[i][lane]) + (std::int64_t)t.B[i] * (centerY - vy[i][lane]);
+
+				// Top-left rule: pixel centers exactly on an edge belong to the
+				// triangle only if the edge is a top or a left edge.
+				bool topLeft = t.A[i] > 0 || (t.A[i] == 0 && t.B[i] > 0);
+				if (!topLeft)
+					edge -= 1;
+
+				assert(edge >= std::numeric_limits<std::int32_t>::min() && edge <= std::numeric_limits<std::int32_t>::max());
+				t.Edge[i] = (std::int32_t)edge;
+			}
+
+			for (int a = 0; a < 6; ++a)
+			{
+				for (int p = 0; p < 3; ++p)
+					t.Planes[a][p] = planes[a][p][lane];
+			}
+
+			slot.Triangles.push_back(t);
+		}
+	}
+}
+
+void ReferenceRasterizer::Flush(std::size_t slotCount)
+{
+	// Binned in submission order, which each tile keeps.
+	for (std::size_t s = 0; s < slotCount; ++s)
+	{
+		for (const Triangle& triangle : m_slots[s].Triangles)
+		{
+			for (std::int32_t ty = triangle.MinY / (std::int32_t)TileSize; ty <= triangle.MaxY / (std::int32_t)TileSize; ++ty)
+			{
+				for (std::int32_t tx = triangle.MinX / (std::int32_t)TileSize; tx <= triangle.MaxX / (std::int32_t)TileSize; ++tx)
+				{
+					m_bins[(std::size_t)ty * m_tilesX + tx].push_back(&triangle);
+					m_stats.TileTriangles++;
+				}
+			}
+		}
+		m_stats.SetupTriangles += m_slots[s].Triangles.size();
+	}
+
+	m_tileIndices.clear();
+	for (std::uint32_t tile = 0; tile < (std::uint32_t)m_bins.size(); ++tile)
+	{
+		if (!m_bins[tile].empty())
+			m_tileIndices.push_back(tile);
+	}
+
+	// Tiles own disjoint pixels, so they need no synchronization.
+	std::for_each(std::execution::par, m_tileIndices.begin(), m_tileIndices.end(), [this](std::uint32_t tile)
+	{
+		RasterizeTile(tile);
+	});
+
+	for (std::uint32_t tile : m_tileIndices)
+	{
+		m_stats.PixelsCovered += m_tileCounters[tile].Covered;
+		m_stats.PixelsWritten += m_tileCounters[tile].Written;
+		m_tileCounters[tile] = TileCounters();
+		m_bins[tile].clear();
+	}
+}
+
+void ReferenceRasterizer::RasterizeTile(std::uint32_t tile)
+{
+	const std::int32_t tileX0 = (std::int32_t)((tile % m_tilesX) * TileSize);
+	const std::int32_t tileY0 = (std::int32_t)((tile / m_tilesX) * TileSize);
+	const std::int32_t tileX1 = std::min(tileX0 + (std::int32_t)TileSize, (std::int32_t)m_width) - 1;
+	const std::int32_t tileY1 = std::min(tileY0 + (std::int32_t)TileSize, (std::int32_t)m_height) - 1;
+
+	const __m128i laneOffsets = _mm_setr_epi32(0, 1, 2, 3);
+	TileCounters counters;
+
+	for (const Triangle* t : m_bins[tile])
+	{
+		const std::int32_t x0 = std::max(t->MinX, tileX0);
+		const std::int32_t y0 = std::max(t->MinY, tileY0);
+		const std::int32_t x1 = std::min(t->MaxX, tileX1);
+		const std::int32_t y1 = std::min(t->MaxY, tileY1);
+		if (x0 > x1 || y0 > y1)
+			continue;
+
+		// Groups start on a multiple of LaneCount; lanes outside [x0, x1] are
+		// masked, and so are their edge values, which may wrap around.
+		const std::int32_t groupX0 = x0 & ~(LaneCount - 1);
+		const __m128i firstColumn = _mm_set1_epi32(x0 - 1);
+		const __m128i lastColumn = _mm_set1_epi32(x1 + 1);
+
+		__m128i laneSteps[3];
+		__m128i groupSteps[3];
+		std::int32_t rowEdges[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			std::int32_t stepX = t->A[i] * SubpixelScale;
+			laneSteps[i] = _mm_setr_epi32(0, stepX, 2 * stepX, 3 * stepX);
+			groupSteps[i] = _mm_set1_epi32(LaneCount * stepX);
+			rowEdges[i] = (std::int32_t)((std::int64_t)t->Edge[i] + (std::int64_t)stepX * (groupX0 - t->MinX)
+				+ (std::int64_t)t->B[i] * SubpixelScale * (y0 - t->MinY));
+		}
+
+		__m128 planeDX[6];
+		for (int a = 0; a < 6; ++a)
+			planeDX[a] = _mm_set1_ps(t->Planes[a][1]);
+
+		for (std::int32_t y = y0; y <= y1; ++y)
+		{
+			// Every pixel evaluates (Origin + DY * dy) + DX * dx, whatever
+			// group or tile it falls in.
+			float dy = (float)(y - t->MinY);
+			__m128 rowPlanes[6];
+			for (int a = 0; a < 6; ++a)
+				rowPlanes[a] = _mm_set1_ps(t->Planes[a][0] + t->Planes[a][2] * dy);
+
+			__m128i e0 = _mm_add_epi32(_mm_set1_epi32(rowEdges[0]), laneSteps[0]);
+			__m128i e1 = _mm_add_epi32(_mm_set1_epi32(rowEdges[1]), laneSteps[1]);
+			__m128i e2 = _mm_add_epi32(_mm_set1_epi32(rowEdges[2]), laneSteps[2]);
+
+			float* depthRow = &m_depth[(std::size_t)y * m_stride];
+			std::uint32_t* colorRow = &m_color[(std::size_t)y * m_stride];
+
+			for (std::int32_t x = groupX0; x <= x1; x += LaneCount)
+			{
+				__m128i columns = _mm_add_epi32(_mm_set1_epi32(x), laneOffsets);
+				__m128i inColumns = _mm_and_si128(_mm_cmpgt_epi32(columns, firstColumn), _mm_cmplt_epi32(columns, lastColumn));
+				__m128i outside = _mm_srai_epi32(_mm_or_si128(e0, _mm_or_si128(e1, e2)), 31);
+				__m128 covered = _mm_castsi128_ps(_mm_andnot_si128(outside, inColumns));
+
+				e0 = _mm_add_epi32(e0, groupSteps[0]);
+				e1 = _mm_add_epi32(e1, groupSteps[1]);
+				e2 = _mm_add_epi32(e2, groupSteps[2]);
+
+				int coveredMask = _mm_movemask_ps(covered);
+				if (coveredMask == 0)
+					continue;
+
+				__m128 dx = _mm_cvtepi32_ps(_mm_sub_epi32(columns, _mm_set1_epi32(t->MinX)));
+
+				// Depth is clamped to the viewport range, then tested LESS.
+				__m128 z = _mm_add_ps(rowPlanes[0], _mm_mul_ps(planeDX[0], dx));
+				z = _mm_min_ps(_mm_max_ps(z, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+				__m128 depth = _mm_loadu_ps(depthRow + x);
+				__m128 pass = _mm_and_ps(covered, _mm_cmplt_ps(z, depth));
+
+				int passMask = _mm_movemask_ps(pass);
+				counters.Covered += (std::uint64_t)std::popcount((unsigned)coveredMask);
+				counters.Written += (std::uint64_t)std::popcount((unsigned)passMask);
+				if (passMask == 0)
+					continue;
+
+				_mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, depth)));
+
+				// Perspective-correct color: (color / w) / (1 / w).
+				__m128 w = _mm_div_ps(_mm_set1_ps(1.0f), _mm_add_ps(rowPlanes[1], _mm_mul_ps(planeDX[1], dx)));
+				__m128i r = ToUnorm8(_mm_mul_ps(_mm_add_ps(rowPlanes[2], _mm_mul_ps(planeDX[2], dx)), w));
+				__m128i g = ToUnorm8(_mm_mul_ps(_mm_add_ps(rowPlanes[3], _mm_mul_ps(planeDX[3], dx)), w));
+				__m128i b = ToUnorm8(_mm_mul_ps(_mm_add_ps(rowPlanes[4], _mm_mul_ps(planeDX[4], dx)), w));
+				__m128i a = ToUnorm8(_mm_mul_ps(_mm_add_ps(rowPlanes[5], _mm_mul_ps(planeDX[5], dx)), w));
+				__m128i color = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)), _mm_or_si128(_mm_slli_epi32(b, 16), _mm_slli_epi32(a, 24)));
+
+				__m128i passInt = _mm_castps_si128(pass);
+				__m128i* target = reinterpret_cast<__m128i*>(colorRow + x);
+				__m128i previous = _mm_loadu_si128(target);
+				_mm_storeu_si128(target, _mm_or_si128(_mm_and_si128(passInt, color), _mm_andnot_si128(passInt, previous)));
+			}
+
+			for (int i = 0; i < 3; ++i)
+				rowEdges[i] += t->B[i] * SubpixelScale;
+		}
+	}
+
+	m_tileCounters[tile] = counters;
+}
+
+bool ReferenceRasterizer::SaveImage(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+		return false;
+
+	file << "P6\n" << m_width << " " << m_height << "\n255\n";
+
+	std::vector<std::uint8_t> row((std::size_t)m_width * 3);
+	for (std::uint32_t y = 0; y < m_height; ++y)
+	{
+		const std::uint32_t* pixels = &m_color[(std::size_t)y * m_stride];
+		for (std::uint32_t x = 0; x < m_width; ++x)
+		{
+			row[x * 3 + 0] = (std::uint8_t)(pixels[x]);
+			row[x * 3 + 1] = (std::uint8_t)(pixels[x] >> 8);
+			row[x * 3 + 2] = (std::uint8_t)(pixels[x] >> 16);
+		}
+		file.write(reinterpret_cast<const char*>(row.data()), (std::streamsize)row.size());
+	}
+	return (bool)file;
+}
+
+bool ReferenceRasterizer::CompareImage(const std::string& path, std::uint32_t tolerance, ImageDiff& diff) const
+{
+	diff = ImageDiff();
+
+	std::ifstream file(path, std::ios::binary);
+	char magic[2] = {};
+	if (!file.read(magic, 2) || magic[0] != 'P' || magic[1] != '6')
+		return false;
+
+	std::uint32_t width = 0, height = 0, maxValue = 0;
+	if (!ReadPpmField(file, width) || !ReadPpmField(file, height) || !ReadPpmField(file, maxValue))
+		return false;
+	if (width != m_width || height != m_height || maxValue != 255)
+		return false;
+	// A single whitespace character ends the header.
+	file.get();
+
+	std::vector<std::uint8_t> row((std::size_t)m_width * 3);
+	for (std::uint32_t y = 0; y < m_height; ++y)
+	{
+		if (!file.read(reinterpret_cast<char*>(row.data()), (std::streamsize)row.size()))
+			return false;
+
+		const std::uint32_t* pixels = &m_color[(std::size_t)y * m_stride];
+		for (std::uint32_t x = 0; x < m_width; ++x)
+		{
+			std::uint32_t delta = 0;
+			for (int c = 0; c < 3; ++c)
+			{
+				int value = (int)((pixels[x] >> (8 * c)) & 0xff);
+				delta = std::max(delta, (std::uint32_t)std::abs(value - (int)row[x * 3 + c]));
+			}
+
+			diff.MaxDelta = std::max(diff.MaxDelta, delta);
+			if (delta > tolerance)
+				diff.Pixels++;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,168 @@
+#pragma once
+#include "RenderBackend.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One DrawIndexedInstanced call, with its buffers as the GPU would read them.
+struct ReferenceDraw
+{
+	// Vertex layout of color.hlsl: POSITION float3 at offset 0, COLOR float4
+	// at offset 12.
+	const std::uint8_t*						Vertices = nullptr;
+	std::uint32_t							VertexStride = 0;
+	std::uint32_t							VertexCount = 0;
+	// First index of the draw.
+	const void*								Indices = nullptr;
+	IndexFormat								Format = IndexFormat::UInt16;
+	std::uint32_t							IndexCount = 0;
+	std::int32_t							BaseVertex = 0;
+
+	// cbPerObject and cbPass as uploaded. Matrices follow HLSL's default
+	// column-major packing, so memory holds the transpose of the matrix the
+	// shader multiplies by, as written by UpdateObjectCBs.
+	const float*							ObjectConstants = nullptr;
+	const float*							PassConstants = nullptr;
+};
+
+struct ReferenceStats
+{
+	std::uint64_t							Draws = 0;
+	std::uint64_t							Triangles = 0;
+	// Left after clipping, back-face culling and dropping triangles that
+	// cover no pixel center.
+	std::uint64_t							SetupTriangles = 0;
+	// Triangle and tile pairs rasterized.
+	std::uint64_t							TileTriangles = 0;
+	// Pixels inside a triangle, and those of them that passed the depth test.
+	std::uint64_t							PixelsCovered = 0;
+	std::uint64_t							PixelsWritten = 0;
+	// Time spent in Draw.
+	double									Seconds = 0.0;
+};
+
+// Pixels whose channels differ by more than the tolerance.
+struct ImageDiff
+{
+	std::uint32_t							Pixels = 0;
+	std::uint32_t							MaxDelta = 0;
+};
+
+// CPU rasterizer drawing what the D3D12 renderer draws, for golden images
+// on machines without a GPU and as a throughput benchmark for our meshes.
+//
+// Draws follow color.hlsl with the default pipeline state: vertices are
+// transformed by gWorld then ViewProj, triangles are clipped to the view
+// volume, back faces (counter-clockwise on screen) are culled, coverage
+// follows the top-left rule at pixel centers with 1/16 pixel snapping, and
+// the vertex color is interpolated perspective-correct into an RGBA8 target
+// behind a LESS depth test on a float depth buffer.
+//
+// Draw() shades the vertices and sets up the triangles of several draws in
+// parallel, four triangles per instruction, then bins them by screen tile
+// and fills the tiles in parallel, four pixels per instruction. Every pixel
+// is computed from its own coordinates and tiles replay their triangles in
+// submission order, so images do not depend on the thread count. Only SSE2
+// is used, so that builds for other instruction sets give the same images.
+class ReferenceRasterizer
+{
+public:
+
+	static const std::uint32_t				TileSize = 64;
+	// Bounds the snapped coordinates so edge functions fit in 32 bits.
+	static const std::uint32_t				MaxSize = 2048;
+
+											ReferenceRasterizer(std::uint32_t width = 800, std::uint32_t height = 600);
+
+	void									Resize(std::uint32_t width, std::uint32_t height);
+	std::uint32_t							GetWidth()			const	{	return m_width;	}
+	std::uint32_t							GetHeight()			const	{	return m_height;	}
+
+	// `color` is RGBA, as passed to ClearRenderTargetView.
+	void									Clear(const float* color, float depth = 1.0f);
+
+	// Draws are applied in order, as a queue would.
+	void									Draw(const ReferenceDraw* draws, std::size_t count);
+
+	// RGBA8, red in the low byte; GetStride() pixels per row.
+	const std::uint32_t*					GetColor()			const	{	return m_color.data();	}
+	const float*							GetDepth()			const	{	return m_depth.data();	}
+	std::uint32_t							GetStride()			const	{	return m_stride;	}
+
+	const ReferenceStats&					GetStats()			const	{	return m_stats;	}
+	void									ResetStats()				{	m_stats = ReferenceStats();	}
+
+	// Binary PPM; alpha is dropped. Returns false if the file cannot be written.
+	bool									SaveImage(const std::string& path)	const;
+	// Compares the color target with a PPM written by SaveImage. Returns
+	// false if the file cannot be read or its size differs.
+	bool									CompareImage(const std::string& path, std::uint32_t tolerance, ImageDiff& diff)	const;
+
+private:
+
+	struct ClipVertex
+	{
+		float								Position[4];
+		float								Color[4];
+	};
+
+	// Edge functions are A * x + B * y in 1/16 pixel units, >= 0 inside;
+	// Edge holds their value at the center of pixel (MinX, MinY) with the
+	// fill rule applied. Attributes are planes Origin + DX * (x - MinX) +
+	// DY * (y - MinY) over pixel centers: z, 1 / w and color / w.
+	struct Triangle
+	{
+		std::int32_t						A[3];
+		std::int32_t						B[3];
+		std::int32_t						Edge[3];
+		float								Planes[6][3];
+		// Covered pixels, inclusive.
+		std::int32_t						MinX;
+		std::int32_t						MinY;
+		std::int32_t						MaxX;
+		std::int32_t						MaxY;
+	};
+
+	// Scratch of one draw of the batch being processed.
+	struct DrawSlot
+	{
+		const ReferenceDraw*				Draw = nullptr;
+		// Shaded vertices of the draw's index range, then clipped ones.
+		std::vector<ClipVertex>				Vertices;
+		std::vector<std::uint32_t>			Outcodes;
+		// Triangles left for setup, three vertex indices each.
+		std::vector<std::uint32_t>			Indices;
+		std::vector<Triangle>				Triangles;
+	};
+
+	struct TileCounters
+	{
+		std::uint64_t						Covered = 0;
+		std::uint64_t						Written = 0;
+	};
+
+	void									ProcessDraw(DrawSlot& slot)		const;
+	void									ClipTriangle(DrawSlot& slot, std::uint32_t a, std::uint32_t b, std::uint32_t c)	const;
+	void									SetupTriangles(DrawSlot& slot)	const;
+	void									Flush(std::size_t slotCount);
+	void									RasterizeTile(std::uint32_t tile);
+
+	std::uint32_t							m_width = 0;
+	std::uint32_t							m_height = 0;
+	// Rows are padded to whole groups of pixels.
+	std::uint32_t							m_stride = 0;
+	std::uint32_t							m_tilesX = 0;
+	std::uint32_t							m_tilesY = 0;
+
+	std::vector<std::uint32_t>				m_color;
+	std::vector<float>						m_depth;
+
+	std::vector<DrawSlot>					m_slots;
+	// Triangles per tile, in submission order.
+	std::vector<std::vector<const Triangle*>>	m_bins;
+	std::vector<std::uint32_t>				m_tileIndices;
+	std::vector<TileCounters>				m_tileCounters;
+
+	ReferenceStats							m_stats;
+};
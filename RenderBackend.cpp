@@ -0,0 +1,19 @@
+#include "RenderBackend.h"
+#include <cstring>
+
+std::unique_ptr<GpuBuffer> CreateDefaultBuffer(RenderDevice& device, GpuCommandList& commandList,
+	const void* initData, std::uint64_t byteSize, std::unique_ptr<GpuBuffer>& uploadBuffer)
+{
+	std::unique_ptr<GpuBuffer> defaultBuffer = device.CreateBuffer(byteSize, GpuBufferUsage::Default);
+
+	// In order to copy CPU memory data into our default buffer, we need
+	// to create an intermediate upload heap.
+	uploadBuffer = device.CreateBuffer(byteSize, GpuBufferUsage::Upload);
+	std::memcpy(uploadBuffer->GetMappedData(), initData, (std::size_t)byteSize);
+
+	commandList.Barrier(*defaultBuffer, ResourceState::Common, ResourceState::CopyDest);
+	commandList.CopyBuffer(*defaultBuffer, 0, *uploadBuffer, 0, byteSize);
+	commandList.Barrier(*defaultBuffer, ResourceState::CopyDest, ResourceState::GenericRead);
+
+	return defaultBuffer;
+}
@@ -0,0 +1,193 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Rendering backend: the subset of the device, queue, fence and command list
+// API the frame loop needs, behind interfaces so the same frame code can
+// record for D3D12 or for the headless NullRenderDevice.
+//
+// Enum values match their D3D12 counterparts, so the D3D12 backend passes
+// them through unchanged.
+
+using GpuAddress = std::uint64_t;
+
+enum class GpuBufferUsage : std::uint8_t
+{
+	Upload,			// CPU-writable, persistently mapped
+	Default,		// GPU-only, filled with CopyBuffer
+};
+
+enum class PrimitiveTopology : std::uint32_t
+{
+	PointList		= 1,
+	LineList		= 2,
+	LineStrip		= 3,
+	TriangleList	= 4,
+	TriangleStrip	= 5,
+};
+
+enum class IndexFormat : std::uint32_t
+{
+	UInt32			= 42,	// DXGI_FORMAT_R32_UINT
+	UInt16			= 57,	// DXGI_FORMAT_R16_UINT
+};
+
+enum class ResourceState : std::uint32_t
+{
+	Common					= 0,
+	VertexAndConstantBuffer	= 0x1,
+	IndexBuffer				= 0x2,
+	IndirectArgument		= 0x200,
+	CopyDest				= 0x400,
+	CopySource				= 0x800,
+	GenericRead				= 0xac3,
+};
+
+enum class IndirectArgumentType : std::uint32_t
+{
+	DrawIndexed				= 1,
+	Constant				= 5,	// one 32-bit value, at offset 0 of the root parameter
+	ConstantBufferView		= 6,
+};
+
+// Constant buffer views start on 256-byte boundaries, so constant buffer
+// elements are rounded up to a multiple of 256 bytes.
+constexpr std::uint32_t ConstantBufferByteSize(std::size_t byteSize)
+{
+	return (std::uint32_t)((byteSize + 255) & ~std::size_t(255));
+}
+
+// Same layout as D3D12_DRAW_INDEXED_ARGUMENTS.
+struct DrawIndexedArguments
+{
+	std::uint32_t							IndexCountPerInstance;
+	std::uint32_t							InstanceCount;
+	std::uint32_t							StartIndexLocation;
+	std::int32_t							BaseVertexLocation;
+	std::uint32_t							StartInstanceLocation;
+};
+
+struct IndirectArgument
+{
+	IndirectArgumentType					Type;
+	std::uint32_t							RootParameter = 0;
+};
+
+// Layout of one command of an ExecuteIndirect argument buffer: the arguments
+// are packed in order, without padding, and commands are ByteStride apart.
+struct CommandSignatureDesc
+{
+	std::uint32_t							ByteStride = 0;
+	std::vector<IndirectArgument>			Arguments;
+};
+
+// Bytes an argument takes in a command.
+constexpr std::uint32_t IndirectArgumentSize(IndirectArgumentType type)
+{
+	return type == IndirectArgumentType::DrawIndexed ? (std::uint32_t)sizeof(DrawIndexedArguments)
+		: type == IndirectArgumentType::ConstantBufferView ? (std::uint32_t)sizeof(GpuAddress) : 4u;
+}
+
+class GpuBuffer
+{
+public:
+
+	virtual									~GpuBuffer() = default;
+
+	// Persistent mapping of an upload buffer; nullptr for default buffers.
+	virtual std::uint8_t*					GetMappedData()		= 0;
+	virtual GpuAddress						GetGpuAddress()		const = 0;
+	virtual std::uint64_t					GetSize()			const = 0;
+	virtual GpuBufferUsage					GetUsage()			const = 0;
+};
+
+class GpuFence
+{
+public:
+
+	virtual									~GpuFence() = default;
+
+	virtual std::uint64_t					GetCompletedValue()	const = 0;
+	// Blocks until the fence has reached `value`.
+	virtual void							Wait(std::uint64_t value) = 0;
+};
+
+class GpuCommandSignature
+{
+public:
+
+	virtual									~GpuCommandSignature() = default;
+
+	virtual const CommandSignatureDesc&		GetDesc()			const = 0;
+};
+
+// Pipelines and root signatures are referred to by the hashes their caches
+// key them by (HashGraphicsPipelineDesc, RootSignatureLayout::GetHash); the
+// backend maps them to its own objects.
+class GpuCommandList
+{
+public:
+
+	virtual									~GpuCommandList() = default;
+
+	// Only once the GPU is done with everything recorded since the last Reset.
+	virtual void							Reset() = 0;
+	virtual void							Close() = 0;
+
+	virtual void							SetPipelineState(std::uint64_t pipelineHash) = 0;
+	virtual void							SetRootSignature(std::uint64_t rootSignatureHash) = 0;
+	virtual void							SetRootConstantBuffer(std::uint32_t rootParameter, GpuAddress address) = 0;
+	virtual void							SetRootConstant(std::uint32_t rootParameter, std::uint32_t value, std::uint32_t offset) = 0;
+
+	virtual void							SetVertexBuffer(GpuAddress address, std::uint32_t size, std::uint32_t stride) = 0;
+	virtual void							SetIndexBuffer(GpuAddress address, std::uint32_t size, IndexFormat format) = 0;
+	virtual void							SetPrimitiveTopology(PrimitiveTopology topology) = 0;
+	virtual void							DrawIndexedInstanced(std::uint32_t indexCount, std::uint32_t instanceCount,
+												std::uint32_t startIndex, std::int32_t baseVertex, std::uint32_t startInstance) = 0;
+
+	// Runs up to `maxCommandCount` commands laid out as `signature` describes,
+	// starting at `argumentOffset`. With a count buffer, the 32-bit value at
+	// `countOffset` lowers the count further.
+	virtual void							ExecuteIndirect(GpuCommandSignature& signature, std::uint32_t maxCommandCount,
+												GpuBuffer& arguments, std::uint64_t argumentOffset,
+												GpuBuffer* count, std::uint64_t countOffset) = 0;
+
+	virtual void							Barrier(GpuBuffer& buffer, ResourceState before, ResourceState after) = 0;
+	virtual void							CopyBuffer(GpuBuffer& destination, std::uint64_t destinationOffset,
+												GpuBuffer& source, std::uint64_t sourceOffset, std::uint64_t size) = 0;
+};
+
+class GpuQueue
+{
+public:
+
+	virtual									~GpuQueue() = default;
+
+	virtual void							Execute(GpuCommandList& commandList) = 0;
+	// The fence reaches `value` once the GPU is done with everything
+	// executed before the signal.
+	virtual void							Signal(GpuFence& fence, std::uint64_t value) = 0;
+};
+
+class RenderDevice
+{
+public:
+
+	virtual									~RenderDevice() = default;
+
+	virtual std::unique_ptr<GpuBuffer>		CreateBuffer(std::uint64_t size, GpuBufferUsage usage) = 0;
+	virtual std::unique_ptr<GpuCommandList>	CreateCommandList() = 0;
+	virtual std::unique_ptr<GpuFence>		CreateFence(std::uint64_t initialValue = 0) = 0;
+	// Signatures that set root arguments are tied to the root signature they
+	// were created for.
+	virtual std::unique_ptr<GpuCommandSignature>	CreateCommandSignature(const CommandSignatureDesc& desc, std::uint64_t rootSignatureHash) = 0;
+	virtual GpuQueue&						GetQueue() = 0;
+};
+
+// Records the upload of `byteSize` bytes of `initData` into a new default
+// buffer, left in GenericRead. The data is staged in `uploadBuffer`, which
+// must live until `commandList` has executed.
+std::unique_ptr<GpuBuffer>					CreateDefaultBuffer(RenderDevice& device, GpuCommandList& commandList,
+												const void* initData, std::uint64_t byteSize, std::unique_ptr<GpuBuffer>& uploadBuffer);
@@ -1,4 +1,5 @@
 #include "RenderWindow.h"
+#include "Profiler.h"
 
 RenderWindow::RenderWindow(HINSTANCE hInstance)
     : DataGlobal(hInstance)
@@ -7,6 +8,17 @@ RenderWindow::RenderWindow(HINSTANCE hInstance)
 
 RenderWindow::~RenderWindow()
 {
+    // Frame resources may still be in use by the GPU.
+    if (m_d3dDevice != nullptr)
+        FlushCommandQueue();
+
+    // Keeps pipelines created after startup for the next run.
+    m_psoCache.Save();
+
+    if (m_vsByteCode != nullptr)
+        MemoryTracker::ReleaseExternal(MemTag::Shaders, m_vsByteCode->Size());
+    if (m_psByteCode != nullptr)
+        MemoryTracker::ReleaseExternal(MemTag::Shaders, m_psByteCode->Size());
 }
 
 bool RenderWindow::Initialize()
@@ -14,27 +26,31 @@ bool RenderWindow::Initialize()
     if (!DataGlobal::Initialize())
         return false;
 
-    // Reset the command list to prep for initialization commands.
-    ThrowIfFailed(m_commandList->Reset(m_commandAllocators.Get(), nullptr));
-
     BuildRootSignature();
     BuildShadersAndInputLayout();
-
-    gameObject.Init(m_commandList, m_d3dDevice);
-    gameObject.BuildRenderOpBox(m_d3dDevice);
-    gameObject.BuildRenderOpCircle(m_d3dDevice);
-
     BuildDescriptorHeaps();
-    BuildConstantBuffers();
+    m_psoCache.Initialize(m_d3dDevice.Get(), ResolveModulePath("ShaderCache/pipelines.bin"));
     BuildPSO();
 
-    // Execute the initialization commands.
-    ThrowIfFailed(m_commandList->Close());
-    ID3D12CommandList* cmdsLists[] = { m_commandList.Get() };
-    m_commandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
+    // Command lists name the pipeline and root signature by hash.
+    m_renderDevice = std::make_unique<D3D12RenderDevice>(m_d3dDevice.Get(), m_commandQueue.Get());
+    m_renderDevice->RegisterPipeline(m_psoHash, m_PSO.Get());
+    m_renderDevice->RegisterRootSignature(m_rootSignatureHash, m_rootSignature.Get());
+
+    SceneRendererSettings settings;
+    settings.PipelineHash = m_psoHash;
+    settings.RootSignatureHash = m_rootSignatureHash;
+    m_scene = std::make_unique<SceneRenderer>(*m_renderDevice, settings);
+
+    // Uploads the geometry and waits until the GPU has it.
+    m_scene->Initialize();
+    m_scene->GetCamera().SetLens(0.25f * MathHelper::Pi, AspectRatio(), 1.0f, 1000.0f);
 
-    // Wait until initialization is complete.
-    FlushCommandQueue();
+    GameObject& scene = m_scene->GetScene();
+    scene.BuildRenderOpBox();
+    scene.BuildRenderOpCircle();
+
+    m_gpuTimer.Initialize(m_d3dDevice.Get(), m_commandQueue.Get(), gNumFrameResources, c_maxGpuZonesPerFrame);
 
     return true;
 }
@@ -43,198 +59,147 @@ void RenderWindow::OnResize()
 {
     DataGlobal::OnResize();
 
-    XMMATRIX P = XMMatrixPerspectiveFovLH(0.25f * MathHelper::Pi, AspectRatio(), 1.0f, 1000.0f);
-    XMStoreFloat4x4(&m_proj, P);
+    // OnResize runs once before the scene exists.
+    if (m_scene != nullptr)
+        m_scene->GetCamera().SetLens(0.25f * MathHelper::Pi, AspectRatio(), 1.0f, 1000.0f);
+}
+
+void RenderWindow::FixedUpdate(float stepSeconds)
+{
+    m_scene->GetScene().FixedUpdate(stepSeconds);
+}
+
+void RenderWindow::PublishSimulation()
+{
+    m_scene->GetScene().PublishSimulation();
 }
 
 void RenderWindow::Update(const GameTimer& gt)
 {
-    // Convert Spherical to Cartesian coordinates.
-    float x = m_radius * sinf(m_phi) * cosf(m_theta);
-    float z = m_radius * sinf(m_phi) * sinf(m_theta);
-    float y = m_radius * cosf(m_phi);
+    PROFILE_FUNCTION();
 
-    for (auto& e : gameObject.GetAllItems()) {
-        XMMATRIX world = XMLoadFloat4x4(&e->World);
+    m_scene->BeginFrame(m_frameLimiter.GetMaxQueuedFrames());
+    m_scene->GetScene().Interpolate(m_simulationAlpha);
 
-        ObjectConstants objConstants;
-        XMStoreFloat4x4(&objConstants.WorldViewProj, XMMatrixTranspose(world));
-        e->m_objectCB->CopyData(0, objConstants);
-    }
+    // The GPU is done with this frame resource, so its timestamps are ready
+    // and the descriptors of that frame can be reused.
+    m_gpuTimer.BeginFrame(m_scene->GetFrameIndex());
+    m_descriptorHeap.BeginFrame(m_scene->GetFence().GetCompletedValue());
 
-    XMVECTOR pos = XMVectorSet(x, y, z, 1.0f);
-    XMVECTOR target = XMVectorZero();
-    XMVECTOR up = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
-    XMMATRIX view = XMMatrixLookAtLH(pos, target, up);
-    XMMATRIX proj = XMLoadFloat4x4(&m_proj);
-
-    XMMATRIX viewProj = XMMatrixMultiply(view, proj);
-
-    XMMATRIX invView = XMMatrixInverse(&XMMatrixDeterminant(view), view);
-    XMMATRIX invProj = XMMatrixInverse(&XMMatrixDeterminant(proj), proj);
-    XMMATRIX invViewProj = XMMatrixInverse(&XMMatrixDeterminant(viewProj), viewProj);
-
-    PassConstants mMainPassCB;
-    XMStoreFloat4x4(&mMainPassCB.View, XMMatrixTranspose(view));
-    XMStoreFloat4x4(&mMainPassCB.InvView, XMMatrixTranspose(invView));
-    XMStoreFloat4x4(&mMainPassCB.Proj, XMMatrixTranspose(proj));
-    XMStoreFloat4x4(&mMainPassCB.InvProj, XMMatrixTranspose(invProj));
-    XMStoreFloat4x4(&mMainPassCB.ViewProj, XMMatrixTranspose(viewProj));
-    XMStoreFloat4x4(&mMainPassCB.InvViewProj, XMMatrixTranspose(invViewProj));
-
-    mMainPassCB.RenderTargetSize = XMFLOAT2((float)m_clientWidth, (float)m_clientHeight);
-    mMainPassCB.InvRenderTargetSize = XMFLOAT2(1.0f / m_clientWidth, 1.0f / m_clientHeight);
-    mMainPassCB.NearZ = 1.0f;
-    mMainPassCB.FarZ = 1000.0f;
-    mMainPassCB.TotalTime = gt.TotalTime();
-    mMainPassCB.DeltaTime = gt.DeltaTime();
-
-    PassCB->CopyData(0, mMainPassCB);
+    m_scene->GetCamera().SetOrbit(m_radius, m_theta, m_phi);
+    m_scene->Update(gt, m_clientWidth, m_clientHeight);
 }
 
 void RenderWindow::Draw(const GameTimer& gt)
 {
-    // Reuse the memory associated with command recording.
-    // We can only reset when the associated command lists have finished execution on the GPU.
-    ThrowIfFailed(m_commandAllocators->Reset());
+    PROFILE_FUNCTION();
 
-    // A command list can be reset after it has been added to the command queue via ExecuteCommandList.
-    // Reusing the command list reuses memory.
-    ThrowIfFailed(m_commandList->Reset(m_commandAllocators.Get(), m_PSO.Get()));
+    GpuCommandList& list = m_scene->BeginCommandList();
+    ID3D12GraphicsCommandList* commandList = static_cast<D3D12CommandList&>(list).GetCommandList();
 
-    m_commandList->RSSetViewports(1, &m_screenViewport);
-    m_commandList->RSSetScissorRects(1, &m_scissorRect);
+    UINT gpuFrameZone = m_gpuTimer.BeginZone(commandList, "Frame");
+
+    commandList->RSSetViewports(1, &m_screenViewport);
+    commandList->RSSetScissorRects(1, &m_scissorRect);
 
     // Indicate a state transition on the resource usage.
-    m_commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
+    commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
         D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
 
     // Clear the back buffer and depth buffer.
-    m_commandList->ClearRenderTargetView(CurrentBackBufferView(), Colors::LightSteelBlue, 0, nullptr);
-    m_commandList->ClearDepthStencilView(DepthStencilView(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
+    {
+        GPU_PROFILE_SCOPE(m_gpuTimer, commandList, "Clear");
+        commandList->ClearRenderTargetView(CurrentBackBufferView(), Colors::LightSteelBlue, 0, nullptr);
+        commandList->ClearDepthStencilView(DepthStencilView(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
+    }
 
     // Specify the buffers we are going to render to.
-    m_commandList->OMSetRenderTargets(1, &CurrentBackBufferView(), true, &DepthStencilView());
-
-    ID3D12DescriptorHeap* descriptorHeaps[] = { m_cbvHeap.Get() };
-    m_commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
-
-    m_commandList->SetGraphicsRootSignature(m_rootSignature.Get());
+    commandList->OMSetRenderTargets(1, &CurrentBackBufferView(), true, &DepthStencilView());
 
-    m_commandList->SetGraphicsRootConstantBufferView(1, PassCB->Resource()->GetGPUVirtualAddress());
+    ID3D12DescriptorHeap* descriptorHeaps[] = { m_descriptorHeap.GetHeap() };
+    commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
 
-    DrawRenderItems();
+    {
+        GPU_PROFILE_SCOPE(m_gpuTimer, commandList, "Opaque");
+        m_scene->DrawScene(list);
+    }
 
     // Indicate a state transition on the resource usage.
-    m_commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
-        D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
+    // The transition to PRESENT is where the GPU flushes the render target
+    // for the swap chain, so it gets its own zone.
+    {
+        GPU_PROFILE_SCOPE(m_gpuTimer, commandList, "Present");
+        commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
+            D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
+    }
 
-    // Done recording commands.
-    ThrowIfFailed(m_commandList->Close());
+    m_gpuTimer.EndZone(commandList, gpuFrameZone);
+    m_gpuTimer.EndFrame(commandList);
 
-    // Add the command list to the queue for execution.
-    ID3D12CommandList* cmdsLists[] = { m_commandList.Get() };
-    m_commandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
+    m_scene->Submit(list);
 
     // swap the back and front buffers
-    ThrowIfFailed(m_swapChain->Present(0, 0));
-    m_currBackBuffer = (m_currBackBuffer + 1) % c_frameCount;
-
-    // Wait until frame commands are complete.  This waiting is inefficient and is
-    // done for simplicity.  Later we will show how to organize our rendering code
-    // so we do not have to wait per frame.
-    FlushCommandQueue();
-}
-
-void RenderWindow::DrawRenderItems() 
-{
-    UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
-
-    for (size_t i = 0; i < gameObject.GetOpaqueItems().size(); i++) 
     {
-        auto ri = gameObject.GetOpaqueItems()[i];
-    
-        m_commandList->IASetVertexBuffers(0, 1, &ri->Geo->VertexBufferView());
-        m_commandList->IASetIndexBuffer(&ri->Geo->IndexBufferView());
-        m_commandList->IASetPrimitiveTopology(ri->PrimitiveType);
-
-        m_commandList->SetGraphicsRootConstantBufferView(0, ri->m_objectCB->Resource()->GetGPUVirtualAddress());
-        m_commandList->DrawIndexedInstanced(ri->IndexCount, 1, ri->StartIndexLocation, ri->BaseVertexLocation, 0);
+        PROFILE_SCOPE("Present");
+        ThrowIfFailed(m_swapChain->Present(0, 0));
     }
+    m_currBackBuffer = (m_currBackBuffer + 1) % c_frameCount;
+    m_frameLimiter.MarkPresent();
+
+    m_descriptorHeap.EndFrame(m_scene->Signal());
 }
 
 void RenderWindow::BuildDescriptorHeaps()
 {
-    UINT objCount = (UINT)gameObject.GetOpaqueItems().size();
-
-    UINT numDescriptor = (objCount + 1);
-    m_passCbvOffset = objCount;
-
-    D3D12_DESCRIPTOR_HEAP_DESC cbvHeapDesc;
-    cbvHeapDesc.NumDescriptors = numDescriptor;
-    cbvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-    cbvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-    cbvHeapDesc.NodeMask = 0;
-    ThrowIfFailed(m_d3dDevice->CreateDescriptorHeap(&cbvHeapDesc,
-        IID_PPV_ARGS(&m_cbvHeap)));
+    // Nothing is bound through tables yet (objects and the pass use root
+    // CBVs), so these are sizes to grow into, not counts of current users.
+    m_descriptorHeap.Initialize(m_d3dDevice.Get(), c_persistentDescriptors, c_transientDescriptors, c_stagingDescriptors);
 }
 
-void RenderWindow::BuildConstantBuffers()
+void RenderWindow::BuildRootSignature()
 {
-    m_objectCB = std::make_unique<UploadBuffer<ObjectConstants>>(m_d3dDevice.Get(), 1, true);
-    PassCB = std::make_unique<UploadBuffer<PassConstants>>(m_d3dDevice.Get(), 1, true);
-
-    UINT passObjCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(PassConstants));
-
-    D3D12_GPU_VIRTUAL_ADDRESS passCbAddress = PassCB->Resource()->GetGPUVirtualAddress();
-
-    int heapIndex = m_passCbvOffset;
-
-    auto handle = CD3DX12_CPU_DESCRIPTOR_HANDLE(
-        m_cbvHeap->GetCPUDescriptorHandleForHeapStart());
-    handle.Offset(heapIndex, m_cbvSrvUavDescriptorSize);
-
-    D3D12_CONSTANT_BUFFER_VIEW_DESC passCbvDesc;
-    passCbvDesc.BufferLocation = passCbAddress;
-    passCbvDesc.SizeInBytes = passObjCBByteSize;
-
-    m_d3dDevice->CreateConstantBufferView(&passCbvDesc, handle);
+    m_rootSignatureCache.Initialize(m_d3dDevice.Get(), ResolveModulePath("ShaderCache"));
+
+    RootSignatureBuilder builder;
+    builder.AddConstantBuffer(0)
+        .AddConstantBuffer(1)
+        // Draw id, written per command by ExecuteIndirect.
+        .AddConstants(1, 2)
+        .SetFlags(D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+
+    const RootSignatureCache::Entry& rootSignature = m_rootSignatureCache.Get(builder.Build());
+    m_rootSignature = rootSignature.Signature;
+    // Identifies the root signature in pipeline keys.
+    m_rootSignatureHash = rootSignature.Hash;
 }
 
-void RenderWindow::BuildRootSignature()
+void RenderWindow::BuildShadersAndInputLayout()
 {
-    CD3DX12_ROOT_PARAMETER slotRootParameter[2];
-
-    slotRootParameter[0].InitAsConstantBufferView(0);
-    slotRootParameter[1].InitAsConstantBufferView(1);
-
-    CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(2, slotRootParameter, 0, nullptr,
-        D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
-
-    ComPtr<ID3DBlob> serializedRootSig = nullptr;
-    ComPtr<ID3DBlob> errorBlob = nullptr;
-    HRESULT hr = D3D12SerializeRootSignature(&rootSigDesc, D3D_ROOT_SIGNATURE_VERSION_1,
-        serializedRootSig.GetAddressOf(), errorBlob.GetAddressOf());
-
-    if (errorBlob != nullptr)
+    if (m_shaderCache == nullptr)
     {
-        ::OutputDebugStringA((char*)errorBlob->GetBufferPointer());
+        m_shaderCache = std::make_unique<ShaderCache>("ShaderCache", [](const ShaderDesc& desc) { return d3dUtil::CompileShader(desc); }, d3dUtil::ShaderCompilerVersion());
+        m_shaderCompiler = std::make_unique<ShaderPermutationCompiler>(*m_shaderCache);
     }
-    ThrowIfFailed(hr);
 
-    ThrowIfFailed(m_d3dDevice->CreateRootSignature(
-        0,
-        serializedRootSig->GetBufferPointer(),
-        serializedRootSig->GetBufferSize(),
-        IID_PPV_ARGS(&m_rootSignature)));
-}
+    // color.hlsl has no feature axes yet, so each set is one permutation;
+    // both stages still compile side by side on a cold cache.
+    ShaderPermutationSet vs({ "Shaders/color.hlsl", "VS", "vs_5_0", {}, d3dUtil::DefaultShaderFlags() });
+    ShaderPermutationSet ps({ "Shaders/color.hlsl", "PS", "ps_5_0", {}, d3dUtil::DefaultShaderFlags() });
 
-void RenderWindow::BuildShadersAndInputLayout()
-{
-    HRESULT hr = S_OK;
+    ShaderPermutationCompiler::Result shaders = m_shaderCompiler->Compile({ vs.GetDesc(0), ps.GetDesc(0) });
 
-    m_vsByteCode = d3dUtil::CompileShader(L"Shaders\\color.hlsl", nullptr, "VS", "vs_5_0");
-    m_psByteCode = d3dUtil::CompileShader(L"Shaders\\color.hlsl", nullptr, "PS", "ps_5_0");
+    m_vsByteCode = shaders.Bytecode[0];
+    m_psByteCode = shaders.Bytecode[1];
+    // The compiler errors have already gone to the debug output.
+    if (m_vsByteCode == nullptr || m_psByteCode == nullptr)
+        ThrowIfFailed(E_FAIL);
+
+    // Blobs written by this run are flushed now rather than at exit, so a
+    // crash later on does not lose them.
+    m_shaderCache->SaveIndex();
+
+    MemoryTracker::RecordExternal(MemTag::Shaders, m_vsByteCode->Size());
+    MemoryTracker::RecordExternal(MemTag::Shaders, m_psByteCode->Size());
 
     m_inputLayout =
     {
@@ -251,13 +216,13 @@ void RenderWindow::BuildPSO()
     psoDesc.pRootSignature = m_rootSignature.Get();
     psoDesc.VS =
     {
-        reinterpret_cast<BYTE*>(m_vsByteCode->GetBufferPointer()),
-        m_vsByteCode->GetBufferSize()
+        m_vsByteCode->Data(),
+        m_vsByteCode->Size()
     };
     psoDesc.PS =
     {
-        reinterpret_cast<BYTE*>(m_psByteCode->GetBufferPointer()),
-        m_psByteCode->GetBufferSize()
+        m_psByteCode->Data(),
+        m_psByteCode->Size()
     };
     psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
     psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
@@ -269,5 +234,8 @@ void RenderWindow::BuildPSO()
     psoDesc.SampleDesc.Count = m4xMsaaState ? 4 : 1;
     psoDesc.SampleDesc.Quality = m4xMsaaState ? (m4xMsaaQuality - 1) : 0;
     psoDesc.DSVFormat = m_depthStencilFormat;
-    ThrowIfFailed(m_d3dDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_PSO)));
+    m_PSO = m_psoCache.Get(psoDesc, m_rootSignatureHash);
+    m_psoHash = HashGraphicsPipelineDesc(psoDesc, m_rootSignatureHash);
+
+    m_psoCache.Save();
 }
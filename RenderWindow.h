@@ -2,34 +2,20 @@
 #include "framework.h"
 #include "DataD3D12.h"
 #include "MathHelper.h"
-#include "UploadBuffer.h"
 #include "ShaderStructures.h"
 #include "d3dUtil.h"
-#include "GameObject.h"
+#include "D3D12Backend.h"
+#include "SceneRenderer.h"
+#include "GpuTimer.h"
+#include "FrameArena.h"
+#include "ShaderPermutations.h"
+#include "PipelineStateCache.h"
+#include "RootSignatureCache.h"
+#include "DescriptorHeap.h"
 
 using namespace DirectX;
 using namespace DX;
 
-struct PassConstants {
-    XMFLOAT4X4                                          View;
-    XMFLOAT4X4                                          InvView;
-    XMFLOAT4X4                                          Proj;
-    XMFLOAT4X4                                          InvProj;
-    XMFLOAT4X4                                          ViewProj;
-    XMFLOAT4X4                                          InvViewProj;
-    XMFLOAT3                                            EyePosW;
-
-    float                                               cbPerObjectPad1;
-
-    XMFLOAT2                                            RenderTargetSize;
-    XMFLOAT2                                            InvRenderTargetSize;
-
-    float                                               NearZ;
-    float                                               FarZ;
-    float                                               TotalTime;
-    float                                               DeltaTime;
-};
-
 class RenderWindow : public DataGlobal
 {
 public:
@@ -42,46 +28,64 @@ public:
     virtual bool                                        Initialize()                override;
     virtual void                                        Update(const GameTimer& gt) override;
     virtual void                                        Draw(const GameTimer& gt)   override;
+
+    const ObjectCBStats&                                GetObjectCBStats()          const   {   return m_scene->GetObjectCBStats(); }
+    const GpuTimer&                                     GetGpuTimer()               const   {   return m_gpuTimer; }
     
 protected:
 
     virtual void                                        OnResize()                  override;
+    virtual void                                        FixedUpdate(float stepSeconds)  override;
+    virtual void                                        PublishSimulation()         override;
 
     void                                                BuildDescriptorHeaps();
-    void                                                BuildConstantBuffers();
     void                                                BuildRootSignature();
     void                                                BuildShadersAndInputLayout();
     void                                                BuildPSO();
 
-    void                                                DrawRenderItems();
-
 protected:
 
     XMFLOAT4							                CubePos;
     XMFLOAT4X4							                CubeRotMat;
 
+    RootSignatureCache                                  m_rootSignatureCache;
     ComPtr<ID3D12RootSignature>                         m_rootSignature = nullptr;
-    ComPtr<ID3D12DescriptorHeap>                        m_cbvHeap = nullptr;
-
-    std::unique_ptr<UploadBuffer<PassConstants>>        PassCB = nullptr;
-    std::unique_ptr<UploadBuffer<ObjectConstants>>      m_objectCB = nullptr;
-
-    ComPtr<ID3DBlob>                                    m_vsByteCode = nullptr;
-    ComPtr<ID3DBlob>                                    m_psByteCode = nullptr;
+    // Shader-visible CBV/SRV/UAV heap: persistent free list + per-frame ring.
+    static const UINT                                   c_persistentDescriptors = 1024;
+    static const UINT                                   c_transientDescriptors = 4096;
+    static const UINT                                   c_stagingDescriptors = 1024;
+    DescriptorHeapManager                               m_descriptorHeap;
+
+    // Compiled shaders are kept across runs, keyed by source and options.
+    std::unique_ptr<ShaderCache>                        m_shaderCache;
+    // Folds identical bytecode across every batch compiled through the
+    // cache, so it lives as long as the cache (and is destroyed first).
+    std::unique_ptr<ShaderPermutationCompiler>          m_shaderCompiler;
+    std::shared_ptr<const ShaderBytecode>               m_vsByteCode;
+    std::shared_ptr<const ShaderBytecode>               m_psByteCode;
 
     std::vector<D3D12_INPUT_ELEMENT_DESC>               m_inputLayout;
 
+    // Pipelines are created once per distinct desc and persisted in a
+    // pipeline library next to the shader cache.
+    PipelineStateCache                                  m_psoCache;
+    std::uint64_t                                       m_rootSignatureHash = 0;
     ComPtr<ID3D12PipelineState>                         m_PSO = nullptr;
+    std::uint64_t                                       m_psoHash = 0;
+
+    // Per-pass GPU timings, read back gNumFrameResources frames late.
+    static const UINT                                   c_maxGpuZonesPerFrame = 16;
+    GpuTimer                                            m_gpuTimer;
 
     XMFLOAT4X4                                          m_world = MathHelper::Identity4x4();
-    XMFLOAT4X4                                          m_view = MathHelper::Identity4x4();
-    XMFLOAT4X4                                          m_proj = MathHelper::Identity4x4();
 
     float                                               m_theta = 1.5f * XM_PI;
     float                                               m_phi = XM_PIDIV4;
     float                                               m_radius = 5.0f;
 
-    UINT												m_passCbvOffset = 0;
-
-    GameObject                                          gameObject;
+    // The frame loop runs on the backend interface, as in the headless
+    // build; the D3D12-only parts of a frame (render targets, GPU timers,
+    // Present) are recorded around it on the same list.
+    std::unique_ptr<D3D12RenderDevice>                  m_renderDevice;
+    std::unique_ptr<SceneRenderer>                      m_scene;
 };
\ No newline at end of file
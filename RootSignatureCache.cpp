@@ -0,0 +1,173 @@
+#include "RootSignatureCache.h"
+#include "Hash.h"
+#include "MappedFile.h"
+#include <cassert>
+#include <filesystem>
+
+RootSignatureCache::RootSignatureCache()
+{
+}
+
+RootSignatureCache::~RootSignatureCache()
+{
+}
+
+void RootSignatureCache::Initialize(ID3D12Device* device, const std::string& directory)
+{
+	m_device = device;
+	m_directory = directory;
+
+	if (!m_directory.empty())
+	{
+		std::error_code error;
+		std::filesystem::create_directories(m_directory, error);
+	}
+}
+
+const RootSignatureCache::Entry& RootSignatureCache::Get(const RootSignatureLayout& layout)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	std::uint64_t hash = layout.GetHash();
+	auto it = m_entries.find(hash);
+	if (it != m_entries.end())
+	{
+		assert(it->second.Layout == layout && "Root signature hash collision.");
+		return it->second;
+	}
+
+	// A new layout one parameter away from an existing one is probably an
+	// accident; every switch between the two rebinds the whole signature.
+	for (const auto& [otherHash, other] : m_entries)
+	{
+		RootSignatureDiff diff = RootSignatureDiff::Compute(other.Layout, layout);
+		if (diff.ChangedParameters.size() <= 1 && !diff.SamplersChanged && !diff.FlagsChanged)
+		{
+			std::string message = "Root signature " + Hasher::ToHex(hash) + " is a near duplicate of "
+				+ Hasher::ToHex(otherHash) + ": " + diff.Describe() + "\n";
+			::OutputDebugStringA(message.c_str());
+		}
+	}
+
+	Entry entry;
+	entry.Hash = hash;
+	entry.Layout = layout;
+
+	MappedFile file;
+	const std::uint8_t* blob = nullptr;
+	std::size_t blobSize = 0;
+	if (!m_directory.empty() && file.Open(BlobPath(hash))
+		&& RootSignatureBlobFile::Unpack(file.Data(), file.Size(), hash, blob, blobSize) && blobSize > 0
+		&& SUCCEEDED(m_device->CreateRootSignature(0, blob, blobSize, IID_PPV_ARGS(&entry.Signature))))
+	{
+		m_diskHits++;
+	}
+	else
+	{
+		ComPtr<ID3DBlob> serialized = Serialize(layout);
+		DX::ThrowIfFailed(m_device->CreateRootSignature(0, serialized->GetBufferPointer(), serialized->GetBufferSize(),
+			IID_PPV_ARGS(&entry.Signature)));
+
+		if (!m_directory.empty())
+		{
+			// Unmapped first: on Windows a mapped file cannot be replaced.
+			file.Close();
+			std::vector<std::uint8_t> contents = RootSignatureBlobFile::Pack(hash, serialized->GetBufferPointer(), serialized->GetBufferSize());
+			WriteFileAtomic(BlobPath(hash), contents.data(), contents.size());
+		}
+	}
+
+	return m_entries.emplace(hash, std::move(entry)).first->second;
+}
+
+const RootSignatureLayout* RootSignatureCache::FindLayout(std::uint64_t hash) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto it = m_entries.find(hash);
+	return it != m_entries.end() ? &it->second.Layout : nullptr;
+}
+
+ComPtr<ID3DBlob> RootSignatureCache::Serialize(const RootSignatureLayout& layout)
+{
+	// Ranges of every table, in one array the parameters point into.
+	std::vector<D3D12_DESCRIPTOR_RANGE> ranges;
+	for (const RootParameter& parameter : layout.Parameters)
+	{
+		for (const DescriptorRange& range : parameter.Ranges)
+		{
+			CD3DX12_DESCRIPTOR_RANGE d3dRange;
+			d3dRange.Init((D3D12_DESCRIPTOR_RANGE_TYPE)range.Type, range.Count, range.BaseRegister, range.Space, range.Offset);
+			ranges.push_back(d3dRange);
+		}
+	}
+
+	std::vector<CD3DX12_ROOT_PARAMETER> parameters(layout.Parameters.size());
+	std::size_t firstRange = 0;
+	for (std::size_t i = 0; i < layout.Parameters.size(); ++i)
+	{
+		const RootParameter& parameter = layout.Parameters[i];
+		D3D12_SHADER_VISIBILITY visibility = (D3D12_SHADER_VISIBILITY)parameter.Visibility;
+
+		switch (parameter.Type)
+		{
+		case RootParameterType::DescriptorTable:
+			parameters[i].InitAsDescriptorTable((UINT)parameter.Ranges.size(), ranges.data() + firstRange, visibility);
+			firstRange += parameter.Ranges.size();
+			break;
+		case RootParameterType::Constants:
+			parameters[i].InitAsConstants(parameter.Num32BitValues, parameter.Register, parameter.Space, visibility);
+			break;
+		case RootParameterType::ConstantBuffer:
+			parameters[i].InitAsConstantBufferView(parameter.Register, parameter.Space, visibility);
+			break;
+		case RootParameterType::ShaderResource:
+			parameters[i].InitAsShaderResourceView(parameter.Register, parameter.Space, visibility);
+			break;
+		case RootParameterType::UnorderedAccess:
+			parameters[i].InitAsUnorderedAccessView(parameter.Register, parameter.Space, visibility);
+			break;
+		}
+	}
+
+	std::vector<D3D12_STATIC_SAMPLER_DESC> samplers;
+	for (const StaticSampler& sampler : layout.StaticSamplers)
+	{
+		D3D12_STATIC_SAMPLER_DESC desc = {};
+		desc.Filter = (D3D12_FILTER)sampler.Filter;
+		desc.AddressU = (D3D12_TEXTURE_ADDRESS_MODE)sampler.AddressU;
+		desc.AddressV = (D3D12_TEXTURE_ADDRESS_MODE)sampler.AddressV;
+		desc.AddressW = (D3D12_TEXTURE_ADDRESS_MODE)sampler.AddressW;
+		desc.MipLODBias = sampler.MipLODBias;
+		desc.MaxAnisotropy = sampler.MaxAnisotropy;
+		desc.ComparisonFunc = (D3D12_COMPARISON_FUNC)sampler.ComparisonFunc;
+		desc.BorderColor = (D3D12_STATIC_BORDER_COLOR)sampler.BorderColor;
+		desc.MinLOD = sampler.MinLOD;
+		desc.MaxLOD = sampler.MaxLOD;
+		desc.ShaderRegister = sampler.Register;
+		desc.RegisterSpace = sampler.Space;
+		desc.ShaderVisibility = (D3D12_SHADER_VISIBILITY)sampler.Visibility;
+		samplers.push_back(desc);
+	}
+
+	CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc((UINT)parameters.size(), parameters.data(),
+		(UINT)samplers.size(), samplers.data(), (D3D12_ROOT_SIGNATURE_FLAGS)layout.Flags);
+
+	ComPtr<ID3DBlob> serializedRootSig = nullptr;
+	ComPtr<ID3DBlob> errorBlob = nullptr;
+	HRESULT hr = D3D12SerializeRootSignature(&rootSigDesc, D3D_ROOT_SIGNATURE_VERSION_1,
+		serializedRootSig.GetAddressOf(), errorBlob.GetAddressOf());
+
+	if (errorBlob != nullptr)
+	{
+		::OutputDebugStringA((char*)errorBlob->GetBufferPointer());
+	}
+	DX::ThrowIfFailed(hr);
+
+	return serializedRootSig;
+}
+
+std::string RootSignatureCache::BlobPath(std::uint64_t hash) const
+{
+	return (std::filesystem::path(m_directory) / (Hasher::ToHex(hash) + ".rootsig")).string();
+}
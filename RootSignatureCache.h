@@ -0,0 +1,60 @@
+#pragma once
+#include "framework.h"
+#include "d3dUtil.h"
+#include "RootSignatureLayout.h"
+#include <mutex>
+#include <unordered_map>
+
+using Microsoft::WRL::ComPtr;
+
+// Creates each distinct root signature once.
+//
+// Layouts are keyed by their canonical hash, so passes that build the same
+// layout share one ID3D12RootSignature, and PSOs created against it share
+// pipeline cache entries. Serialized blobs are kept in the cache directory
+// and memory-mapped on later runs. A blob is only used if its header names
+// the same layout hash and serializer version and its contents check out
+// (see RootSignatureBlobFile); otherwise, or if the device rejects it, the
+// layout is serialized again. Near-duplicate layouts are reported to the
+// debug output.
+class RootSignatureCache
+{
+public:
+
+	struct Entry
+	{
+		ComPtr<ID3D12RootSignature>			Signature;
+		std::uint64_t						Hash = 0;
+		RootSignatureLayout					Layout;
+	};
+
+											RootSignatureCache();
+											RootSignatureCache(const RootSignatureCache& rhs) = delete;
+											RootSignatureCache& operator=(const RootSignatureCache& rhs) = delete;
+											~RootSignatureCache();
+
+	// An empty directory disables the disk cache.
+	void									Initialize(ID3D12Device* device, const std::string& directory);
+
+	const Entry&							Get(const RootSignatureLayout& layout);
+
+	// Layout behind a hash returned by Get(), or nullptr.
+	const RootSignatureLayout*				FindLayout(std::uint64_t hash)	const;
+
+	// Signatures created from a blob found on disk.
+	UINT									GetDiskHits()		const	{	return m_diskHits;	}
+
+private:
+
+	// Serializes a version 1.0 root signature.
+	static ComPtr<ID3DBlob>					Serialize(const RootSignatureLayout& layout);
+	std::string								BlobPath(std::uint64_t hash)	const;
+
+	ComPtr<ID3D12Device>					m_device = nullptr;
+	std::string								m_directory;
+
+	mutable std::mutex						m_mutex;
+	// Node-based: entries handed out by Get() stay put.
+	std::unordered_map<std::uint64_t, Entry>	m_entries;
+	UINT									m_diskHits = 0;
+};
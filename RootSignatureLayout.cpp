@@ -0,0 +1,323 @@
+#include "RootSignatureLayout.h"
+#include "Hash.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <sstream>
+#include <tuple>
+
+bool DescriptorRange::operator==(const DescriptorRange& rhs) const
+{
+	return Type == rhs.Type && Count == rhs.Count && BaseRegister == rhs.BaseRegister
+		&& Space == rhs.Space && Offset == rhs.Offset;
+}
+
+std::uint32_t RootParameter::GetCost() const
+{
+	switch (Type)
+	{
+	case RootParameterType::DescriptorTable:	return 1;
+	case RootParameterType::Constants:			return Num32BitValues;
+	default:									return 2;	// GPU virtual address
+	}
+}
+
+bool RootParameter::operator==(const RootParameter& rhs) const
+{
+	if (Type != rhs.Type || Visibility != rhs.Visibility)
+		return false;
+
+	if (Type == RootParameterType::DescriptorTable)
+		return Ranges == rhs.Ranges;
+
+	return Register == rhs.Register && Space == rhs.Space
+		&& (Type != RootParameterType::Constants || Num32BitValues == rhs.Num32BitValues);
+}
+
+bool StaticSampler::operator==(const StaticSampler& rhs) const
+{
+	return Filter == rhs.Filter && AddressU == rhs.AddressU && AddressV == rhs.AddressV && AddressW == rhs.AddressW
+		&& MipLODBias == rhs.MipLODBias && MaxAnisotropy == rhs.MaxAnisotropy && ComparisonFunc == rhs.ComparisonFunc
+		&& BorderColor == rhs.BorderColor && MinLOD == rhs.MinLOD && MaxLOD == rhs.MaxLOD
+		&& Register == rhs.Register && Space == rhs.Space && Visibility == rhs.Visibility;
+}
+
+std::uint32_t RootSignatureLayout::GetCost() const
+{
+	std::uint32_t cost = 0;
+	for (const RootParameter& parameter : Parameters)
+		cost += parameter.GetCost();
+	return cost;
+}
+
+// Hashes the same fields operator== compares, so equal layouts always hash
+// equal.
+std::uint64_t RootSignatureLayout::GetHash() const
+{
+	Hasher hasher;
+	hasher.Value(Flags);
+
+	hasher.Value((std::uint32_t)Parameters.size());
+	for (const RootParameter& parameter : Parameters)
+	{
+		hasher.Value(parameter.Type);
+		hasher.Value(parameter.Visibility);
+
+		if (parameter.Type == RootParameterType::DescriptorTable)
+		{
+			hasher.Value((std::uint32_t)parameter.Ranges.size());
+			for (const DescriptorRange& range : parameter.Ranges)
+			{
+				hasher.Value(range.Type);
+				hasher.Value(range.Count);
+				hasher.Value(range.BaseRegister);
+				hasher.Value(range.Space);
+				hasher.Value(range.Offset);
+			}
+		}
+		else
+		{
+			hasher.Value(parameter.Register);
+			hasher.Value(parameter.Space);
+			if (parameter.Type == RootParameterType::Constants)
+				hasher.Value(parameter.Num32BitValues);
+		}
+	}
+
+	hasher.Value((std::uint32_t)StaticSamplers.size());
+	for (const StaticSampler& sampler : StaticSamplers)
+	{
+		hasher.Value(sampler.Filter);
+		hasher.Value(sampler.AddressU);
+		hasher.Value(sampler.AddressV);
+		hasher.Value(sampler.AddressW);
+		hasher.Value(sampler.MipLODBias);
+		hasher.Value(sampler.MaxAnisotropy);
+		hasher.Value(sampler.ComparisonFunc);
+		hasher.Value(sampler.BorderColor);
+		hasher.Value(sampler.MinLOD);
+		hasher.Value(sampler.MaxLOD);
+		hasher.Value(sampler.Register);
+		hasher.Value(sampler.Space);
+		hasher.Value(sampler.Visibility);
+	}
+
+	return hasher.Get();
+}
+
+bool RootSignatureLayout::operator==(const RootSignatureLayout& rhs) const
+{
+	return Flags == rhs.Flags && Parameters == rhs.Parameters && StaticSamplers == rhs.StaticSamplers;
+}
+
+RootParameter& RootSignatureBuilder::AddParameter(RootParameterType type, std::uint32_t shaderRegister, std::uint32_t space, ShaderVisibility visibility)
+{
+	RootParameter& parameter = m_layout.Parameters.emplace_back();
+	parameter.Type = type;
+	parameter.Register = shaderRegister;
+	parameter.Space = space;
+	parameter.Visibility = visibility;
+	return parameter;
+}
+
+RootSignatureBuilder& RootSignatureBuilder::AddConstants(std::uint32_t num32BitValues, std::uint32_t shaderRegister, std::uint32_t space, ShaderVisibility visibility)
+{
+	AddParameter(RootParameterType::Constants, shaderRegister, space, visibility).Num32BitValues = num32BitValues;
+	return *this;
+}
+
+RootSignatureBuilder& RootSignatureBuilder::AddConstantBuffer(std::uint32_t shaderRegister, std::uint32_t space, ShaderVisibility visibility)
+{
+	AddParameter(RootParameterType::ConstantBuffer, shaderRegister, space, visibility);
+	return *this;
+}
+
+RootSignatureBuilder& RootSignatureBuilder::AddShaderResource(std::uint32_t shaderRegister, std::uint32_t space, ShaderVisibility visibility)
+{
+	AddParameter(RootParameterType::ShaderResource, shaderRegister, space, visibility);
+	return *this;
+}
+
+RootSignatureBuilder& RootSignatureBuilder::AddUnorderedAccess(std::uint32_t shaderRegister, std::uint32_t space, ShaderVisibility visibility)
+{
+	AddParameter(RootParameterType::UnorderedAccess, shaderRegister, space, visibility);
+	return *this;
+}
+
+RootSignatureBuilder& RootSignatureBuilder::AddTable(const std::vector<DescriptorRange>& ranges, ShaderVisibility visibility)
+{
+	assert(!ranges.empty() && "A descriptor table needs at least one range.");
+	AddParameter(RootParameterType::DescriptorTable, 0, 0, visibility).Ranges = ranges;
+	return *this;
+}
+
+RootSignatureBuilder& RootSignatureBuilder::AddStaticSampler(const StaticSampler& sampler)
+{
+	m_layout.StaticSamplers.push_back(sampler);
+	return *this;
+}
+
+RootSignatureBuilder& RootSignatureBuilder::SetFlags(std::uint32_t flags)
+{
+	m_layout.Flags = flags;
+	return *this;
+}
+
+RootSignatureLayout RootSignatureBuilder::Build() const
+{
+	RootSignatureLayout layout = m_layout;
+
+	for (RootParameter& parameter : layout.Parameters)
+	{
+		if (parameter.Type != RootParameterType::DescriptorTable)
+		{
+			// Unused for this type; cleared so they cannot make equal
+			// layouts look different.
+			if (parameter.Type != RootParameterType::Constants)
+				parameter.Num32BitValues = 0;
+			parameter.Ranges.clear();
+			continue;
+		}
+
+		parameter.Register = 0;
+		parameter.Space = 0;
+		parameter.Num32BitValues = 0;
+
+		// Resolve appended ranges the way D3D12 does.
+		std::uint32_t next = 0;
+		for (DescriptorRange& range : parameter.Ranges)
+		{
+			if (range.Offset == DescriptorRange::Append)
+				range.Offset = next;
+			next = range.Offset + range.Count;
+		}
+
+		std::sort(parameter.Ranges.begin(), parameter.Ranges.end(), [](const DescriptorRange& a, const DescriptorRange& b)
+		{
+			return a.Offset < b.Offset;
+		});
+
+		// t0-t1 at offset 0 followed by t2-t4 at offset 2 is t0-t4 at offset 0.
+		std::vector<DescriptorRange> merged;
+		for (const DescriptorRange& range : parameter.Ranges)
+		{
+			if (!merged.empty())
+			{
+				DescriptorRange& last = merged.back();
+				if (last.Type == range.Type && last.Space == range.Space
+					&& last.Offset + last.Count == range.Offset
+					&& last.BaseRegister + last.Count == range.BaseRegister)
+				{
+					last.Count += range.Count;
+					continue;
+				}
+			}
+			merged.push_back(range);
+		}
+		parameter.Ranges = std::move(merged);
+	}
+
+	std::sort(layout.StaticSamplers.begin(), layout.StaticSamplers.end(), [](const StaticSampler& a, const StaticSampler& b)
+	{
+		return std::tie(a.Space, a.Register) < std::tie(b.Space, b.Register);
+	});
+
+	assert(layout.GetCost() <= RootSignatureLayout::MaxCost && "Root signature is larger than 64 DWORDs.");
+	return layout;
+}
+
+RootSignatureDiff RootSignatureDiff::Compute(const RootSignatureLayout& from, const RootSignatureLayout& to)
+{
+	RootSignatureDiff diff;
+
+	std::size_t common = std::min(from.Parameters.size(), to.Parameters.size());
+	std::size_t total = std::max(from.Parameters.size(), to.Parameters.size());
+
+	bool prefix = true;
+	for (std::size_t i = 0; i < total; ++i)
+	{
+		bool same = i < common && from.Parameters[i] == to.Parameters[i];
+		if (same && prefix)
+			diff.CommonPrefix++;
+		if (!same)
+		{
+			prefix = false;
+			diff.ChangedParameters.push_back((std::uint32_t)i);
+		}
+	}
+
+	diff.SamplersChanged = from.StaticSamplers != to.StaticSamplers;
+	diff.FlagsChanged = from.Flags != to.Flags;
+	diff.Identical = diff.ChangedParameters.empty() && !diff.SamplersChanged && !diff.FlagsChanged;
+	diff.RebindCost = diff.Identical ? 0 : to.GetCost();
+	return diff;
+}
+
+std::string RootSignatureDiff::Describe() const
+{
+	if (Identical)
+		return "identical";
+
+	std::ostringstream text;
+	text << "rebind " << RebindCost << " DWORDs; changed parameters:";
+	for (std::uint32_t index : ChangedParameters)
+		text << " " << index;
+	if (ChangedParameters.empty())
+		text << " none";
+	if (SamplersChanged)
+		text << "; static samplers differ";
+	if (FlagsChanged)
+		text << "; flags differ";
+	return text.str();
+}
+
+namespace
+{
+	struct BlobHeader
+	{
+		std::uint32_t						Magic;
+		std::uint32_t						SerializerVersion;
+		std::uint64_t						LayoutHash;
+		std::uint64_t						BlobSize;
+		std::uint64_t						BlobHash;
+	};
+
+	const std::uint32_t						c_blobMagic = 0x47495352;	// "RSIG"
+}
+
+std::vector<std::uint8_t> RootSignatureBlobFile::Pack(std::uint64_t layoutHash, const void* blob, std::size_t blobSize)
+{
+	BlobHeader header;
+	header.Magic = c_blobMagic;
+	header.SerializerVersion = SerializerVersion;
+	header.LayoutHash = layoutHash;
+	header.BlobSize = blobSize;
+	header.BlobHash = Hasher().Bytes(blob, blobSize).Get();
+
+	std::vector<std::uint8_t> file(sizeof(header) + blobSize);
+	std::memcpy(file.data(), &header, sizeof(header));
+	if (blobSize > 0)
+		std::memcpy(file.data() + sizeof(header), blob, blobSize);
+	return file;
+}
+
+bool RootSignatureBlobFile::Unpack(const std::uint8_t* file, std::size_t fileSize, std::uint64_t layoutHash,
+	const std::uint8_t*& blob, std::size_t& blobSize)
+{
+	BlobHeader header;
+	if (file == nullptr || fileSize < sizeof(header))
+		return false;
+	std::memcpy(&header, file, sizeof(header));
+
+	if (header.Magic != c_blobMagic || header.SerializerVersion != SerializerVersion || header.LayoutHash != layoutHash
+		|| header.BlobSize != fileSize - sizeof(header))
+		return false;
+
+	const std::uint8_t* data = file + sizeof(header);
+	if (Hasher().Bytes(data, (std::size_t)header.BlobSize).Get() != header.BlobHash)
+		return false;
+
+	blob = data;
+	blobSize = (std::size_t)header.BlobSize;
+	return true;
+}
@@ -0,0 +1,177 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Backend-independent description of a root signature. The enum values match
+// their D3D12 counterparts so the D3D12 side converts with a cast.
+
+enum class RootParameterType : std::uint8_t
+{
+	DescriptorTable = 0,
+	Constants = 1,
+	ConstantBuffer = 2,
+	ShaderResource = 3,
+	UnorderedAccess = 4,
+};
+
+enum class DescriptorRangeType : std::uint8_t
+{
+	ShaderResource = 0,
+	UnorderedAccess = 1,
+	ConstantBuffer = 2,
+	Sampler = 3,
+};
+
+enum class ShaderVisibility : std::uint8_t
+{
+	All = 0,
+	Vertex = 1,
+	Hull = 2,
+	Domain = 3,
+	Geometry = 4,
+	Pixel = 5,
+};
+
+struct DescriptorRange
+{
+	static constexpr std::uint32_t			Append = 0xffffffffu;
+
+	DescriptorRangeType						Type = DescriptorRangeType::ShaderResource;
+	std::uint32_t							Count = 1;
+	std::uint32_t							BaseRegister = 0;
+	std::uint32_t							Space = 0;
+	// Descriptors from the start of the table, or Append to follow the
+	// previous range.
+	std::uint32_t							Offset = Append;
+
+	bool									operator==(const DescriptorRange& rhs)	const;
+};
+
+struct RootParameter
+{
+	RootParameterType						Type = RootParameterType::ConstantBuffer;
+	ShaderVisibility						Visibility = ShaderVisibility::All;
+	// Root constants and root descriptors.
+	std::uint32_t							Register = 0;
+	std::uint32_t							Space = 0;
+	std::uint32_t							Num32BitValues = 0;
+	// Descriptor tables.
+	std::vector<DescriptorRange>			Ranges;
+
+	// Size in the root arguments, in DWORDs: what rebinding it costs.
+	std::uint32_t							GetCost()		const;
+	bool									operator==(const RootParameter& rhs)	const;
+};
+
+// Fields are D3D12_STATIC_SAMPLER_DESC's, kept as raw values.
+struct StaticSampler
+{
+	std::uint32_t							Filter = 0x55;		// MIN_MAG_MIP_LINEAR
+	std::uint32_t							AddressU = 1;		// WRAP
+	std::uint32_t							AddressV = 1;
+	std::uint32_t							AddressW = 1;
+	float									MipLODBias = 0.0f;
+	std::uint32_t							MaxAnisotropy = 16;
+	std::uint32_t							ComparisonFunc = 4;	// LESS_EQUAL
+	std::uint32_t							BorderColor = 1;	// OPAQUE_BLACK
+	float									MinLOD = 0.0f;
+	float									MaxLOD = 3.402823466e+38f;
+	std::uint32_t							Register = 0;
+	std::uint32_t							Space = 0;
+	ShaderVisibility						Visibility = ShaderVisibility::Pixel;
+
+	bool									operator==(const StaticSampler& rhs)	const;
+};
+
+// Root signature in canonical form, as returned by RootSignatureBuilder:
+// - table ranges have explicit offsets, are sorted by offset, and adjacent
+//   ranges that continue each other are merged,
+// - static samplers are sorted by space and register.
+// Two descriptions that produce the same root signature on the device are
+// then equal and have the same hash. Parameter order is kept: it is the
+// binding interface.
+struct RootSignatureLayout
+{
+	std::vector<RootParameter>				Parameters;
+	std::vector<StaticSampler>				StaticSamplers;
+	std::uint32_t							Flags = 0;		// D3D12_ROOT_SIGNATURE_FLAGS
+
+	// The API limit is 64 DWORDs.
+	static const std::uint32_t				MaxCost = 64;
+
+	std::uint32_t							GetCost()		const;
+	std::uint64_t							GetHash()		const;
+	bool									operator==(const RootSignatureLayout& rhs)	const;
+	bool									operator!=(const RootSignatureLayout& rhs)	const	{	return !(*this == rhs);	}
+};
+
+class RootSignatureBuilder
+{
+public:
+
+	RootSignatureBuilder&					AddConstants(std::uint32_t num32BitValues, std::uint32_t shaderRegister, std::uint32_t space = 0, ShaderVisibility visibility = ShaderVisibility::All);
+	RootSignatureBuilder&					AddConstantBuffer(std::uint32_t shaderRegister, std::uint32_t space = 0, ShaderVisibility visibility = ShaderVisibility::All);
+	RootSignatureBuilder&					AddShaderResource(std::uint32_t shaderRegister, std::uint32_t space = 0, ShaderVisibility visibility = ShaderVisibility::All);
+	RootSignatureBuilder&					AddUnorderedAccess(std::uint32_t shaderRegister, std::uint32_t space = 0, ShaderVisibility visibility = ShaderVisibility::All);
+	RootSignatureBuilder&					AddTable(const std::vector<DescriptorRange>& ranges, ShaderVisibility visibility = ShaderVisibility::All);
+	RootSignatureBuilder&					AddStaticSampler(const StaticSampler& sampler);
+	RootSignatureBuilder&					SetFlags(std::uint32_t flags);
+
+	// Index the next Add* call will get.
+	std::uint32_t							GetNextIndex()	const	{	return (std::uint32_t)m_layout.Parameters.size();	}
+
+	// Canonical form of what was added.
+	RootSignatureLayout						Build()			const;
+
+private:
+
+	RootParameter&							AddParameter(RootParameterType type, std::uint32_t shaderRegister, std::uint32_t space, ShaderVisibility visibility);
+
+	RootSignatureLayout						m_layout;
+};
+
+// What switching from one root signature to another costs on a command list.
+//
+// Setting a different root signature invalidates every root argument, so
+// all of the new signature's parameters must be bound again, even those the
+// two share. Layouts that differ only in a few parameters are worth
+// merging: they pay the full rebind for what is often a trivial difference.
+struct RootSignatureDiff
+{
+	bool									Identical = false;
+	// Leading parameters the two layouts have in common.
+	std::uint32_t							CommonPrefix = 0;
+	// Parameter indices that differ, or exist in only one layout.
+	std::vector<std::uint32_t>				ChangedParameters;
+	bool									SamplersChanged = false;
+	bool									FlagsChanged = false;
+	// DWORDs of root arguments to set again after the switch: zero when
+	// identical, the full cost of the target otherwise.
+	std::uint32_t							RebindCost = 0;
+
+	static RootSignatureDiff				Compute(const RootSignatureLayout& from, const RootSignatureLayout& to);
+
+	// One line, for logs.
+	std::string								Describe()		const;
+};
+
+// On-disk form of a serialized root signature: a header naming the layout it
+// was serialized from, the serializer version and the hash of the blob, then
+// the blob. The device accepts any well-formed blob, so without the header a
+// file left by an older serializer, or damaged on disk, would be taken for
+// the layout asked for.
+struct RootSignatureBlobFile
+{
+	// Bump when serialization changes (root signature version, how the
+	// layout is converted).
+	static const std::uint32_t				SerializerVersion = 1;
+
+	// The file contents for `blob`.
+	static std::vector<std::uint8_t>		Pack(std::uint64_t layoutHash, const void* blob, std::size_t blobSize);
+
+	// Finds the blob in `file`. Returns false if the file is not a blob of
+	// `layoutHash` written by this serializer version, or is damaged.
+	static bool								Unpack(const std::uint8_t* file, std::size_t fileSize, std::uint64_t layoutHash,
+												const std::uint8_t*& blob, std::size_t& blobSize);
+};
@@ -0,0 +1,240 @@
+#include "SceneRenderer.h"
+#include "FrameArena.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstring>
+#include <execution>
+
+static_assert(gNumFrameResources <= FrameArena::MaxFrames, "FrameArena needs one arena per frame resource.");
+
+SceneRenderer::SceneRenderer(RenderDevice& device, const SceneRendererSettings& settings, UINT maxRenderItems)
+	: m_device(device), m_settings(settings), m_scene(maxRenderItems)
+{
+}
+
+SceneRenderer::~SceneRenderer()
+{
+	// Frame resources may still be in use by the GPU.
+	if (m_fence != nullptr)
+		Flush();
+}
+
+void SceneRenderer::Initialize()
+{
+	PROFILE_FUNCTION();
+
+	m_fence = m_device.CreateFence(0);
+
+	// Items can be spawned at run time, so size for the whole pool.
+	for (int i = 0; i < gNumFrameResources; ++i)
+		m_frameResources.push_back(std::make_unique<FrameResource>(m_device, m_scene.GetMaxRenderItems()));
+	m_currFrameResource = m_frameResources[m_currFrameResourceIndex].get();
+
+	// The signature changes root arguments, so it is tied to the root signature.
+	m_commandSignature = m_device.CreateCommandSignature(IndirectCommandSignature(), m_settings.RootSignatureHash);
+
+	GpuCommandList& commandList = *m_currFrameResource->CommandList;
+	commandList.Reset();
+	m_scene.Init(m_device, commandList);
+	commandList.Close();
+	m_device.GetQueue().Execute(commandList);
+
+	// Wait until initialization is complete.
+	Flush();
+	m_scene.DisposeUploaders();
+}
+
+void SceneRenderer::BeginFrame(UINT maxQueuedFrames)
+{
+	PROFILE_FUNCTION();
+
+	// Cycle through the circular frame resource array.
+	m_currFrameResourceIndex = (m_currFrameResourceIndex + 1) % gNumFrameResources;
+	m_currFrameResource = m_frameResources[m_currFrameResourceIndex].get();
+
+	// Has the GPU finished processing the commands of the current frame resource?
+	// If not, wait until the GPU has completed commands up to this fence point.
+	// The frame limiter may allow fewer queued frames than there are frame
+	// resources, in which case we wait on a more recent frame.
+	UINT64 maxQueued = MathHelper::Clamp<UINT64>(maxQueuedFrames, 1, gNumFrameResources);
+	UINT64 queueFence = m_currentFence >= maxQueued ? m_currentFence - (maxQueued - 1) : 0;
+	UINT64 waitFence = MathHelper::Max(m_currFrameResource->Fence, queueFence);
+	if (waitFence != 0 && m_fence->GetCompletedValue() < waitFence)
+	{
+		PROFILE_SCOPE("WaitForFence");
+		m_fence->Wait(waitFence);
+	}
+
+	// The GPU is done with this frame resource, so the transient memory of
+	// that frame can be reused.
+	FrameArena::BeginFrame(m_currFrameResourceIndex);
+}
+
+void SceneRenderer::Update(const GameTimer& gt, UINT renderTargetWidth, UINT renderTargetHeight)
+{
+	PROFILE_FUNCTION();
+
+	// Camera matrices are only rebuilt when the orbit or the lens changed.
+	// Occlusion culling needs this frame's camera.
+	m_camera.UpdatePassConstants(m_mainPassCB);
+
+	m_scene.Update(m_camera);
+	UpdateObjectCBs();
+
+	m_mainPassCB.RenderTargetSize = XMFLOAT2((float)renderTargetWidth, (float)renderTargetHeight);
+	m_mainPassCB.InvRenderTargetSize = XMFLOAT2(1.0f / renderTargetWidth, 1.0f / renderTargetHeight);
+	m_mainPassCB.TotalTime = gt.TotalTime();
+	m_mainPassCB.DeltaTime = gt.DeltaTime();
+
+	std::memcpy(m_currFrameResource->PassCB->GetMappedData(), &m_mainPassCB, sizeof(m_mainPassCB));
+}
+
+void SceneRenderer::UpdateObjectCBs()
+{
+	// Gather the items whose constants are stale in at least one frame
+	// resource. Static items drop out after gNumFrameResources frames.
+	RenderItemSpan items = m_scene.GetRenderItems();
+	FrameVector<RenderItem*> dirtyItems;
+	dirtyItems.reserve(items.size());
+	for (RenderItem& e : items)
+	{
+		if (e.NumFramesDirty > 0)
+			dirtyItems.push_back(&e);
+	}
+
+	m_objectCBStats.Written = (UINT)dirtyItems.size();
+	m_objectCBStats.Skipped = (UINT)(items.size() - dirtyItems.size());
+	PROFILE_COUNTER("ObjectCB written", m_objectCBStats.Written);
+	PROFILE_COUNTER("ObjectCB skipped", m_objectCBStats.Skipped);
+
+	// Each item owns its element of the object buffer, so the dirty list can
+	// be transposed and copied in parallel.
+	std::uint8_t* objectCB = m_currFrameResource->ObjectCB->GetMappedData();
+	std::for_each(std::execution::par, dirtyItems.begin(), dirtyItems.end(), [this, objectCB](RenderItem* ri)
+	{
+		XMFLOAT4X4 world4x4 = m_scene.GetWorld(*ri);
+		XMMATRIX world = XMLoadFloat4x4(&world4x4);
+
+		ObjectConstants objConstants;
+		XMStoreFloat4x4(&objConstants.WorldViewProj, XMMatrixTranspose(world));
+		std::memcpy(objectCB + (std::size_t)ri->ObjCBIndex * ConstantBufferByteSize(sizeof(ObjectConstants)),
+			&objConstants, sizeof(objConstants));
+
+		ri->NumFramesDirty--;
+	});
+}
+
+GpuCommandList& SceneRenderer::BeginCommandList()
+{
+	// A command list can be reset once the GPU is done with it, which
+	// BeginFrame made sure of. Reusing the command list reuses memory.
+	GpuCommandList& commandList = *m_currFrameResource->CommandList;
+	commandList.Reset();
+	return commandList;
+}
+
+void SceneRenderer::DrawScene(GpuCommandList& commandList)
+{
+	PROFILE_FUNCTION();
+
+	commandList.SetPipelineState(m_settings.PipelineHash);
+	commandList.SetRootSignature(m_settings.RootSignatureHash);
+	commandList.SetRootConstantBuffer(1, m_currFrameResource->PassCB->GetGpuAddress());
+
+	if (m_settings.IndirectDraw)
+		DrawRenderItemsIndirect(commandList);
+	else
+		DrawRenderItems(commandList);
+}
+
+void SceneRenderer::DrawRenderItems(GpuCommandList& commandList)
+{
+	PROFILE_FUNCTION();
+
+	GpuAddress objectCBBase = m_currFrameResource->ObjectCB->GetGpuAddress();
+	RenderItemSpan items = m_scene.GetRenderItems();
+
+	UINT draws = 0;
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		const RenderItem* ri = &items[i];
+		if (!ri->Visible)
+			continue;
+
+		ri->Geo->SetBuffers(commandList);
+		commandList.SetPrimitiveTopology(ri->PrimitiveType);
+
+		commandList.SetRootConstantBuffer(0, ri->ObjectCBAddress(objectCBBase));
+		commandList.SetRootConstant(2, (UINT)i, 0);
+		commandList.DrawIndexedInstanced(ri->IndexCount, 1, ri->StartIndexLocation, ri->BaseVertexLocation, 0);
+		draws++;
+	}
+	m_drawCount = draws;
+}
+
+void SceneRenderer::DrawRenderItemsIndirect(GpuCommandList& commandList)
+{
+	PROFILE_FUNCTION();
+
+	RenderItemSpan items = m_scene.GetRenderItems();
+	UINT maxCommands = m_scene.GetMaxRenderItems();
+	assert(items.size() <= maxCommands);
+
+	UINT commandCount = m_indirectBuilder.Build(items, m_currFrameResource->ObjectCB->GetGpuAddress());
+	m_drawCount = commandCount;
+	if (commandCount == 0)
+		return;
+
+	GpuBuffer& indirectCommands = *m_currFrameResource->IndirectCommands;
+	GpuBuffer& indirectCount = *m_currFrameResource->IndirectCount;
+	std::memcpy(indirectCommands.GetMappedData(), m_indirectBuilder.GetCommands().data(), commandCount * sizeof(IndirectCommand));
+
+	UINT commandStride = sizeof(IndirectCommand);
+	for (const IndirectBatch& batch : m_indirectBuilder.GetBatches())
+	{
+		batch.Geo->SetBuffers(commandList);
+		commandList.SetPrimitiveTopology(batch.PrimitiveType);
+
+		// With a single batch the count buffer drives the draw count, exactly as
+		// it will once a culling pass writes it on the GPU.
+		if (m_indirectBuilder.GetBatches().size() == 1)
+		{
+			std::memcpy(indirectCount.GetMappedData(), &batch.CommandCount, sizeof(batch.CommandCount));
+			commandList.ExecuteIndirect(*m_commandSignature, maxCommands, indirectCommands, 0, &indirectCount, 0);
+		}
+		else
+		{
+			commandList.ExecuteIndirect(*m_commandSignature, batch.CommandCount,
+				indirectCommands, (UINT64)batch.FirstCommand * commandStride, nullptr, 0);
+		}
+	}
+}
+
+void SceneRenderer::Submit(GpuCommandList& commandList)
+{
+	PROFILE_FUNCTION();
+
+	// Done recording commands.
+	commandList.Close();
+
+	// Add the command list to the queue for execution.
+	m_device.GetQueue().Execute(commandList);
+}
+
+std::uint64_t SceneRenderer::Signal()
+{
+	// Advance the fence value to mark commands up to this fence point.
+	// The GPU keeps working on this frame while the CPU moves on to the next
+	// frame resource; BeginFrame waits on this value before reusing it.
+	m_currFrameResource->Fence = ++m_currentFence;
+	m_device.GetQueue().Signal(*m_fence, m_currentFence);
+	return m_currentFence;
+}
+
+void SceneRenderer::Flush()
+{
+	PROFILE_FUNCTION();
+
+	m_device.GetQueue().Signal(*m_fence, ++m_currentFence);
+	m_fence->Wait(m_currentFence);
+}
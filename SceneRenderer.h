@@ -0,0 +1,106 @@
+#pragma once
+#include "RenderBackend.h"
+#include "GameObject.h"
+#include "IndirectDraw.h"
+#include "FrameResource.h"
+#include "Camera.h"
+#include "GameTimer.h"
+#include <vector>
+
+// Object constant uploads done by the last Update, for profiling the dirty
+// tracking.
+struct ObjectCBStats
+{
+	UINT									Written = 0;
+	UINT									Skipped = 0;
+};
+
+struct SceneRendererSettings
+{
+	// As registered with the device; the null backend takes any value.
+	std::uint64_t							PipelineHash = 0;
+	std::uint64_t							RootSignatureHash = 0;
+
+	// ExecuteIndirect path: one command per visible item, plus a count buffer
+	// so a GPU culling pass can later compact the arguments in place.
+	bool									IndirectDraw = true;
+};
+
+// The frame loop shared by RenderWindow and the headless renderer: frame
+// resource cycling and fence waits, GameObject's per-frame systems, dirty-only
+// object constant uploads and the draws of the scene, all on a RenderDevice.
+//
+// A frame is BeginFrame, Update, then BeginCommandList, DrawScene, Submit and
+// Signal. The caller records whatever surrounds the scene (render targets,
+// GPU timers) on the list in between, and presents after Submit.
+class SceneRenderer
+{
+public:
+
+											SceneRenderer(RenderDevice& device, const SceneRendererSettings& settings = SceneRendererSettings(),
+												UINT maxRenderItems = GameObject::DefaultMaxRenderItems);
+											SceneRenderer(const SceneRenderer& rhs) = delete;
+											SceneRenderer& operator=(const SceneRenderer& rhs) = delete;
+											~SceneRenderer();
+
+	// Creates the frame resources and uploads the scene geometry; returns
+	// once the GPU has it. Items can be spawned afterwards.
+	void									Initialize();
+
+	// Moves to the next frame resource and waits until the GPU is done with
+	// it, or with a more recent frame when fewer than gNumFrameResources
+	// frames may be queued.
+	void									BeginFrame(UINT maxQueuedFrames = gNumFrameResources);
+	// Camera, GameObject systems, object and pass constants.
+	void									Update(const GameTimer& gt, UINT renderTargetWidth, UINT renderTargetHeight);
+
+	// The frame's command list, reset.
+	GpuCommandList&							BeginCommandList();
+	// Pipeline, root signature, pass constants and the render items.
+	void									DrawScene(GpuCommandList& commandList);
+	// Closes and executes the list.
+	void									Submit(GpuCommandList& commandList);
+	// Marks the end of the frame on the queue; returns the fence value the
+	// frame resource waits on before reuse.
+	std::uint64_t							Signal();
+	// Waits for every submitted frame.
+	void									Flush();
+
+	GameObject&								GetScene()					{	return m_scene;	}
+	Camera&									GetCamera()					{	return m_camera;	}
+	const PassConstants&					GetPassConstants()	const	{	return m_mainPassCB;	}
+
+	UINT									GetFrameIndex()		const	{	return m_currFrameResourceIndex;	}
+	GpuFence&								GetFence()					{	return *m_fence;	}
+	std::uint64_t							GetCurrentFence()	const	{	return m_currentFence;	}
+
+	const ObjectCBStats&					GetObjectCBStats()	const	{	return m_objectCBStats;	}
+	// Items drawn by the last DrawScene.
+	UINT									GetDrawCount()		const	{	return m_drawCount;	}
+
+private:
+
+	void									UpdateObjectCBs();
+	void									DrawRenderItems(GpuCommandList& commandList);
+	void									DrawRenderItemsIndirect(GpuCommandList& commandList);
+
+	RenderDevice&							m_device;
+	SceneRendererSettings					m_settings;
+
+	GameObject								m_scene;
+	Camera									m_camera;
+	PassConstants							m_mainPassCB = {};
+
+	std::vector<std::unique_ptr<FrameResource>>	m_frameResources;
+	FrameResource*							m_currFrameResource = nullptr;
+	UINT									m_currFrameResourceIndex = 0;
+
+	std::unique_ptr<GpuFence>				m_fence;
+	std::uint64_t							m_currentFence = 0;
+
+	std::unique_ptr<GpuCommandSignature>	m_commandSignature;
+	IndirectDrawBuilder						m_indirectBuilder;
+
+	ObjectCBStats							m_objectCBStats;
+	UINT									m_drawCount = 0;
+};
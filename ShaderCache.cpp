@@ -0,0 +1,246 @@
+#include "ShaderCache.h"
+#include "Hash.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+static const char* c_indexFileName = "index.txt";
+// Bump when the key layout or the blob format changes.
+static const std::uint32_t c_cacheVersion = 2;
+
+static bool ReadWholeFile(const std::string& path, std::string& contents)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		return false;
+
+	std::ostringstream stream;
+	stream << file.rdbuf();
+	contents = stream.str();
+	return true;
+}
+
+std::uint64_t ShaderBytecode::HashOf(const void* data, std::size_t size)
+{
+	return Hasher().Bytes(data, size).Get();
+}
+
+ShaderCache::ShaderCache(const std::string& directory, CompileFn compiler, const std::string& compilerVersion)
+	: m_directory(ResolveModulePath(directory)), m_compiler(std::move(compiler)), m_compilerVersion(compilerVersion)
+{
+	std::error_code error;
+	fs::create_directories(m_directory, error);
+
+	LoadIndex();
+}
+
+ShaderCache::~ShaderCache()
+{
+	SaveIndex();
+}
+
+std::vector<std::string> ShaderCache::FindIncludes(const std::string& sourcePath)
+{
+	std::vector<std::string> files;
+	std::unordered_set<std::string> visited;
+	std::vector<std::string> pending = { fs::path(sourcePath).lexically_normal().generic_string() };
+
+	while (!pending.empty())
+	{
+		std::string path = pending.back();
+		pending.pop_back();
+		if (!visited.insert(path).second)
+			continue;
+
+		files.push_back(path);
+
+		std::string contents;
+		if (!ReadWholeFile(path, contents))
+			continue;
+
+		// Same lookup as D3D_COMPILE_STANDARD_FILE_INCLUDE: relative to the
+		// including file. Commented-out includes are picked up too, which
+		// only makes the key more conservative.
+		fs::path directory = fs::path(path).parent_path();
+		std::istringstream lines(contents);
+		std::string line;
+		while (std::getline(lines, line))
+		{
+			std::size_t pos = line.find_first_not_of(" \t");
+			if (pos == std::string::npos || line.compare(pos, 8, "#include") != 0)
+				continue;
+
+			std::size_t open = line.find_first_of("\"<", pos + 8);
+			if (open == std::string::npos)
+				continue;
+			std::size_t close = line.find_first_of("\">", open + 1);
+			if (close == std::string::npos)
+				continue;
+
+			fs::path include = directory / line.substr(open + 1, close - open - 1);
+			pending.push_back(include.lexically_normal().generic_string());
+		}
+	}
+
+	return files;
+}
+
+std::uint64_t ShaderCache::ComputeKey(const ShaderDesc& desc) const
+{
+	Hasher hasher;
+	hasher.Value(c_cacheVersion);
+	hasher.String(m_compilerVersion);
+	hasher.String(desc.EntryPoint);
+	hasher.String(desc.Target);
+	hasher.Value(desc.Flags);
+
+	hasher.Value((std::uint64_t)desc.Defines.size());
+	for (const ShaderDefine& define : desc.Defines)
+	{
+		hasher.String(define.Name);
+		hasher.String(define.Value);
+	}
+
+	// The contents decide the output; the path only disambiguates missing
+	// files, which hash as empty.
+	for (const std::string& file : FindIncludes(desc.SourcePath))
+	{
+		std::string contents;
+		ReadWholeFile(file, contents);
+		hasher.String(file);
+		hasher.String(contents);
+	}
+
+	return hasher.Get();
+}
+
+std::shared_ptr<const ShaderBytecode> ShaderCache::Get(const ShaderDesc& desc)
+{
+	std::uint64_t key = ComputeKey(desc);
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto loaded = m_loaded.find(key);
+		if (loaded != m_loaded.end())
+		{
+			if (auto bytecode = loaded->second.lock())
+			{
+				m_stats.Hits++;
+				return bytecode;
+			}
+		}
+
+		auto entry = m_index.find(key);
+		if (entry != m_index.end())
+		{
+			auto bytecode = std::make_shared<ShaderBytecode>();
+			if (bytecode->m_mapped.Open(BlobPath(key)) && bytecode->m_mapped.Size() == entry->second.Size)
+			{
+				bytecode->m_hash = ShaderBytecode::HashOf(bytecode->Data(), bytecode->Size());
+				if (bytecode->m_hash == entry->second.Hash)
+				{
+					m_stats.Hits++;
+					m_loaded[key] = bytecode;
+					return bytecode;
+				}
+			}
+
+			// Deleted, truncated or overwritten behind our back.
+			m_index.erase(entry);
+			m_indexDirty = true;
+		}
+	}
+
+	// Compile outside the lock: other shaders can be served meanwhile. Two
+	// threads missing on the same key both compile; the results are equal.
+	CompileResult result = m_compiler(desc);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_stats.Misses++;
+
+	if (!result.Success)
+	{
+		m_stats.Failures++;
+		m_lastErrors = result.Errors;
+		return nullptr;
+	}
+
+	auto bytecode = std::make_shared<ShaderBytecode>();
+	bytecode->m_hash = ShaderBytecode::HashOf(result.Bytecode.data(), result.Bytecode.size());
+
+	if (WriteBlob(key, result.Bytecode))
+	{
+		IndexEntry& entry = m_index[key];
+		entry.Size = result.Bytecode.size();
+		entry.Hash = bytecode->m_hash;
+		entry.Label = desc.SourcePath + ":" + desc.EntryPoint + ":" + desc.Target;
+		m_indexDirty = true;
+	}
+
+	bytecode->m_owned = std::move(result.Bytecode);
+	m_loaded[key] = bytecode;
+	return bytecode;
+}
+
+ShaderCache::Stats ShaderCache::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+std::string ShaderCache::GetLastErrors() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_lastErrors;
+}
+
+std::string ShaderCache::BlobPath(std::uint64_t key) const
+{
+	return (fs::path(m_directory) / (Hasher::ToHex(key) + ".cso")).string();
+}
+
+bool ShaderCache::WriteBlob(std::uint64_t key, const std::vector<std::uint8_t>& bytecode)
+{
+	return WriteFileAtomic(BlobPath(key), bytecode.data(), bytecode.size());
+}
+
+void ShaderCache::LoadIndex()
+{
+	std::ifstream file((fs::path(m_directory) / c_indexFileName).string());
+	if (!file)
+		return;
+
+	std::uint32_t version = 0;
+	if (!(file >> version) || version != c_cacheVersion)
+		return;
+
+	std::string hex;
+	std::string hash;
+	IndexEntry entry;
+	while (file >> hex >> entry.Size >> hash)
+	{
+		entry.Hash = std::stoull(hash, nullptr, 16);
+		std::getline(file >> std::ws, entry.Label);
+		m_index[std::stoull(hex, nullptr, 16)] = entry;
+	}
+}
+
+void ShaderCache::SaveIndex()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_indexDirty)
+		return;
+
+	std::ostringstream index;
+	index << c_cacheVersion << "\n";
+	for (const auto& [key, entry] : m_index)
+		index << Hasher::ToHex(key) << " " << entry.Size << " " << Hasher::ToHex(entry.Hash) << " " << entry.Label << "\n";
+
+	const std::string contents = index.str();
+	if (WriteFileAtomic((fs::path(m_directory) / c_indexFileName).string(), contents.data(), contents.size()))
+		m_indexDirty = false;
+}
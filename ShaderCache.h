@@ -0,0 +1,132 @@
+#pragma once
+#include "MappedFile.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ShaderDefine
+{
+	std::string								Name;
+	std::string								Value;
+};
+
+// Everything that decides what a compile produces.
+struct ShaderDesc
+{
+	std::string								SourcePath;
+	std::string								EntryPoint;
+	std::string								Target;
+	std::vector<ShaderDefine>				Defines;
+	std::uint32_t							Flags = 0;
+};
+
+// Compiled bytecode. Either mapped from the cache directory or owned.
+class ShaderBytecode
+{
+public:
+
+	const void*								Data()			const	{	return m_mapped.IsOpen() ? (const void*)m_mapped.Data() : (const void*)m_owned.data();	}
+	std::size_t								Size()			const	{	return m_mapped.IsOpen() ? m_mapped.Size() : m_owned.size();	}
+	// Hash of the bytecode itself, unlike the cache key: permutations
+	// compiled to the same bytecode share it. Pipeline keys identify shaders
+	// by this hash (see PipelineKeyBuilder).
+	std::uint64_t							Hash()			const	{	return m_hash;	}
+
+	static std::uint64_t					HashOf(const void* data, std::size_t size);
+
+private:
+
+	friend class ShaderCache;
+
+	MappedFile								m_mapped;
+	std::vector<std::uint8_t>				m_owned;
+	std::uint64_t							m_hash = 0;
+};
+
+// Persistent cache of compiled shaders.
+//
+// The key hashes the description (entry point, target, defines, flags) and
+// the contents of the source file and of every file it includes, found by
+// scanning #include directives, and the compiler's version tag. Editing any
+// of them, or updating the compiler, changes the key, so a stale blob is
+// never returned. Blobs are stored as <key>.cso in the cache directory and
+// memory-mapped back on a hit; an index file lists what the directory holds,
+// with the size and content hash of each blob, so a miss does not probe the
+// disk and a blob damaged on disk is recompiled rather than returned.
+//
+// The compiler is injected: the renderer passes a D3DCompile wrapper, tests
+// can pass a stub.
+class ShaderCache
+{
+public:
+
+	struct CompileResult
+	{
+		bool								Success = false;
+		std::vector<std::uint8_t>			Bytecode;
+		std::string							Errors;
+	};
+
+	using CompileFn = std::function<CompileResult(const ShaderDesc& desc)>;
+
+	struct Stats
+	{
+		std::uint32_t						Hits = 0;
+		std::uint32_t						Misses = 0;
+		std::uint32_t						Failures = 0;
+	};
+
+	// A relative `directory` is taken from the executable's directory (see
+	// ResolveModulePath). `compilerVersion` names the compiler build; blobs
+	// from another version are not reused.
+											ShaderCache(const std::string& directory, CompileFn compiler, const std::string& compilerVersion);
+											ShaderCache(const ShaderCache& rhs) = delete;
+											ShaderCache& operator=(const ShaderCache& rhs) = delete;
+											~ShaderCache();
+
+	// Returns the bytecode, compiling and storing it on a miss, or nullptr if
+	// the compile failed (the errors are in GetLastErrors()). Identical
+	// requests share the same bytecode. Thread safe.
+	std::shared_ptr<const ShaderBytecode>	Get(const ShaderDesc& desc);
+
+	// Cache key of `desc` with its current sources, the name of its blob.
+	// Reads every source file, so Get() callers should not compute it again.
+	std::uint64_t							ComputeKey(const ShaderDesc& desc)	const;
+
+	// Source file followed by every file it includes, transitively.
+	static std::vector<std::string>			FindIncludes(const std::string& sourcePath);
+
+	Stats									GetStats()			const;
+	std::string								GetLastErrors()		const;
+
+	// Rewrites the index. Called by the destructor.
+	void									SaveIndex();
+
+private:
+
+	struct IndexEntry
+	{
+		std::uint64_t						Size = 0;
+		std::uint64_t						Hash = 0;	// of the blob's contents
+		std::string							Label;		// source:entry:target, for humans
+	};
+
+	std::string								BlobPath(std::uint64_t key)	const;
+	void									LoadIndex();
+	bool									WriteBlob(std::uint64_t key, const std::vector<std::uint8_t>& bytecode);
+
+	std::string								m_directory;
+	CompileFn								m_compiler;
+	std::string								m_compilerVersion;
+
+	mutable std::mutex						m_mutex;
+	std::unordered_map<std::uint64_t, IndexEntry>								m_index;
+	std::unordered_map<std::uint64_t, std::weak_ptr<const ShaderBytecode>>		m_loaded;
+	bool									m_indexDirty = false;
+	Stats									m_stats;
+	std::string								m_lastErrors;
+};
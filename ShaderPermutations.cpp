@@ -0,0 +1,168 @@
+#include "ShaderPermutations.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <thread>
+#include <unordered_set>
+
+ShaderPermutationSet::ShaderPermutationSet(const ShaderDesc& base)
+	: m_base(base)
+{
+}
+
+std::uint32_t ShaderPermutationSet::AddAxis(const std::string& name, const std::vector<std::string>& values)
+{
+	assert(!values.empty() && "An axis needs at least one value.");
+	assert((std::uint64_t)m_permutationCount * values.size() <= 0xffffffffull && "Too many permutations.");
+
+	m_axes.push_back(ShaderFeatureAxis{ name, values });
+	m_strides.push_back(m_permutationCount);
+	m_permutationCount *= (std::uint32_t)values.size();
+	return (std::uint32_t)m_axes.size() - 1;
+}
+
+std::uint32_t ShaderPermutationSet::AddBoolAxis(const std::string& name)
+{
+	return AddAxis(name, { "", "1" });
+}
+
+std::uint32_t ShaderPermutationSet::GetValue(std::uint32_t permutation, std::uint32_t axis) const
+{
+	return (permutation / m_strides[axis]) % (std::uint32_t)m_axes[axis].Values.size();
+}
+
+std::uint32_t ShaderPermutationSet::GetPermutation(const std::vector<std::uint32_t>& values) const
+{
+	assert(values.size() == m_axes.size());
+
+	std::uint32_t permutation = 0;
+	for (std::size_t axis = 0; axis < m_axes.size(); ++axis)
+	{
+		assert(values[axis] < m_axes[axis].Values.size());
+		permutation += values[axis] * m_strides[axis];
+	}
+	return permutation;
+}
+
+ShaderDesc ShaderPermutationSet::GetDesc(std::uint32_t permutation) const
+{
+	assert(permutation < m_permutationCount);
+
+	ShaderDesc desc = m_base;
+	for (std::uint32_t axis = 0; axis < GetAxisCount(); ++axis)
+	{
+		const std::string& value = m_axes[axis].Values[GetValue(permutation, axis)];
+		if (!value.empty())
+			desc.Defines.push_back(ShaderDefine{ m_axes[axis].Name, value });
+	}
+	return desc;
+}
+
+std::vector<std::uint32_t> ShaderPermutationSet::Enumerate(const Filter& needed) const
+{
+	std::vector<std::uint32_t> permutations;
+	for (std::uint32_t permutation = 0; permutation < m_permutationCount; ++permutation)
+	{
+		if (!needed || needed(*this, permutation))
+			permutations.push_back(permutation);
+	}
+	return permutations;
+}
+
+ShaderPermutationCompiler::ShaderPermutationCompiler(ShaderCache& cache, std::uint32_t threadCount)
+	: m_cache(cache), m_threadCount(threadCount)
+{
+	if (m_threadCount == 0)
+		m_threadCount = std::max(1u, std::thread::hardware_concurrency());
+}
+
+ShaderPermutationCompiler::Result ShaderPermutationCompiler::Compile(const std::vector<ShaderDesc>& jobs)
+{
+	Result result;
+	result.Bytecode.resize(jobs.size());
+
+	// Jobs are handed out one at a time: compile times vary by an order of
+	// magnitude between permutations, so static ranges would leave threads
+	// idle.
+	std::atomic<std::size_t> next { 0 };
+	auto worker = [&]()
+	{
+		for (std::size_t i = next++; i < jobs.size(); i = next++)
+			result.Bytecode[i] = m_cache.Get(jobs[i]);
+	};
+
+	std::size_t threadCount = std::min<std::size_t>(m_threadCount, jobs.size());
+	std::vector<std::thread> threads;
+	for (std::size_t i = 1; i < threadCount; ++i)
+		threads.emplace_back(worker);
+
+	// The calling thread works too instead of waiting.
+	worker();
+	for (std::thread& thread : threads)
+		thread.join();
+
+	Deduplicate(result);
+	return result;
+}
+
+ShaderPermutationCompiler::Result ShaderPermutationCompiler::Compile(const ShaderPermutationSet& set, const ShaderPermutationSet::Filter& needed)
+{
+	std::vector<ShaderDesc> jobs;
+	for (std::uint32_t permutation : set.Enumerate(needed))
+		jobs.push_back(set.GetDesc(permutation));
+
+	return Compile(jobs);
+}
+
+void ShaderPermutationCompiler::Deduplicate(Result& result)
+{
+	for (std::shared_ptr<const ShaderBytecode>& bytecode : result.Bytecode)
+	{
+		if (bytecode == nullptr)
+		{
+			result.Failures++;
+			continue;
+		}
+
+		std::uint64_t hash = bytecode->Hash();
+
+		bool found = false;
+		auto range = m_unique.equal_range(hash);
+		for (auto it = range.first; it != range.second && !found; ++it)
+		{
+			std::shared_ptr<const ShaderBytecode> existing = it->second.lock();
+			if (existing == nullptr)
+				continue;
+
+			// The same cached shader requested twice is not a duplicate.
+			if (existing == bytecode)
+			{
+				found = true;
+			}
+			else if (existing->Size() == bytecode->Size() && std::memcmp(existing->Data(), bytecode->Data(), bytecode->Size()) == 0)
+			{
+				bytecode = existing;
+				result.Duplicates++;
+				found = true;
+			}
+		}
+
+		if (!found)
+		{
+			// Drop the expired entries of this hash before adding.
+			for (auto it = range.first; it != range.second;)
+				it = it->second.expired() ? m_unique.erase(it) : std::next(it);
+
+			m_unique.emplace(hash, bytecode);
+		}
+	}
+
+	std::unordered_set<const ShaderBytecode*> distinct;
+	for (const std::shared_ptr<const ShaderBytecode>& bytecode : result.Bytecode)
+	{
+		if (bytecode != nullptr)
+			distinct.insert(bytecode.get());
+	}
+	result.Unique = (std::uint32_t)distinct.size();
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include "ShaderCache.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One compile-time switch of a shader: a define and the values it can take.
+// An empty value leaves the define out, for #ifdef-style features.
+struct ShaderFeatureAxis
+{
+	std::string								Name;
+	std::vector<std::string>				Values;
+};
+
+// The permutation space of one entry point: a base description and the
+// feature axes declared on it. A permutation is a mixed-radix number with one
+// digit per axis, the first axis varying fastest; permutation 0 takes the
+// first value of every axis.
+class ShaderPermutationSet
+{
+public:
+
+	using Filter = std::function<bool(const ShaderPermutationSet& set, std::uint32_t permutation)>;
+
+	explicit								ShaderPermutationSet(const ShaderDesc& base);
+
+	// Return the axis index.
+	std::uint32_t							AddAxis(const std::string& name, const std::vector<std::string>& values);
+	std::uint32_t							AddBoolAxis(const std::string& name);
+
+	std::uint32_t							GetAxisCount()			const	{	return (std::uint32_t)m_axes.size();	}
+	const ShaderFeatureAxis&				GetAxis(std::uint32_t axis)	const	{	return m_axes[axis];	}
+	std::uint32_t							GetPermutationCount()	const	{	return m_permutationCount;	}
+	const ShaderDesc&						GetBase()				const	{	return m_base;	}
+
+	// Index of the value the permutation takes on an axis.
+	std::uint32_t							GetValue(std::uint32_t permutation, std::uint32_t axis)	const;
+	// Permutation with the given value index on each axis, in axis order.
+	std::uint32_t							GetPermutation(const std::vector<std::uint32_t>& values)	const;
+
+	// The base description plus the defines of the permutation.
+	ShaderDesc								GetDesc(std::uint32_t permutation)	const;
+
+	// Permutations accepted by `needed`, in increasing order. Use it to skip
+	// combinations the renderer never asks for.
+	std::vector<std::uint32_t>				Enumerate(const Filter& needed = nullptr)	const;
+
+private:
+
+	ShaderDesc								m_base;
+	std::vector<ShaderFeatureAxis>			m_axes;
+	std::vector<std::uint32_t>				m_strides;
+	std::uint32_t							m_permutationCount = 1;
+};
+
+// Compiles batches of shaders through a ShaderCache on worker threads.
+//
+// Cache hits only cost a key computation and a map, so the threads mostly
+// matter on a cold cache. Permutations whose defines do not change the
+// output compile to identical bytecode; those are folded onto one
+// ShaderBytecode so that everything downstream (PSOs in particular) sees a
+// single shader. Folding spans batches, so keep one compiler for as long as
+// its cache lives rather than one per batch.
+class ShaderPermutationCompiler
+{
+public:
+
+	struct Result
+	{
+		// One entry per job, nullptr where compilation failed.
+		std::vector<std::shared_ptr<const ShaderBytecode>>	Bytecode;
+		// Distinct bytecodes in the batch, and results folded onto an
+		// identical bytecode with a different key.
+		std::uint32_t						Unique = 0;
+		std::uint32_t						Duplicates = 0;
+		std::uint32_t						Failures = 0;
+	};
+
+	// threadCount 0 uses one thread per hardware thread.
+											ShaderPermutationCompiler(ShaderCache& cache, std::uint32_t threadCount = 0);
+
+	Result									Compile(const std::vector<ShaderDesc>& jobs);
+
+	// Every permutation of `set` accepted by `needed`, in Enumerate() order.
+	Result									Compile(const ShaderPermutationSet& set, const ShaderPermutationSet::Filter& needed = nullptr);
+
+private:
+
+	// Replaces the result's bytecode by the first identical one seen.
+	void									Deduplicate(Result& result);
+
+	ShaderCache&							m_cache;
+	std::uint32_t							m_threadCount;
+	// Content hash to bytecode, across batches.
+	std::unordered_multimap<std::uint64_t, std::weak_ptr<const ShaderBytecode>>	m_unique;
+};
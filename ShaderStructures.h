@@ -1,5 +1,6 @@
 #pragma once
-#include "framework.h"
+#include "MathTypes.h"
+#include "MathHelper.h"
 
 using namespace DirectX;
 
@@ -7,4 +8,29 @@ struct Vertex
 {
     XMFLOAT3 Pos;
     XMFLOAT4 Color;
-};
\ No newline at end of file
+};
+
+struct PassConstants {
+    XMFLOAT4X4                                          View;
+    XMFLOAT4X4                                          InvView;
+    XMFLOAT4X4                                          Proj;
+    XMFLOAT4X4                                          InvProj;
+    XMFLOAT4X4                                          ViewProj;
+    XMFLOAT4X4                                          InvViewProj;
+    XMFLOAT3                                            EyePosW;
+
+    float                                               cbPerObjectPad1;
+
+    XMFLOAT2                                            RenderTargetSize;
+    XMFLOAT2                                            InvRenderTargetSize;
+
+    float                                               NearZ;
+    float                                               FarZ;
+    float                                               TotalTime;
+    float                                               DeltaTime;
+};
+
+struct ObjectConstants
+{
+    XMFLOAT4X4                                          WorldViewProj = MathHelper::Identity4x4();
+};
@@ -0,0 +1,75 @@
+#include "StringId.h"
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace
+{
+	// The deque never moves its strings, so the views used as keys and the
+	// pointers handed out by c_str() stay valid.
+	struct StringTable
+	{
+		std::shared_mutex											Mutex;
+		std::deque<std::string>										Strings;
+		std::unordered_map<std::string_view, std::uint32_t>			Ids;
+
+		StringTable()
+		{
+			// Id 0 is the invalid id and reads back as an empty string.
+			Strings.emplace_back();
+		}
+	};
+
+	StringTable& GetTable()
+	{
+		static StringTable table;
+		return table;
+	}
+}
+
+StringId::StringId(std::string_view name)
+{
+	StringTable& table = GetTable();
+
+	{
+		std::shared_lock<std::shared_mutex> lock(table.Mutex);
+		auto it = table.Ids.find(name);
+		if (it != table.Ids.end())
+		{
+			m_value = it->second;
+			return;
+		}
+	}
+
+	std::unique_lock<std::shared_mutex> lock(table.Mutex);
+	auto it = table.Ids.find(name);
+	if (it != table.Ids.end())
+	{
+		m_value = it->second;
+		return;
+	}
+
+	m_value = (std::uint32_t)table.Strings.size();
+	table.Strings.emplace_back(name);
+	table.Ids.emplace(table.Strings.back(), m_value);
+}
+
+StringId StringId::Find(std::string_view name)
+{
+	StringTable& table = GetTable();
+	std::shared_lock<std::shared_mutex> lock(table.Mutex);
+
+	StringId id;
+	auto it = table.Ids.find(name);
+	if (it != table.Ids.end())
+		id.m_value = it->second;
+	return id;
+}
+
+const char* StringId::c_str() const
+{
+	StringTable& table = GetTable();
+	std::shared_lock<std::shared_mutex> lock(table.Mutex);
+	return table.Strings[m_value].c_str();
+}
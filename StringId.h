@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Interned string. Equal strings always get the same id, so comparing and
+// hashing a StringId is an integer operation. Ids are never released; intern
+// names (assets, submeshes, passes), not arbitrary runtime text.
+class StringId
+{
+public:
+
+	static constexpr std::uint32_t			InvalidValue = 0;
+
+	StringId() = default;
+	// Interns `name`. Takes a lock and hashes the string: keep the result
+	// around (e.g. in a static) rather than converting on hot paths.
+	explicit StringId(std::string_view name);
+
+	// Id of an already interned string, or an invalid id. Never inserts.
+	static StringId							Find(std::string_view name);
+
+	const char*								c_str()							const;
+	std::uint32_t							Value()							const	{	return m_value;	}
+	bool									IsValid()						const	{	return m_value != InvalidValue;	}
+
+	bool									operator==(const StringId& rhs)	const	{	return m_value == rhs.m_value;	}
+	bool									operator!=(const StringId& rhs)	const	{	return m_value != rhs.m_value;	}
+	bool									operator<(const StringId& rhs)	const	{	return m_value < rhs.m_value;	}
+
+private:
+
+	std::uint32_t							m_value = InvalidValue;
+};
@@ -0,0 +1,176 @@
+#pragma once
+#include "StringId.h"
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Open-addressing hash map keyed by StringId.
+//
+// Keys and values live in two flat arrays with linear probing, so a lookup
+// is one multiply and usually a single cache line of keys. The table is kept
+// at most half full. Erase uses backward-shift deletion, so there are no
+// tombstones. Values must be default constructible; the name-based overloads
+// intern or look up the string first and are the slow path.
+template<typename V>
+class StringIdMap
+{
+public:
+
+	StringIdMap()
+	{
+		Rehash(8);
+	}
+
+	V* Find(StringId key)
+	{
+		// An invalid key would match the first empty slot.
+		if (!key.IsValid())
+			return nullptr;
+
+		std::uint32_t slot = FindSlot(key);
+		return m_keys[slot] == key ? &m_values[slot] : nullptr;
+	}
+
+	const V* Find(StringId key) const
+	{
+		return const_cast<StringIdMap*>(this)->Find(key);
+	}
+
+	V* Find(std::string_view name)
+	{
+		StringId key = StringId::Find(name);
+		return key.IsValid() ? Find(key) : nullptr;
+	}
+
+	bool Contains(StringId key) const
+	{
+		return key.IsValid() && Find(key) != nullptr;
+	}
+
+	bool Contains(std::string_view name) const
+	{
+		StringId key = StringId::Find(name);
+		return key.IsValid() && Contains(key);
+	}
+
+	// Inserts a default value if the key is missing.
+	V& operator[](StringId key)
+	{
+		assert(key.IsValid());
+
+		std::uint32_t slot = FindSlot(key);
+		if (m_keys[slot] == key)
+			return m_values[slot];
+
+		if ((m_size + 1) * 2 > Capacity())
+		{
+			Rehash(Capacity() * 2);
+			slot = FindSlot(key);
+		}
+
+		m_keys[slot] = key;
+		m_size++;
+		return m_values[slot];
+	}
+
+	V& operator[](std::string_view name)
+	{
+		return (*this)[StringId(name)];
+	}
+
+	bool Erase(StringId key)
+	{
+		if (!key.IsValid())
+			return false;
+
+		std::uint32_t slot = FindSlot(key);
+		if (m_keys[slot] != key)
+			return false;
+
+		// Backward-shift: pull later entries of the probe run into the hole.
+		std::uint32_t mask = Capacity() - 1;
+		std::uint32_t hole = slot;
+		for (std::uint32_t next = (hole + 1) & mask; m_keys[next].IsValid(); next = (next + 1) & mask)
+		{
+			std::uint32_t home = Home(m_keys[next]);
+			// Move `next` into the hole unless its home lies in (hole, next].
+			bool homeBetween = hole <= next ? (hole < home && home <= next) : (hole < home || home <= next);
+			if (!homeBetween)
+			{
+				m_keys[hole] = m_keys[next];
+				m_values[hole] = std::move(m_values[next]);
+				hole = next;
+			}
+		}
+
+		m_keys[hole] = StringId();
+		m_values[hole] = V();
+		m_size--;
+		return true;
+	}
+
+	// Calls f(StringId, V&) for every entry, in no particular order.
+	template<typename F>
+	void ForEach(F&& f)
+	{
+		for (std::uint32_t i = 0; i < Capacity(); ++i)
+		{
+			if (m_keys[i].IsValid())
+				f(m_keys[i], m_values[i]);
+		}
+	}
+
+	std::uint32_t							Size()			const	{	return m_size;	}
+	std::uint32_t							Capacity()		const	{	return (std::uint32_t)m_keys.size();	}
+
+private:
+
+	std::uint32_t Home(StringId key) const
+	{
+		// Fibonacci hashing: interned ids are sequential, this spreads them.
+		return (key.Value() * 2654435769u) >> m_shift;
+	}
+
+	// Slot holding `key`, or the empty slot where it would go. `key` must be
+	// valid.
+	std::uint32_t FindSlot(StringId key) const
+	{
+		std::uint32_t mask = Capacity() - 1;
+		std::uint32_t slot = Home(key);
+		while (m_keys[slot].IsValid() && m_keys[slot] != key)
+			slot = (slot + 1) & mask;
+		return slot;
+	}
+
+	void Rehash(std::uint32_t capacity)
+	{
+		std::vector<StringId> keys(capacity);
+		std::vector<V> values(capacity);
+		std::swap(keys, m_keys);
+		std::swap(values, m_values);
+
+		m_shift = 32;
+		for (std::uint32_t c = capacity; c > 1; c >>= 1)
+			m_shift--;
+
+		std::uint32_t mask = capacity - 1;
+		for (std::size_t i = 0; i < keys.size(); ++i)
+		{
+			if (!keys[i].IsValid())
+				continue;
+
+			std::uint32_t slot = Home(keys[i]);
+			while (m_keys[slot].IsValid())
+				slot = (slot + 1) & mask;
+
+			m_keys[slot] = keys[i];
+			m_values[slot] = std::move(values[i]);
+		}
+	}
+
+	std::vector<StringId>					m_keys;
+	std::vector<V>							m_values;
+	std::uint32_t							m_size = 0;
+	std::uint32_t							m_shift = 32;
+};
@@ -0,0 +1,101 @@
+// Built with MEMORY_TRACKING_GLOBAL_NEW, so every heap allocation in the
+// process is counted (see Tests/CMakeLists.txt).
+#include "HeadlessRenderer.h"
+#include "MemoryTracker.h"
+#include "NullBackend.h"
+#include <gtest/gtest.h>
+#include <memory>
+
+namespace
+{
+	struct alignas(64) OverAligned
+	{
+		float									Values[16];
+	};
+
+	// Keeps the compiler from eliding a new/delete pair.
+	template<typename T>
+	T* Escape(T* p)
+	{
+		static T* volatile sink;
+		sink = p;
+		return sink;
+	}
+
+	std::uint64_t GeneralAllocations()
+	{
+		return MemoryTracker::GetStats(MemTag::General).TotalCount;
+	}
+}
+
+TEST(MemoryTracker, EveryFormOfGlobalNewIsCounted)
+{
+	MemTagStats before = MemoryTracker::GetStats(MemTag::General);
+
+	delete Escape(new int(1));
+	delete[] Escape(new int[4]);
+	delete Escape(new (std::nothrow) int(2));
+	delete[] Escape(new (std::nothrow) int[4]);
+
+	OverAligned* aligned = Escape(new OverAligned);
+	EXPECT_EQ((std::uintptr_t)aligned % alignof(OverAligned), 0u);
+	delete aligned;
+	OverAligned* alignedArray = Escape(new OverAligned[3]);
+	EXPECT_EQ((std::uintptr_t)alignedArray % alignof(OverAligned), 0u);
+	delete[] alignedArray;
+	OverAligned* alignedNothrow = Escape(new (std::nothrow) OverAligned);
+	EXPECT_EQ((std::uintptr_t)alignedNothrow % alignof(OverAligned), 0u);
+	delete alignedNothrow;
+
+	void* wide = Escape(::operator new(100, std::align_val_t(4096)));
+	EXPECT_EQ((std::uintptr_t)wide % 4096, 0u);
+	::operator delete(wide, std::align_val_t(4096));
+
+	MemTagStats after = MemoryTracker::GetStats(MemTag::General);
+	EXPECT_EQ(after.TotalCount - before.TotalCount, 8u);
+	EXPECT_EQ(after.LiveCount, before.LiveCount);
+	EXPECT_EQ(after.LiveBytes, before.LiveBytes);
+}
+
+TEST(MemoryTracker, GeometryIsReleasedWithTheScene)
+{
+	MemTagStats before = MemoryTracker::GetStats(MemTag::Geometry);
+	{
+		NullRenderDevice device;
+		HeadlessSettings settings;
+		settings.ItemCount = 64;
+		HeadlessRenderer renderer(device, settings);
+		renderer.Initialize();
+		MemTagStats loaded = MemoryTracker::GetStats(MemTag::Geometry);
+		EXPECT_GT(loaded.LiveBytes, before.LiveBytes);
+	}
+	EXPECT_EQ(MemoryTracker::GetStats(MemTag::Geometry).LiveBytes, before.LiveBytes);
+	EXPECT_EQ(MemoryTracker::GetStats(MemTag::Geometry).LiveCount, before.LiveCount);
+}
+
+TEST(MemoryTracker, SteadyStateFramesDoNotAllocate)
+{
+	for (bool threaded : { false, true })
+	{
+		NullRenderDevice device;
+		HeadlessSettings settings;
+		settings.ItemCount = 1024;
+		settings.ThreadedSimulation = threaded;
+		HeadlessRenderer renderer(device, settings);
+		renderer.Initialize();
+
+		GameTimer timer;
+		timer.Reset();
+		renderer.Run(timer, 16);
+
+		MemoryTracker::BeginFrame();
+		for (int frame = 0; frame < 64; ++frame)
+		{
+			std::uint64_t start = GeneralAllocations();
+			renderer.Run(timer, 1);
+			ASSERT_EQ(GeneralAllocations(), start) << "frame " << frame << (threaded ? ", threaded" : "");
+		}
+		MemoryTracker::BeginFrame();
+		EXPECT_EQ(MemoryTracker::GetFrameAllocations(), 0u);
+	}
+}
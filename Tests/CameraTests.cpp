@@ -0,0 +1,119 @@
+#include "Camera.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+	// Largest absolute difference between two matrices.
+	float MaxDifference(const XMFLOAT4X4& a, const XMFLOAT4X4& b)
+	{
+		float diff = 0.0f;
+		for (int r = 0; r < 4; ++r)
+			for (int c = 0; c < 4; ++c)
+				diff = std::max(diff, std::fabs(a.m[r][c] - b.m[r][c]));
+		return diff;
+	}
+
+	XMFLOAT4X4 Store(FXMMATRIX m)
+	{
+		XMFLOAT4X4 result;
+		XMStoreFloat4x4(&result, m);
+		return result;
+	}
+
+	// The pass constants as RenderWindow::Update built them before Camera:
+	// three general inversions per frame.
+	PassConstants Reference(float radius, float theta, float phi, float fovY, float aspect, float zn, float zf)
+	{
+		XMMATRIX view = XMMatrixLookAtLH(MathHelper::SphericalToCartesian(radius, theta, phi), XMVectorZero(), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+		XMMATRIX proj = XMMatrixPerspectiveFovLH(fovY, aspect, zn, zf);
+		XMMATRIX viewProj = XMMatrixMultiply(view, proj);
+
+		XMVECTOR det;
+		PassConstants pass = {};
+		XMStoreFloat4x4(&pass.View, XMMatrixTranspose(view));
+		XMStoreFloat4x4(&pass.InvView, XMMatrixTranspose(XMMatrixInverse(&det, view)));
+		XMStoreFloat4x4(&pass.Proj, XMMatrixTranspose(proj));
+		XMStoreFloat4x4(&pass.InvProj, XMMatrixTranspose(XMMatrixInverse(&det, proj)));
+		XMStoreFloat4x4(&pass.ViewProj, XMMatrixTranspose(viewProj));
+		XMStoreFloat4x4(&pass.InvViewProj, XMMatrixTranspose(XMMatrixInverse(&det, viewProj)));
+		return pass;
+	}
+}
+
+TEST(Camera, ClosedFormInversesMatchGeneralInversion)
+{
+	const float radii[] = { 1.5f, 5.0f, 80.0f };
+	const float thetas[] = { 0.0f, 0.3f, 1.5f * XM_PI, 5.9f };
+	const float phis[] = { 0.1f, XM_PIDIV4, 0.47f * XM_PI, 3.0f };
+	const float aspects[] = { 0.5f, 4.0f / 3.0f, 21.0f / 9.0f };
+
+	for (float radius : radii)
+		for (float theta : thetas)
+			for (float phi : phis)
+				for (float aspect : aspects)
+				{
+					Camera camera;
+					camera.SetOrbit(radius, theta, phi);
+					camera.SetLens(0.25f * XM_PI, aspect, 1.0f, 1000.0f);
+
+					PassConstants pass = {};
+					ASSERT_TRUE(camera.UpdatePassConstants(pass));
+					PassConstants expected = Reference(radius, theta, phi, 0.25f * XM_PI, aspect, 1.0f, 1000.0f);
+
+					EXPECT_EQ(MaxDifference(pass.View, expected.View), 0.0f);
+					EXPECT_EQ(MaxDifference(pass.Proj, expected.Proj), 0.0f);
+					EXPECT_LT(MaxDifference(pass.ViewProj, expected.ViewProj), 1e-6f);
+					EXPECT_LT(MaxDifference(pass.InvView, expected.InvView), 1e-5f * radius);
+					EXPECT_LT(MaxDifference(pass.InvProj, expected.InvProj), 1e-5f);
+					EXPECT_LT(MaxDifference(pass.InvViewProj, expected.InvViewProj), 1e-4f * radius);
+
+					XMFLOAT3 eye;
+					XMStoreFloat3(&eye, MathHelper::SphericalToCartesian(radius, theta, phi));
+					EXPECT_EQ(pass.EyePosW.x, eye.x);
+					EXPECT_EQ(pass.EyePosW.y, eye.y);
+					EXPECT_EQ(pass.EyePosW.z, eye.z);
+				}
+}
+
+TEST(Camera, InversesRoundTrip)
+{
+	Camera camera;
+	camera.SetOrbit(12.0f, 0.7f, 1.1f);
+	camera.SetLens(0.3f * XM_PI, 1.6f, 0.5f, 500.0f);
+
+	PassConstants pass = {};
+	camera.UpdatePassConstants(pass);
+
+	XMFLOAT4X4 identity = MathHelper::Identity4x4();
+	XMMATRIX view = XMLoadFloat4x4(&pass.View);
+	XMMATRIX proj = XMLoadFloat4x4(&pass.Proj);
+	XMMATRIX viewProj = XMLoadFloat4x4(&pass.ViewProj);
+	EXPECT_LT(MaxDifference(Store(XMMatrixMultiply(view, XMLoadFloat4x4(&pass.InvView))), identity), 1e-5f);
+	EXPECT_LT(MaxDifference(Store(XMMatrixMultiply(proj, XMLoadFloat4x4(&pass.InvProj))), identity), 1e-5f);
+	EXPECT_LT(MaxDifference(Store(XMMatrixMultiply(viewProj, XMLoadFloat4x4(&pass.InvViewProj))), identity), 1e-4f);
+}
+
+TEST(Camera, RecomputesOnlyWhenInputsChange)
+{
+	Camera camera;
+	PassConstants pass = {};
+	EXPECT_TRUE(camera.UpdatePassConstants(pass));
+	EXPECT_FALSE(camera.UpdatePassConstants(pass));
+
+	// Setting the same values is not a change.
+	camera.SetOrbit(5.0f, 1.5f * XM_PI, XM_PIDIV4);
+	camera.SetLens(0.25f * XM_PI, 1.0f, 1.0f, 1000.0f);
+	EXPECT_FALSE(camera.UpdatePassConstants(pass));
+
+	XMFLOAT4X4 proj = pass.Proj;
+	camera.SetOrbit(6.0f, 1.5f * XM_PI, XM_PIDIV4);
+	EXPECT_TRUE(camera.UpdatePassConstants(pass));
+	EXPECT_EQ(MaxDifference(pass.Proj, proj), 0.0f);
+	EXPECT_FALSE(camera.UpdatePassConstants(pass));
+
+	XMFLOAT4X4 view = pass.View;
+	camera.SetLens(0.25f * XM_PI, 2.0f, 1.0f, 1000.0f);
+	EXPECT_TRUE(camera.UpdatePassConstants(pass));
+	EXPECT_EQ(MaxDifference(pass.View, view), 0.0f);
+	EXPECT_NE(MaxDifference(pass.Proj, proj), 0.0f);
+}
@@ -0,0 +1,175 @@
+#include "CommandLog.h"
+#include "CommandReplay.h"
+#include "NullBackend.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	// Writes a log through CommandLogWriter and reads it back into memory.
+	class LogBuilder
+	{
+	public:
+
+											LogBuilder()
+		{
+			const ::testing::TestInfo* test = ::testing::UnitTest::GetInstance()->current_test_info();
+			m_path = (fs::temp_directory_path() / (std::string("CommandReplayTest_") + test->name() + ".cmdlog")).string();
+			m_writer.Open(m_path);
+		}
+											~LogBuilder()
+		{
+			std::error_code error;
+			fs::remove(m_path, error);
+		}
+
+		CommandLogWriter&					operator*()		{	return m_writer;	}
+
+		const std::vector<std::uint8_t>&	Finish()
+		{
+			m_writer.Close();
+			std::ifstream file(m_path, std::ios::binary);
+			m_data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+			return m_data;
+		}
+
+	private:
+
+		std::string							m_path;
+		CommandLogWriter					m_writer;
+		std::vector<std::uint8_t>			m_data;
+	};
+
+	bool Replay(const std::vector<std::uint8_t>& log, std::size_t* errorOffset = nullptr)
+	{
+		NullRenderDevice device;
+		CommandReplayer replayer(device);
+		if (!replayer.Open(log.data(), log.size()))
+			return false;
+		bool ok = replayer.Replay();
+		if (errorOffset != nullptr)
+			*errorOffset = replayer.GetErrorOffset();
+		return ok;
+	}
+
+	// A list, a fence and two 256-byte upload buffers: what every log below
+	// starts with.
+	void Prologue(CommandLogWriter& log)
+	{
+		log.Op(CommandLogOp::CreateBuffer).U(1).U(256).U((std::uint64_t)GpuBufferUsage::Upload);
+		log.Op(CommandLogOp::CreateBuffer).U(2).U(256).U((std::uint64_t)GpuBufferUsage::Upload);
+		log.Op(CommandLogOp::CreateCommandList).U(1);
+		log.Op(CommandLogOp::CreateFence).U(1).U(0);
+	}
+}
+
+TEST(CommandReplay, WellFormedLogReplays)
+{
+	LogBuilder log;
+	Prologue(*log);
+	const std::uint8_t bytes[4] = { 1, 2, 3, 4 };
+	(*log).Op(CommandLogOp::BufferData).U(1).U(252).U(4).Bytes(bytes, 4);
+	(*log).Op(CommandLogOp::Close).U(1);
+	(*log).Op(CommandLogOp::Reset).U(1);
+	(*log).Op(CommandLogOp::CopyBuffer).U(1).U(2).U(0).U(1).U(252).U(4);
+	(*log).Op(CommandLogOp::Close).U(1);
+	(*log).Op(CommandLogOp::Execute).U(1);
+	(*log).Op(CommandLogOp::Signal).U(1).U(1).U(16000);
+	(*log).Op(CommandLogOp::Wait).U(1).U(1);
+
+	EXPECT_TRUE(Replay(log.Finish()));
+}
+
+TEST(CommandReplay, HostileCapturesAreMalformed)
+{
+	// Collected in review: an upload at offset 2^64-1 whose end wraps to 0,
+	// a wait for a value never signaled, and a record cut short.
+	for (const char* name : { "evil.cmdlog", "wait.cmdlog", "trunc.cmdlog" })
+	{
+		std::ifstream file(fs::path(ENGINE_TEST_DATA_DIR) / name, std::ios::binary);
+		ASSERT_TRUE(file) << name;
+		std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		EXPECT_FALSE(Replay(data)) << name;
+	}
+}
+
+TEST(CommandReplay, OffsetsThatWrapAroundAreMalformed)
+{
+	const std::uint64_t wrap = ~0ull;
+	const std::uint8_t byte = 0xaa;
+	{
+		LogBuilder log;
+		Prologue(*log);
+		(*log).Op(CommandLogOp::BufferData).U(1).U(wrap).U(1).Bytes(&byte, 1);
+		EXPECT_FALSE(Replay(log.Finish()));
+	}
+	{
+		LogBuilder log;
+		Prologue(*log);
+		(*log).Op(CommandLogOp::BufferData).U(1).U(1).U(wrap).Bytes(&byte, 1);
+		EXPECT_FALSE(Replay(log.Finish()));
+	}
+	{
+		LogBuilder log;
+		Prologue(*log);
+		(*log).Op(CommandLogOp::CopyBuffer).U(1).U(2).U(wrap).U(1).U(0).U(1);
+		EXPECT_FALSE(Replay(log.Finish()));
+	}
+	{
+		LogBuilder log;
+		Prologue(*log);
+		(*log).Op(CommandLogOp::CopyBuffer).U(1).U(2).U(0).U(1).U(wrap - 15).U(16);
+		EXPECT_FALSE(Replay(log.Finish()));
+	}
+	{
+		// One past the end, without wrapping.
+		LogBuilder log;
+		Prologue(*log);
+		(*log).Op(CommandLogOp::CopyBuffer).U(1).U(2).U(1).U(1).U(0).U(256);
+		EXPECT_FALSE(Replay(log.Finish()));
+	}
+}
+
+TEST(CommandReplay, WaitingForAValueNeverSignaledIsMalformed)
+{
+	LogBuilder log;
+	Prologue(*log);
+	(*log).Op(CommandLogOp::Close).U(1);
+	(*log).Op(CommandLogOp::Execute).U(1);
+	(*log).Op(CommandLogOp::Signal).U(1).U(1).U(0);
+	(*log).Op(CommandLogOp::Wait).U(1).U(2);
+
+	std::size_t errorOffset = 0;
+	const std::vector<std::uint8_t>& data = log.Finish();
+	EXPECT_FALSE(Replay(data, &errorOffset));
+	// The last record: the op and two one-byte operands.
+	EXPECT_EQ(errorOffset, data.size() - 3);
+}
+
+TEST(CommandReplay, ListsUsedInTheWrongStateAreMalformed)
+{
+	{
+		LogBuilder log;
+		Prologue(*log);
+		(*log).Op(CommandLogOp::Close).U(1);
+		(*log).Op(CommandLogOp::Close).U(1);
+		EXPECT_FALSE(Replay(log.Finish()));
+	}
+	{
+		LogBuilder log;
+		Prologue(*log);
+		(*log).Op(CommandLogOp::Close).U(1);
+		(*log).Op(CommandLogOp::SetPipelineState).U(1).Fixed(0x1234);
+		EXPECT_FALSE(Replay(log.Finish()));
+	}
+	{
+		LogBuilder log;
+		Prologue(*log);
+		(*log).Op(CommandLogOp::Execute).U(1);
+		EXPECT_FALSE(Replay(log.Finish()));
+	}
+}
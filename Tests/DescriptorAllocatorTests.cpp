@@ -0,0 +1,193 @@
+#include "DescriptorAllocator.h"
+#include <gtest/gtest.h>
+#include <random>
+
+TEST(DescriptorFreeList, AllocatesFromTheTailAndCoalesces)
+{
+	DescriptorFreeList list(100, 16);
+	DescriptorSpan a = list.Allocate(4);
+	DescriptorSpan b = list.Allocate(4);
+	EXPECT_EQ(a.Offset, 112u);
+	EXPECT_EQ(b.Offset, 108u);
+	EXPECT_EQ(list.GetFreeCount(), 8u);
+	EXPECT_EQ(list.GetFreeRangeCount(), 1u);
+
+	// Freeing the older span leaves a hole; freeing the other closes it.
+	list.FreeNow(a);
+	EXPECT_EQ(list.GetFreeRangeCount(), 2u);
+	list.FreeNow(b);
+	EXPECT_EQ(list.GetFreeRangeCount(), 1u);
+	EXPECT_EQ(list.GetFreeCount(), 16u);
+
+	// The whole heap comes back as one span.
+	DescriptorSpan all = list.Allocate(16);
+	EXPECT_EQ(all.Offset, 100u);
+	EXPECT_FALSE(list.Allocate(1).IsValid());
+}
+
+TEST(DescriptorFreeList, TooLargeAllocationsFail)
+{
+	DescriptorFreeList list(0, 8);
+	DescriptorSpan a = list.Allocate(3);
+	list.Allocate(2);
+	list.FreeNow(a);
+
+	// 6 free, but in ranges of 3 and 3.
+	EXPECT_EQ(list.GetFreeCount(), 6u);
+	EXPECT_FALSE(list.Allocate(4).IsValid());
+	EXPECT_TRUE(list.Allocate(3).IsValid());
+
+	DescriptorFreeList empty(0, 0);
+	EXPECT_FALSE(empty.Allocate(1).IsValid());
+}
+
+TEST(DescriptorFreeList, FreedSpansWaitForTheirFence)
+{
+	DescriptorFreeList list(0, 4);
+	DescriptorSpan a = list.Allocate(4);
+
+	list.Free(a);
+	EXPECT_EQ(list.GetFreeCount(), 0u);
+	list.EndFrame(10);
+	list.ReleaseCompleted(9);
+	EXPECT_EQ(list.GetFreeCount(), 0u);
+	EXPECT_FALSE(list.Allocate(1).IsValid());
+
+	list.ReleaseCompleted(10);
+	EXPECT_EQ(list.GetFreeCount(), 4u);
+
+	// Freeing an invalid span is a no-op.
+	list.Free(DescriptorSpan());
+	list.FreeNow(DescriptorSpan());
+	list.EndFrame(11);
+	list.ReleaseCompleted(11);
+	EXPECT_EQ(list.GetFreeCount(), 4u);
+}
+
+TEST(DescriptorFreeList, RandomChurnNeverHandsOutADescriptorTwice)
+{
+	const std::uint32_t capacity = 512;
+	DescriptorFreeList list(0, capacity);
+	std::vector<int> owner(capacity, -1);
+	std::vector<DescriptorSpan> live;
+	std::mt19937 random(7);
+
+	std::uint64_t fence = 0;
+	for (int step = 0; step < 20000; ++step)
+	{
+		if (live.empty() || random() % 2 == 0)
+		{
+			DescriptorSpan span = list.Allocate(1 + random() % 8);
+			if (!span.IsValid())
+				continue;
+			for (std::uint32_t i = 0; i < span.Count; ++i)
+			{
+				ASSERT_EQ(owner[span.Offset + i], -1);
+				owner[span.Offset + i] = step;
+			}
+			live.push_back(span);
+		}
+		else
+		{
+			std::size_t index = random() % live.size();
+			DescriptorSpan span = live[index];
+			live[index] = live.back();
+			live.pop_back();
+			for (std::uint32_t i = 0; i < span.Count; ++i)
+				owner[span.Offset + i] = -1;
+			list.Free(span);
+		}
+
+		// Three frames in flight.
+		if (step % 16 == 15)
+		{
+			list.EndFrame(++fence);
+			if (fence > 3)
+				list.ReleaseCompleted(fence - 3);
+		}
+	}
+
+	list.EndFrame(++fence);
+	list.ReleaseCompleted(fence);
+	std::uint32_t liveCount = 0;
+	for (const DescriptorSpan& span : live)
+		liveCount += span.Count;
+	EXPECT_EQ(list.GetFreeCount() + liveCount, capacity);
+
+	for (const DescriptorSpan& span : live)
+		list.FreeNow(span);
+	EXPECT_EQ(list.GetFreeCount(), capacity);
+	EXPECT_EQ(list.GetFreeRangeCount(), 1u);
+}
+
+TEST(DescriptorRing, HandsOutConsecutiveSpans)
+{
+	DescriptorRing ring(1000, 16);
+	EXPECT_EQ(ring.Allocate(4).Offset, 1000u);
+	EXPECT_EQ(ring.Allocate(4).Offset, 1004u);
+	EXPECT_EQ(ring.GetUsedCount(), 8u);
+
+	ring.EndFrame(1);
+	ring.ReleaseCompleted(1);
+	EXPECT_EQ(ring.GetUsedCount(), 0u);
+
+	// With nothing in flight, the ring starts over.
+	EXPECT_EQ(ring.Allocate(4).Offset, 1000u);
+}
+
+TEST(DescriptorRing, SpansDoNotWrapAndTheSkippedTailIsCharged)
+{
+	DescriptorRing ring(0, 16);
+	ring.Allocate(6);
+	ring.EndFrame(1);
+	ring.Allocate(6);
+	ring.EndFrame(2);
+	ring.ReleaseCompleted(1);
+	EXPECT_EQ(ring.GetUsedCount(), 6u);
+
+	// Head at 12: 4 left before the end, so 5 go to the start and the 4
+	// skipped belong to this frame.
+	DescriptorSpan span = ring.Allocate(5);
+	ASSERT_TRUE(span.IsValid());
+	EXPECT_EQ(span.Offset, 0u);
+	EXPECT_EQ(ring.GetUsedCount(), 15u);
+
+	// Only 1 left, and it would overlap frame 2's span.
+	EXPECT_FALSE(ring.Allocate(2).IsValid());
+
+	ring.EndFrame(3);
+	ring.ReleaseCompleted(3);
+	EXPECT_EQ(ring.GetUsedCount(), 0u);
+}
+
+TEST(DescriptorRing, FramesInFlightNeverOverlap)
+{
+	const std::uint32_t capacity = 256;
+	DescriptorRing ring(0, capacity);
+	std::vector<std::uint64_t> owner(capacity, 0);
+	std::mt19937 random(11);
+
+	for (std::uint64_t fence = 1; fence <= 2000; ++fence)
+	{
+		// Frames up to two behind are still on the GPU.
+		if (fence > 2)
+			ring.ReleaseCompleted(fence - 2);
+
+		std::uint32_t allocations = random() % 12;
+		for (std::uint32_t i = 0; i < allocations; ++i)
+		{
+			DescriptorSpan span = ring.Allocate(1 + random() % 16);
+			if (!span.IsValid())
+				continue;
+			ASSERT_LE(span.Offset + span.Count, capacity);
+			for (std::uint32_t d = 0; d < span.Count; ++d)
+			{
+				ASSERT_TRUE(owner[span.Offset + d] == 0 || owner[span.Offset + d] + 2 <= fence)
+					<< "descriptor " << span.Offset + d << " of frame " << owner[span.Offset + d] << " reused in frame " << fence;
+				owner[span.Offset + d] = fence;
+			}
+		}
+		ring.EndFrame(fence);
+		ASSERT_LE(ring.GetUsedCount(), capacity);
+	}
+}
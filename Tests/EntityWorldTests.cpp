@@ -0,0 +1,150 @@
+#include "Components.h"
+#include "EntityWorld.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+	struct Velocity
+	{
+		float									X = 0.0f;
+	};
+
+	Transform At(float x)
+	{
+		return Transform(XMFLOAT3(x, 0.0f, 0.0f), XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f), 1.0f);
+	}
+}
+
+TEST(EntityWorld, HandlesAreGenerational)
+{
+	EntityWorld world;
+	Entity a = world.Create(At(1.0f));
+	EXPECT_TRUE(world.IsAlive(a));
+	EXPECT_EQ(world.GetEntityCount(), 1u);
+
+	world.Destroy(a);
+	EXPECT_FALSE(world.IsAlive(a));
+	EXPECT_EQ(world.Get<Transform>(a), nullptr);
+	EXPECT_EQ(world.GetEntityCount(), 0u);
+
+	// The index is reused under a new generation; the old handle stays dead.
+	Entity b = world.Create(At(2.0f));
+	EXPECT_EQ(b.Index, a.Index);
+	EXPECT_NE(b, a);
+	EXPECT_FALSE(world.IsAlive(a));
+	world.Destroy(a);
+	EXPECT_TRUE(world.IsAlive(b));
+
+	EXPECT_FALSE(world.IsAlive(Entity()));
+}
+
+TEST(EntityWorld, DestroyKeepsTheOtherEntitiesData)
+{
+	EntityWorld world;
+	std::vector<Entity> entities;
+	for (int i = 0; i < 1000; ++i)
+		entities.push_back(world.Create(At((float)i), Visibility()));
+
+	// Destroying fills holes with the last row of the archetype.
+	for (int i = 0; i < 1000; i += 3)
+		world.Destroy(entities[i]);
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		if (i % 3 == 0)
+			continue;
+		const Transform* transform = world.Get<Transform>(entities[i]);
+		ASSERT_NE(transform, nullptr);
+		EXPECT_EQ(transform->Position.x, (float)i);
+	}
+}
+
+TEST(EntityWorld, AddAndRemoveMoveBetweenArchetypes)
+{
+	EntityWorld world;
+	Entity e = world.Create(At(3.0f), Visibility());
+	EXPECT_EQ(world.Get<Velocity>(e), nullptr);
+
+	world.Add(e, Velocity{ 2.0f });
+	ASSERT_NE(world.Get<Velocity>(e), nullptr);
+	EXPECT_EQ(world.Get<Velocity>(e)->X, 2.0f);
+	EXPECT_EQ(world.Get<Transform>(e)->Position.x, 3.0f);
+
+	// Adding again overwrites in place.
+	world.Add(e, Velocity{ 4.0f });
+	EXPECT_EQ(world.Get<Velocity>(e)->X, 4.0f);
+	EXPECT_EQ(world.GetArchetypeCount(), 2u);
+
+	world.Remove<Visibility>(e);
+	EXPECT_EQ(world.Get<Visibility>(e), nullptr);
+	EXPECT_EQ(world.Get<Velocity>(e)->X, 4.0f);
+	EXPECT_EQ(world.Get<Transform>(e)->Position.x, 3.0f);
+	EXPECT_EQ(world.GetEntityCount(), 1u);
+}
+
+TEST(EntityWorld, QueriesVisitOnlyMatchingEntities)
+{
+	EntityWorld world;
+	for (int i = 0; i < 500; ++i)
+		world.Create(At((float)i));
+	for (int i = 0; i < 300; ++i)
+		world.Create(At((float)i), Velocity{ 1.0f });
+	for (int i = 0; i < 200; ++i)
+		world.Create(Velocity{ 1.0f }, Visibility());
+
+	int transforms = 0;
+	world.ForEach<Transform>([&](Entity, Transform&) { transforms++; });
+	EXPECT_EQ(transforms, 800);
+
+	int moving = 0;
+	world.ForEach<const Velocity, Transform>([&](Entity entity, const Velocity& velocity, Transform& transform)
+	{
+		EXPECT_TRUE(world.IsAlive(entity));
+		transform.Position.x += velocity.X;
+		moving++;
+	});
+	EXPECT_EQ(moving, 300);
+
+	std::uint32_t chunked = 0;
+	world.ForEachChunk<Velocity>([&](std::uint32_t count, const Entity*, Velocity*) { chunked += count; });
+	EXPECT_EQ(chunked, 500u);
+}
+
+TEST(EntityWorld, MillionEntitiesInParallel)
+{
+	const std::uint32_t count = 1000000;
+
+	EntityWorld world;
+	std::vector<Entity> entities;
+	entities.reserve(count);
+	for (std::uint32_t i = 0; i < count; ++i)
+		entities.push_back(world.Create(At((float)(i % 1000)), Bounds(), Visibility()));
+	EXPECT_EQ(world.GetEntityCount(), count);
+
+	// Every entity is handed to exactly one worker.
+	FrameArena::BeginFrame(0);
+	world.ParallelForEach<Transform, Visibility>([](Entity entity, Transform& transform, Visibility& visibility)
+	{
+		transform.Position.y = (float)(entity.Index % 7);
+		visibility.Visible = entity.Index % 2 == 0;
+	});
+
+	std::uint64_t visible = 0;
+	double sum = 0.0;
+	world.ForEach<const Transform, const Visibility>([&](Entity, const Transform& transform, const Visibility& visibility)
+	{
+		visible += visibility.Visible ? 1 : 0;
+		sum += transform.Position.y;
+	});
+	EXPECT_EQ(visible, count / 2);
+	double expected = 0.0;
+	for (std::uint32_t i = 0; i < count; ++i)
+		expected += i % 7;
+	EXPECT_EQ(sum, expected);
+
+	for (std::uint32_t i = 0; i < count; i += 2)
+		world.Destroy(entities[i]);
+	EXPECT_EQ(world.GetEntityCount(), count / 2);
+	EXPECT_EQ(world.Get<Visibility>(entities[1])->Visible, false);
+	EXPECT_EQ(world.Get<Transform>(entities[999999])->Position.y, (float)(999999 % 7));
+}
@@ -0,0 +1,293 @@
+#include "FixedStepScheduler.h"
+#include "NullBackend.h"
+#include "SceneRenderer.h"
+#include <gtest/gtest.h>
+#include <cstring>
+
+namespace
+{
+	const double Step = 1.0 / 60.0;
+
+	// Frame times of a fake clock: mostly around 60 Hz with jitter, some
+	// fast frames and a few hitches long enough to hit the clamp.
+	std::vector<double> FakeFrameTimes(std::size_t count)
+	{
+		std::vector<double> times;
+		std::uint32_t state = 12345;
+		double clock = 0.0;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			state = state * 1664525u + 1013904223u;
+			double frame = 0.004 + (state >> 8) * (0.026 / 16777216.0);
+			if (i % 97 == 50)
+				frame = 0.25;
+
+			// As a loop measures it: the difference of two clock readings.
+			double next = clock + frame;
+			times.push_back(next - clock);
+			clock = next;
+		}
+		return times;
+	}
+
+	struct Body
+	{
+		double									Position = 0.0;
+		double									Velocity = 1.0;
+	};
+
+	struct Published
+	{
+		Body									State;
+		float									Alpha;
+	};
+
+	// Runs a FixedStepLoop over `times`, recording what each frame renders.
+	std::vector<Published> RunLoop(const std::vector<double>& times, bool threaded)
+	{
+		Body simulated;
+		Body front;
+		std::vector<Published> frames;
+		{
+			FixedStepLoop loop(Step, 5,
+				[&simulated](double dt)
+				{
+					simulated.Velocity -= simulated.Position * dt;
+					simulated.Position += simulated.Velocity * dt;
+				},
+				[&simulated, &front] { front = simulated; },
+				threaded);
+			EXPECT_EQ(loop.IsThreaded(), threaded);
+
+			for (double frameSeconds : times)
+			{
+				float alpha = loop.Advance(frameSeconds);
+				frames.push_back(Published{ front, alpha });
+			}
+		}
+		return frames;
+	}
+
+	// A scene of spinning items driven by a FixedStepLoop; returns the world
+	// matrices drawn each frame.
+	std::vector<std::vector<XMFLOAT4X4>> RunScene(const std::vector<double>& times, bool threaded)
+	{
+		NullRenderDevice device;
+		SceneRenderer renderer(device, SceneRendererSettings(), 64);
+		renderer.Initialize();
+
+		GameObject& scene = renderer.GetScene();
+		scene.SetOcclusionCulling(false);
+		for (int i = 0; i < 32; ++i)
+		{
+			Transform local(XMFLOAT3(2.0f * i, 0.0f, 0.0f), XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f), 1.0f);
+			Entity entity = scene.Spawn("shapeGeo", "box", local);
+			if (i % 2 == 0)
+				scene.SetSpin(entity, 0.5f + 0.25f * i);
+		}
+
+		std::vector<std::vector<XMFLOAT4X4>> frames;
+		FixedStepLoop loop(Step, 5,
+			[&scene](double dt) { scene.FixedUpdate((float)dt); },
+			[&scene] { scene.PublishSimulation(); },
+			threaded);
+
+		GameTimer timer;
+		timer.Reset();
+		for (double frameSeconds : times)
+		{
+			renderer.BeginFrame();
+			scene.Interpolate(loop.Advance(frameSeconds));
+			renderer.Update(timer, 800, 600);
+
+			std::vector<XMFLOAT4X4> worlds;
+			for (const RenderItem& item : scene.GetRenderItems())
+				worlds.push_back(scene.GetWorld(item));
+			frames.push_back(worlds);
+
+			GpuCommandList& commandList = renderer.BeginCommandList();
+			renderer.DrawScene(commandList);
+			renderer.Submit(commandList);
+			renderer.Signal();
+		}
+		return frames;
+	}
+}
+
+TEST(FixedStepScheduler, AccumulatesAndClamps)
+{
+	FixedStepScheduler scheduler(Step, 5);
+
+	EXPECT_EQ(scheduler.Advance(Step / 2), 0u);
+	EXPECT_NEAR(scheduler.Alpha(), 0.5f, 1e-6f);
+	EXPECT_EQ(scheduler.Advance(Step / 2), 1u);
+	EXPECT_NEAR(scheduler.Alpha(), 0.0f, 1e-6f);
+	EXPECT_EQ(scheduler.Advance(2.5 * Step), 2u);
+	EXPECT_NEAR(scheduler.Alpha(), 0.5f, 1e-6f);
+
+	// A one second hitch runs five steps and drops the rest.
+	EXPECT_EQ(scheduler.Advance(1.0), 5u);
+	EXPECT_EQ(scheduler.DroppedSteps(), 55u);
+	EXPECT_EQ(scheduler.StepCount(), 8u);
+
+	// Negative frame times, as from a clock that went backwards, count as zero.
+	float alpha = scheduler.Alpha();
+	EXPECT_EQ(scheduler.Advance(-1.0), 0u);
+	EXPECT_EQ(scheduler.Alpha(), alpha);
+
+	scheduler.Reset();
+	EXPECT_EQ(scheduler.StepCount(), 0u);
+	EXPECT_EQ(scheduler.DroppedSteps(), 0u);
+	EXPECT_EQ(scheduler.Alpha(), 0.0f);
+}
+
+TEST(FixedStepScheduler, SameFrameTimesSameSteps)
+{
+	std::vector<double> times = FakeFrameTimes(2000);
+
+	FixedStepScheduler a(Step, 5), b(Step, 5);
+	double simulated = 0.0;
+	double elapsed = 0.0;
+	for (double frameSeconds : times)
+	{
+		std::uint32_t steps = a.Advance(frameSeconds);
+		ASSERT_EQ(steps, b.Advance(frameSeconds));
+		ASSERT_EQ(a.Alpha(), b.Alpha());
+		EXPECT_LE(steps, 5u);
+		EXPECT_GE(a.Alpha(), 0.0f);
+		EXPECT_LT(a.Alpha(), 1.0f);
+
+		simulated += steps * Step;
+		elapsed += frameSeconds;
+	}
+
+	// Every second of the fake clock is either simulated, dropped or left in
+	// the accumulator.
+	EXPECT_GT(a.DroppedSteps(), 0u);
+	EXPECT_NEAR(simulated + a.DroppedSteps() * Step + a.Alpha() * Step, elapsed, 1e-9);
+}
+
+TEST(FixedStepLoop, ThreadedPublishesTheSerialSequenceOneFrameLater)
+{
+	std::vector<double> times = FakeFrameTimes(500);
+	std::vector<Published> serial = RunLoop(times, false);
+	std::vector<Published> threaded = RunLoop(times, true);
+
+	ASSERT_EQ(serial.size(), threaded.size());
+	EXPECT_EQ(threaded[0].State.Position, 0.0);
+	EXPECT_EQ(threaded[0].Alpha, 0.0f);
+	for (size_t i = 1; i < threaded.size(); ++i)
+	{
+		ASSERT_EQ(threaded[i].State.Position, serial[i - 1].State.Position) << "frame " << i;
+		ASSERT_EQ(threaded[i].State.Velocity, serial[i - 1].State.Velocity) << "frame " << i;
+		ASSERT_EQ(threaded[i].Alpha, serial[i - 1].Alpha) << "frame " << i;
+	}
+
+	// And the serial run is reproducible.
+	std::vector<Published> again = RunLoop(times, false);
+	for (size_t i = 0; i < serial.size(); ++i)
+		ASSERT_EQ(again[i].State.Position, serial[i].State.Position);
+}
+
+TEST(FixedStepLoop, ThreadedSceneMatchesSerialScene)
+{
+	std::vector<double> times = FakeFrameTimes(300);
+	auto serial = RunScene(times, false);
+	auto threaded = RunScene(times, true);
+
+	ASSERT_EQ(serial.size(), threaded.size());
+	for (size_t i = 1; i < threaded.size(); ++i)
+	{
+		ASSERT_EQ(threaded[i].size(), serial[i - 1].size());
+		ASSERT_EQ(std::memcmp(threaded[i].data(), serial[i - 1].data(), serial[i - 1].size() * sizeof(XMFLOAT4X4)), 0) << "frame " << i;
+	}
+
+	// The items do turn, and interpolation moves them between steps.
+	EXPECT_NE(std::memcmp(serial.front().data(), serial.back().data(), serial.back().size() * sizeof(XMFLOAT4X4)), 0);
+}
+
+TEST(GameObject, InterpolatesBetweenTheLastTwoSteps)
+{
+	NullRenderDevice device;
+	SceneRenderer renderer(device, SceneRendererSettings(), 4);
+	renderer.Initialize();
+
+	GameObject& scene = renderer.GetScene();
+	Entity entity = scene.Spawn("shapeGeo", "box", Transform());
+	scene.SetSpin(entity, 1.0f);
+	scene.PublishSimulation();
+
+	scene.FixedUpdate(0.5f);
+	scene.FixedUpdate(0.5f);
+	scene.PublishSimulation();
+
+	auto yaw = [&]
+	{
+		const XMFLOAT4& q = scene.GetTransform(entity)->Rotation;
+		return 2.0f * std::atan2(q.y, q.w);
+	};
+
+	scene.Interpolate(0.0f);
+	EXPECT_NEAR(yaw(), 0.5f, 1e-6f);
+	scene.Interpolate(0.5f);
+	EXPECT_NEAR(yaw(), 0.75f, 1e-6f);
+	scene.Interpolate(1.0f);
+	EXPECT_NEAR(yaw(), 1.0f, 1e-6f);
+
+	// Steps not yet published are not seen.
+	scene.FixedUpdate(0.5f);
+	scene.Interpolate(1.0f);
+	EXPECT_NEAR(yaw(), 1.0f, 1e-6f);
+
+	// Despawned entities leave the simulation at the next publish.
+	EXPECT_TRUE(scene.Despawn(entity));
+	scene.PublishSimulation();
+	scene.Interpolate(0.5f);
+}
+
+TEST(GameObject, SpinsWrapBothWaysAndKeepTheSpawnRotation)
+{
+	NullRenderDevice device;
+	SceneRenderer renderer(device, SceneRendererSettings(), 4);
+	renderer.Initialize();
+
+	// Pitched by 90 degrees: the spin turns it about its own Y axis, which
+	// now points along world -Z.
+	GameObject& scene = renderer.GetScene();
+	XMFLOAT4 pitch;
+	XMStoreFloat4(&pitch, XMQuaternionRotationAxis(XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f), XM_PIDIV2));
+	Entity entity = scene.Spawn("shapeGeo", "box", Transform(XMFLOAT3(0.0f, 0.0f, 0.0f), pitch, 1.0f));
+	scene.SetSpin(entity, -1.0f);
+	scene.PublishSimulation();
+
+	// Yaws far from zero are reduced in double first, so only the scene's
+	// own rounding is measured; q and -q are the same rotation.
+	auto expectRotation = [&](double yaw)
+	{
+		XMFLOAT4 expected;
+		XMStoreFloat4(&expected, XMQuaternionMultiply(XMQuaternionRotationAxis(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), (float)std::fmod(yaw, 2.0 * XM_PI)), XMLoadFloat4(&pitch)));
+		const XMFLOAT4& actual = scene.GetTransform(entity)->Rotation;
+		float dot = actual.x * expected.x + actual.y * expected.y + actual.z * expected.z + actual.w * expected.w;
+		EXPECT_NEAR(std::fabs(dot), 1.0f, 1e-5f) << "yaw " << yaw;
+	};
+
+	scene.Interpolate(0.0f);
+	expectRotation(0.0);
+
+	// Turning backwards wraps below zero, and interpolation across the wrap
+	// still takes the short way.
+	const float step = 0.1f;
+	scene.FixedUpdate(step);
+	scene.PublishSimulation();
+	scene.Interpolate(0.5f);
+	expectRotation(-0.5 * step);
+
+	// Many turns later the angle is still small enough to keep its precision.
+	for (int i = 0; i < 100000; ++i)
+		scene.FixedUpdate(step);
+	scene.PublishSimulation();
+	scene.Interpolate(1.0f);
+	expectRotation(-100001.0 * step);
+	scene.Interpolate(0.5f);
+	expectRotation(-100000.5 * step);
+}
@@ -0,0 +1,96 @@
+#include "FrameArena.h"
+#include "MemoryTracker.h"
+#include "NullBackend.h"
+#include "SceneRenderer.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+TEST(LinearArena, BumpsAlignsAndFreesLifo)
+{
+	LinearArena arena(1024);
+	void* a = arena.Allocate(10, 1);
+	void* b = arena.Allocate(8, 64);
+	EXPECT_EQ((std::uintptr_t)b % 64, 0u);
+	EXPECT_GT(b, a);
+
+	// Only the most recent allocation comes back.
+	std::size_t used = arena.BytesUsed();
+	arena.Free(a, 10);
+	EXPECT_EQ(arena.BytesUsed(), used);
+	arena.Free(b, 8);
+	EXPECT_EQ(arena.Allocate(8, 64), b);
+}
+
+TEST(LinearArena, ResetCoalescesIntoOneBlock)
+{
+	LinearArena arena(256);
+	for (int i = 0; i < 10; ++i)
+		arena.Allocate(200, 8);
+	std::size_t capacity = arena.Capacity();
+	EXPECT_GE(capacity, 2000u);
+
+	// The next use of the same size fits in the single block.
+	arena.Reset();
+	EXPECT_EQ(arena.BytesUsed(), 0u);
+	EXPECT_EQ(arena.Capacity(), capacity);
+	for (int i = 0; i < 10; ++i)
+		arena.Allocate(200, 8);
+	EXPECT_EQ(arena.Capacity(), capacity);
+}
+
+TEST(FrameArena, ResetsWhenItsFrameComesRound)
+{
+	FrameArena::BeginFrame(0);
+	void* first = FrameArena::Allocate(64);
+	FrameArena::BeginFrame(1);
+	void* other = FrameArena::Allocate(64);
+	EXPECT_NE(other, first);
+
+	// Frame 0 again: its arena starts over.
+	FrameArena::BeginFrame(0);
+	EXPECT_EQ(FrameArena::Allocate(64), first);
+}
+
+TEST(FrameArena, FreeNeverResetsTheArena)
+{
+	static_assert(noexcept(FrameArena::Free(nullptr, 0)), "deallocate relies on Free not throwing");
+
+	// On a fresh thread, so its arena for frame 0 holds only these blocks.
+	std::uint64_t blocksBefore = 0, blocksAfterFree = 0, blocksAfterAllocate = 0;
+	std::thread worker([&]
+	{
+		FrameArena::BeginFrame(0);
+		void* last = nullptr;
+		for (int i = 0; i < 3; ++i)
+			last = FrameArena::Allocate(LinearArena::DefaultBlockSize / 2);
+
+		// The frame comes round: only the next Allocate may coalesce the
+		// chain into a new block.
+		FrameArena::BeginFrame(0);
+		blocksBefore = MemoryTracker::GetStats(MemTag::Frame).TotalCount;
+		FrameArena::Free(last, LinearArena::DefaultBlockSize / 2);
+		blocksAfterFree = MemoryTracker::GetStats(MemTag::Frame).TotalCount;
+		FrameArena::Allocate(64);
+		blocksAfterAllocate = MemoryTracker::GetStats(MemTag::Frame).TotalCount;
+	});
+	worker.join();
+
+	EXPECT_EQ(blocksAfterFree, blocksBefore);
+	EXPECT_EQ(blocksAfterAllocate, blocksBefore + 1);
+}
+
+TEST(FrameArena, LoadingDoesNotUseTheFrameArenas)
+{
+	// On a fresh thread, whose arenas have no blocks yet.
+	std::size_t capacity = 1;
+	std::thread loader([&capacity]
+	{
+		NullRenderDevice device;
+		SceneRenderer renderer(device, SceneRendererSettings(), 64);
+		renderer.Initialize();
+		capacity = FrameArena::ThreadArena().Capacity();
+	});
+	loader.join();
+
+	EXPECT_EQ(capacity, 0u);
+}
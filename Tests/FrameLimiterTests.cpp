@@ -0,0 +1,141 @@
+#include "FrameLimiter.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace
+{
+	// A clock that only moves when read (one microsecond per read, so the
+	// spin loop terminates) or slept on. Sleeps overshoot by a fixed amount.
+	struct FakeClock
+	{
+		double									Now = 0.0;
+		double									Tick = 1e-6;
+		double									Overshoot = 0.0;
+		std::vector<double>						Sleeps;
+
+		FrameLimiter MakeLimiter()
+		{
+			return FrameLimiter(
+				[this] { Now += Tick; return Now; },
+				[this](double seconds) { Sleeps.push_back(seconds); Now += seconds + Overshoot; });
+		}
+	};
+}
+
+TEST(FrameLimiter, PacesAtTheTargetRate)
+{
+	FakeClock clock;
+	FrameLimiter limiter = clock.MakeLimiter();
+	limiter.SetTargetFrameRate(100.0);
+	EXPECT_DOUBLE_EQ(limiter.GetTargetFrameRate(), 100.0);
+
+	// The first wait starts the schedule.
+	limiter.WaitForNextFrame();
+	double start = clock.Now;
+
+	for (int frame = 1; frame <= 50; ++frame)
+	{
+		clock.Now += 0.003;
+		limiter.WaitForNextFrame();
+		EXPECT_NEAR(clock.Now - start, frame * 0.01, 1e-5) << "frame " << frame;
+	}
+
+	// Every wait slept for the bulk of the frame and spun for the rest.
+	ASSERT_EQ(clock.Sleeps.size(), 50u);
+	for (double sleep : clock.Sleeps)
+		EXPECT_NEAR(sleep, 0.01 - 0.003 - 0.002, 1e-5);
+	EXPECT_EQ(limiter.WakeError().Compute().SampleCount, 50u);
+	EXPECT_LE(limiter.WakeError().Compute().Max, 0.002f);
+}
+
+TEST(FrameLimiter, ADeadlineAtClockZeroStillWaits)
+{
+	// The schedule starts at -period, so the first deadline is exactly 0.0.
+	FakeClock clock;
+	clock.Now = -0.01;
+	clock.Tick = 0.0;
+	FrameLimiter limiter = clock.MakeLimiter();
+	limiter.SetTargetFrameRate(100.0);
+	limiter.WaitForNextFrame();
+
+	clock.Tick = 1e-6;
+	limiter.WaitForNextFrame();
+	EXPECT_EQ(clock.Sleeps.size(), 1u);
+	EXPECT_GE(clock.Now, 0.0);
+	EXPECT_LT(clock.Now, 1e-4);
+}
+
+TEST(FrameLimiter, AnOverrunRestartsTheSchedule)
+{
+	FakeClock clock;
+	FrameLimiter limiter = clock.MakeLimiter();
+	limiter.SetTargetFrameRate(100.0);
+	limiter.WaitForNextFrame();
+
+	// More than a whole frame late: no wait, and no burst of short frames.
+	clock.Now += 0.025;
+	limiter.WaitForNextFrame();
+	EXPECT_TRUE(clock.Sleeps.empty());
+
+	double restart = clock.Now;
+	clock.Now += 0.001;
+	limiter.WaitForNextFrame();
+	EXPECT_NEAR(clock.Now - restart, 0.01, 1e-5);
+
+	// Changing the rate restarts the schedule too.
+	limiter.SetTargetFrameRate(50.0);
+	size_t sleeps = clock.Sleeps.size();
+	limiter.WaitForNextFrame();
+	EXPECT_EQ(clock.Sleeps.size(), sleeps);
+
+	// And a zero rate disables the cap.
+	limiter.SetTargetFrameRate(0.0);
+	EXPECT_EQ(limiter.GetTargetFrameRate(), 0.0);
+	double before = clock.Now;
+	limiter.WaitForNextFrame();
+	EXPECT_EQ(clock.Now, before);
+}
+
+TEST(FrameLimiter, SpinWindowGrowsWithTheOvershoot)
+{
+	FakeClock clock;
+	clock.Overshoot = 0.003;
+	FrameLimiter limiter = clock.MakeLimiter();
+	limiter.SetTargetFrameRate(100.0);
+	limiter.WaitForNextFrame();
+
+	for (int frame = 0; frame < 20; ++frame)
+	{
+		clock.Now += 0.001;
+		limiter.WaitForNextFrame();
+	}
+
+	// The first sleep overshot its deadline; after that the limiter leaves
+	// room for the overshoot and wakes on time.
+	EXPECT_NEAR(clock.Sleeps.back(), 0.01 - 0.001 - 0.003, 1e-4);
+	FrameTimeStats wake = limiter.WakeError().Compute();
+	EXPECT_EQ(wake.SampleCount, 20u);
+	EXPECT_LE(wake.P95, 0.005f);
+}
+
+TEST(FrameLimiter, LatencyIsMeasuredFromInputToPresent)
+{
+	FakeClock clock;
+	FrameLimiter limiter = clock.MakeLimiter();
+
+	// A present without input records nothing.
+	limiter.MarkPresent();
+	EXPECT_EQ(limiter.Latency().Compute().SampleCount, 0u);
+
+	limiter.MarkInput();
+	clock.Now += 0.005;
+	limiter.MarkPresent();
+	limiter.MarkPresent();
+
+	FrameTimeStats latency = limiter.Latency().Compute();
+	EXPECT_EQ(latency.SampleCount, 1u);
+	EXPECT_NEAR(latency.Max, 5.0f, 0.002f);
+
+	limiter.SetMaxQueuedFrames(0);
+	EXPECT_EQ(limiter.GetMaxQueuedFrames(), 1u);
+}
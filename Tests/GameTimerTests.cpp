@@ -0,0 +1,138 @@
+#include "GameTimer.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+	void Sleep(int milliseconds)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+	}
+}
+
+TEST(GameTimer, TracksTheSteadyClock)
+{
+	GameTimer timer;
+	timer.Reset();
+	auto start = std::chrono::steady_clock::now();
+	Sleep(50);
+	timer.Tick();
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	EXPECT_GE(timer.TotalTime(), 0.05f);
+	EXPECT_LE(timer.TotalTime(), elapsed + 1e-3);
+	EXPECT_NEAR(timer.DeltaTime(), timer.TotalTime(), 1e-6f);
+}
+
+TEST(GameTimer, PausedTimeIsNotCounted)
+{
+	GameTimer timer;
+	timer.Reset();
+	Sleep(20);
+	timer.Tick();
+
+	timer.Stop();
+	EXPECT_TRUE(timer.IsStopped());
+	float stoppedAt = timer.TotalTime();
+	Sleep(60);
+	EXPECT_EQ(timer.TotalTime(), stoppedAt);
+
+	// Ticks while stopped report no time and are not recorded.
+	timer.Tick();
+	EXPECT_EQ(timer.DeltaTime(), 0.0f);
+	EXPECT_EQ(timer.FrameTimes().Compute().SampleCount, 1u);
+
+	// Stopping twice does not move the stop time.
+	timer.Stop();
+	EXPECT_EQ(timer.TotalTime(), stoppedAt);
+
+	timer.Start();
+	EXPECT_FALSE(timer.IsStopped());
+	Sleep(20);
+	timer.Tick();
+
+	// The first frame after resuming starts at Start, not at the last Tick.
+	EXPECT_GE(timer.DeltaTime(), 0.02f);
+	EXPECT_LT(timer.DeltaTime(), 0.06f);
+	EXPECT_GE(timer.TotalTime(), 0.04f);
+	EXPECT_LT(timer.TotalTime(), 0.04f + 0.06f);
+
+	// Starting a running timer changes nothing.
+	float total = timer.TotalTime();
+	timer.Start();
+	EXPECT_EQ(timer.TotalTime(), total);
+}
+
+TEST(GameTimer, SeveralPausesAccumulate)
+{
+	GameTimer timer;
+	timer.Reset();
+	for (int i = 0; i < 3; ++i)
+	{
+		Sleep(10);
+		timer.Stop();
+		Sleep(30);
+		timer.Start();
+	}
+	timer.Tick();
+
+	EXPECT_GE(timer.TotalTime(), 0.03f);
+	EXPECT_LT(timer.TotalTime(), 0.03f + 0.09f);
+}
+
+TEST(FrameTimeHistogram, Percentiles)
+{
+	FrameTimeHistogram histogram;
+	EXPECT_EQ(histogram.Compute().SampleCount, 0u);
+
+	// 1..100 ms: nearest-rank percentiles are the values themselves.
+	for (int i = 1; i <= 100; ++i)
+		histogram.Record(i * 1e-3);
+
+	FrameTimeStats stats = histogram.Compute();
+	EXPECT_EQ(stats.SampleCount, 100u);
+	EXPECT_FLOAT_EQ(stats.P50, 50.0f);
+	EXPECT_FLOAT_EQ(stats.P95, 95.0f);
+	EXPECT_FLOAT_EQ(stats.P99, 99.0f);
+	EXPECT_FLOAT_EQ(stats.Max, 100.0f);
+	// Hitches are longer than the median times the factor.
+	EXPECT_EQ(stats.HitchCount, 0u);
+	EXPECT_EQ(histogram.Compute(1.55f).HitchCount, 23u);
+
+	// Small windows round the rank up.
+	FrameTimeHistogram three;
+	three.Record(0.001);
+	three.Record(0.002);
+	three.Record(0.003);
+	stats = three.Compute();
+	EXPECT_FLOAT_EQ(stats.P50, 2.0f);
+	EXPECT_FLOAT_EQ(stats.P95, 3.0f);
+	EXPECT_FLOAT_EQ(stats.P99, 3.0f);
+}
+
+TEST(FrameTimeHistogram, HitchesAndRollingWindow)
+{
+	const std::uint32_t capacity = FrameTimeHistogram::Capacity;
+
+	FrameTimeHistogram histogram;
+	for (std::uint32_t i = 0; i < capacity; ++i)
+		histogram.Record(i % 100 == 0 ? 0.050 : 0.016);
+
+	FrameTimeStats stats = histogram.Compute();
+	EXPECT_EQ(stats.SampleCount, capacity);
+	EXPECT_FLOAT_EQ(stats.P50, 16.0f);
+	EXPECT_FLOAT_EQ(stats.Max, 50.0f);
+	EXPECT_EQ(stats.HitchCount, 11u);
+
+	// A full window later the hitches have rolled out.
+	for (std::uint32_t i = 0; i < capacity; ++i)
+		histogram.Record(0.008);
+	stats = histogram.Compute();
+	EXPECT_EQ(stats.SampleCount, capacity);
+	EXPECT_FLOAT_EQ(stats.Max, 8.0f);
+	EXPECT_EQ(stats.HitchCount, 0u);
+
+	histogram.Clear();
+	EXPECT_EQ(histogram.Compute().SampleCount, 0u);
+}
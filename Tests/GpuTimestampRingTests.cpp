@@ -0,0 +1,135 @@
+#include "GpuTimestampRing.h"
+#include <gtest/gtest.h>
+
+TEST(GpuTimestampRing, EachFrameWritesItsOwnRegion)
+{
+	GpuTimestampRing ring(3, 4);
+	EXPECT_EQ(ring.TotalQueries(), 24u);
+
+	for (std::uint32_t frame = 0; frame < 3; ++frame)
+	{
+		ring.BeginFrame(frame);
+		std::uint32_t first = ring.BeginZone("Frame");
+		std::uint32_t second = ring.BeginZone("Opaque");
+		EXPECT_EQ(first, ring.FirstQuery(frame));
+		EXPECT_EQ(second, ring.FirstQuery(frame) + 2);
+		EXPECT_EQ(ring.EndZone(second), second + 1);
+		EXPECT_EQ(ring.EndZone(first), first + 1);
+		EXPECT_EQ(ring.QueryCount(frame), 4u);
+	}
+	EXPECT_EQ(ring.FirstQuery(2), 16u);
+}
+
+TEST(GpuTimestampRing, FullRegionReturnsInvalidZones)
+{
+	const std::uint32_t invalid = GpuTimestampRing::InvalidZone;
+	GpuTimestampRing ring(2, 2);
+	ring.BeginFrame(1);
+	std::uint32_t a = ring.BeginZone("A");
+	std::uint32_t b = ring.BeginZone("B");
+	std::uint32_t c = ring.BeginZone("C");
+	EXPECT_NE(a, invalid);
+	EXPECT_NE(b, invalid);
+	EXPECT_EQ(c, invalid);
+
+	// Ending an invalid zone is harmless and writes nothing.
+	EXPECT_EQ(ring.EndZone(c), invalid);
+	ring.EndZone(b);
+	ring.EndZone(a);
+	EXPECT_EQ(ring.QueryCount(1), 4u);
+
+	// Starting the frame over empties its region.
+	ring.BeginFrame(1);
+	EXPECT_EQ(ring.QueryCount(1), 0u);
+	EXPECT_EQ(ring.BeginZone("A"), ring.FirstQuery(1));
+}
+
+TEST(GpuTimestampRing, ResolveTurnsTicksIntoNestedTimings)
+{
+	GpuTimestampRing ring(2, 8);
+	ring.BeginFrame(1);
+	std::uint32_t frame = ring.BeginZone("Frame");
+	std::uint32_t opaque = ring.BeginZone("Opaque");
+	ring.EndZone(opaque);
+	std::uint32_t post = ring.BeginZone("Post");
+	ring.EndZone(post);
+	std::uint32_t open = ring.BeginZone("Open");
+	(void)open;
+	ring.EndZone(frame);
+
+	// Ticks at 1 MHz, from the first query of frame 1's region.
+	const std::uint64_t timestamps[] = { 1000, 5000, 1100, 3100, 3200, 4200, 4300, 0 };
+	std::vector<GpuZoneTiming> timings;
+	ring.Resolve(1, timestamps, 1000000, timings);
+
+	// The zone left open is dropped.
+	ASSERT_EQ(timings.size(), 3u);
+	EXPECT_STREQ(timings[0].Name, "Frame");
+	EXPECT_EQ(timings[0].Depth, 0u);
+	EXPECT_DOUBLE_EQ(timings[0].Milliseconds, 4.0);
+	EXPECT_STREQ(timings[1].Name, "Opaque");
+	EXPECT_EQ(timings[1].Depth, 1u);
+	EXPECT_DOUBLE_EQ(timings[1].Milliseconds, 2.0);
+	EXPECT_STREQ(timings[2].Name, "Post");
+	EXPECT_EQ(timings[2].Depth, 1u);
+	EXPECT_DOUBLE_EQ(timings[2].Milliseconds, 1.0);
+}
+
+TEST(GpuTimestampRing, OutOfOrderTimestampsAreClamped)
+{
+	GpuTimestampRing ring(1, 1);
+	ring.BeginFrame(0);
+	ring.EndZone(ring.BeginZone("Zone"));
+
+	const std::uint64_t timestamps[] = { 2000, 1500 };
+	std::vector<GpuZoneTiming> timings;
+	ring.Resolve(0, timestamps, 1000000, timings);
+	ASSERT_EQ(timings.size(), 1u);
+	EXPECT_EQ(timings[0].End, timings[0].Begin);
+	EXPECT_EQ(timings[0].Milliseconds, 0.0);
+}
+
+TEST(GpuTimestampRing, GpuTicksMapOntoTheCpuClock)
+{
+	// Both clocks at 1024 Hz, sampled together at GPU tick 5000 and CPU
+	// count 100.
+	const double cpuSecondsPerCount = 1.0 / 1024.0;
+	EXPECT_EQ(GpuTimestampRing::GpuToCpuTicks(5000, 1024, 5000, 100, cpuSecondsPerCount), 100);
+	EXPECT_EQ(GpuTimestampRing::GpuToCpuTicks(5000 + 2048, 1024, 5000, 100, cpuSecondsPerCount), 100 + 2048);
+	// A CPU counter twice as fast.
+	EXPECT_EQ(GpuTimestampRing::GpuToCpuTicks(5000 + 2048, 1024, 5000, 100, cpuSecondsPerCount / 2.0), 100 + 4096);
+
+	// Before the calibration point.
+	EXPECT_EQ(GpuTimestampRing::GpuToCpuTicks(5000 - 1024, 1024, 5000, 100, cpuSecondsPerCount), 100 - 1024);
+}
+
+TEST(GpuTimestampRing, OpenZonesEndInnermostFirst)
+{
+	GpuTimestampRing ring(2, 4);
+	ring.BeginFrame(1);
+	std::uint32_t frame = ring.BeginZone("Frame");
+	ring.EndZone(ring.BeginZone("Opaque"));
+	std::uint32_t post = ring.BeginZone("Post");
+	std::uint32_t bloom = ring.BeginZone("Bloom");
+
+	EXPECT_EQ(ring.EndOpenZone(), bloom + 1);
+	EXPECT_EQ(ring.EndOpenZone(), post + 1);
+	EXPECT_EQ(ring.EndOpenZone(), frame + 1);
+	const std::uint32_t invalid = GpuTimestampRing::InvalidZone;
+	EXPECT_EQ(ring.EndOpenZone(), invalid);
+
+	// Every zone now resolves, at its recorded depth.
+	const std::uint64_t timestamps[] = { 0, 9000, 1000, 2000, 3000, 8000, 4000, 7000 };
+	std::vector<GpuZoneTiming> timings;
+	ring.Resolve(1, timestamps, 1000000, timings);
+	ASSERT_EQ(timings.size(), 4u);
+	EXPECT_EQ(timings[3].Depth, 2u);
+	EXPECT_DOUBLE_EQ(timings[3].Milliseconds, 3.0);
+
+	// The next frame starts back at depth 0.
+	ring.BeginFrame(0);
+	ring.EndZone(ring.BeginZone("Frame"));
+	ring.Resolve(0, timestamps, 1000000, timings);
+	ASSERT_EQ(timings.size(), 1u);
+	EXPECT_EQ(timings[0].Depth, 0u);
+}
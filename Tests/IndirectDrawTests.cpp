@@ -0,0 +1,167 @@
+#include "IndirectDraw.h"
+#include "NullBackend.h"
+#include "SceneRenderer.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+	const GpuAddress ObjectCBBase = 0x10000;
+
+	RenderItem MakeItem(MeshGeometry* geo, UINT objCBIndex, UINT indexCount, bool visible)
+	{
+		RenderItem item;
+		item.Geo = geo;
+		item.ObjCBIndex = objCBIndex;
+		item.IndexCount = indexCount;
+		item.StartIndexLocation = 3 * objCBIndex;
+		item.BaseVertexLocation = -(int)objCBIndex;
+		item.Visible = visible;
+		return item;
+	}
+
+	// Scene of `count` entities, every `stride`-th one visible, rendered by a
+	// SceneRenderer on the null backend.
+	UINT DrawScene(bool indirect, UINT count, UINT stride, NullQueueStats& stats)
+	{
+		NullRenderDevice device;
+		SceneRendererSettings settings;
+		settings.IndirectDraw = indirect;
+		SceneRenderer renderer(device, settings, count);
+		renderer.Initialize();
+
+		GameObject& scene = renderer.GetScene();
+		scene.SetOcclusionCulling(false);
+		for (UINT i = 0; i < count; ++i)
+		{
+			Transform local(XMFLOAT3(2.0f * i, 0.0f, 0.0f), XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f), 1.0f);
+			Entity entity = scene.Spawn("shapeGeo", i % 2 == 0 ? "box" : "sphere", local);
+			scene.GetEntities().Get<Visibility>(entity)->Visible = i % stride == 0;
+		}
+
+		GameTimer timer;
+		timer.Reset();
+		renderer.BeginFrame();
+		renderer.Update(timer, 800, 600);
+		device.ResetStats();
+		GpuCommandList& commandList = renderer.BeginCommandList();
+		renderer.DrawScene(commandList);
+		renderer.Submit(commandList);
+		renderer.Signal();
+		renderer.Flush();
+
+		stats = device.GetStats();
+		return renderer.GetDrawCount();
+	}
+}
+
+TEST(IndirectDrawBuilder, SignatureMatchesCommandLayout)
+{
+	CommandSignatureDesc desc = IndirectCommandSignature();
+	EXPECT_EQ(desc.ByteStride, sizeof(IndirectCommand));
+
+	std::uint32_t size = 0;
+	for (const IndirectArgument& argument : desc.Arguments)
+		size += IndirectArgumentSize(argument.Type);
+	EXPECT_EQ(size, sizeof(IndirectCommand));
+
+	ASSERT_EQ(desc.Arguments.size(), 3u);
+	EXPECT_EQ(desc.Arguments[0].Type, IndirectArgumentType::ConstantBufferView);
+	EXPECT_EQ(desc.Arguments[0].RootParameter, 0u);
+	EXPECT_EQ(desc.Arguments[1].Type, IndirectArgumentType::Constant);
+	EXPECT_EQ(desc.Arguments[1].RootParameter, 2u);
+	EXPECT_EQ(desc.Arguments[2].Type, IndirectArgumentType::DrawIndexed);
+}
+
+TEST(IndirectDrawBuilder, CompactsVisibleItemsInOrder)
+{
+	MeshGeometry geo;
+	std::vector<RenderItem> storage;
+	for (UINT i = 0; i < 1000; ++i)
+		storage.push_back(MakeItem(&geo, i, 36 + i, i % 3 != 1));
+
+	IndirectDrawBuilder builder;
+	UINT count = builder.Build(storage, ObjectCBBase);
+	ASSERT_EQ(count, 667u);
+	EXPECT_EQ(builder.GetCommandCount(), count);
+
+	UINT next = 0;
+	for (UINT i = 0; i < storage.size(); ++i)
+	{
+		if (!storage[i].Visible)
+			continue;
+
+		const IndirectCommand& cmd = builder.GetCommands()[next++];
+		EXPECT_EQ(cmd.DrawId, i);
+		EXPECT_EQ(cmd.ObjectCbv, storage[i].ObjectCBAddress(ObjectCBBase));
+		EXPECT_EQ(cmd.DrawArguments.IndexCountPerInstance, 36 + i);
+		EXPECT_EQ(cmd.DrawArguments.InstanceCount, 1u);
+		EXPECT_EQ(cmd.DrawArguments.StartIndexLocation, 3 * i);
+		EXPECT_EQ(cmd.DrawArguments.BaseVertexLocation, -(int)i);
+		EXPECT_EQ(cmd.DrawArguments.StartInstanceLocation, 0u);
+	}
+	EXPECT_EQ(next, count);
+
+	ASSERT_EQ(builder.GetBatches().size(), 1u);
+	EXPECT_EQ(builder.GetBatches()[0].FirstCommand, 0u);
+	EXPECT_EQ(builder.GetBatches()[0].CommandCount, count);
+}
+
+TEST(IndirectDrawBuilder, SplitsBatchesOnGeometryAndTopology)
+{
+	MeshGeometry a, b;
+	std::vector<RenderItem> storage =
+	{
+		MakeItem(&a, 0, 3, true),
+		MakeItem(&a, 1, 3, true),
+		MakeItem(&b, 2, 3, true),
+		MakeItem(&b, 3, 3, false),
+		MakeItem(&b, 4, 3, true),
+		MakeItem(&b, 5, 3, true),
+	};
+	storage[5].PrimitiveType = PrimitiveTopology::LineList;
+
+	IndirectDrawBuilder builder;
+	ASSERT_EQ(builder.Build(storage, ObjectCBBase), 5u);
+
+	const std::vector<IndirectBatch>& batches = builder.GetBatches();
+	ASSERT_EQ(batches.size(), 3u);
+	EXPECT_EQ(batches[0].Geo, &a);
+	EXPECT_EQ(batches[0].FirstCommand, 0u);
+	EXPECT_EQ(batches[0].CommandCount, 2u);
+	EXPECT_EQ(batches[1].Geo, &b);
+	EXPECT_EQ(batches[1].FirstCommand, 2u);
+	EXPECT_EQ(batches[1].CommandCount, 2u);
+	EXPECT_EQ(batches[2].PrimitiveType, PrimitiveTopology::LineList);
+	EXPECT_EQ(batches[2].FirstCommand, 4u);
+	EXPECT_EQ(batches[2].CommandCount, 1u);
+}
+
+TEST(IndirectDrawBuilder, EmptyAndAllHidden)
+{
+	MeshGeometry geo;
+	RenderItem hidden = MakeItem(&geo, 0, 3, false);
+
+	IndirectDrawBuilder builder;
+	EXPECT_EQ(builder.Build({}, ObjectCBBase), 0u);
+	EXPECT_TRUE(builder.GetBatches().empty());
+
+	EXPECT_EQ(builder.Build({ &hidden, 1 }, ObjectCBBase), 0u);
+	EXPECT_TRUE(builder.GetBatches().empty());
+}
+
+TEST(SceneRenderer, IndirectPathDrawsWhatTheDirectPathDraws)
+{
+	for (UINT stride : { 1u, 7u, 100u })
+	{
+		NullQueueStats direct, indirect;
+		UINT directDraws = DrawScene(false, 500, stride, direct);
+		UINT indirectDraws = DrawScene(true, 500, stride, indirect);
+
+		UINT visible = (500 + stride - 1) / stride;
+		EXPECT_EQ(directDraws, visible);
+		EXPECT_EQ(indirectDraws, visible);
+		EXPECT_EQ(direct.Draws, visible);
+		EXPECT_EQ(indirect.Draws, visible);
+		EXPECT_LT(indirect.Commands, direct.Commands);
+	}
+}
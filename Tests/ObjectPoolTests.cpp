@@ -0,0 +1,97 @@
+#include "ObjectPool.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace
+{
+	struct Item
+	{
+		std::uint32_t						Id = 0;
+		std::vector<int>					Payload;
+
+											Item(std::uint32_t id) : Id(id), Payload(4, (int)id)	{}
+	};
+}
+
+TEST(ObjectPool, HandlesSurviveTheObjectsMoving)
+{
+	ObjectPool<Item> pool(8);
+	std::vector<PoolHandle> handles;
+	for (std::uint32_t i = 0; i < 8; ++i)
+		handles.push_back(pool.Create(i));
+	EXPECT_TRUE(pool.Full());
+	EXPECT_FALSE(pool.Create(99u).IsValid());
+
+	// Lowest slots first.
+	for (std::uint32_t i = 0; i < 8; ++i)
+		EXPECT_EQ(handles[i].Index, i);
+
+	// Destroying from the front moves the last object into the hole.
+	EXPECT_TRUE(pool.Destroy(handles[0]));
+	EXPECT_FALSE(pool.Destroy(handles[0]));
+	EXPECT_EQ(pool.Get(handles[0]), nullptr);
+	EXPECT_EQ(pool.Items()[0].Id, 7u);
+	for (std::uint32_t i = 1; i < 8; ++i)
+	{
+		ASSERT_NE(pool.Get(handles[i]), nullptr);
+		EXPECT_EQ(pool.Get(handles[i])->Id, i);
+		EXPECT_EQ(pool.Get(handles[i])->Payload, std::vector<int>(4, (int)i));
+	}
+
+	// The freed slot is reused, and the old handle does not see the new object.
+	PoolHandle reused = pool.Create(42u);
+	EXPECT_EQ(reused.Index, 0u);
+	EXPECT_NE(reused, handles[0]);
+	EXPECT_EQ(pool.Get(handles[0]), nullptr);
+	EXPECT_EQ(pool.Get(reused)->Id, 42u);
+}
+
+TEST(ObjectPool, ItemsStayPackedThroughChurn)
+{
+	const std::uint32_t capacity = 1000;
+	ObjectPool<Item> pool(capacity);
+	std::vector<PoolHandle> live;
+	std::vector<std::uint32_t> ids(capacity, 0xffffffffu);
+	std::mt19937 random(7);
+	std::uint32_t nextId = 0;
+
+	for (int step = 0; step < 20000; ++step)
+	{
+		if (!live.empty() && (pool.Full() || random() % 2 == 0))
+		{
+			std::size_t victim = random() % live.size();
+			ASSERT_TRUE(pool.Destroy(live[victim]));
+			ids[live[victim].Index] = 0xffffffffu;
+			live[victim] = live.back();
+			live.pop_back();
+		}
+		else
+		{
+			PoolHandle handle = pool.Create(nextId);
+			ASSERT_TRUE(handle.IsValid());
+			ASSERT_LT(handle.Index, capacity);
+			ids[handle.Index] = nextId++;
+			live.push_back(handle);
+		}
+
+		ASSERT_EQ(pool.Size(), live.size());
+		ASSERT_EQ(pool.Items().size(), live.size());
+	}
+
+	// Every handle finds its own object, every object is reached once through
+	// HandleAt, and the objects are one contiguous run.
+	for (const PoolHandle& handle : live)
+		ASSERT_EQ(pool.Get(handle)->Id, ids[handle.Index]);
+	for (std::uint32_t i = 0; i < pool.Size(); ++i)
+	{
+		PoolHandle handle = pool.HandleAt(i);
+		ASSERT_EQ(pool.Get(handle), &pool.Items()[i]);
+		ASSERT_EQ(pool.Items()[i].Id, ids[handle.Index]);
+	}
+
+	pool.Clear();
+	EXPECT_EQ(pool.Size(), 0u);
+	for (const PoolHandle& handle : live)
+		EXPECT_FALSE(pool.IsAlive(handle));
+}
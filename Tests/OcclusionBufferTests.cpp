@@ -0,0 +1,499 @@
+#include "OcclusionBuffer.h"
+#include "CreateGeometry.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+	const float Identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+	// Scalar rasterizer for one triangle at a time, with the conventions
+	// OcclusionBuffer documents: positions snapped to 1/8 pixel, the top-left
+	// rule, clockwise front faces, and depth interpolated from the exact
+	// positions. Every pixel is tested on its own in 64-bit integers.
+	class ScalarRasterizer
+	{
+	public:
+
+											ScalarRasterizer(int width, int height)
+			: m_width(width), m_height(height), m_depth((std::size_t)width * height, 1.0f)
+		{
+		}
+
+		// Clip-space vertices with w = 1, none outside the guard band.
+		void								Triangle(const float* a, const float* b, const float* c)
+		{
+			const float* v[3] = { a, b, c };
+			std::int64_t x[3], y[3];
+			double exactX[3], exactY[3], z[3];
+			for (int i = 0; i < 3; ++i)
+			{
+				float sx = (v[i][0] * 0.5f + 0.5f) * (float)m_width;
+				float sy = (0.5f - v[i][1] * 0.5f) * (float)m_height;
+				x[i] = (std::int64_t)std::nearbyint(sx * 8.0f);
+				y[i] = (std::int64_t)std::nearbyint(sy * 8.0f);
+				exactX[i] = sx;
+				exactY[i] = sy;
+				z[i] = std::clamp(v[i][2], 0.0f, 1.0f);
+			}
+
+			std::int64_t area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+			if (area <= 0)
+				return;
+			double exactArea = (exactX[1] - exactX[0]) * (exactY[2] - exactY[0]) - (exactY[1] - exactY[0]) * (exactX[2] - exactX[0]);
+
+			for (int py = 0; py < m_height; ++py)
+			{
+				for (int px = 0; px < m_width; ++px)
+				{
+					std::int64_t cx = px * 8 + 4, cy = py * 8 + 4;
+					double weights[3];
+					bool inside = true;
+					for (int i = 0; i < 3 && inside; ++i)
+					{
+						int j = (i + 1) % 3;
+						std::int64_t dx = x[j] - x[i], dy = y[j] - y[i];
+						std::int64_t edge = dx * (cy - y[i]) - dy * (cx - x[i]);
+						bool topLeft = dy < 0 || (dy == 0 && dx > 0);
+						inside = edge > 0 || (edge == 0 && topLeft);
+						weights[(i + 2) % 3] = (double)edge / area;
+					}
+					if (!inside)
+						continue;
+
+					// Snapping can turn a thin triangle over; OcclusionBuffer
+					// then falls back to the snapped positions.
+					if (exactArea > 0.0)
+					{
+						double qx = px + 0.5, qy = py + 0.5;
+						auto cross = [&](int m, int n) { return (exactX[m] - qx) * (exactY[n] - qy) - (exactY[m] - qy) * (exactX[n] - qx); };
+						weights[0] = cross(1, 2) / exactArea;
+						weights[1] = cross(2, 0) / exactArea;
+						weights[2] = 1.0 - weights[0] - weights[1];
+					}
+					float depth = (float)(weights[0] * z[0] + weights[1] * z[1] + weights[2] * z[2]);
+					float& pixel = m_depth[(std::size_t)py * m_width + px];
+					pixel = std::min(pixel, depth);
+				}
+			}
+		}
+
+		const std::vector<float>&			GetDepth()		const	{	return m_depth;	}
+
+	private:
+
+		int									m_width;
+		int									m_height;
+		std::vector<float>					m_depth;
+	};
+
+	struct Mesh
+	{
+		std::vector<float>					Positions;
+		std::vector<std::uint16_t>			Indices;
+
+		void								AddTo(OcclusionBuffer& buffer, const float* world = Identity)	const
+		{
+			buffer.AddOccluder(world, Positions.data(), 3 * sizeof(float), Indices.data(), (std::uint32_t)Indices.size());
+		}
+	};
+
+	// (n + 1)^2 vertices from (x0, y0) to (x1, y1) at depth z, interior
+	// vertices jittered, two clockwise triangles per cell.
+	Mesh Grid(int n, float x0, float y0, float x1, float y1, float z, float jitter, std::uint32_t seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> offset(-jitter, jitter);
+		Mesh mesh;
+		for (int row = 0; row <= n; ++row)
+		{
+			for (int column = 0; column <= n; ++column)
+			{
+				float x = x0 + (x1 - x0) * column / n + (column % n != 0 ? offset(random) : 0.0f);
+				float y = y0 + (y1 - y0) * row / n + (row % n != 0 ? offset(random) : 0.0f);
+				mesh.Positions.insert(mesh.Positions.end(), { x, y, z });
+			}
+		}
+		for (int row = 0; row < n; ++row)
+		{
+			for (int column = 0; column < n; ++column)
+			{
+				std::uint16_t a = (std::uint16_t)(row * (n + 1) + column);
+				std::uint16_t b = a + 1;
+				std::uint16_t c = (std::uint16_t)(a + n + 1);
+				std::uint16_t d = c + 1;
+				mesh.Indices.insert(mesh.Indices.end(), { a, c, b, b, c, d });
+			}
+		}
+		return mesh;
+	}
+
+	void Store(FXMMATRIX m, float* out)
+	{
+		XMStoreFloat4x4(reinterpret_cast<XMFLOAT4X4*>(out), m);
+	}
+
+	XMMATRIX ViewProj(FXMVECTOR eye, float aspect)
+	{
+		return XMMatrixMultiply(XMMatrixLookAtLH(eye, XMVectorZero(), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)),
+			XMMatrixPerspectiveFovLH(0.25f * XM_PI, aspect, 1.0f, 1000.0f));
+	}
+
+	void BoxCornerToClip(const float* viewProj, const float* center, const float* extents, int corner, double* clip)
+	{
+		double p[3] = { center[0] + (corner & 1 ? extents[0] : -extents[0]), center[1] + (corner & 2 ? extents[1] : -extents[1]), center[2] + (corner & 4 ? extents[2] : -extents[2]) };
+		for (int k = 0; k < 4; ++k)
+			clip[k] = p[0] * viewProj[k] + p[1] * viewProj[4 + k] + p[2] * viewProj[8 + k] + viewProj[12 + k];
+	}
+
+	bool CrossesNearPlane(const float* viewProj, const float* center, const float* extents)
+	{
+		for (int i = 0; i < 8; ++i)
+		{
+			double clip[4];
+			BoxCornerToClip(viewProj, center, extents, i, clip);
+			if (clip[2] < 0.0)
+				return true;
+		}
+		return false;
+	}
+
+	// Whether some point of the surface of a box in front of the near plane
+	// is at or in front of the depth buffer, found by rasterizing all twelve
+	// triangles in doubles.
+	bool BoxReachesDepth(const float* viewProj, const float* center, const float* extents, const OcclusionBuffer& buffer)
+	{
+		const int width = (int)buffer.GetWidth(), height = (int)buffer.GetHeight();
+		double sx[8], sy[8], sz[8];
+		for (int i = 0; i < 8; ++i)
+		{
+			double clip[4];
+			BoxCornerToClip(viewProj, center, extents, i, clip);
+			sx[i] = (clip[0] / clip[3] * 0.5 + 0.5) * width;
+			sy[i] = (0.5 - clip[1] / clip[3] * 0.5) * height;
+			sz[i] = clip[2] / clip[3];
+		}
+
+		const int faces[6][4] = { { 0, 2, 3, 1 }, { 4, 5, 7, 6 }, { 0, 4, 6, 2 }, { 1, 3, 7, 5 }, { 0, 1, 5, 4 }, { 2, 6, 7, 3 } };
+		for (const int* face : faces)
+		{
+			for (int t = 0; t < 2; ++t)
+			{
+				int a = face[0], b = face[1 + t], c = face[2 + t];
+				double area = (sx[b] - sx[a]) * (sy[c] - sy[a]) - (sy[b] - sy[a]) * (sx[c] - sx[a]);
+				if (std::fabs(area) < 1e-12)
+					continue;
+				int x0 = std::max(0, (int)std::floor(std::min({ sx[a], sx[b], sx[c] })));
+				int x1 = std::min(width - 1, (int)std::ceil(std::max({ sx[a], sx[b], sx[c] })));
+				int y0 = std::max(0, (int)std::floor(std::min({ sy[a], sy[b], sy[c] })));
+				int y1 = std::min(height - 1, (int)std::ceil(std::max({ sy[a], sy[b], sy[c] })));
+				for (int y = y0; y <= y1; ++y)
+				{
+					for (int x = x0; x <= x1; ++x)
+					{
+						double px = x + 0.5, py = y + 0.5;
+						double w0 = ((sx[b] - sx[a]) * (py - sy[a]) - (sy[b] - sy[a]) * (px - sx[a])) / area;
+						double w1 = ((sx[c] - sx[b]) * (py - sy[b]) - (sy[c] - sy[b]) * (px - sx[b])) / area;
+						double w2 = 1.0 - w0 - w1;
+						if (w0 < 0.0 || w1 < 0.0 || w2 < 0.0)
+							continue;
+						double z = w1 * sz[a] + w2 * sz[b] + w0 * sz[c];
+						if (z <= buffer.GetDepth()[(std::size_t)y * width + x])
+							return true;
+					}
+				}
+			}
+		}
+		return false;
+	}
+}
+
+TEST(OcclusionBuffer, SizesAreRoundedToBlocks)
+{
+	OcclusionBuffer buffer(100, 50);
+	EXPECT_EQ(buffer.GetWidth(), 104u);
+	EXPECT_EQ(buffer.GetHeight(), 56u);
+
+	buffer.BeginFrame(Identity);
+	buffer.Rasterize();
+	for (std::uint32_t i = 0; i < buffer.GetWidth() * buffer.GetHeight(); ++i)
+		ASSERT_EQ(buffer.GetDepth()[i], 1.0f);
+}
+
+TEST(OcclusionBuffer, MatchesAScalarRasterizer)
+{
+	// Random triangles reaching past the view but not the guard band, with
+	// horizontal edges and slivers thinner than the subpixel grid.
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> position(-1.6f, 1.6f);
+	std::uniform_real_distribution<float> depth(0.05f, 0.95f);
+	std::uniform_real_distribution<float> sliver(-0.02f, 0.02f);
+
+	for (int trial = 0; trial < 300; ++trial)
+	{
+		int width = 8 * (1 + random() % 40), height = 8 * (1 + random() % 24);
+		OcclusionBuffer buffer(width, height);
+		ScalarRasterizer reference(width, height);
+		buffer.BeginFrame(Identity);
+
+		Mesh mesh;
+		int triangles = 1 + random() % 20;
+		for (int t = 0; t < triangles; ++t)
+		{
+			float v[3][4];
+			for (float* p : v)
+			{
+				p[0] = position(random);
+				p[1] = position(random);
+				p[2] = depth(random);
+				p[3] = 1.0f;
+			}
+			if (trial % 3 == 0)
+				v[1][1] = v[0][1];
+			if (trial % 4 == 1)
+			{
+				for (int k = 1; k < 3; ++k)
+				{
+					v[k][0] = v[0][0] + sliver(random);
+					v[k][1] = v[0][1] + sliver(random);
+				}
+			}
+
+			for (const float* p : v)
+				mesh.Positions.insert(mesh.Positions.end(), { p[0], p[1], p[2] });
+			mesh.Indices.insert(mesh.Indices.end(), { (std::uint16_t)(3 * t), (std::uint16_t)(3 * t + 1), (std::uint16_t)(3 * t + 2) });
+			reference.Triangle(v[0], v[1], v[2]);
+		}
+		mesh.AddTo(buffer);
+		buffer.Rasterize();
+
+		for (int i = 0; i < width * height; ++i)
+		{
+			float expected = reference.GetDepth()[i];
+			float actual = buffer.GetDepth()[i];
+			ASSERT_EQ(actual < 1.0f, expected < 1.0f) << "trial " << trial << ", pixel " << i % width << ", " << i / width;
+			// Depth is evaluated in floats; slivers have steep planes, which
+			// builds contracting to FMA round differently.
+			ASSERT_NEAR(actual, expected, 1e-4f) << "trial " << trial << ", pixel " << i % width << ", " << i / width;
+		}
+	}
+}
+
+TEST(OcclusionBuffer, ClippingKeepsTheDepthPlane)
+{
+	// One triangle at a time, reaching past the guard band. Clipping moves
+	// the snapped ends of the clipped edges, so coverage may only differ
+	// within a pixel of an edge; the depth plane must not move.
+	std::mt19937 random(13);
+	std::uniform_real_distribution<float> position(-4.0f, 4.0f);
+	std::uniform_real_distribution<float> depth(0.05f, 0.95f);
+	const int width = 160, height = 96;
+
+	int clipped = 0;
+	for (int trial = 0; trial < 300; ++trial)
+	{
+		float v[3][4];
+		bool outsideGuardBand = false;
+		for (float* p : v)
+		{
+			p[0] = position(random);
+			p[1] = position(random);
+			p[2] = depth(random);
+			p[3] = 1.0f;
+			outsideGuardBand |= std::fabs(p[0]) > 2.0f || std::fabs(p[1]) > 2.0f;
+		}
+		clipped += outsideGuardBand;
+
+		Mesh mesh;
+		for (const float* p : v)
+			mesh.Positions.insert(mesh.Positions.end(), { p[0], p[1], p[2] });
+		mesh.Indices = { 0, 1, 2 };
+
+		OcclusionBuffer buffer(width, height);
+		buffer.BeginFrame(Identity);
+		mesh.AddTo(buffer);
+		buffer.Rasterize();
+
+		double sx[3], sy[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			sx[i] = (v[i][0] * 0.5 + 0.5) * width;
+			sy[i] = (0.5 - v[i][1] * 0.5) * height;
+		}
+		double area = (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sy[1] - sy[0]) * (sx[2] - sx[0]);
+
+		for (int y = 0; y < height; ++y)
+		{
+			for (int x = 0; x < width; ++x)
+			{
+				double px = x + 0.5, py = y + 0.5;
+				double nearestEdge = std::numeric_limits<double>::max();
+				double weights[3];
+				for (int i = 0; i < 3; ++i)
+				{
+					int j = (i + 1) % 3;
+					double edge = (sx[j] - sx[i]) * (py - sy[i]) - (sy[j] - sy[i]) * (px - sx[i]);
+					nearestEdge = std::min(nearestEdge, std::fabs(edge) / std::hypot(sx[j] - sx[i], sy[j] - sy[i]));
+					weights[(i + 2) % 3] = edge / area;
+				}
+				bool inside = area > 0.0 && weights[0] >= 0.0 && weights[1] >= 0.0 && weights[2] >= 0.0;
+
+				float actual = buffer.GetDepth()[(std::size_t)y * width + x];
+				if (nearestEdge > 1.0)
+				{
+					ASSERT_EQ(actual < 1.0f, inside) << "trial " << trial << ", pixel " << x << ", " << y;
+				}
+				if (actual < 1.0f && area > 0.0)
+				{
+					double expected = weights[0] * v[0][2] + weights[1] * v[1][2] + weights[2] * v[2][2];
+					ASSERT_NEAR(actual, expected, 1e-5) << "trial " << trial << ", pixel " << x << ", " << y;
+				}
+			}
+		}
+	}
+	EXPECT_GT(clipped, 200);
+}
+
+TEST(OcclusionBuffer, MeshesAreWatertight)
+{
+	// Jittered grids over the view, inside and past the guard band: every
+	// pixel is covered exactly once, so it holds the grid's depth.
+	const float extents[] = { 1.2f, 3.0f };
+	for (float extent : extents)
+	{
+		OcclusionBuffer buffer(320, 192);
+		buffer.BeginFrame(Identity);
+		Mesh grid = Grid(16, -extent, -extent, extent, extent, 0.5f, 0.03f * extent, 3);
+		grid.AddTo(buffer);
+		buffer.Rasterize();
+
+		for (std::uint32_t i = 0; i < buffer.GetWidth() * buffer.GetHeight(); ++i)
+			ASSERT_EQ(buffer.GetDepth()[i], 0.5f) << "extent " << extent << ", pixel " << i;
+	}
+}
+
+TEST(OcclusionBuffer, PerspectiveMeshesCrossingTheNearPlaneAreWatertight)
+{
+	// A floor from behind the camera to the distance, turned about y.
+	XMMATRIX proj = XMMatrixPerspectiveFovLH(0.25f * XM_PI, 320.0f / 192.0f, 1.0f, 100.0f);
+	float viewProj[16];
+	Store(proj, viewProj);
+
+	for (std::uint32_t seed = 0; seed < 100; ++seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> offset(-0.3f, 0.3f);
+		std::uniform_real_distribution<float> angle(-0.6f, 0.6f);
+		float world[16];
+		Store(XMMatrixMultiply(XMMatrixRotationY(angle(random)), XMMatrixTranslation(offset(random), offset(random), 3.0f + offset(random))), world);
+
+		// The grid's y is the floor's z.
+		Mesh floor = Grid(10, -30.0f, -5.0f, 30.0f, 40.0f, 0.0f, 0.3f, seed);
+		for (std::size_t v = 0; v < floor.Positions.size(); v += 3)
+		{
+			floor.Positions[v + 2] = floor.Positions[v + 1];
+			floor.Positions[v + 1] = -1.0f;
+		}
+
+		OcclusionBuffer buffer(320, 192);
+		buffer.BeginFrame(viewProj);
+		floor.AddTo(buffer, world);
+		buffer.Rasterize();
+		ASSERT_GT(buffer.GetStats().Triangles, 0u);
+
+		// A crack shows as an empty pixel between two covered ones.
+		const float* depth = buffer.GetDepth();
+		const int width = (int)buffer.GetWidth(), height = (int)buffer.GetHeight();
+		for (int y = 1; y < height - 1; ++y)
+		{
+			for (int x = 1; x < width - 1; ++x)
+			{
+				int i = y * width + x;
+				if (depth[i] < 1.0f)
+					continue;
+				ASSERT_FALSE(depth[i - 1] < 1.0f && depth[i + 1] < 1.0f) << "seed " << seed << ", pixel " << x << ", " << y;
+				ASSERT_FALSE(depth[i - width] < 1.0f && depth[i + width] < 1.0f) << "seed " << seed << ", pixel " << x << ", " << y;
+			}
+		}
+	}
+}
+
+TEST(OcclusionBuffer, BoxesBehindAWallAreHidden)
+{
+	float viewProj[16];
+	Store(ViewProj(XMVectorSet(0.0f, 0.0f, -10.0f, 1.0f), 320.0f / 192.0f), viewProj);
+
+	// The engine's box, 4 x 4 x 1, at the origin.
+	CreateGeometry::MeshData box = CreateGeometry().CreateBox(4.0f, 4.0f, 1.0f, 0);
+	OcclusionBuffer buffer(320, 192);
+	buffer.BeginFrame(viewProj);
+	buffer.AddOccluder(Identity, box.Vertices.data(), sizeof(CreateGeometry::Vertex), box.GetIndices16().data(), (std::uint32_t)box.GetIndices16().size());
+	buffer.Rasterize();
+	EXPECT_EQ(buffer.GetStats().Occluders, 1u);
+	EXPECT_GT(buffer.GetStats().Triangles, 0u);
+
+	const float extents[3] = { 1.0f, 1.0f, 1.0f };
+	const float behind[3] = { 0.0f, 0.0f, 5.0f };
+	const float inFront[3] = { 0.0f, 0.0f, -3.0f };
+	const float pastTheEdge[3] = { 6.0f, 0.0f, 5.0f };
+	const float outOfView[3] = { 200.0f, 0.0f, 5.0f };
+	const float atTheEye[3] = { 0.0f, 0.0f, -10.0f };
+	EXPECT_FALSE(buffer.IsVisible(behind, extents));
+	EXPECT_TRUE(buffer.IsVisible(inFront, extents));
+	EXPECT_TRUE(buffer.IsVisible(pastTheEdge, extents));
+	EXPECT_FALSE(buffer.IsVisible(outOfView, extents));
+	EXPECT_TRUE(buffer.IsVisible(atTheEye, extents));
+
+	// Nothing is hidden once the next frame starts.
+	buffer.BeginFrame(viewProj);
+	buffer.Rasterize();
+	EXPECT_TRUE(buffer.IsVisible(behind, extents));
+}
+
+TEST(OcclusionBuffer, NeverHidesAVisibleBox)
+{
+	// Random views of random boxes on the ground, against random boxes
+	// tested whole: a box is hidden only if no point of its surface is in
+	// front of the depth buffer.
+	CreateGeometry::MeshData box = CreateGeometry().CreateBox(2.0f, 2.0f, 2.0f, 0);
+	std::mt19937 random(11);
+	std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+	std::uniform_real_distribution<float> size(0.2f, 4.0f);
+
+	int hidden = 0;
+	for (int frame = 0; frame < 60; ++frame)
+	{
+		float viewProj[16];
+		Store(ViewProj(XMVectorSet(position(random), 2.0f * size(random), position(random), 1.0f), 320.0f / 192.0f), viewProj);
+
+		OcclusionBuffer buffer(320, 192);
+		buffer.BeginFrame(viewProj);
+		for (int occluder = 0; occluder < 8; ++occluder)
+		{
+			float world[16];
+			Store(XMMatrixMultiply(XMMatrixScaling(size(random), size(random), size(random)),
+				XMMatrixTranslation(0.5f * position(random), 0.0f, 0.5f * position(random))), world);
+			buffer.AddOccluder(world, box.Vertices.data(), sizeof(CreateGeometry::Vertex), box.GetIndices16().data(), (std::uint32_t)box.GetIndices16().size());
+		}
+		buffer.Rasterize();
+
+		for (int i = 0; i < 200; ++i)
+		{
+			const float center[3] = { position(random), 0.3f * position(random), position(random) };
+			const float extents[3] = { 0.3f * size(random), 0.3f * size(random), 0.3f * size(random) };
+			if (buffer.IsVisible(center, extents))
+				continue;
+			hidden++;
+
+			// Boxes crossing the near plane but outside the view are hidden
+			// too; there is nothing to rasterize for them.
+			if (CrossesNearPlane(viewProj, center, extents))
+				continue;
+			ASSERT_FALSE(BoxReachesDepth(viewProj, center, extents, buffer)) << "frame " << frame << ", box " << i;
+		}
+	}
+	// Enough boxes hidden for the check to mean something.
+	EXPECT_GT(hidden, 500);
+}
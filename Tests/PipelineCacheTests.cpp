@@ -0,0 +1,179 @@
+#include "PipelineCache.h"
+#include "PipelineKey.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace
+{
+	// A render target's blend state, keyed the way HashGraphicsPipelineDesc
+	// keys D3D12_RENDER_TARGET_BLEND_DESC.
+	struct BlendState
+	{
+		bool									BlendEnable = false;
+		std::uint32_t							SrcBlend = 2;
+		std::uint32_t							DestBlend = 1;
+		std::uint32_t							WriteMask = 0xf;
+	};
+
+	std::uint64_t Key(const BlendState& blend, std::uint64_t rootSignatureHash = 1)
+	{
+		PipelineKeyBuilder key(rootSignatureHash);
+		if (key.Enabled(blend.BlendEnable))
+			key.Value(blend.SrcBlend).Value(blend.DestBlend);
+		key.Value(blend.WriteMask);
+		return key.Get();
+	}
+}
+
+TEST(PipelineKey, ShadersAreIdentifiedByTheirBytecodeHash)
+{
+	const std::string vs = "DXBC vertex";
+	const std::string copy = vs;
+	ASSERT_NE(vs.data(), copy.data());
+
+	// The same bytecode at another address is the same shader.
+	std::uint64_t a = PipelineKeyBuilder(1).Shader(vs.data(), vs.size()).Get();
+	EXPECT_EQ(PipelineKeyBuilder(1).Shader(copy.data(), copy.size()).Get(), a);
+	EXPECT_EQ(PipelineKeyBuilder(1).Shader(ShaderBytecode::HashOf(vs.data(), vs.size())).Get(), a);
+
+	const std::string other = "DXBC vertey";
+	EXPECT_NE(PipelineKeyBuilder(1).Shader(other.data(), other.size()).Get(), a);
+
+	// A missing stage, however it is spelled.
+	std::uint64_t none = PipelineKeyBuilder(1).Shader(nullptr, 0).Get();
+	EXPECT_EQ(PipelineKeyBuilder(1).Shader(vs.data(), 0).Get(), none);
+	EXPECT_NE(none, a);
+}
+
+TEST(PipelineKey, RootSignatureAndOrderChangeTheKey)
+{
+	EXPECT_NE(PipelineKeyBuilder(1).Get(), PipelineKeyBuilder(2).Get());
+
+	std::uint64_t ab = PipelineKeyBuilder(1).Value(1u).Value(2u).Get();
+	EXPECT_NE(PipelineKeyBuilder(1).Value(2u).Value(1u).Get(), ab);
+	EXPECT_EQ(PipelineKeyBuilder(1).Value(1u).Value(2u).Get(), ab);
+}
+
+TEST(PipelineKey, NullAndEmptyNamesAreTheSame)
+{
+	EXPECT_EQ(PipelineKeyBuilder(1).Name(nullptr).Get(), PipelineKeyBuilder(1).Name("").Get());
+	EXPECT_NE(PipelineKeyBuilder(1).Name("POSITION").Get(), PipelineKeyBuilder(1).Name("").Get());
+
+	// Names are length-prefixed: the split between two of them matters.
+	EXPECT_NE(PipelineKeyBuilder(1).Name("POS").Name("ITION").Get(), PipelineKeyBuilder(1).Name("POSITION").Name("").Get());
+}
+
+TEST(PipelineKey, OnlyTheUsedPrefixOfAnArrayCounts)
+{
+	std::uint32_t formats[8] = { 28, 0, 0, 0, 0, 0, 0, 0 };
+	std::uint64_t one = PipelineKeyBuilder(1).Prefix(formats, 1).Get();
+
+	// Leftovers past NumRenderTargets are ignored.
+	formats[1] = 87;
+	EXPECT_EQ(PipelineKeyBuilder(1).Prefix(formats, 1).Get(), one);
+	EXPECT_NE(PipelineKeyBuilder(1).Prefix(formats, 2).Get(), one);
+
+	// The count is part of the key, even for equal values.
+	std::uint32_t zeros[2] = {};
+	EXPECT_NE(PipelineKeyBuilder(1).Prefix(zeros, 1).Get(), PipelineKeyBuilder(1).Prefix(zeros, 2).Get());
+}
+
+TEST(PipelineKey, SettingsOfADisabledFeatureAreIgnored)
+{
+	BlendState off;
+	BlendState offOtherFactors = off;
+	offOtherFactors.SrcBlend = 5;
+	offOtherFactors.DestBlend = 6;
+	EXPECT_EQ(Key(offOtherFactors), Key(off));
+
+	BlendState on = off;
+	on.BlendEnable = true;
+	BlendState onOtherFactors = offOtherFactors;
+	onOtherFactors.BlendEnable = true;
+	EXPECT_NE(Key(on), Key(off));
+	EXPECT_NE(Key(onOtherFactors), Key(on));
+
+	// Fields outside the switch count either way.
+	BlendState masked = off;
+	masked.WriteMask = 0x7;
+	EXPECT_NE(Key(masked), Key(off));
+}
+
+TEST(PipelineCache, CreatesEachKeyOnce)
+{
+	PipelineCache<std::shared_ptr<int>> cache(2);
+	std::atomic<int> creations{ 0 };
+	auto create = [&creations]() { creations++; return std::make_shared<int>(7); };
+
+	cache.Request(1, create);
+	cache.Request(1, create);
+	std::shared_ptr<int> pipeline = cache.Get(1, create);
+	ASSERT_NE(pipeline, nullptr);
+	EXPECT_EQ(*pipeline, 7);
+	EXPECT_EQ(cache.Get(1, create), pipeline);
+	EXPECT_EQ(creations, 1);
+
+	PipelineCache<std::shared_ptr<int>>::Stats stats = cache.GetStats();
+	EXPECT_EQ(stats.Requests, 4u);
+	EXPECT_EQ(stats.Hits, 3u);
+	EXPECT_EQ(stats.Creations, 1u);
+}
+
+TEST(PipelineCache, RequestsCompileInTheBackground)
+{
+	PipelineCache<std::shared_ptr<int>> cache(1);
+	std::thread::id caller = std::this_thread::get_id();
+	std::atomic<bool> onCaller{ true };
+
+	for (std::uint64_t key = 0; key < 8; ++key)
+	{
+		cache.Request(key, [&onCaller, caller, key]()
+		{
+			onCaller = std::this_thread::get_id() == caller;
+			return std::make_shared<int>((int)key);
+		});
+	}
+	cache.WaitIdle();
+	EXPECT_FALSE(onCaller);
+
+	for (std::uint64_t key = 0; key < 8; ++key)
+	{
+		std::shared_ptr<int> pipeline;
+		ASSERT_TRUE(cache.TryGet(key, pipeline));
+		EXPECT_EQ(*pipeline, (int)key);
+		EXPECT_EQ(cache.GetState(key), PipelineCache<std::shared_ptr<int>>::State::Ready);
+	}
+	EXPECT_EQ(cache.GetState(100), PipelineCache<std::shared_ptr<int>>::State::Missing);
+}
+
+TEST(PipelineCache, GetTakesOverAQueuedCreation)
+{
+	// Without workers nothing runs until Get() or WaitIdle().
+	PipelineCache<std::shared_ptr<int>> cache(0);
+	cache.Request(1, []() { return std::make_shared<int>(1); });
+	EXPECT_EQ(cache.GetState(1), PipelineCache<std::shared_ptr<int>>::State::Queued);
+
+	std::shared_ptr<int> pipeline;
+	EXPECT_FALSE(cache.TryGet(1, pipeline));
+	EXPECT_EQ(*cache.Get(1, nullptr), 1);
+	cache.WaitIdle();
+	EXPECT_EQ(cache.GetStats().Creations, 1u);
+}
+
+TEST(PipelineCache, FailuresAreRethrownToEveryCaller)
+{
+	PipelineCache<std::shared_ptr<int>> cache(1);
+	auto fail = []() -> std::shared_ptr<int> { throw std::runtime_error("E_INVALIDARG"); };
+
+	EXPECT_THROW(cache.Get(1, fail), std::runtime_error);
+	EXPECT_THROW(cache.Get(1, fail), std::runtime_error);
+	EXPECT_EQ(cache.GetState(1), PipelineCache<std::shared_ptr<int>>::State::Failed);
+
+	// Returning nothing counts as a failure too.
+	EXPECT_THROW(cache.Get(2, []() { return std::shared_ptr<int>(); }), std::runtime_error);
+	EXPECT_EQ(cache.GetStats().Creations, 2u);
+}
@@ -0,0 +1,100 @@
+#include "Profiler.h"
+#include "GameTimer.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	size_t Count(const std::string& text, const std::string& pattern)
+	{
+		size_t count = 0;
+		for (size_t at = text.find(pattern); at != std::string::npos; at = text.find(pattern, at + 1))
+			count++;
+		return count;
+	}
+}
+
+TEST(Profiler, ExportsZonesAndCounters)
+{
+	Profiler& profiler = Profiler::Get();
+	profiler.Clear();
+	{
+		PROFILE_SCOPE("outer zone");
+		PROFILE_SCOPE("inner \"zone\"");
+		PROFILE_COUNTER("test counter", 42);
+	}
+
+	std::string trace = profiler.ExportChromeTrace();
+	EXPECT_EQ(Count(trace, "\"name\":\"outer zone\",\"ph\":\"X\""), 1u);
+	EXPECT_EQ(Count(trace, "\"name\":\"inner \\\"zone\\\"\",\"ph\":\"X\""), 1u);
+	EXPECT_EQ(Count(trace, "\"args\":{\"depth\":1}"), 1u);
+	EXPECT_EQ(Count(trace, "\"name\":\"test counter\",\"ph\":\"C\""), 1u);
+	EXPECT_EQ(Profiler::ThreadDepth(), 0u);
+
+	profiler.Clear();
+	EXPECT_EQ(Count(profiler.ExportChromeTrace(), "outer zone"), 0u);
+}
+
+TEST(Profiler, ConcurrentWritersCreateATrackOnce)
+{
+	Profiler& profiler = Profiler::Get();
+	profiler.Clear();
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 8; ++t)
+	{
+		threads.emplace_back([]
+		{
+			for (int i = 0; i < 1000; ++i)
+				Profiler::Get().RecordTrackZone("concurrent track", "track zone", i, i + 1, 0);
+		});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+
+	std::string trace = profiler.ExportChromeTrace();
+	EXPECT_EQ(Count(trace, "\"args\":{\"name\":\"concurrent track\"}"), 1u);
+	EXPECT_EQ(Count(trace, "\"name\":\"track zone\""), 8000u);
+}
+
+TEST(Profiler, ClearWhileWritersRecord)
+{
+	Profiler& profiler = Profiler::Get();
+	profiler.Clear();
+
+	std::atomic<bool> stop { false };
+	std::atomic<std::uint64_t> written { 0 };
+	std::thread writer([&]
+	{
+		PROFILE_THREAD_NAME("clear test writer");
+		while (!stop.load())
+		{
+			PROFILE_SCOPE("writer zone");
+			written++;
+		}
+	});
+
+	while (written.load() < 2 * Profiler::EventsPerThread)
+		std::this_thread::yield();
+	profiler.Clear();
+	std::uint64_t clearedAt = written.load();
+	while (written.load() < clearedAt + 1000)
+		std::this_thread::yield();
+	stop = true;
+	writer.join();
+
+	// Only the zone in flight when Clear ran may start before the new epoch.
+	std::string trace = profiler.ExportChromeTrace();
+	size_t early = 0;
+	for (size_t at = trace.find("\"name\":\"writer zone\""); at != std::string::npos; at = trace.find("\"name\":\"writer zone\"", at + 1))
+	{
+		size_t ts = trace.find("\"ts\":", at);
+		ASSERT_NE(ts, std::string::npos);
+		if (trace[ts + 5] == '-')
+			early++;
+	}
+	EXPECT_LE(early, 1u);
+	EXPECT_GE(Count(trace, "\"name\":\"writer zone\""), 1000u);
+}
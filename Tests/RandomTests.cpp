@@ -0,0 +1,343 @@
+#include "Random.h"
+#include "MathHelper.h"
+#include <gtest/gtest.h>
+#include <climits>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// The published xoshiro256++ and splitmix64, written out independently.
+	class ReferenceXoshiro
+	{
+	public:
+
+		explicit							ReferenceXoshiro(std::uint64_t seed)
+		{
+			for (std::uint64_t& word : m_s)
+			{
+				std::uint64_t z = (seed += 0x9e3779b97f4a7c15ull);
+				z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+				z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+				word = z ^ (z >> 31);
+			}
+		}
+
+		std::uint64_t						Next()
+		{
+			const std::uint64_t result = Rotl(m_s[0] + m_s[3], 23) + m_s[0];
+			const std::uint64_t t = m_s[1] << 17;
+			m_s[2] ^= m_s[0];
+			m_s[3] ^= m_s[1];
+			m_s[1] ^= m_s[2];
+			m_s[0] ^= m_s[3];
+			m_s[2] ^= t;
+			m_s[3] = Rotl(m_s[3], 45);
+			return result;
+		}
+
+	private:
+
+		static std::uint64_t				Rotl(std::uint64_t x, int k)	{	return (x << k) | (x >> (64 - k));	}
+
+		std::uint64_t						m_s[4];
+	};
+
+	// Pearson's statistic of `counts` against equally likely buckets.
+	double ChiSquare(const std::vector<std::uint64_t>& counts)
+	{
+		std::uint64_t total = 0;
+		for (std::uint64_t count : counts)
+			total += count;
+		const double expected = (double)total / counts.size();
+		double chi2 = 0.0;
+		for (std::uint64_t count : counts)
+			chi2 += (count - expected) * (count - expected) / expected;
+		return chi2;
+	}
+
+	// Far beyond the 1e-6 tail of the chi-square distribution with 63 and
+	// 2 degrees of freedom: the sequences are fixed, so these only fail on
+	// a real bias.
+	const double Chi2Limit63 = 140.0;
+	const double Chi2Limit2 = 30.0;
+
+	// A bound of 3 * 2^30 is where bias shows most: `% bound` makes the
+	// first third of the range twice as likely, and multiply-shift without
+	// redraws makes every third value twice as likely.
+	const std::uint32_t SkewedBound = 3u << 30;
+
+	void ExpectUnbiased(const std::vector<std::uint32_t>& values)
+	{
+		std::vector<std::uint64_t> thirds(3), residues(3);
+		for (std::uint32_t value : values)
+		{
+			ASSERT_LT(value, SkewedBound);
+			thirds[value >> 30]++;
+			residues[value % 3]++;
+		}
+		EXPECT_LT(ChiSquare(thirds), Chi2Limit2);
+		EXPECT_LT(ChiSquare(residues), Chi2Limit2);
+	}
+}
+
+TEST(Random, MatchesTheReferenceGenerator)
+{
+	const std::uint64_t seeds[] = { 0, 1, Random::DefaultSeed, ~0ull };
+	for (std::uint64_t seed : seeds)
+	{
+		Random random(seed);
+		ReferenceXoshiro reference(seed);
+		for (int i = 0; i < 1000; ++i)
+			ASSERT_EQ(random.Next(), reference.Next()) << "seed " << seed << ", output " << i;
+	}
+
+	// Seed() starts over.
+	Random random(5);
+	std::uint64_t first = random.Next();
+	random.Next();
+	random.Seed(5);
+	EXPECT_EQ(random.Next(), first);
+}
+
+TEST(Random, JumpedSequencesDoNotMeet)
+{
+	Random random(9);
+	Random jumped(9);
+	jumped.Jump();
+	std::vector<std::uint64_t> head;
+	for (int i = 0; i < 4096; ++i)
+		head.push_back(random.Next());
+	std::sort(head.begin(), head.end());
+	for (int i = 0; i < 4096; ++i)
+		ASSERT_FALSE(std::binary_search(head.begin(), head.end(), jumped.Next()));
+}
+
+TEST(Random, FloatsAreUniformInTheHalfOpenRange)
+{
+	Random random(17);
+	std::vector<std::uint64_t> buckets(64);
+	double sum = 0.0;
+	const int samples = 1 << 20;
+	for (int i = 0; i < samples; ++i)
+	{
+		float value = random.NextFloat();
+		ASSERT_GE(value, 0.0f);
+		ASSERT_LT(value, 1.0f);
+		buckets[(int)(value * 64.0f)]++;
+		sum += value;
+	}
+	EXPECT_LT(ChiSquare(buckets), Chi2Limit63);
+	EXPECT_NEAR(sum / samples, 0.5, 1e-3);
+}
+
+TEST(Random, FloatRangesNeverReturnTheUpperBound)
+{
+	// a + x * (b - a) rounds up to b for most x when b is the next float
+	// after a, and for some x on wide ranges.
+	struct Range { float A, B; };
+	const Range ranges[] = { { 1.0f, std::nextafter(1.0f, 2.0f) }, { -1.0f, 1.0f }, { 100.0f, 100.5f }, { 0.0f, 1e-30f } };
+	for (const Range& range : ranges)
+	{
+		Random random(23);
+		std::vector<float> batch(4099);
+		random.FillFloats(batch.data(), batch.size(), range.A, range.B);
+		for (int i = 0; i < 100000; ++i)
+		{
+			float value = random.NextFloat(range.A, range.B);
+			ASSERT_GE(value, range.A);
+			ASSERT_LT(value, range.B);
+		}
+		for (float value : batch)
+		{
+			ASSERT_GE(value, range.A);
+			ASSERT_LT(value, range.B);
+		}
+
+		float helper = MathHelper::RandF(range.A, range.B);
+		EXPECT_GE(helper, range.A);
+		EXPECT_LT(helper, range.B);
+	}
+
+	// Reversed ranges run from a down to b, b still excluded.
+	const Range reversed[] = { { 1.0f, -1.0f }, { std::nextafter(1.0f, 2.0f), 1.0f }, { 5.0f, -3.0f } };
+	for (const Range& range : reversed)
+	{
+		Random random(27);
+		std::vector<float> batch(4099);
+		random.FillFloats(batch.data(), batch.size(), range.A, range.B);
+		batch.push_back(MathHelper::RandF(range.A, range.B));
+		float low = range.A, high = range.A;
+		for (int i = 0; i < 100000; ++i)
+			batch.push_back(random.NextFloat(range.A, range.B));
+		for (float value : batch)
+		{
+			ASSERT_LE(value, range.A);
+			ASSERT_GT(value, range.B);
+			low = std::min(low, value);
+			high = std::max(high, value);
+		}
+		// Not stuck at a: the whole range is reached.
+		EXPECT_LT(low - range.B, (range.A - range.B) * 0.01f + 1e-6f);
+		EXPECT_GT(high - range.B, (range.A - range.B) * 0.99f - 1e-6f);
+	}
+
+	// An empty range gives its bound.
+	Random random(29);
+	EXPECT_EQ(random.NextFloat(2.0f, 2.0f), 2.0f);
+	float batch[5];
+	random.FillFloats(batch, 5, 2.0f, 2.0f);
+	for (float value : batch)
+		EXPECT_EQ(value, 2.0f);
+}
+
+TEST(Random, IntegerRangesAreUnbiased)
+{
+	Random random(31);
+	std::vector<std::uint32_t> values(300000);
+	for (std::uint32_t& value : values)
+		value = random.NextUInt(SkewedBound);
+	ExpectUnbiased(values);
+
+	EXPECT_EQ(random.NextUInt(0), 0u);
+	EXPECT_EQ(random.NextUInt(1), 0u);
+
+	// Both ends of NextInt's range come out, equally often.
+	std::vector<std::uint64_t> counts(5);
+	for (int i = 0; i < 50000; ++i)
+	{
+		std::int32_t value = random.NextInt(-2, 2);
+		ASSERT_GE(value, -2);
+		ASSERT_LE(value, 2);
+		counts[value + 2]++;
+	}
+	EXPECT_LT(ChiSquare(counts), Chi2Limit2 + 10.0);
+
+	// The whole int range, where the width wraps to 0.
+	bool negative = false, positive = false;
+	for (int i = 0; i < 64; ++i)
+	{
+		std::int32_t value = random.NextInt(INT_MIN, INT_MAX);
+		negative |= value < 0;
+		positive |= value > 0;
+	}
+	EXPECT_TRUE(negative && positive);
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		int value = MathHelper::Rand(3, 4);
+		ASSERT_TRUE(value == 3 || value == 4);
+	}
+}
+
+TEST(Random, UnitVectorsAreUniformOnTheSphere)
+{
+	// Uniform on the sphere means z uniform in [-1, 1] and the angle around
+	// z uniform.
+	Random random(37);
+	std::vector<std::uint64_t> heights(64), angles(64);
+	double sum[3] = {};
+	const int samples = 1 << 18;
+	for (int i = 0; i < samples; ++i)
+	{
+		float v[3];
+		random.UnitVector(v);
+		ASSERT_NEAR(v[0] * v[0] + v[1] * v[1] + v[2] * v[2], 1.0f, 1e-5f);
+		heights[std::min((int)((v[2] + 1.0f) * 32.0f), 63)]++;
+		angles[std::min((int)((std::atan2(v[1], v[0]) + MathHelper::Pi) / (2.0f * MathHelper::Pi) * 64.0f), 63)]++;
+		for (int k = 0; k < 3; ++k)
+			sum[k] += v[k];
+	}
+	EXPECT_LT(ChiSquare(heights), Chi2Limit63);
+	EXPECT_LT(ChiSquare(angles), Chi2Limit63);
+	for (int k = 0; k < 3; ++k)
+		EXPECT_NEAR(sum[k] / samples, 0.0, 5e-3);
+}
+
+TEST(Random, HemisphereVectorsAreUniformOnTheirSide)
+{
+	// Not normalized, and off the axes.
+	const float n[3] = { 0.0f, 3.0f, 4.0f };
+	Random random(41);
+	std::vector<std::uint64_t> heights(64);
+	const int samples = 1 << 18;
+	for (int i = 0; i < samples; ++i)
+	{
+		float v[3];
+		random.HemisphereVector(n, v);
+		ASSERT_NEAR(v[0] * v[0] + v[1] * v[1] + v[2] * v[2], 1.0f, 1e-5f);
+		float cosine = (n[0] * v[0] + n[1] * v[1] + n[2] * v[2]) / 5.0f;
+		ASSERT_GE(cosine, 0.0f);
+		heights[std::min((int)(cosine * 64.0f), 63)]++;
+	}
+	EXPECT_LT(ChiSquare(heights), Chi2Limit63);
+
+	XMVECTOR v = MathHelper::RandHemisphereUnitVec3(XMVectorSet(0.0f, 0.0f, -1.0f, 0.0f));
+	EXPECT_LE(XMVectorGetZ(v), 0.0f);
+	EXPECT_NEAR(XMVectorGetX(XMVector3Length(v)), 1.0f, 1e-5f);
+}
+
+TEST(Random, BatchesDependOnlyOnTheSeed)
+{
+	Random a(43), b(43);
+	// Next() does not touch the batch streams.
+	for (int i = 0; i < 10; ++i)
+		b.Next();
+
+	// Counts that are not a multiple of the lane count.
+	std::vector<float> floatsA(1001), floatsB(1001);
+	a.FillFloats(floatsA.data(), floatsA.size());
+	b.FillFloats(floatsB.data(), floatsB.size());
+	EXPECT_EQ(floatsA, floatsB);
+
+	std::vector<std::uint32_t> uintsA(13), uintsB(13);
+	a.FillUInts(uintsA.data(), uintsA.size(), 1000);
+	b.FillUInts(uintsB.data(), uintsB.size(), 1000);
+	EXPECT_EQ(uintsA, uintsB);
+
+	// Batches go on where they left off.
+	std::vector<float> next(1001);
+	a.FillFloats(next.data(), next.size());
+	EXPECT_NE(next, floatsA);
+}
+
+TEST(Random, BatchesAreUniform)
+{
+	Random random(47);
+	std::vector<float> floats(1 << 20);
+	random.FillFloats(floats.data(), floats.size(), -3.0f, 5.0f);
+	std::vector<std::uint64_t> buckets(64);
+	for (float value : floats)
+	{
+		ASSERT_GE(value, -3.0f);
+		ASSERT_LT(value, 5.0f);
+		buckets[(int)((value + 3.0f) * 8.0f)]++;
+	}
+	EXPECT_LT(ChiSquare(buckets), Chi2Limit63);
+
+	std::vector<std::uint32_t> values(300000);
+	random.FillUInts(values.data(), values.size(), SkewedBound);
+	ExpectUnbiased(values);
+
+	std::vector<std::uint32_t> zeros(7, 1u);
+	random.FillUInts(zeros.data(), zeros.size(), 0);
+	EXPECT_EQ(zeros, std::vector<std::uint32_t>(7, 0u));
+}
+
+TEST(Random, ThreadsGetTheirOwnGenerators)
+{
+	Random& mine = Random::ThreadLocal();
+	EXPECT_EQ(&mine, &Random::ThreadLocal());
+
+	std::uint64_t here = Random(mine).Next();
+	std::uint64_t there = 0;
+	Random* theirs = nullptr;
+	std::thread thread([&]
+	{
+		theirs = &Random::ThreadLocal();
+		there = theirs->Next();
+	});
+	thread.join();
+	EXPECT_NE(theirs, &mine);
+	EXPECT_NE(here, there);
+}
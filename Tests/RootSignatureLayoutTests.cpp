@@ -0,0 +1,161 @@
+#include "RootSignatureLayout.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+	DescriptorRange Range(DescriptorRangeType type, std::uint32_t count, std::uint32_t baseRegister, std::uint32_t offset = DescriptorRange::Append)
+	{
+		DescriptorRange range;
+		range.Type = type;
+		range.Count = count;
+		range.BaseRegister = baseRegister;
+		range.Offset = offset;
+		return range;
+	}
+
+	StaticSampler Sampler(std::uint32_t shaderRegister, std::uint32_t space = 0)
+	{
+		StaticSampler sampler;
+		sampler.Register = shaderRegister;
+		sampler.Space = space;
+		return sampler;
+	}
+
+	// The renderer's layout: two root CBVs and the draw id.
+	RootSignatureLayout SceneLayout()
+	{
+		return RootSignatureBuilder().AddConstantBuffer(0).AddConstantBuffer(1).AddConstants(1, 2).SetFlags(1).Build();
+	}
+}
+
+TEST(RootSignatureLayout, EquivalentTablesCanonicalizeToTheSameLayout)
+{
+	// t0-t1 then t2-t4 appended, against t0-t4 in one range at offset 0.
+	RootSignatureLayout split = RootSignatureBuilder()
+		.AddTable({ Range(DescriptorRangeType::ShaderResource, 2, 0), Range(DescriptorRangeType::ShaderResource, 3, 2) })
+		.Build();
+	RootSignatureLayout whole = RootSignatureBuilder()
+		.AddTable({ Range(DescriptorRangeType::ShaderResource, 5, 0, 0) })
+		.Build();
+	EXPECT_EQ(split, whole);
+	EXPECT_EQ(split.GetHash(), whole.GetHash());
+	ASSERT_EQ(split.Parameters[0].Ranges.size(), 1u);
+	EXPECT_EQ(split.Parameters[0].Ranges[0].Count, 5u);
+
+	// Ranges given out of order are sorted by offset.
+	RootSignatureLayout reversed = RootSignatureBuilder()
+		.AddTable({ Range(DescriptorRangeType::ShaderResource, 3, 2, 2), Range(DescriptorRangeType::ShaderResource, 2, 0, 0) })
+		.Build();
+	EXPECT_EQ(reversed, whole);
+
+	// Ranges of different types stay apart.
+	RootSignatureLayout mixed = RootSignatureBuilder()
+		.AddTable({ Range(DescriptorRangeType::ShaderResource, 2, 0), Range(DescriptorRangeType::UnorderedAccess, 3, 2) })
+		.Build();
+	EXPECT_EQ(mixed.Parameters[0].Ranges.size(), 2u);
+	EXPECT_NE(mixed.GetHash(), whole.GetHash());
+}
+
+TEST(RootSignatureLayout, UnusedFieldsAndSamplerOrderDoNotMatter)
+{
+	RootSignatureBuilder a;
+	a.AddConstantBuffer(0).AddStaticSampler(Sampler(1)).AddStaticSampler(Sampler(0));
+	RootSignatureBuilder b;
+	b.AddConstantBuffer(0).AddStaticSampler(Sampler(0)).AddStaticSampler(Sampler(1));
+
+	RootSignatureLayout first = a.Build();
+	RootSignatureLayout second = b.Build();
+	EXPECT_EQ(first, second);
+	EXPECT_EQ(first.GetHash(), second.GetHash());
+	EXPECT_EQ(first.StaticSamplers[0].Register, 0u);
+
+	// A root CBV has no 32-bit value count.
+	RootSignatureLayout layout = SceneLayout();
+	layout.Parameters[0].Num32BitValues = 8;
+	EXPECT_EQ(layout, SceneLayout());
+	EXPECT_EQ(layout.GetHash(), SceneLayout().GetHash());
+}
+
+TEST(RootSignatureLayout, ParameterOrderIsTheInterface)
+{
+	RootSignatureLayout layout = SceneLayout();
+	RootSignatureLayout swapped = RootSignatureBuilder().AddConstantBuffer(1).AddConstantBuffer(0).AddConstants(1, 2).SetFlags(1).Build();
+	EXPECT_NE(layout, swapped);
+	EXPECT_NE(layout.GetHash(), swapped.GetHash());
+
+	// 2 + 2 + 1 DWORDs.
+	EXPECT_EQ(layout.GetCost(), 5u);
+}
+
+TEST(RootSignatureDiff, ReportsWhatASwitchCosts)
+{
+	RootSignatureLayout from = SceneLayout();
+	EXPECT_TRUE(RootSignatureDiff::Compute(from, from).Identical);
+	EXPECT_EQ(RootSignatureDiff::Compute(from, from).RebindCost, 0u);
+
+	RootSignatureLayout to = RootSignatureBuilder().AddConstantBuffer(0).AddConstantBuffer(1).AddConstants(4, 2).SetFlags(1).Build();
+	RootSignatureDiff diff = RootSignatureDiff::Compute(from, to);
+	EXPECT_FALSE(diff.Identical);
+	EXPECT_EQ(diff.CommonPrefix, 2u);
+	EXPECT_EQ(diff.ChangedParameters, std::vector<std::uint32_t>{ 2 });
+	// Everything is bound again, not just the changed parameter.
+	EXPECT_EQ(diff.RebindCost, 8u);
+	EXPECT_FALSE(diff.SamplersChanged);
+	EXPECT_FALSE(diff.FlagsChanged);
+	EXPECT_EQ(diff.Describe(), "rebind 8 DWORDs; changed parameters: 2");
+}
+
+TEST(RootSignatureBlobFile, RoundTrips)
+{
+	const std::vector<std::uint8_t> blob = { 'D', 'X', 'B', 'C', 1, 2, 3, 4 };
+	std::uint64_t hash = SceneLayout().GetHash();
+	std::vector<std::uint8_t> file = RootSignatureBlobFile::Pack(hash, blob.data(), blob.size());
+
+	const std::uint8_t* data = nullptr;
+	std::size_t size = 0;
+	ASSERT_TRUE(RootSignatureBlobFile::Unpack(file.data(), file.size(), hash, data, size));
+	EXPECT_EQ(std::vector<std::uint8_t>(data, data + size), blob);
+}
+
+TEST(RootSignatureBlobFile, RejectsFilesOfAnotherLayoutOrVersion)
+{
+	const std::vector<std::uint8_t> blob = { 'D', 'X', 'B', 'C', 1, 2, 3, 4 };
+	std::uint64_t hash = SceneLayout().GetHash();
+	std::vector<std::uint8_t> file = RootSignatureBlobFile::Pack(hash, blob.data(), blob.size());
+	const std::uint8_t* data = nullptr;
+	std::size_t size = 0;
+
+	// Written for another layout, e.g. after a hash collision or a rename.
+	EXPECT_FALSE(RootSignatureBlobFile::Unpack(file.data(), file.size(), hash + 1, data, size));
+
+	// Written by another serializer version (the field after the magic).
+	std::vector<std::uint8_t> older = file;
+	older[4] ^= 0xff;
+	EXPECT_FALSE(RootSignatureBlobFile::Unpack(older.data(), older.size(), hash, data, size));
+
+	// A bare blob, as the cache used to write them.
+	EXPECT_FALSE(RootSignatureBlobFile::Unpack(blob.data(), blob.size(), hash, data, size));
+}
+
+TEST(RootSignatureBlobFile, RejectsDamagedFiles)
+{
+	const std::vector<std::uint8_t> blob = { 'D', 'X', 'B', 'C', 1, 2, 3, 4 };
+	std::uint64_t hash = SceneLayout().GetHash();
+	std::vector<std::uint8_t> file = RootSignatureBlobFile::Pack(hash, blob.data(), blob.size());
+	const std::uint8_t* data = nullptr;
+	std::size_t size = 0;
+
+	std::vector<std::uint8_t> flipped = file;
+	flipped.back() ^= 1;
+	EXPECT_FALSE(RootSignatureBlobFile::Unpack(flipped.data(), flipped.size(), hash, data, size));
+
+	std::vector<std::uint8_t> truncated(file.begin(), file.end() - 1);
+	EXPECT_FALSE(RootSignatureBlobFile::Unpack(truncated.data(), truncated.size(), hash, data, size));
+
+	std::vector<std::uint8_t> extended = file;
+	extended.push_back(0);
+	EXPECT_FALSE(RootSignatureBlobFile::Unpack(extended.data(), extended.size(), hash, data, size));
+
+	EXPECT_FALSE(RootSignatureBlobFile::Unpack(file.data(), 10, hash, data, size));
+	EXPECT_FALSE(RootSignatureBlobFile::Unpack(nullptr, 0, hash, data, size));
+}
@@ -0,0 +1,176 @@
+#include "NullBackend.h"
+#include "SceneRenderer.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+	Transform At(float x)
+	{
+		return Transform(XMFLOAT3(x, 0.0f, 0.0f), XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f), 1.0f);
+	}
+
+	class SceneRendererTest : public ::testing::Test
+	{
+	protected:
+
+		SceneRendererTest()
+			: m_renderer(m_device, DirectSettings(), 64)
+		{
+			m_renderer.Initialize();
+			m_renderer.GetScene().SetOcclusionCulling(false);
+			m_timer.Reset();
+		}
+
+		static SceneRendererSettings DirectSettings()
+		{
+			SceneRendererSettings settings;
+			settings.IndirectDraw = false;
+			return settings;
+		}
+
+		// One frame, stepping spinning items by 1/60 s. Returns the list the
+		// frame was recorded on.
+		const NullCommandList& RunFrame()
+		{
+			m_renderer.BeginFrame();
+			GameObject& scene = m_renderer.GetScene();
+			scene.FixedUpdate(1.0f / 60.0f);
+			scene.PublishSimulation();
+			scene.Interpolate(1.0f);
+			m_renderer.Update(m_timer, 800, 600);
+
+			GpuCommandList& commandList = m_renderer.BeginCommandList();
+			m_renderer.DrawScene(commandList);
+			m_renderer.Submit(commandList);
+			m_renderer.Signal();
+			return static_cast<const NullCommandList&>(commandList);
+		}
+
+		NullRenderDevice							m_device;
+		SceneRenderer								m_renderer;
+		GameTimer									m_timer;
+	};
+}
+
+TEST_F(SceneRendererTest, StaticItemsAreSkippedOnceEveryFrameResourceHasThem)
+{
+	GameObject& scene = m_renderer.GetScene();
+	std::vector<Entity> entities;
+	for (int i = 0; i < 10; ++i)
+	{
+		entities.push_back(scene.Spawn("shapeGeo", "box", At(2.0f * i)));
+		if (i < 3)
+			scene.SetSpin(entities.back(), 1.0f);
+	}
+
+	// New items are uploaded to each frame resource once.
+	for (int frame = 0; frame < gNumFrameResources; ++frame)
+	{
+		RunFrame();
+		EXPECT_EQ(m_renderer.GetObjectCBStats().Written, 10u);
+		EXPECT_EQ(m_renderer.GetObjectCBStats().Skipped, 0u);
+	}
+
+	for (int frame = 0; frame < 4; ++frame)
+	{
+		RunFrame();
+		EXPECT_EQ(m_renderer.GetObjectCBStats().Written, 3u);
+		EXPECT_EQ(m_renderer.GetObjectCBStats().Skipped, 7u);
+	}
+
+	// Moving a static item makes it stale in every frame resource again.
+	scene.SetTransform(entities[5], At(-4.0f));
+	for (int frame = 0; frame < gNumFrameResources; ++frame)
+	{
+		RunFrame();
+		EXPECT_EQ(m_renderer.GetObjectCBStats().Written, 4u);
+	}
+	RunFrame();
+	EXPECT_EQ(m_renderer.GetObjectCBStats().Written, 3u);
+
+	// Stopping the spin stops the uploads.
+	for (int i = 0; i < 3; ++i)
+		scene.SetSpin(entities[i], 0.0f);
+	for (int frame = 0; frame < gNumFrameResources; ++frame)
+		RunFrame();
+	RunFrame();
+	EXPECT_EQ(m_renderer.GetObjectCBStats().Written, 0u);
+	EXPECT_EQ(m_renderer.GetObjectCBStats().Skipped, 10u);
+}
+
+TEST_F(SceneRendererTest, DrawsReadTheCurrentWorldMatrices)
+{
+	GameObject& scene = m_renderer.GetScene();
+	for (int i = 0; i < 20; ++i)
+	{
+		Entity entity = scene.Spawn("shapeGeo", i % 2 ? "sphere" : "box", At(2.0f * i));
+		if (i % 4 == 0)
+			scene.SetSpin(entity, 0.5f + i);
+	}
+
+	// Every frame resource is visited more than once, with skipped items in
+	// each of them.
+	for (int frame = 0; frame < 3 * gNumFrameResources; ++frame)
+	{
+		const NullCommandList& commandList = RunFrame();
+		RenderItemSpan items = scene.GetRenderItems();
+
+		size_t draw = 0;
+		for (const NullCommand& command : commandList.GetCommands())
+		{
+			if (command.Type != NullCommandType::SetRootConstantBuffer || command.Operands[0] != 0)
+				continue;
+
+			ASSERT_LT(draw, items.size());
+			NullBuffer* objectCB = m_device.FindBuffer(command.Operands[1]);
+			ASSERT_NE(objectCB, nullptr);
+
+			ObjectConstants constants;
+			std::memcpy(&constants, objectCB->GetData() + (command.Operands[1] - objectCB->GetGpuAddress()), sizeof(constants));
+
+			XMFLOAT4X4 world = scene.GetWorld(items[draw]);
+			XMFLOAT4X4 expected;
+			XMStoreFloat4x4(&expected, XMMatrixTranspose(XMLoadFloat4x4(&world)));
+			EXPECT_EQ(std::memcmp(&constants.WorldViewProj, &expected, sizeof(expected)), 0) << "frame " << frame << ", draw " << draw;
+			draw++;
+		}
+		EXPECT_EQ(draw, items.size());
+	}
+}
+
+TEST_F(SceneRendererTest, SpawningUnknownGeometryFails)
+{
+	GameObject& scene = m_renderer.GetScene();
+	EXPECT_FALSE(scene.GetEntities().IsAlive(scene.Spawn("noSuchGeo", "box", At(0.0f))));
+	EXPECT_FALSE(scene.GetEntities().IsAlive(scene.Spawn("shapeGeo", "noSuchSubmesh", At(0.0f))));
+	EXPECT_TRUE(scene.GetRenderItems().empty());
+	// Unknown names are looked up, not interned.
+	EXPECT_FALSE(StringId::Find("noSuchGeo").IsValid());
+	EXPECT_FALSE(StringId::Find("noSuchSubmesh").IsValid());
+
+	EXPECT_TRUE(scene.GetEntities().IsAlive(scene.Spawn("shapeGeo", "box", At(0.0f))));
+	EXPECT_EQ(scene.GetRenderItems().size(), 1u);
+}
+
+TEST_F(SceneRendererTest, TheHierarchyIsTheOnlyTransform)
+{
+	GameObject& scene = m_renderer.GetScene();
+	Entity entity = scene.Spawn("shapeGeo", "box", At(1.0f));
+	EXPECT_EQ(scene.GetEntities().Get<Transform>(entity), nullptr);
+	EXPECT_EQ(scene.GetTransform(entity)->Position.x, 1.0f);
+
+	scene.SetTransform(entity, At(5.0f));
+	EXPECT_EQ(scene.GetTransform(entity)->Position.x, 5.0f);
+	RunFrame();
+	EXPECT_EQ(scene.GetWorld(*scene.GetRenderItem(entity))._41, 5.0f);
+
+	// Spinning writes the same transform and keeps the position.
+	scene.SetSpin(entity, 1.0f);
+	RunFrame();
+	RunFrame();
+	EXPECT_EQ(scene.GetTransform(entity)->Position.x, 5.0f);
+	EXPECT_NE(scene.GetTransform(entity)->Rotation.w, 1.0f);
+
+	EXPECT_TRUE(scene.Despawn(entity));
+	EXPECT_EQ(scene.GetTransform(entity), nullptr);
+}
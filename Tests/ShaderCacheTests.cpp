@@ -0,0 +1,204 @@
+#include "Hash.h"
+#include "ShaderCache.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	// A fresh directory with a shader and one include, removed afterwards.
+	class ShaderCacheTest : public ::testing::Test
+	{
+	protected:
+
+		void SetUp() override
+		{
+			const ::testing::TestInfo* test = ::testing::UnitTest::GetInstance()->current_test_info();
+			m_root = fs::temp_directory_path() / (std::string("ShaderCacheTest_") + test->name());
+			fs::remove_all(m_root);
+			fs::create_directories(m_root / "Shaders");
+
+			Write("Shaders/common.hlsli", "float4 Tint;\n");
+			Write("Shaders/color.hlsl", "#include \"common.hlsli\"\nfloat4 PS() : SV_Target { return Tint; }\n");
+		}
+
+		void TearDown() override
+		{
+			fs::remove_all(m_root);
+		}
+
+		void Write(const std::string& relative, const std::string& contents)
+		{
+			std::ofstream file(m_root / relative, std::ios::binary | std::ios::trunc);
+			file << contents;
+		}
+
+		std::string Path(const std::string& relative) const
+		{
+			return (m_root / relative).generic_string();
+		}
+
+		ShaderDesc Desc() const
+		{
+			return { Path("Shaders/color.hlsl"), "PS", "ps_5_0", {}, 0 };
+		}
+
+		// Stands in for D3DCompile: the "bytecode" is the entry point and the
+		// defines, and every call is counted.
+		ShaderCache::CompileFn Stub()
+		{
+			return [this](const ShaderDesc& desc)
+			{
+				m_compiles++;
+				ShaderCache::CompileResult result;
+				if (desc.EntryPoint == "Broken")
+				{
+					result.Errors = "error X3000: syntax error";
+					return result;
+				}
+
+				std::string code = "DXBC" + desc.EntryPoint;
+				for (const ShaderDefine& define : desc.Defines)
+					code += ";" + define.Name + "=" + define.Value;
+				result.Success = true;
+				result.Bytecode.assign(code.begin(), code.end());
+				return result;
+			};
+		}
+
+		fs::path								m_root;
+		std::atomic<int>						m_compiles{ 0 };
+	};
+
+	std::string Contents(const ShaderBytecode& bytecode)
+	{
+		return std::string((const char*)bytecode.Data(), bytecode.Size());
+	}
+}
+
+TEST_F(ShaderCacheTest, CompilesOnceAndSharesTheBytecode)
+{
+	ShaderCache cache(Path("Cache"), Stub(), "stub 1");
+
+	std::shared_ptr<const ShaderBytecode> first = cache.Get(Desc());
+	ASSERT_NE(first, nullptr);
+	EXPECT_EQ(Contents(*first), "DXBCPS");
+	EXPECT_EQ(cache.Get(Desc()), first);
+	EXPECT_EQ(m_compiles, 1);
+
+	ShaderCache::Stats stats = cache.GetStats();
+	EXPECT_EQ(stats.Misses, 1u);
+	EXPECT_EQ(stats.Hits, 1u);
+}
+
+TEST_F(ShaderCacheTest, NextRunMapsTheBlobFromDisk)
+{
+	std::uint64_t hash = 0;
+	{
+		ShaderCache cache(Path("Cache"), Stub(), "stub 1");
+		hash = cache.Get(Desc())->Hash();
+	}
+
+	ShaderCache cache(Path("Cache"), Stub(), "stub 1");
+	std::shared_ptr<const ShaderBytecode> bytecode = cache.Get(Desc());
+	ASSERT_NE(bytecode, nullptr);
+	EXPECT_EQ(Contents(*bytecode), "DXBCPS");
+	EXPECT_EQ(bytecode->Hash(), hash);
+	EXPECT_EQ(m_compiles, 1);
+	EXPECT_EQ(cache.GetStats().Hits, 1u);
+}
+
+TEST_F(ShaderCacheTest, EditingAnIncludeChangesTheKey)
+{
+	ShaderCache cache(Path("Cache"), Stub(), "stub 1");
+	std::uint64_t before = cache.ComputeKey(Desc());
+
+	std::vector<std::string> files = ShaderCache::FindIncludes(Desc().SourcePath);
+	ASSERT_EQ(files.size(), 2u);
+	EXPECT_EQ(files[1], Path("Shaders/common.hlsli"));
+
+	Write("Shaders/common.hlsli", "float4 Tint;\nfloat Scale;\n");
+	EXPECT_NE(cache.ComputeKey(Desc()), before);
+}
+
+TEST_F(ShaderCacheTest, DescriptionChangesTheKey)
+{
+	ShaderCache cache(Path("Cache"), Stub(), "stub 1");
+	ShaderDesc desc = Desc();
+	std::uint64_t key = cache.ComputeKey(desc);
+
+	desc.Defines.push_back({ "FOG", "1" });
+	EXPECT_NE(cache.ComputeKey(desc), key);
+	desc = Desc();
+	desc.Flags = 1;
+	EXPECT_NE(cache.ComputeKey(desc), key);
+	desc = Desc();
+	desc.Target = "ps_5_1";
+	EXPECT_NE(cache.ComputeKey(desc), key);
+}
+
+TEST_F(ShaderCacheTest, AnotherCompilerVersionRecompiles)
+{
+	{
+		ShaderCache cache(Path("Cache"), Stub(), "stub 1");
+		cache.Get(Desc());
+	}
+
+	ShaderCache cache(Path("Cache"), Stub(), "stub 2");
+	EXPECT_NE(cache.Get(Desc()), nullptr);
+	EXPECT_EQ(m_compiles, 2);
+	EXPECT_EQ(cache.GetStats().Hits, 0u);
+}
+
+TEST_F(ShaderCacheTest, DamagedBlobIsRecompiled)
+{
+	std::uint64_t key = 0;
+	{
+		ShaderCache cache(Path("Cache"), Stub(), "stub 1");
+		key = cache.ComputeKey(Desc());
+		cache.Get(Desc());
+	}
+
+	// Same size, different contents: only the content hash can tell.
+	fs::path blob = m_root / "Cache" / (Hasher::ToHex(key) + ".cso");
+	ASSERT_TRUE(fs::exists(blob));
+	{
+		std::ofstream file(blob, std::ios::binary | std::ios::trunc);
+		file << "DXBCXX";
+	}
+
+	ShaderCache cache(Path("Cache"), Stub(), "stub 1");
+	std::shared_ptr<const ShaderBytecode> bytecode = cache.Get(Desc());
+	ASSERT_NE(bytecode, nullptr);
+	EXPECT_EQ(Contents(*bytecode), "DXBCPS");
+	EXPECT_EQ(m_compiles, 2);
+}
+
+TEST_F(ShaderCacheTest, FailedCompileReturnsNullAndTheErrors)
+{
+	ShaderCache cache(Path("Cache"), Stub(), "stub 1");
+	ShaderDesc desc = Desc();
+	desc.EntryPoint = "Broken";
+
+	EXPECT_EQ(cache.Get(desc), nullptr);
+	EXPECT_EQ(cache.GetLastErrors(), "error X3000: syntax error");
+	EXPECT_EQ(cache.GetStats().Failures, 1u);
+
+	// Failures are not cached.
+	EXPECT_EQ(cache.Get(desc), nullptr);
+	EXPECT_EQ(m_compiles, 2);
+}
+
+TEST(ResolveModulePath, RelativePathsAreUnderTheExecutable)
+{
+	std::string resolved = ResolveModulePath("ShaderCache");
+	EXPECT_TRUE(fs::path(resolved).is_absolute());
+	EXPECT_EQ(fs::path(resolved).filename(), "ShaderCache");
+	EXPECT_TRUE(fs::exists(fs::path(resolved).parent_path() / "engine_tests"));
+
+	std::string absolute = (fs::temp_directory_path() / "cache").string();
+	EXPECT_EQ(ResolveModulePath(absolute), absolute);
+}
@@ -0,0 +1,183 @@
+#include "ShaderPermutations.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	class ShaderPermutationTest : public ::testing::Test
+	{
+	protected:
+
+		void SetUp() override
+		{
+			const ::testing::TestInfo* test = ::testing::UnitTest::GetInstance()->current_test_info();
+			m_root = fs::temp_directory_path() / (std::string("ShaderPermutationTest_") + test->name());
+			fs::remove_all(m_root);
+			fs::create_directories(m_root);
+
+			std::ofstream(m_root / "lit.hlsl") << "float4 PS() : SV_Target { return 1; }\n";
+		}
+
+		void TearDown() override
+		{
+			fs::remove_all(m_root);
+		}
+
+		ShaderDesc Base() const
+		{
+			return { (m_root / "lit.hlsl").generic_string(), "PS", "ps_5_0", {}, 0 };
+		}
+
+		// Stands in for D3DCompile. Only FOG and SHADOWS reach the output;
+		// DEBUG_NAME is ignored, as a define the shader never tests would be.
+		// FAIL=1 is a compile error. Compiles are slow enough to overlap and
+		// the peak number running at once is recorded.
+		ShaderCache::CompileFn Fake()
+		{
+			return [this](const ShaderDesc& desc)
+			{
+				int running = ++m_running;
+				for (int peak = m_peak; running > peak && !m_peak.compare_exchange_weak(peak, running);)
+					;
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+				m_compiles++;
+
+				ShaderCache::CompileResult result;
+				std::string code = "DXBC";
+				result.Success = true;
+				for (const ShaderDefine& define : desc.Defines)
+				{
+					if (define.Name == "FAIL")
+						result.Success = false;
+					else if (define.Name != "DEBUG_NAME")
+						code += ";" + define.Name + "=" + define.Value;
+				}
+				if (result.Success)
+					result.Bytecode.assign(code.begin(), code.end());
+				else
+					result.Errors = "error X3000";
+
+				--m_running;
+				return result;
+			};
+		}
+
+		fs::path								m_root;
+		std::atomic<int>						m_compiles{ 0 };
+		std::atomic<int>						m_running{ 0 };
+		std::atomic<int>						m_peak{ 0 };
+	};
+}
+
+TEST(ShaderPermutationSet, PermutationsAreMixedRadixNumbers)
+{
+	ShaderPermutationSet set({ "a.hlsl", "PS", "ps_5_0", {}, 0 });
+	std::uint32_t fog = set.AddBoolAxis("FOG");
+	std::uint32_t quality = set.AddAxis("QUALITY", { "0", "1", "2" });
+	EXPECT_EQ(set.GetPermutationCount(), 6u);
+
+	// The first axis varies fastest.
+	EXPECT_EQ(set.GetValue(1, fog), 1u);
+	EXPECT_EQ(set.GetValue(1, quality), 0u);
+	EXPECT_EQ(set.GetValue(2, quality), 1u);
+	for (std::uint32_t permutation = 0; permutation < set.GetPermutationCount(); ++permutation)
+		EXPECT_EQ(set.GetPermutation({ set.GetValue(permutation, fog), set.GetValue(permutation, quality) }), permutation);
+
+	// An empty value leaves its define out.
+	ShaderDesc desc = set.GetDesc(set.GetPermutation({ 0, 2 }));
+	ASSERT_EQ(desc.Defines.size(), 1u);
+	EXPECT_EQ(desc.Defines[0].Name, "QUALITY");
+	EXPECT_EQ(desc.Defines[0].Value, "2");
+
+	std::vector<std::uint32_t> needed = set.Enumerate([&](const ShaderPermutationSet& s, std::uint32_t permutation)
+	{
+		return s.GetValue(permutation, quality) != 1;
+	});
+	EXPECT_EQ(needed, (std::vector<std::uint32_t>{ 0, 1, 4, 5 }));
+}
+
+TEST_F(ShaderPermutationTest, CompilesEveryPermutationInParallel)
+{
+	ShaderCache cache((m_root / "Cache").string(), Fake(), "fake 1");
+	ShaderPermutationCompiler compiler(cache, 4);
+
+	ShaderPermutationSet set(Base());
+	set.AddBoolAxis("FOG");
+	set.AddBoolAxis("SHADOWS");
+	set.AddAxis("QUALITY", { "0", "1", "2", "3" });
+
+	ShaderPermutationCompiler::Result result = compiler.Compile(set);
+	ASSERT_EQ(result.Bytecode.size(), 16u);
+	EXPECT_EQ(result.Unique, 16u);
+	EXPECT_EQ(result.Duplicates, 0u);
+	EXPECT_EQ(result.Failures, 0u);
+	EXPECT_EQ(m_compiles, 16);
+	EXPECT_GT(m_peak, 1);
+	EXPECT_LE(m_peak, 4);
+
+	// Results are in job order.
+	for (std::uint32_t i = 0; i < 16; ++i)
+	{
+		ShaderDesc desc = set.GetDesc(i);
+		std::string expected = "DXBC";
+		for (const ShaderDefine& define : desc.Defines)
+			expected += ";" + define.Name + "=" + define.Value;
+		ASSERT_NE(result.Bytecode[i], nullptr);
+		EXPECT_EQ(std::string((const char*)result.Bytecode[i]->Data(), result.Bytecode[i]->Size()), expected);
+	}
+
+	// A second pass is all cache hits.
+	result = compiler.Compile(set);
+	EXPECT_EQ(m_compiles, 16);
+	EXPECT_EQ(result.Unique, 16u);
+	EXPECT_EQ(result.Duplicates, 0u);
+}
+
+TEST_F(ShaderPermutationTest, IdenticalBytecodeIsFoldedAcrossBatches)
+{
+	ShaderCache cache((m_root / "Cache").string(), Fake(), "fake 1");
+	ShaderPermutationCompiler compiler(cache, 4);
+
+	ShaderPermutationSet set(Base());
+	set.AddBoolAxis("FOG");
+	set.AddBoolAxis("DEBUG_NAME");
+
+	ShaderPermutationCompiler::Result result = compiler.Compile(set);
+	EXPECT_EQ(result.Unique, 2u);
+	EXPECT_EQ(result.Duplicates, 2u);
+	EXPECT_EQ(result.Bytecode[0], result.Bytecode[2]);
+	EXPECT_EQ(result.Bytecode[1], result.Bytecode[3]);
+	EXPECT_NE(result.Bytecode[0], result.Bytecode[1]);
+
+	// A later batch with a new key for the same output gets the shader
+	// already handed out.
+	ShaderDesc renamed = Base();
+	renamed.Defines.push_back({ "DEBUG_NAME", "lit" });
+	ShaderPermutationCompiler::Result later = compiler.Compile(std::vector<ShaderDesc>{ renamed });
+	EXPECT_EQ(later.Duplicates, 1u);
+	EXPECT_EQ(later.Bytecode[0], result.Bytecode[0]);
+}
+
+TEST_F(ShaderPermutationTest, FailuresAreCountedAndLeftNull)
+{
+	ShaderCache cache((m_root / "Cache").string(), Fake(), "fake 1");
+	ShaderPermutationCompiler compiler(cache, 2);
+
+	ShaderPermutationSet set(Base());
+	set.AddBoolAxis("FAIL");
+	set.AddBoolAxis("FOG");
+
+	ShaderPermutationCompiler::Result result = compiler.Compile(set);
+	EXPECT_EQ(result.Failures, 2u);
+	EXPECT_EQ(result.Unique, 2u);
+	EXPECT_NE(result.Bytecode[0], nullptr);
+	EXPECT_EQ(result.Bytecode[1], nullptr);
+	EXPECT_NE(result.Bytecode[2], nullptr);
+	EXPECT_EQ(result.Bytecode[3], nullptr);
+}
@@ -0,0 +1,72 @@
+#include "StringIdMap.h"
+#include <gtest/gtest.h>
+#include <string>
+
+TEST(StringId, InterningIsStable)
+{
+	StringId a("string id test: a");
+	EXPECT_TRUE(a.IsValid());
+	EXPECT_EQ(StringId("string id test: a"), a);
+	EXPECT_NE(StringId("string id test: b"), a);
+	EXPECT_STREQ(a.c_str(), "string id test: a");
+
+	EXPECT_EQ(StringId::Find("string id test: a"), a);
+	EXPECT_FALSE(StringId::Find("string id test: never interned").IsValid());
+	EXPECT_FALSE(StringId().IsValid());
+}
+
+TEST(StringIdMap, InvalidKeysAreNeverFound)
+{
+	StringIdMap<int> map;
+	EXPECT_EQ(map.Find(StringId()), nullptr);
+	EXPECT_FALSE(map.Contains(StringId()));
+	EXPECT_FALSE(map.Erase(StringId()));
+	EXPECT_EQ(map.Size(), 0u);
+
+	map[StringId("string id map test: one")] = 1;
+	EXPECT_EQ(map.Find(StringId()), nullptr);
+	EXPECT_FALSE(map.Erase(StringId()));
+	EXPECT_EQ(map.Size(), 1u);
+
+	// Through the name-based overloads: a name never interned is a miss,
+	// and the lookup does not intern it.
+	EXPECT_EQ(map.Find("string id map test: missing"), nullptr);
+	EXPECT_FALSE(map.Contains("string id map test: missing"));
+	EXPECT_FALSE(StringId::Find("string id map test: missing").IsValid());
+}
+
+TEST(StringIdMap, InsertFindEraseAcrossRehashes)
+{
+	StringIdMap<int> map;
+	std::vector<StringId> keys;
+	for (int i = 0; i < 1000; ++i)
+	{
+		keys.push_back(StringId("string id map test: key " + std::to_string(i)));
+		map[keys.back()] = i;
+	}
+	EXPECT_EQ(map.Size(), 1000u);
+	EXPECT_LE(map.Size() * 2, map.Capacity());
+
+	// Erasing every third key must leave the others reachable past the
+	// backward-shifted holes.
+	for (int i = 0; i < 1000; i += 3)
+		EXPECT_TRUE(map.Erase(keys[i]));
+	for (int i = 0; i < 1000; ++i)
+	{
+		const int* value = map.Find(keys[i]);
+		if (i % 3 == 0)
+		{
+			EXPECT_EQ(value, nullptr);
+			EXPECT_FALSE(map.Erase(keys[i]));
+		}
+		else
+		{
+			ASSERT_NE(value, nullptr);
+			EXPECT_EQ(*value, i);
+		}
+	}
+
+	int visited = 0;
+	map.ForEach([&](StringId, int&) { visited++; });
+	EXPECT_EQ(visited, (int)map.Size());
+}
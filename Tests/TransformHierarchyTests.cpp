@@ -0,0 +1,207 @@
+#include "TransformHierarchy.h"
+#include <gtest/gtest.h>
+#include <cstring>
+
+namespace
+{
+	Transform Make(float x, float yaw, float scale)
+	{
+		XMFLOAT4 rotation;
+		XMStoreFloat4(&rotation, XMQuaternionRotationAxis(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), yaw));
+		return Transform(XMFLOAT3(x, 1.0f, -x), rotation, scale);
+	}
+
+	float MaxDifference(const XMFLOAT4X4& a, FXMMATRIX b)
+	{
+		XMFLOAT4X4 m;
+		XMStoreFloat4x4(&m, b);
+		float diff = 0.0f;
+		for (int r = 0; r < 4; ++r)
+			for (int c = 0; c < 4; ++c)
+				diff = std::max(diff, std::fabs(a.m[r][c] - m.m[r][c]));
+		return diff;
+	}
+
+	// World matrix of `node` composed by walking up to the root.
+	XMMATRIX ExpectedWorld(const TransformHierarchy& hierarchy, TransformHierarchy::NodeId node)
+	{
+		XMMATRIX world = XMMatrixIdentity();
+		for (TransformHierarchy::NodeId n = node; n != TransformHierarchy::InvalidNode; n = hierarchy.GetParent(n))
+			world = XMMatrixMultiply(world, hierarchy.GetLocal(n).ToMatrix());
+		return world;
+	}
+
+	void ExpectWorldsMatch(const TransformHierarchy& hierarchy)
+	{
+		for (TransformHierarchy::NodeId node = 0; node < hierarchy.GetNodeCount(); ++node)
+			EXPECT_LT(MaxDifference(hierarchy.GetWorldMatrix(node), ExpectedWorld(hierarchy, node)), 1e-4f) << "node " << node;
+	}
+}
+
+TEST(TransformHierarchy, ComposesWorldMatricesDownTheTree)
+{
+	TransformHierarchy hierarchy;
+	auto root = hierarchy.AddNode(TransformHierarchy::InvalidNode, Make(1.0f, 0.3f, 2.0f));
+	auto child = hierarchy.AddNode(root, Make(2.0f, -0.5f, 0.5f));
+	auto grandchild = hierarchy.AddNode(child, Make(-1.0f, 1.2f, 1.0f));
+	auto other = hierarchy.AddNode(TransformHierarchy::InvalidNode, Make(5.0f, 0.0f, 1.0f));
+	hierarchy.Update();
+
+	ExpectWorldsMatch(hierarchy);
+	EXPECT_TRUE(hierarchy.WasUpdated(grandchild));
+	EXPECT_TRUE(hierarchy.WasUpdated(other));
+
+	// Moving a node updates its subtree only.
+	hierarchy.SetLocal(child, Make(3.0f, 0.1f, 1.5f));
+	hierarchy.Update();
+	ExpectWorldsMatch(hierarchy);
+	EXPECT_FALSE(hierarchy.WasUpdated(root));
+	EXPECT_TRUE(hierarchy.WasUpdated(child));
+	EXPECT_TRUE(hierarchy.WasUpdated(grandchild));
+	EXPECT_FALSE(hierarchy.WasUpdated(other));
+
+	hierarchy.Update();
+	EXPECT_FALSE(hierarchy.WasUpdated(child));
+}
+
+TEST(TransformHierarchy, MatchesDirectXMathForAnyRotation)
+{
+	// Make only turns about y; these exercise every term of the quaternion
+	// math the sweep and GetWorldMatrix do themselves.
+	TransformHierarchy hierarchy;
+	TransformHierarchy::NodeId parent = TransformHierarchy::InvalidNode;
+	for (int i = 0; i < 16; ++i)
+	{
+		XMFLOAT4 rotation;
+		XMVECTOR axis = XMVector3Normalize(XMVectorSet(1.0f + i, -2.0f + 0.5f * i, 0.3f * i - 1.0f, 0.0f));
+		XMStoreFloat4(&rotation, XMQuaternionRotationAxis(axis, 0.4f * i - 3.0f));
+		parent = hierarchy.AddNode(i % 5 == 0 ? TransformHierarchy::InvalidNode : parent, Transform(XMFLOAT3(0.5f * i, -1.0f, 2.0f - i), rotation, 0.5f + 0.1f * i));
+	}
+	hierarchy.Update();
+
+	for (TransformHierarchy::NodeId node = 0; node < hierarchy.GetNodeCount(); ++node)
+	{
+		EXPECT_LT(MaxDifference(hierarchy.GetWorldMatrix(node), ExpectedWorld(hierarchy, node)), 1e-4f) << "node " << node;
+		EXPECT_LT(MaxDifference(hierarchy.GetWorldMatrix(node), hierarchy.GetWorld(node).ToMatrix()), 1e-6f) << "node " << node;
+		// A root's world transform is its local one.
+		if (hierarchy.GetParent(node) == TransformHierarchy::InvalidNode)
+			EXPECT_EQ(std::memcmp(&hierarchy.GetWorld(node), &hierarchy.GetLocal(node), sizeof(Transform)), 0) << "node " << node;
+	}
+}
+
+TEST(TransformHierarchy, ReparentingAndRemoval)
+{
+	TransformHierarchy hierarchy;
+	auto a = hierarchy.AddNode(TransformHierarchy::InvalidNode, Make(1.0f, 0.3f, 2.0f));
+	auto b = hierarchy.AddNode(a, Make(2.0f, -0.5f, 0.5f));
+	auto c = hierarchy.AddNode(b, Make(-1.0f, 1.2f, 1.0f));
+	auto d = hierarchy.AddNode(TransformHierarchy::InvalidNode, Make(4.0f, 0.7f, 1.0f));
+	hierarchy.Update();
+
+	EXPECT_TRUE(hierarchy.SetParent(b, d));
+	hierarchy.Update();
+	ExpectWorldsMatch(hierarchy);
+	EXPECT_TRUE(hierarchy.WasUpdated(c));
+	EXPECT_FALSE(hierarchy.WasUpdated(a));
+
+	// The children of a removed node become roots, and its id is recycled.
+	hierarchy.RemoveNode(b);
+	EXPECT_EQ(hierarchy.GetParent(c), TransformHierarchy::InvalidNode);
+	auto e = hierarchy.AddNode(c, Make(0.5f, 0.0f, 3.0f));
+	EXPECT_EQ(e, b);
+	hierarchy.Update();
+	ExpectWorldsMatch(hierarchy);
+}
+
+TEST(TransformHierarchy, RejectsCycles)
+{
+	TransformHierarchy hierarchy;
+	auto a = hierarchy.AddNode(TransformHierarchy::InvalidNode, Make(1.0f, 0.0f, 1.0f));
+	auto b = hierarchy.AddNode(a, Make(1.0f, 0.0f, 1.0f));
+	auto c = hierarchy.AddNode(b, Make(1.0f, 0.0f, 1.0f));
+	hierarchy.Update();
+
+	EXPECT_FALSE(hierarchy.SetParent(a, a));
+	EXPECT_FALSE(hierarchy.SetParent(a, b));
+	EXPECT_FALSE(hierarchy.SetParent(a, c));
+	EXPECT_FALSE(hierarchy.SetParent(b, c));
+	EXPECT_EQ(hierarchy.GetParent(a), TransformHierarchy::InvalidNode);
+	EXPECT_EQ(hierarchy.GetParent(b), a);
+
+	// Still a tree: Update sorts it and composes as before.
+	hierarchy.Update();
+	ExpectWorldsMatch(hierarchy);
+
+	EXPECT_TRUE(hierarchy.SetParent(c, a));
+	EXPECT_TRUE(hierarchy.SetParent(b, c));
+	hierarchy.Update();
+	ExpectWorldsMatch(hierarchy);
+}
+
+TEST(TransformHierarchy, LargeLevelsMatchTheSerialSweep)
+{
+	// Wider than the parallel threshold at every level.
+	TransformHierarchy hierarchy;
+	std::vector<TransformHierarchy::NodeId> level;
+	for (int i = 0; i < 3000; ++i)
+		level.push_back(hierarchy.AddNode(TransformHierarchy::InvalidNode, Make(0.01f * i, 0.001f * i, 1.0f)));
+	for (int depth = 0; depth < 3; ++depth)
+	{
+		std::vector<TransformHierarchy::NodeId> next;
+		for (size_t i = 0; i < level.size(); ++i)
+			next.push_back(hierarchy.AddNode(level[(i * 7919) % level.size()], Make(0.5f, 0.002f * i, 0.9f)));
+		level = next;
+	}
+	hierarchy.Update();
+	ExpectWorldsMatch(hierarchy);
+
+	for (TransformHierarchy::NodeId node = 0; node < 3000; node += 97)
+		hierarchy.SetLocal(node, Make(-1.0f, 0.5f, 1.1f));
+	hierarchy.Update();
+	ExpectWorldsMatch(hierarchy);
+}
+
+TEST(TransformHierarchy, RandomChurnKeepsWorldsCorrect)
+{
+	TransformHierarchy hierarchy;
+	std::vector<TransformHierarchy::NodeId> live;
+	std::uint32_t state = 7;
+	auto next = [&state](std::uint32_t range)
+	{
+		state = state * 1664525u + 1013904223u;
+		return (state >> 8) % range;
+	};
+
+	for (int i = 0; i < 200; ++i)
+		live.push_back(hierarchy.AddNode(i % 4 == 0 || live.empty() ? TransformHierarchy::InvalidNode : live[next((std::uint32_t)live.size())], Make(0.1f * i, 0.01f * i, 1.0f)));
+
+	for (int round = 0; round < 50; ++round)
+	{
+		for (int op = 0; op < 40; ++op)
+		{
+			TransformHierarchy::NodeId node = live[next((std::uint32_t)live.size())];
+			switch (next(4))
+			{
+			case 0:
+				live.push_back(hierarchy.AddNode(next(3) == 0 ? TransformHierarchy::InvalidNode : node, Make(0.3f, 0.02f * op, 1.05f)));
+				break;
+			case 1:
+				if (live.size() > 10)
+				{
+					hierarchy.RemoveNode(node);
+					live.erase(std::find(live.begin(), live.end(), node));
+				}
+				break;
+			case 2:
+				hierarchy.SetParent(node, next(4) == 0 ? TransformHierarchy::InvalidNode : live[next((std::uint32_t)live.size())]);
+				break;
+			default:
+				hierarchy.SetLocal(node, Make(-0.2f, 0.03f * op, 0.95f));
+				break;
+			}
+		}
+		hierarchy.Update();
+		for (TransformHierarchy::NodeId node : live)
+			ASSERT_LT(MaxDifference(hierarchy.GetWorldMatrix(node), ExpectedWorld(hierarchy, node)), 1e-3f) << "round " << round << ", node " << node;
+	}
+}
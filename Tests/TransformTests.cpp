@@ -0,0 +1,59 @@
+#include "MathHelper.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+	XMFLOAT4 YawQuaternion(float yaw)
+	{
+		XMFLOAT4 q;
+		XMStoreFloat4(&q, XMQuaternionRotationAxis(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), yaw));
+		return q;
+	}
+}
+
+TEST(Transform, ScalesThenRotatesThenTranslates)
+{
+	Transform t(XMFLOAT3(1.0f, 2.0f, 3.0f), YawQuaternion(XM_PIDIV2), 2.0f);
+
+	// +X scaled by 2, turned a quarter about Y (left-handed: +X goes to -Z),
+	// then moved.
+	XMFLOAT3 p;
+	XMStoreFloat3(&p, XMVector3Transform(XMVectorSet(1.0f, 0.0f, 0.0f, 1.0f), t.ToMatrix()));
+	EXPECT_NEAR(p.x, 1.0f, 1e-5f);
+	EXPECT_NEAR(p.y, 2.0f, 1e-5f);
+	EXPECT_NEAR(p.z, 1.0f, 1e-5f);
+
+	XMFLOAT4X4 m, expected;
+	XMStoreFloat4x4(&m, t.ToMatrix());
+	XMStoreFloat4x4(&expected, XMMatrixMultiply(XMMatrixMultiply(XMMatrixScaling(2.0f, 2.0f, 2.0f), XMMatrixRotationY(XM_PIDIV2)),
+		XMMatrixTranslation(1.0f, 2.0f, 3.0f)));
+	for (int r = 0; r < 4; ++r)
+		for (int c = 0; c < 4; ++c)
+			EXPECT_NEAR(m.m[r][c], expected.m[r][c], 1e-5f);
+}
+
+TEST(Transform, InterpolateLerpsAndSlerps)
+{
+	Transform a(XMFLOAT3(0.0f, 0.0f, 0.0f), YawQuaternion(0.0f), 1.0f);
+	Transform b(XMFLOAT3(4.0f, -2.0f, 8.0f), YawQuaternion(XM_PIDIV2), 3.0f);
+
+	Transform start = MathHelper::Interpolate(a, b, 0.0f);
+	Transform end = MathHelper::Interpolate(a, b, 1.0f);
+	EXPECT_EQ(start.Position.x, a.Position.x);
+	EXPECT_EQ(start.Rotation.w, a.Rotation.w);
+	EXPECT_NEAR(end.Position.z, 8.0f, 1e-6f);
+	EXPECT_NEAR(end.Rotation.y, b.Rotation.y, 1e-6f);
+	EXPECT_NEAR(end.Rotation.w, b.Rotation.w, 1e-6f);
+
+	Transform mid = MathHelper::Interpolate(a, b, 0.5f);
+	EXPECT_NEAR(mid.Position.x, 2.0f, 1e-6f);
+	EXPECT_NEAR(mid.Position.y, -1.0f, 1e-6f);
+	EXPECT_NEAR(mid.Scale, 2.0f, 1e-6f);
+
+	// Half of a quarter turn, and still a unit quaternion.
+	XMFLOAT4 eighth = YawQuaternion(XM_PIDIV4);
+	EXPECT_NEAR(mid.Rotation.y, eighth.y, 1e-5f);
+	EXPECT_NEAR(mid.Rotation.w, eighth.w, 1e-5f);
+	const XMFLOAT4& q = mid.Rotation;
+	EXPECT_NEAR(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w, 1.0f, 1e-5f);
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "MathTypes.h"
+
+using namespace DirectX;
+
+// Translation/rotation/uniform scale transform, 32 bytes against the 64 of an
+// XMFLOAT4X4, and it never accumulates shear. With a single scale factor the
+// composition of two transforms is again a transform, so TransformHierarchy
+// keeps world transforms in this form too: a node costs the 64 bytes one
+// world matrix used to, and matrices are composed only where they are used.
+struct Transform
+{
+	XMFLOAT3 Position = { 0.0f, 0.0f, 0.0f };
+	float Scale = 1.0f;
+	XMFLOAT4 Rotation = { 0.0f, 0.0f, 0.0f, 1.0f }; // unit quaternion
+
+	Transform() = default;
+	Transform(const XMFLOAT3& position, const XMFLOAT4& rotation, float scale)
+		: Position(position), Scale(scale), Rotation(rotation) {}
+
+	// Scale, then rotate, then translate.
+	XMMATRIX ToMatrix() const
+	{
+		return XMMatrixAffineTransformation(
+			XMVectorReplicate(Scale),
+			XMVectorZero(),
+			XMLoadFloat4(&Rotation),
+			XMLoadFloat3(&Position));
+	}
+};
+
+static_assert(sizeof(Transform) == 32, "Transform is meant to stay compact.");
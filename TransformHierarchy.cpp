@@ -0,0 +1,416 @@
+#include "TransformHierarchy.h"
+#include <cstddef>
+#include <execution>
+
+#include <emmintrin.h>
+
+// Levels smaller than this are swept serially; the fork/join cost of the
+// parallel algorithms is not worth it for a handful of transforms.
+static const UINT c_parallelLevelSize = 1024;
+
+static_assert(offsetof(Transform, Scale) == 12 && offsetof(Transform, Rotation) == 16,
+	"The sweep loads Position and Scale as one vector, then Rotation.");
+
+namespace
+{
+	// The sweep and GetWorldMatrix work in SSE registers themselves rather
+	// than through DirectXMath, so their cost is the same whichever
+	// DirectXMath the build uses.
+
+	// Lanes x, y, z kept and w cleared.
+	__m128 ClearW(__m128 v)
+	{
+		return _mm_and_ps(v, _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)));
+	}
+
+	template<int X, int Y, int Z, int W>
+	__m128 Swizzle(__m128 v)
+	{
+		return _mm_shuffle_ps(v, v, _MM_SHUFFLE(W, Z, Y, X));
+	}
+
+	// a x b in x, y, z; 0 in w.
+	__m128 Cross(__m128 a, __m128 b)
+	{
+		return _mm_sub_ps(
+			_mm_mul_ps(Swizzle<1, 2, 0, 3>(a), Swizzle<2, 0, 1, 3>(b)),
+			_mm_mul_ps(Swizzle<2, 0, 1, 3>(a), Swizzle<1, 2, 0, 3>(b)));
+	}
+
+	// Rotation q1 followed by q2, as XMQuaternionMultiply(q1, q2).
+	__m128 QuaternionMultiply(__m128 q1, __m128 q2)
+	{
+		const __m128 signsX = _mm_setr_ps(1.0f, -1.0f, 1.0f, -1.0f);
+		const __m128 signsY = _mm_setr_ps(1.0f, 1.0f, -1.0f, -1.0f);
+		const __m128 signsZ = _mm_setr_ps(-1.0f, 1.0f, 1.0f, -1.0f);
+
+		__m128 r = _mm_mul_ps(Swizzle<3, 3, 3, 3>(q2), q1);
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(Swizzle<0, 0, 0, 0>(q2), Swizzle<3, 2, 1, 0>(q1)), signsX));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(Swizzle<1, 1, 1, 1>(q2), Swizzle<2, 3, 0, 1>(q1)), signsY));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(Swizzle<2, 2, 2, 2>(q2), Swizzle<1, 0, 3, 2>(q1)), signsZ));
+		return r;
+	}
+
+	// World transform of a node from its local one and its parent's world.
+	// Loading Position and Scale as one vector scales both by the parent's
+	// scale in a single multiply; the rotation leaves w alone.
+	void Compose(const Transform& local, const Transform& parent, Transform& world)
+	{
+		__m128 parentPositionScale = _mm_loadu_ps(&parent.Position.x);
+		__m128 parentRotation = _mm_loadu_ps(&parent.Rotation.x);
+		__m128 v = _mm_mul_ps(_mm_loadu_ps(&local.Position.x), Swizzle<3, 3, 3, 3>(parentPositionScale));
+
+		// v + 2w (q x v) + 2 q x (q x v), with q the parent rotation.
+		__m128 t = Cross(parentRotation, v);
+		t = _mm_add_ps(t, t);
+		v = _mm_add_ps(v, _mm_mul_ps(Swizzle<3, 3, 3, 3>(parentRotation), t));
+		v = _mm_add_ps(v, Cross(parentRotation, t));
+
+		_mm_storeu_ps(&world.Position.x, _mm_add_ps(v, ClearW(parentPositionScale)));
+		_mm_storeu_ps(&world.Rotation.x, QuaternionMultiply(_mm_loadu_ps(&local.Rotation.x), parentRotation));
+	}
+
+	// Same matrix as Transform::ToMatrix: scale, then rotate, then translate.
+	// Row-vector, as in DirectXMath: rows 0-2 are the scaled rotation, row 3
+	// the translation.
+	void ComposeMatrix(const Transform& t, XMFLOAT4X4& matrix)
+	{
+		__m128 q = _mm_loadu_ps(&t.Rotation.x);
+		__m128 q2 = _mm_add_ps(q, q);
+
+		// D = diagonal: 1 - 2(yy + zz), 1 - 2(xx + zz), 1 - 2(xx + yy).
+		__m128 sq = _mm_mul_ps(q, q2);
+		__m128 d = ClearW(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_add_ps(Swizzle<1, 0, 0, 3>(sq), Swizzle<2, 2, 1, 3>(sq))));
+
+		// B = 2(yz, xz, xy), C = 2w(x, y, z); P = B + C and M = B - C hold
+		// the six off-diagonal terms.
+		__m128 b = _mm_mul_ps(Swizzle<1, 0, 0, 3>(q), Swizzle<2, 2, 1, 3>(q2));
+		__m128 c = _mm_mul_ps(Swizzle<3, 3, 3, 3>(q), q2);
+		__m128 p = ClearW(_mm_add_ps(b, c));
+		__m128 m = ClearW(_mm_sub_ps(b, c));
+
+		// (D0, P2, M1, 0), (M2, D1, P0, 0), (P1, M0, D2, 0).
+		__m128 scale = _mm_set1_ps(t.Scale);
+		__m128 t0 = _mm_shuffle_ps(d, p, _MM_SHUFFLE(2, 2, 0, 0));
+		__m128 t1 = _mm_shuffle_ps(m, d, _MM_SHUFFLE(1, 1, 2, 2));
+		__m128 t2 = _mm_shuffle_ps(p, m, _MM_SHUFFLE(0, 0, 1, 1));
+		_mm_storeu_ps(&matrix._11, _mm_mul_ps(_mm_shuffle_ps(t0, m, _MM_SHUFFLE(3, 1, 2, 0)), scale));
+		_mm_storeu_ps(&matrix._21, _mm_mul_ps(_mm_shuffle_ps(t1, p, _MM_SHUFFLE(3, 0, 2, 0)), scale));
+		_mm_storeu_ps(&matrix._31, _mm_mul_ps(_mm_shuffle_ps(t2, d, _MM_SHUFFLE(3, 2, 2, 0)), scale));
+		_mm_storeu_ps(&matrix._41, _mm_setr_ps(t.Position.x, t.Position.y, t.Position.z, 1.0f));
+	}
+}
+
+TransformHierarchy::NodeId TransformHierarchy::AddNode(NodeId parent, const Transform& local)
+{
+	assert(parent == InvalidNode || parent < GetNodeCount());
+
+	if (!m_freeNodes.empty())
+	{
+		// Reuse a removed node. It is a root without children, so SetParent
+		// can always place it without a sort.
+		NodeId node = m_freeNodes.back();
+		m_freeNodes.pop_back();
+
+		UINT slot = m_nodeToSlot[node];
+		m_local[slot] = local;
+		m_dirty[slot] = 1;
+		m_anyDirty = true;
+
+		SetParent(node, parent);
+		return node;
+	}
+
+	NodeId node = GetNodeCount();
+	m_parentNode.push_back(parent);
+	m_firstChild.push_back(InvalidNode);
+	m_nextSibling.push_back(InvalidNode);
+	m_prevSibling.push_back(InvalidNode);
+	m_nodeToSlot.push_back(InvalidNode);
+	if (parent != InvalidNode)
+		LinkChild(node, parent);
+
+	AppendSlot(node, local);
+	return node;
+}
+
+void TransformHierarchy::AppendSlot(NodeId node, const Transform& local)
+{
+	UINT slot = (UINT)m_slotToNode.size();
+	NodeId parent = m_parentNode[node];
+	UINT parentSlot = parent == InvalidNode ? InvalidNode : m_nodeToSlot[parent];
+
+	// Join the last level, unless that is where the parent is: then the node
+	// opens a level of its own after it.
+	UINT levelCount = (UINT)m_levelStart.size() - 1;
+	if (levelCount == 0 || (parentSlot != InvalidNode && m_slotLevel[parentSlot] == levelCount - 1))
+	{
+		m_levelStart.push_back(m_levelStart.back() + 1);
+		m_levelsOpened++;
+	}
+	else
+	{
+		m_levelStart.back()++;
+	}
+
+	m_nodeToSlot[node] = slot;
+	m_slotToNode.push_back(node);
+	m_parentSlot.push_back(parentSlot);
+	m_slotLevel.push_back((UINT)m_levelStart.size() - 2);
+	m_local.push_back(local);
+	m_world.push_back(Transform());
+	m_dirty.push_back(1);
+	m_updated.push_back(0);
+
+	m_anyDirty = true;
+}
+
+void TransformHierarchy::RemoveNode(NodeId node)
+{
+	assert(node < GetNodeCount());
+
+	while (m_firstChild[node] != InvalidNode)
+		SetParent(m_firstChild[node], InvalidNode);
+
+	// Removed nodes stay in the arrays as roots; they are cheap to carry
+	// until their id is handed out again.
+	SetParent(node, InvalidNode);
+	m_freeNodes.push_back(node);
+}
+
+bool TransformHierarchy::SetParent(NodeId node, NodeId parent)
+{
+	assert(node < GetNodeCount());
+	assert(parent == InvalidNode || parent < GetNodeCount());
+
+	if (m_parentNode[node] == parent)
+		return true;
+
+	// The hierarchy has no cycles, so walking up from the new parent ends at
+	// a root unless it passes through `node`.
+	for (NodeId n = parent; n != InvalidNode; n = m_parentNode[n])
+	{
+		if (n == node)
+			return false;
+	}
+
+	UnlinkChild(node);
+	m_parentNode[node] = parent;
+	if (parent != InvalidNode)
+		LinkChild(node, parent);
+
+	UINT slot = m_nodeToSlot[node];
+	UINT parentSlot = parent == InvalidNode ? InvalidNode : m_nodeToSlot[parent];
+	m_anyDirty = true;
+
+	// A root can sit in any level; a child needs its parent in an earlier one.
+	if (parentSlot == InvalidNode || m_slotLevel[parentSlot] < m_slotLevel[slot])
+	{
+		m_parentSlot[slot] = parentSlot;
+		m_dirty[slot] = 1;
+	}
+	else if (m_firstChild[node] == InvalidNode)
+	{
+		// A leaf moves to the end instead, leaving a hole the next sort
+		// closes.
+		Transform local = m_local[slot];
+		m_slotToNode[slot] = InvalidNode;
+		m_parentSlot[slot] = InvalidNode;
+		m_dirty[slot] = 0;
+		m_holes++;
+		AppendSlot(node, local);
+	}
+	else
+	{
+		m_parentSlot[slot] = parentSlot;
+		m_dirty[slot] = 1;
+		m_orderDirty = true;
+	}
+
+	return true;
+}
+
+void TransformHierarchy::LinkChild(NodeId node, NodeId parent)
+{
+	NodeId next = m_firstChild[parent];
+	m_prevSibling[node] = InvalidNode;
+	m_nextSibling[node] = next;
+	if (next != InvalidNode)
+		m_prevSibling[next] = node;
+	m_firstChild[parent] = node;
+}
+
+void TransformHierarchy::UnlinkChild(NodeId node)
+{
+	NodeId parent = m_parentNode[node];
+	if (parent == InvalidNode)
+		return;
+
+	NodeId prev = m_prevSibling[node];
+	NodeId next = m_nextSibling[node];
+	if (prev != InvalidNode)
+		m_nextSibling[prev] = next;
+	else
+		m_firstChild[parent] = next;
+	if (next != InvalidNode)
+		m_prevSibling[next] = prev;
+
+	m_prevSibling[node] = InvalidNode;
+	m_nextSibling[node] = InvalidNode;
+}
+
+void TransformHierarchy::SetLocal(NodeId node, const Transform& local)
+{
+	UINT slot = m_nodeToSlot[node];
+
+	m_local[slot] = local;
+	m_dirty[slot] = 1;
+
+	m_anyDirty = true;
+}
+
+void TransformHierarchy::Update()
+{
+	// Levels opened and holes left by appended slots are correct but cost
+	// the sweep; compact once they make up a good part of the hierarchy,
+	// which keeps the sort amortised O(1) per appended slot.
+	if (m_orderDirty || (m_levelsOpened > 1 && m_levelsOpened * 8 >= GetNodeCount()) || m_holes * 8 >= GetNodeCount() + 8)
+		SortByDepth();
+
+	if (!m_anyDirty)
+	{
+		// Nothing moved: just forget what changed during the previous update.
+		if (m_anyUpdated)
+		{
+			std::fill(m_updated.begin(), m_updated.end(), (std::uint8_t)0);
+			m_anyUpdated = false;
+		}
+		return;
+	}
+
+	// Every parent lives in an earlier level, so by the time a level is
+	// processed all of its parents already hold their final world transform.
+	for (size_t level = 0; level + 1 < m_levelStart.size(); ++level)
+	{
+		UINT first = m_levelStart[level];
+		UINT last = m_levelStart[level + 1];
+
+		if (last - first < c_parallelLevelSize)
+		{
+			for (UINT slot = first; slot < last; ++slot)
+				UpdateSlot(slot);
+		}
+		else
+		{
+			std::for_each(std::execution::par, m_slotToNode.begin() + first, m_slotToNode.begin() + last, [this](const NodeId& node)
+			{
+				UpdateSlot((UINT)(&node - m_slotToNode.data()));
+			});
+		}
+	}
+
+	m_anyDirty = false;
+	m_anyUpdated = true;
+}
+
+void TransformHierarchy::UpdateSlot(UINT slot)
+{
+	UINT parent = m_parentSlot[slot];
+
+	// A node is recomputed if it moved itself or if anything above it did.
+	bool updated = m_dirty[slot] || (parent != InvalidNode && m_updated[parent]);
+	m_updated[slot] = updated ? 1 : 0;
+	if (!updated)
+		return;
+
+	m_dirty[slot] = 0;
+
+	if (parent != InvalidNode)
+		Compose(m_local[slot], m_world[parent], m_world[slot]);
+	else
+		m_world[slot] = m_local[slot];
+}
+
+XMFLOAT4X4 TransformHierarchy::GetWorldMatrix(NodeId node) const
+{
+	XMFLOAT4X4 matrix;
+	ComposeMatrix(m_world[m_nodeToSlot[node]], matrix);
+	return matrix;
+}
+
+void TransformHierarchy::SortByDepth()
+{
+	const UINT count = GetNodeCount();
+
+	// Depth of every node, resolved by walking up to the first ancestor whose
+	// depth is already known.
+	std::vector<UINT> depth(count, UINT_MAX);
+	std::vector<NodeId> chain;
+	UINT maxDepth = 0;
+
+	for (NodeId node = 0; node < count; ++node)
+	{
+		chain.clear();
+		NodeId n = node;
+		while (n != InvalidNode && depth[n] == UINT_MAX)
+		{
+			chain.push_back(n);
+			n = m_parentNode[n];
+			assert(chain.size() <= count && "Cycle in transform hierarchy.");
+		}
+
+		UINT d = (n == InvalidNode) ? 0 : depth[n] + 1;
+		for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+			depth[*it] = d++;
+
+		maxDepth = MathHelper::Max(maxDepth, depth[node]);
+	}
+
+	// Counting sort by depth; stable, so siblings keep their creation order.
+	m_levelStart.assign(count > 0 ? maxDepth + 2 : 1, 0);
+	for (NodeId node = 0; node < count; ++node)
+		m_levelStart[depth[node] + 1]++;
+	for (size_t level = 1; level < m_levelStart.size(); ++level)
+		m_levelStart[level] += m_levelStart[level - 1];
+
+	std::vector<UINT> newNodeToSlot(count);
+	std::vector<UINT> cursor(m_levelStart.begin(), m_levelStart.end());
+	for (NodeId node = 0; node < count; ++node)
+		newNodeToSlot[node] = cursor[depth[node]]++;
+
+	std::vector<NodeId> slotToNode(count);
+	std::vector<UINT> parentSlot(count);
+	std::vector<Transform> local(count);
+	std::vector<Transform> world(count);
+	std::vector<std::uint8_t> dirty(count);
+
+	for (NodeId node = 0; node < count; ++node)
+	{
+		UINT oldSlot = m_nodeToSlot[node];
+		UINT newSlot = newNodeToSlot[node];
+		NodeId parent = m_parentNode[node];
+
+		slotToNode[newSlot] = node;
+		parentSlot[newSlot] = parent == InvalidNode ? InvalidNode : newNodeToSlot[parent];
+		local[newSlot] = m_local[oldSlot];
+		world[newSlot] = m_world[oldSlot];
+		dirty[newSlot] = m_dirty[oldSlot];
+	}
+
+	m_slotLevel.resize(count);
+	for (size_t level = 0; level + 1 < m_levelStart.size(); ++level)
+		std::fill(m_slotLevel.begin() + m_levelStart[level], m_slotLevel.begin() + m_levelStart[level + 1], (UINT)level);
+
+	m_nodeToSlot = std::move(newNodeToSlot);
+	m_slotToNode = std::move(slotToNode);
+	m_parentSlot = std::move(parentSlot);
+	m_local = std::move(local);
+	m_world = std::move(world);
+	m_dirty = std::move(dirty);
+	m_updated.assign(count, 0);
+
+	m_orderDirty = false;
+	m_levelsOpened = 0;
+	m_holes = 0;
+	m_anyUpdated = false;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include "MathTypes.h"
+#include "MathHelper.h"
+#include <vector>
+
+using namespace DirectX;
+
+// Parent/child transform graph. Nodes keep a compact local Transform and the
+// hierarchy owns their world transforms, in the same 32-byte form; world
+// matrices are composed from those on demand.
+//
+// Storage is structure-of-arrays in "slot" order: nodes are grouped in
+// levels, each a contiguous range, with every parent in an earlier level
+// than its children. Update() walks the levels front to back in one linear
+// sweep; nodes inside a level are independent and are processed in parallel
+// when the level is large enough. Node ids stay stable while slots move.
+//
+// Children are kept as first-child/next-sibling lists, and new nodes are
+// appended to the last level (or open a new one after their parent's), so
+// adding and removing nodes is O(1) per node and child. A leaf reparented
+// under a node that is not in an earlier level moves to a new slot at the
+// end; only moving a whole subtree that way makes Update() sort the slots by
+// depth again.
+class TransformHierarchy
+{
+public:
+
+	using NodeId = UINT;
+	static constexpr NodeId										InvalidNode = UINT_MAX;
+
+	NodeId														AddNode(NodeId parent, const Transform& local);
+	// Detaches the children of `node` (they become roots) and recycles its id
+	// for a later AddNode.
+	void														RemoveNode(NodeId node);
+	// Returns false and leaves the hierarchy unchanged if `parent` is `node`
+	// or one of its descendants.
+	bool														SetParent(NodeId node, NodeId parent);
+	void														SetLocal(NodeId node, const Transform& local);
+
+	// Recomputes world transforms of every dirty node and of all its descendants.
+	void														Update();
+
+	const Transform&											GetWorld(NodeId node)		const	{	return m_world[m_nodeToSlot[node]];	}
+	// Same as GetWorld(node).ToMatrix(), without going through DirectXMath.
+	XMFLOAT4X4													GetWorldMatrix(NodeId node)	const;
+	const Transform&											GetLocal(NodeId node)		const	{	return m_local[m_nodeToSlot[node]];	}
+	// True if the world transform of `node` changed during the last Update().
+	bool														WasUpdated(NodeId node)		const	{	return m_updated[m_nodeToSlot[node]] != 0;	}
+	NodeId														GetParent(NodeId node)		const	{	return m_parentNode[node];	}
+	// Includes removed nodes waiting to be recycled.
+	UINT														GetNodeCount()				const	{	return (UINT)m_parentNode.size();	}
+
+private:
+
+	void														AppendSlot(NodeId node, const Transform& local);
+	void														LinkChild(NodeId node, NodeId parent);
+	void														UnlinkChild(NodeId node);
+	void														SortByDepth();
+	void														UpdateSlot(UINT slot);
+
+	// Indexed by node id.
+	std::vector<NodeId>											m_parentNode;
+	std::vector<NodeId>											m_firstChild;
+	std::vector<NodeId>											m_nextSibling;
+	std::vector<NodeId>											m_prevSibling;
+	std::vector<UINT>											m_nodeToSlot;
+
+	// Indexed by slot.
+	std::vector<NodeId>											m_slotToNode;
+	std::vector<UINT>											m_parentSlot;
+	std::vector<UINT>											m_slotLevel;
+	std::vector<Transform>										m_local;
+	std::vector<Transform>										m_world;
+	std::vector<std::uint8_t>									m_dirty;
+	std::vector<std::uint8_t>									m_updated;
+
+	std::vector<NodeId>											m_freeNodes;
+
+	// Level d occupies slots [m_levelStart[d], m_levelStart[d + 1]).
+	std::vector<UINT>											m_levelStart { 0 };
+	// Levels opened and slots left empty by AppendSlot since the last sort.
+	// A sort merges the levels back into one per depth, for the parallel
+	// sweep, and closes the holes.
+	UINT														m_levelsOpened = 0;
+	UINT														m_holes = 0;
+
+	bool														m_orderDirty = false;
+	bool														m_anyDirty = false;
+	bool														m_anyUpdated = false;
+};
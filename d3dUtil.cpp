@@ -1,81 +1,18 @@
 #include "d3dUtil.h"
+#include <winver.h>
 
 bool d3dUtil::IsKeyDown(int vkeyCode)
 {
 	return (GetAsyncKeyState(vkeyCode) & 0x8000) != 0;
 }
 
-ID3D12Resource* d3dUtil::CreateDefaultBuffer(
-	ID3D12Device* device,
-	ID3D12GraphicsCommandList* cmdList,
-	const void* initData,
-	UINT64 byteSize,
-	ID3D12Resource* uploadBuffer)
-{
-	ID3D12Resource* defaultBuffer;
-	// Create the actual default buffer resource.
-
-	DX::ThrowIfFailed(device->CreateCommittedResource(
-		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
-		D3D12_HEAP_FLAG_NONE,
-		&CD3DX12_RESOURCE_DESC::Buffer(byteSize),
-		D3D12_RESOURCE_STATE_COMMON,
-		nullptr,
-		IID_PPV_ARGS(&defaultBuffer)));
-
-	// In order to copy CPU memory data into our default buffer, we need
-	//to create an intermediate upload heap. 
-
-	DX::ThrowIfFailed(device->CreateCommittedResource(
-		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
-		D3D12_HEAP_FLAG_NONE,
-		&CD3DX12_RESOURCE_DESC::Buffer(byteSize),
-		D3D12_RESOURCE_STATE_GENERIC_READ,
-		nullptr,
-		IID_PPV_ARGS(&uploadBuffer)));
-
-	// Describe the data we want to copy into the default buffer.
-	D3D12_SUBRESOURCE_DATA subResourceData = {};
-	subResourceData.pData = initData;
-	subResourceData.RowPitch = byteSize;
-	subResourceData.SlicePitch = subResourceData.RowPitch;
-
-	// Schedule to copy the data to the default buffer resource. 
-	// At a high level, the helper function UpdateSubresources
-	// will copy the CPU memory into the intermediate upload heap.
-	// Then, using ID3D12CommandList::CopySubresourceRegion,
-	// the intermediate upload heap data will be copied to mBuffer.
-	cmdList->ResourceBarrier(1,
-		&CD3DX12_RESOURCE_BARRIER::Transition(defaultBuffer,
-			D3D12_RESOURCE_STATE_COMMON,
-			D3D12_RESOURCE_STATE_COPY_DEST));
-
-	UpdateSubresources<1>(cmdList, defaultBuffer, uploadBuffer, 0, 0, 1, &subResourceData);
-
-	cmdList->ResourceBarrier(1,
-		&CD3DX12_RESOURCE_BARRIER::Transition(defaultBuffer,
-			D3D12_RESOURCE_STATE_COPY_DEST,
-			D3D12_RESOURCE_STATE_GENERIC_READ));
-
-	// Note: uploadBuffer has to be kept alive after the above function 
-	// calls because the command list has not been executed yet that
-	// performs the actual copy.
-	// The caller can Release the uploadBuffer after it knows the copy
-	// has been executed.
-	return defaultBuffer;
-}
-
 ID3DBlob* d3dUtil::CompileShader(
 	const std::wstring& filename,
 	const D3D_SHADER_MACRO* defines,
 	const std::string& entrypoint,
 	const std::string& target)
 {
-	// Use debug flags in debug mode.
-	UINT compileFlags = 0;
-#if defined(DEBUG) || defined(_DEBUG) 
-	compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-#endif
+	UINT compileFlags = DefaultShaderFlags();
 
 	HRESULT hr = S_OK;
 
@@ -94,6 +31,70 @@ ID3DBlob* d3dUtil::CompileShader(
 	return byteCode;
 }
 
+UINT d3dUtil::DefaultShaderFlags()
+{
+	UINT compileFlags = 0;
+#if defined(DEBUG) || defined(_DEBUG) 
+	compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#endif
+	return compileFlags;
+}
+
+std::string d3dUtil::ShaderCompilerVersion()
+{
+	// The header version alone would miss a DLL updated next to the
+	// executable, so read the version of the module actually loaded.
+	std::string version = "d3dcompiler " + std::to_string(D3D_COMPILER_VERSION);
+
+	HMODULE module = GetModuleHandleA(D3DCOMPILER_DLL_A);
+	char path[MAX_PATH];
+	if (module == nullptr || GetModuleFileNameA(module, path, MAX_PATH) == 0)
+		return version;
+
+	DWORD handle = 0;
+	DWORD size = GetFileVersionInfoSizeA(path, &handle);
+	std::vector<BYTE> info(size);
+	VS_FIXEDFILEINFO* fixed = nullptr;
+	UINT fixedSize = 0;
+	if (size == 0 || !GetFileVersionInfoA(path, 0, size, info.data()) ||
+		!VerQueryValueA(info.data(), "\\", (void**)&fixed, &fixedSize) || fixed == nullptr)
+		return version;
+
+	return version + " " +
+		std::to_string(HIWORD(fixed->dwFileVersionMS)) + "." + std::to_string(LOWORD(fixed->dwFileVersionMS)) + "." +
+		std::to_string(HIWORD(fixed->dwFileVersionLS)) + "." + std::to_string(LOWORD(fixed->dwFileVersionLS));
+}
+
+ShaderCache::CompileResult d3dUtil::CompileShader(const ShaderDesc& desc)
+{
+	std::vector<D3D_SHADER_MACRO> macros;
+	for (const ShaderDefine& define : desc.Defines)
+		macros.push_back({ define.Name.c_str(), define.Value.c_str() });
+	macros.push_back({ nullptr, nullptr });
+
+	std::wstring filename(desc.SourcePath.begin(), desc.SourcePath.end());
+
+	Microsoft::WRL::ComPtr<ID3DBlob> byteCode;
+	Microsoft::WRL::ComPtr<ID3DBlob> errors;
+	HRESULT hr = D3DCompileFromFile(filename.c_str(), macros.data(), D3D_COMPILE_STANDARD_FILE_INCLUDE,
+		desc.EntryPoint.c_str(), desc.Target.c_str(), desc.Flags, 0, &byteCode, &errors);
+
+	ShaderCache::CompileResult result;
+	if (errors != nullptr)
+	{
+		result.Errors.assign((const char*)errors->GetBufferPointer(), errors->GetBufferSize());
+		OutputDebugStringA(result.Errors.c_str());
+	}
+
+	result.Success = SUCCEEDED(hr);
+	if (result.Success)
+	{
+		const std::uint8_t* bytes = static_cast<const std::uint8_t*>(byteCode->GetBufferPointer());
+		result.Bytecode.assign(bytes, bytes + byteCode->GetBufferSize());
+	}
+	return result;
+}
+
 std::wstring DxException::ToString()const
 {
 	// Get the string description of the error code.
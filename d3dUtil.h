@@ -2,14 +2,13 @@
 #include "framework.h"
 #include <exception>
 #include <unordered_map>
+#include "ShaderCache.h"
 
 class d3dUtil
 {
 public:
 	static bool IsKeyDown(int vkeyCode);
 
-	static ID3D12Resource* CreateDefaultBuffer(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList, const void* initData, UINT64 byteSize, ID3D12Resource* uploadBuffer);
-
 	static UINT d3dUtil::CalcConstantBufferByteSize(UINT byteSize)
 	{
 		// Constant buffers must be a multiple of the minimum hardware
@@ -32,6 +31,15 @@ public:
 		const std::string& entrypoint,
 		const std::string& target);
 
+	// D3DCompileFromFile front end for ShaderCache.
+	static ShaderCache::CompileResult CompileShader(const ShaderDesc& desc);
+
+	// Debug info and no optimization in debug builds.
+	static UINT DefaultShaderFlags();
+
+	// File version of the d3dcompiler DLL in use, for ShaderCache keys.
+	static std::string ShaderCompilerVersion();
+
 private:
 	ID3D12Resource* mUploadBuffer;
 	BYTE* mMappedData;
@@ -63,69 +71,6 @@ namespace DX
 	}
 }
 
-struct SubmeshGeometry
-{
-	UINT IndexCount = 0;
-	UINT StartIndexLocation = 0;
-	INT BaseVertexLocation = 0;
-
-};
-
-struct MeshGeometry
-{
-	// Give it a name so we can look it up by name.
-	std::string Name;
-
-	// System memory copies.  Use Blobs because the vertex/index format can be generic.
-	// It is up to the client to cast appropriately.  
-	ID3DBlob* VertexBufferCPU = nullptr;
-	ID3DBlob* IndexBufferCPU = nullptr;
-
-	ID3D12Resource* VertexBufferGPU = nullptr;
-	ID3D12Resource* IndexBufferGPU = nullptr;
-
-	ID3D12Resource* VertexBufferUploader = nullptr;
-	ID3D12Resource* IndexBufferUploader = nullptr;
-
-	// Data about the buffers.
-	UINT VertexByteStride = 0;
-	UINT VertexBufferByteSize = 0;
-	DXGI_FORMAT IndexFormat = DXGI_FORMAT_R16_UINT;
-	UINT IndexBufferByteSize = 0;
-
-	// A MeshGeometry may store multiple geometries in one vertex/index buffer.
-	// Use this container to define the Submesh geometries so we can draw
-	// the Submeshes individually.
-	std::unordered_map<std::string, SubmeshGeometry> DrawArgs;
-
-	D3D12_VERTEX_BUFFER_VIEW VertexBufferView()const
-	{
-		D3D12_VERTEX_BUFFER_VIEW vbv;
-		vbv.BufferLocation = VertexBufferGPU->GetGPUVirtualAddress();
-		vbv.StrideInBytes = VertexByteStride;
-		vbv.SizeInBytes = VertexBufferByteSize;
-
-		return vbv;
-	}
-
-	D3D12_INDEX_BUFFER_VIEW IndexBufferView()const
-	{
-		D3D12_INDEX_BUFFER_VIEW ibv;
-		ibv.BufferLocation = IndexBufferGPU->GetGPUVirtualAddress();
-		ibv.Format = IndexFormat;
-		ibv.SizeInBytes = IndexBufferByteSize;
-
-		return ibv;
-	}
-
-	// We can free this memory after we finish upload to the GPU.
-	void DisposeUploaders()
-	{
-		VertexBufferUploader = nullptr;
-		IndexBufferUploader = nullptr;
-	}
-};
-
 class DxException
 {
 public: